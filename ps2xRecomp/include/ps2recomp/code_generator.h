@@ -41,6 +41,15 @@ namespace ps2recomp
         void setRenamedFunctions(const std::unordered_map<uint32_t, std::string> &renames);
         void setBootstrapInfo(const BootstrapInfo &info);
         void setRelocationCallNames(const std::unordered_map<uint32_t, std::string> &callNames);
+        // Extra void name(PS2Runtime &) registration functions called at the end of registerAllFunctions.
+        void setRegistrationHooks(const std::vector<std::string> &hooks);
+        // ps2_watch specs armed at the start of registerAllFunctions.
+        void setWatchpoints(const std::vector<std::string> &watchpoints);
+        // When set, generateFunction emits #line directives so the host debug info of each
+        // guest instruction points at its line in this listing; empty disables them.
+        void setGuestListingPath(const std::string &path);
+        // One line per guest instruction emitted since setGuestListingPath, in #line order.
+        std::string generateGuestListing() const;
         std::unordered_set<uint32_t> collectInternalBranchTargets(const Function &function,
                                                                   const std::vector<Instruction> &instructions);
 
@@ -49,6 +58,10 @@ namespace ps2recomp
         std::unordered_map<uint32_t, std::string> m_renamedFunctions;
         std::unordered_map<uint32_t, std::string> m_relocationCallNames;
         BootstrapInfo m_bootstrapInfo;
+        std::vector<std::string> m_registrationHooks;
+        std::vector<std::string> m_watchpoints;
+        std::string m_guestListingPath;
+        std::vector<std::string> m_guestListing;
 
         std::string translateInstruction(const Instruction &inst);
         std::string translateMMIInstruction(const Instruction &inst);
@@ -637,6 +637,65 @@ namespace ps2recomp
         VU0_S2_VRXOR = 0x43
     };
 
+    // VU micro mode lower instructions with bit 31 clear (bits 31-25). Upper
+    // instructions share the VU0 macro Special1/Special2 numbering, as do the
+    // lower integer (Special1 0x30-0x35) and Special2 0x30-0x43 forms.
+    enum VUMicroLowerFunctions : uint8_t
+    {
+        VU_LOWER_LQ = 0x00,
+        VU_LOWER_SQ = 0x01,
+        VU_LOWER_ILW = 0x04,
+        VU_LOWER_ISW = 0x05,
+        VU_LOWER_IADDIU = 0x08,
+        VU_LOWER_ISUBIU = 0x09,
+        VU_LOWER_FCEQ = 0x10,
+        VU_LOWER_FCSET = 0x11,
+        VU_LOWER_FCAND = 0x12,
+        VU_LOWER_FCOR = 0x13,
+        VU_LOWER_FSEQ = 0x14,
+        VU_LOWER_FSSET = 0x15,
+        VU_LOWER_FSAND = 0x16,
+        VU_LOWER_FSOR = 0x17,
+        VU_LOWER_FMEQ = 0x18,
+        VU_LOWER_FMAND = 0x1A,
+        VU_LOWER_FMOR = 0x1B,
+        VU_LOWER_FCGET = 0x1C,
+        VU_LOWER_B = 0x20,
+        VU_LOWER_BAL = 0x21,
+        VU_LOWER_JR = 0x24,
+        VU_LOWER_JALR = 0x25,
+        VU_LOWER_IBEQ = 0x28,
+        VU_LOWER_IBNE = 0x29,
+        VU_LOWER_IBLTZ = 0x2C,
+        VU_LOWER_IBGTZ = 0x2D,
+        VU_LOWER_IBLEZ = 0x2E,
+        VU_LOWER_IBGEZ = 0x2F,
+    };
+
+    // VU micro mode lower Special2 entries past the macro table: EFU, XGKICK
+    // and friends ((bits 10-6 << 2) | bits 1-0 of a 0x3C-0x3F function).
+    enum VUMicroLowerSpecialFunctions : uint8_t
+    {
+        VU_LOWER_S2_MFP = 0x64,
+        VU_LOWER_S2_XTOP = 0x68,
+        VU_LOWER_S2_XITOP = 0x69,
+        VU_LOWER_S2_XGKICK = 0x6C,
+        VU_LOWER_S2_ESADD = 0x70,
+        VU_LOWER_S2_ERSADD = 0x71,
+        VU_LOWER_S2_ELENG = 0x72,
+        VU_LOWER_S2_ERLENG = 0x73,
+        VU_LOWER_S2_EATANxy = 0x74,
+        VU_LOWER_S2_EATANxz = 0x75,
+        VU_LOWER_S2_ESUM = 0x76,
+        VU_LOWER_S2_ESQRT = 0x78,
+        VU_LOWER_S2_ERSQRT = 0x79,
+        VU_LOWER_S2_ERCPR = 0x7A,
+        VU_LOWER_S2_WAITP = 0x7B,
+        VU_LOWER_S2_ESIN = 0x7C,
+        VU_LOWER_S2_EATAN = 0x7D,
+        VU_LOWER_S2_EEXP = 0x7E,
+    };
+
     // // VU0 macro instruction function codes (subset - there are many more)
     // enum VU0MacroFunctions
     // {
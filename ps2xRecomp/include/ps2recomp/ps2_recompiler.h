@@ -51,6 +51,7 @@ namespace ps2recomp
         std::vector<Symbol> m_symbols;
         std::vector<Section> m_sections;
         std::vector<Relocation> m_relocations;
+        std::vector<VUMicroprogram> m_vuPrograms;
 
         std::unordered_map<uint32_t, std::vector<Instruction>> m_decodedFunctions;
         std::unordered_map<std::string, bool> m_skipFunctions;
@@ -68,6 +69,7 @@ namespace ps2recomp
         bool isStubFunction(const Function &function) const;
         bool generateFunctionHeader();
         bool generateStubHeader();
+        bool generateVuMicroprograms();
         bool writeToFile(const std::string &path, const std::string &content);
         std::filesystem::path getOutputPath(const Function &function) const;
         std::string sanitizeFunctionName(const std::string &name) const;       
@@ -165,6 +165,59 @@ namespace ps2recomp
         std::string calleeName;
     };
 
+    // One VU micro mode instruction pair (lower word at the lower address)
+    struct VUInstruction
+    {
+        uint32_t address = 0; // micro memory byte offset
+        uint32_t upper = 0;
+        uint32_t lower = 0;
+        bool iBit = false; // lower word is an immediate for I
+        bool eBit = false; // program ends after the next pair
+        bool mBit = false;
+        bool dBit = false;
+        bool tBit = false;
+
+        // Upper: VU0MacroSpecial1Functions, or VU0MacroSpecial2Functions when upperSpecial
+        uint8_t upperFunction = 0;
+        bool upperSpecial = false;
+        uint8_t dest = 0;
+        uint8_t ft = 0;
+        uint8_t fs = 0;
+        uint8_t fd = 0;
+        uint8_t bc = 0;
+
+        // Lower: VUMicroLowerFunctions (lowerType2), VU0MacroSpecial1Functions
+        // (integer ops) or VU0MacroSpecial2/VUMicroLowerSpecialFunctions (lowerSpecial)
+        uint8_t lowerFunction = 0;
+        bool lowerType2 = false;
+        bool lowerSpecial = false;
+        uint8_t lowerDest = 0;
+        uint8_t it = 0; // also ft
+        uint8_t is = 0; // also fs
+        uint8_t id = 0; // also imm5
+        uint8_t fsf = 0;
+        uint8_t ftf = 0;
+        int32_t imm11 = 0;
+        uint32_t imm12 = 0;
+        uint32_t imm15 = 0;
+        uint32_t imm24 = 0;
+
+        bool isBranch = false;      // B, BAL, IBxx (target known)
+        bool isJump = false;        // JR, JALR (target in a VI register)
+        uint32_t branchTarget = 0;  // doublewords
+        bool valid = true;
+    };
+
+    // Microcode uploaded by VIF MPG commands found in the ELF data.
+    struct VUMicroprogram
+    {
+        uint32_t elfAddress = 0;  // where the first MPG's data sits in the ELF
+        uint32_t loadAddress = 0; // micro memory byte offset
+        std::vector<uint8_t> code;
+        uint64_t hash = 0;
+        std::vector<VUInstruction> instructions;
+    };
+
     // Recompiler configuration
     struct RecompilerConfig
     {
@@ -175,10 +228,13 @@ namespace ps2recomp
         bool patchSyscalls = false;
         bool patchCop0 = true;
         bool patchCache = true;
+        bool recompileVuMicrocode = true;
         std::vector<std::string> skipFunctions;
         std::unordered_map<uint32_t, std::string> patches;
         std::vector<std::string> stubImplementations;
         std::unordered_map<uint32_t, uint32_t> mmioByInstructionAddress;
+        std::vector<std::string> watchpoints; // ps2_watch specs armed by registerAllFunctions
+        bool guestLineInfo = false;           // point generated code's line info at guest_lines.lst
     };
 
 } // namespace ps2recomp
@@ -0,0 +1,41 @@
+#ifndef PS2RECOMP_VU_CODE_GENERATOR_H
+#define PS2RECOMP_VU_CODE_GENERATOR_H
+
+#include "ps2recomp/types.h"
+#include <string>
+#include <vector>
+
+namespace ps2recomp
+{
+
+    // Emits C++ for VU microprograms. Each program becomes one function over
+    // ps2_vu::State that keeps VF/VI/ACC/Q/P/I in locals (__m128 for vectors),
+    // enters through a switch on the start pc and ends by returning kEnd, or the
+    // pc of a branch that leaves the upload so the runtime can dispatch it.
+    class VUCodeGenerator
+    {
+    public:
+        std::string generateProgram(const VUMicroprogram &program) const;
+        // Every program plus registerVuMicroprograms(PS2Runtime &).
+        std::string generateFile(const std::vector<VUMicroprogram> &programs) const;
+
+        static std::string getProgramName(const VUMicroprogram &program);
+        static constexpr const char *kRegistrationFunction = "registerVuMicroprograms";
+
+    private:
+        struct UpperCode
+        {
+            std::string compute; // before the lower instruction runs
+            std::string commit;  // after it
+        };
+
+        UpperCode translateUpper(const VUInstruction &inst, bool flagsUsed) const;
+        std::string translateLower(const VUInstruction &inst) const;
+        std::string translateBranchCondition(const VUInstruction &inst) const;
+        // Upper, lower (branches excluded) and I immediate of one pair.
+        std::string translatePair(const VUInstruction &inst, bool flagsUsed, const std::string &indent) const;
+    };
+
+} // namespace ps2recomp
+
+#endif // PS2RECOMP_VU_CODE_GENERATOR_H
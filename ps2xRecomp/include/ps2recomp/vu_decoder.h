@@ -0,0 +1,39 @@
+#ifndef PS2RECOMP_VU_DECODER_H
+#define PS2RECOMP_VU_DECODER_H
+
+#include "ps2recomp/types.h"
+#include "ps2recomp/instructions.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ps2recomp
+{
+
+    // Decodes VU micro mode code: 64-bit pairs of an upper (FMAC) and a lower
+    // (integer, load/store, branch, FDIV/EFU) instruction, with the I/E/M/D/T
+    // bits at the top of the upper word.
+    class VUDecoder
+    {
+    public:
+        VUInstruction decodePair(uint32_t address, uint32_t lower, uint32_t upper) const;
+        std::vector<VUInstruction> decodeProgram(const uint8_t *code, uint32_t size, uint32_t loadAddress) const;
+
+        // Scans ELF data for VIF MPG commands and returns each upload (adjacent
+        // MPGs to consecutive addresses merged) that decodes cleanly and ends.
+        std::vector<VUMicroprogram> findMicroprograms(const std::vector<Section> &sections) const;
+
+        // Must match ps2_vu::contentHash in the runtime.
+        static constexpr uint64_t kHashSeed = 0xCBF29CE484222325ull;
+        static uint64_t contentHash(const uint8_t *bytes, size_t size, uint64_t seed = kHashSeed);
+
+        static constexpr uint32_t kMicroMemorySize = 16u * 1024u; // VU1
+
+    private:
+        bool decodeUpper(VUInstruction &inst) const;
+        bool decodeLower(VUInstruction &inst) const;
+    };
+
+} // namespace ps2recomp
+
+#endif // PS2RECOMP_VU_DECODER_H
@@ -52,6 +52,21 @@ namespace ps2recomp
         return literal;
     }
 
+    static std::string escapeStringLiteral(const std::string &text)
+    {
+        std::string escaped;
+        escaped.reserve(text.size());
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
     static std::string sanitizeIdentifierBody(const std::string &name)
     {
         std::string sanitized;
@@ -116,6 +131,33 @@ namespace ps2recomp
         m_bootstrapInfo = info;
     }
 
+    void CodeGenerator::setRegistrationHooks(const std::vector<std::string> &hooks)
+    {
+        m_registrationHooks = hooks;
+    }
+
+    void CodeGenerator::setWatchpoints(const std::vector<std::string> &watchpoints)
+    {
+        m_watchpoints = watchpoints;
+    }
+
+    void CodeGenerator::setGuestListingPath(const std::string &path)
+    {
+        m_guestListingPath = path;
+        m_guestListing.clear();
+    }
+
+    std::string CodeGenerator::generateGuestListing() const
+    {
+        std::string listing;
+        for (const auto &line : m_guestListing)
+        {
+            listing += line;
+            listing += '\n';
+        }
+        return listing;
+    }
+
     void CodeGenerator::setRelocationCallNames(const std::unordered_map<uint32_t, std::string> &callNames)
     {
         m_relocationCallNames = callNames;
@@ -260,6 +302,7 @@ namespace ps2recomp
                     else
                     {
                         ss << "    {\n";
+                        ss << fmt::format("        PS2_PROFILE_CALL(0x{:X}u);\n", target);
                         ss << "        const uint32_t __entryPc = ctx->pc;\n";
                         ss << "        " << funcName << "(rdram, ctx, runtime);\n";
                         ss << fmt::format("        if (ctx->pc == __entryPc) {{ ctx->pc = 0x{:X}u; }}\n", fallthroughPc);
@@ -284,6 +327,8 @@ namespace ps2recomp
                             const std::string_view handlerName = isSyscall ? resolvedSyscallName : resolvedStubName;
 
                             ss << "    {\n";
+                            ss << "        " << (isSyscall ? "PS2_CALL_STATS_SYSCALL(" : "PS2_CALL_STATS_STUB(")
+                               << handlerName << ");\n";
                             ss << "        const uint32_t __entryPc = ctx->pc;\n";
                             ss << "        "
                                << (isSyscall ? "ps2_syscalls::" : "ps2_stubs::")
@@ -306,6 +351,10 @@ namespace ps2recomp
                     {
                         ss << "    {\n";
                         ss << fmt::format("        auto targetFn = runtime->lookupFunction(0x{:X}u);\n", target);
+                        if (branchInst.opcode == OPCODE_JAL)
+                        {
+                            ss << fmt::format("        PS2_PROFILE_CALL(0x{:X}u);\n", target);
+                        }
                         ss << "        const uint32_t __entryPc = ctx->pc;\n";
                         ss << "        targetFn(rdram, ctx, runtime);\n";
                         if (branchInst.opcode == OPCODE_J)
@@ -363,6 +412,7 @@ namespace ps2recomp
             {
                 ss << "        {\n";
                 ss << "            auto targetFn = runtime->lookupFunction(jumpTarget);\n";
+                ss << "            PS2_PROFILE_CALL(jumpTarget);\n";
                 ss << "            const uint32_t __entryPc = ctx->pc;\n";
                 ss << "            targetFn(rdram, ctx, runtime);\n";
                 ss << fmt::format("            if (ctx->pc == __entryPc) {{ ctx->pc = 0x{:X}u; }}\n", fallthroughPc);
@@ -673,32 +723,50 @@ namespace ps2recomp
 
             ss << "    // 0x" << std::hex << inst.address << ": 0x" << inst.raw << std::dec << "\n";
 
+            std::string lineDirective;
+            if (!m_guestListingPath.empty())
+            {
+                m_guestListing.push_back(fmt::format("0x{:08X}  0x{:08X}  {}+0x{:X}", inst.address, inst.raw,
+                                                     function.name, inst.address - function.start));
+                lineDirective = "#line " + std::to_string(m_guestListing.size()) + " \"" +
+                                escapeStringLiteral(m_guestListingPath) + "\"\n";
+            }
+
+            // Collected first so every line of the instruction can carry its listing line.
+            std::stringstream body;
             try
             {
                 if (inst.hasDelaySlot && i + 1 < instructions.size())
                 {
                     const Instruction &delaySlot = instructions[i + 1];
+                    if (!m_guestListingPath.empty())
+                    {
+                        // The delay slot is emitted inside the branch code, so it shares the branch's line.
+                        m_guestListing.push_back(fmt::format("0x{:08X}  0x{:08X}  {}+0x{:X}  (delay slot)",
+                                                             delaySlot.address, delaySlot.raw, function.name,
+                                                             delaySlot.address - function.start));
+                    }
 
                     if (internalTargets.contains(delaySlot.address))
                     {
-                        ss << "label_" << std::hex << delaySlot.address << std::dec << ":\n";
+                        body << "label_" << std::hex << delaySlot.address << std::dec << ":\n";
                     }
 
-                    ss << handleBranchDelaySlots(inst, delaySlot, function, internalTargets);
+                    body << handleBranchDelaySlots(inst, delaySlot, function, internalTargets);
 
                     ++i; // Skip delay slot instruction (handled inside branch logic)
                 }
                 else
                 {
-                    ss << "    ctx->pc = 0x" << std::hex << inst.address << "u;\n"
-                       << std::dec;
+                    body << "    ctx->pc = 0x" << std::hex << inst.address << "u;\n"
+                         << std::dec;
 
-                    ss << "    " << translateInstruction(inst);
+                    body << "    " << translateInstruction(inst);
                     if (inst.isMmio)
                     {
-                        ss << " // MMIO: 0x" << std::hex << inst.mmioAddress << std::dec;
+                        body << " // MMIO: 0x" << std::hex << inst.mmioAddress << std::dec;
                     }
-                    ss << "\n";
+                    body << "\n";
                 }
             }
             catch (const std::exception &e)
@@ -712,6 +780,18 @@ namespace ps2recomp
 
                 throw;
             }
+
+            if (lineDirective.empty())
+            {
+                ss << body.str();
+                continue;
+            }
+            // #line only names the next source line, and branch code spans many.
+            std::string line;
+            while (std::getline(body, line))
+            {
+                ss << lineDirective << line << "\n";
+            }
         }
 
         ss << "}\n";
@@ -2519,27 +2599,14 @@ namespace ps2recomp
         uint16_t instr_index = static_cast<uint16_t>((inst.raw >> 6) & 0x1FF); // imm15[8:0]
         uint32_t target_byte_addr = static_cast<uint32_t>(instr_index) << 3;   // Convert instruction index to byte address
 
-        return fmt::format(
-            "{{ "
-            "    ctx->vu0_tpc = 0x{:X}; " // Set target program counter
-            "    runtime->executeVU0Microprogram(rdram, ctx, 0x{:X}); "
-            "}}",
-            target_byte_addr, target_byte_addr);
+        return fmt::format("PS2_VCALLMS(0x{:X});", target_byte_addr);
     }
 
     std::string CodeGenerator::translateVU_VCALLMSR(const Instruction &inst)
     {
-        // VCALLMSR calls a VU0 microprogram at address stored in integer register
-        uint8_t vis_reg_idx = inst.rd; // Source integer register (vis)
-
-        return fmt::format(
-            "{{ "
-            "    uint16_t instr_index = ctx->vi[{}] & 0x1FF; "             // Get instruction index from VI[IS], mask to 9 bits
-            "    uint32_t target_byte_addr = (uint32_t)instr_index << 3; " // Convert to byte address
-            "    ctx->vu0_pc = target_byte_addr; "
-            "    runtime->vu0StartMicroProgram(rdram, ctx, target_byte_addr); "
-            "}}",
-            vis_reg_idx);
+        // VCALLMSR starts the VU0 microprogram at CMSAR0 (the vi27 control register).
+        (void)inst;
+        return "PS2_VCALLMSR(ctx->vu0_cmsar0);";
     }
 
     std::string CodeGenerator::translateVU_VRNEXT(const Instruction &inst)
@@ -3218,11 +3285,57 @@ namespace ps2recomp
         ss << "#include \"ps2_recompiled_functions.h\"\n";
         ss << "#include \"ps2_stubs.h\"\n";
         ss << "#include \"ps2_recompiled_stubs.h\"//this will give duplicated erros because runtime maybe has it define already, just delete the TODOS ones\n";
+        ss << "#include \"ps2_symbols.h\"\n";
         ss << "#include \"ps2_syscalls.h\"\n\n";
 
+        // Guest extent of every recompiled function, for the profiler.
+        std::vector<const Function *> symbolFunctions;
+        for (const auto &function : functions)
+        {
+            if (function.isRecompiled && !function.isStub && !function.isSkipped && function.end > function.start)
+            {
+                symbolFunctions.push_back(&function);
+            }
+        }
+        if (!symbolFunctions.empty())
+        {
+            ss << "static const ps2_symbols::FunctionSymbol kFunctionSymbols[] = {\n";
+            for (const Function *function : symbolFunctions)
+            {
+                const std::string name = function->name.empty() ? getFunctionName(function->start) : function->name;
+                ss << fmt::format("    {{0x{:X}u, 0x{:X}u, \"{}\"}},\n",
+                                  function->start, function->end, escapeStringLiteral(name));
+            }
+            ss << "};\n\n";
+        }
+
+        for (const auto &hook : m_registrationHooks)
+        {
+            ss << "void " << hook << "(PS2Runtime &runtime);\n";
+        }
+        if (!m_registrationHooks.empty())
+        {
+            ss << "\n";
+        }
+
         // Registration function
         ss << "void registerAllFunctions(PS2Runtime& runtime) {\n";
 
+        if (!m_watchpoints.empty())
+        {
+            ss << "    // Watchpoints from general.watchpoints\n";
+            for (const auto &spec : m_watchpoints)
+            {
+                ss << "    ps2_watch::configure(\"" << escapeStringLiteral(spec) << "\");\n";
+            }
+            ss << "\n";
+        }
+
+        if (!symbolFunctions.empty())
+        {
+            ss << "    ps2_symbols::registerFunctions(kFunctionSymbols, sizeof(kFunctionSymbols) / sizeof(kFunctionSymbols[0]));\n\n";
+        }
+
         std::vector<std::pair<uint32_t, std::string>> normalFunctions;
         std::vector<std::pair<uint32_t, std::string>> stubFunctions;
         std::vector<std::pair<uint32_t, std::string>> systemCallFunctions;
@@ -3300,6 +3413,11 @@ namespace ps2recomp
             emitRegistration(first, second);
         }
 
+        for (const auto &hook : m_registrationHooks)
+        {
+            ss << "\n    " << hook << "(runtime);\n";
+        }
+
         ss << "}\n";
 
         return ss.str();
@@ -32,6 +32,8 @@ namespace ps2recomp
             config.patchSyscalls = toml::find_or<bool>(general, "patch_syscalls", config.patchSyscalls);
             config.patchCop0 = toml::find_or<bool>(general, "patch_cop0", config.patchCop0);
             config.patchCache = toml::find_or<bool>(general, "patch_cache", config.patchCache);
+            config.recompileVuMicrocode = toml::find_or<bool>(general, "recompile_vu_microcode", config.recompileVuMicrocode);
+            config.guestLineInfo = toml::find_or<bool>(general, "guest_line_info", config.guestLineInfo);
 
             if (general.contains("stubs") && general.at("stubs").is_array())
             {
@@ -51,6 +53,11 @@ namespace ps2recomp
                 config.skipFunctions = toml::find<std::vector<std::string>>(data, "skip");
             }
 
+            if (general.contains("watchpoints") && general.at("watchpoints").is_array())
+            {
+                config.watchpoints = toml::find<std::vector<std::string>>(general, "watchpoints");
+            }
+
             if (data.contains("patches") && data.at("patches").is_table())
             {
                 const auto &patches = toml::find(data, "patches");
@@ -134,8 +141,14 @@ namespace ps2recomp
         general["patch_syscalls"] = config.patchSyscalls;
         general["patch_cop0"] = config.patchCop0;
         general["patch_cache"] = config.patchCache;
+        general["recompile_vu_microcode"] = config.recompileVuMicrocode;
+        general["guest_line_info"] = config.guestLineInfo;
         general["skip"] = config.skipFunctions;
         general["stubs"] = config.stubImplementations;
+        if (!config.watchpoints.empty())
+        {
+            general["watchpoints"] = config.watchpoints;
+        }
         data["general"] = general;
 
         if (!config.mmioByInstructionAddress.empty())
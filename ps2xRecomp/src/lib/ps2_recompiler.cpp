@@ -3,6 +3,8 @@
 #include "ps2recomp/types.h"
 #include "ps2recomp/elf_parser.h"
 #include "ps2recomp/r5900_decoder.h"
+#include "ps2recomp/vu_code_generator.h"
+#include "ps2recomp/vu_decoder.h"
 #include "ps2_runtime_calls.h"
 #include <iostream>
 #include <fstream>
@@ -896,6 +898,11 @@ namespace ps2recomp
 
             discoverAdditionalEntryPoints();
 
+            if (m_config.recompileVuMicrocode)
+            {
+                m_vuPrograms = VUDecoder().findMicroprograms(m_sections);
+            }
+
             if (failedCount > 0)
             {
                 std::cerr << "Recompile completed with " << failedCount << " function(s) skipped due decode issues." << std::endl;
@@ -1006,11 +1013,13 @@ namespace ps2recomp
                         const std::string_view resolvedStubName = ps2_runtime_calls::resolveStubName(dispatchName);
                         if (!resolvedSyscallName.empty())
                         {
-                            stub << "ps2_syscalls::" << resolvedSyscallName << "(rdram, ctx, runtime); ";
+                            stub << "PS2_CALL_STATS_SYSCALL(" << resolvedSyscallName << "); "
+                                 << "ps2_syscalls::" << resolvedSyscallName << "(rdram, ctx, runtime); ";
                         }
                         else if (!resolvedStubName.empty())
                         {
-                            stub << "ps2_stubs::" << resolvedStubName << "(rdram, ctx, runtime); ";
+                            stub << "PS2_CALL_STATS_STUB(" << resolvedStubName << "); "
+                                 << "ps2_stubs::" << resolvedStubName << "(rdram, ctx, runtime); ";
                         }
                         else
                         {
@@ -1034,6 +1043,9 @@ namespace ps2recomp
 
             generateFunctionHeader();
 
+            const fs::path guestListingPath = fs::absolute(fs::path(m_config.outputPath) / "guest_lines.lst");
+            m_codeGenerator->setGuestListingPath(m_config.guestLineInfo ? guestListingPath.generic_string() : std::string());
+
             if (m_config.singleFileOutput)
             {
                 std::stringstream combinedOutput;
@@ -1130,6 +1142,23 @@ namespace ps2recomp
                 std::cout << "Wrote individual function files to: " << m_config.outputPath << std::endl;
             }
 
+            if (m_config.guestLineInfo)
+            {
+                if (!writeToFile(guestListingPath.string(), m_codeGenerator->generateGuestListing()))
+                {
+                    throw std::runtime_error("Failed to write guest line listing: " + guestListingPath.string());
+                }
+                std::cout << "Wrote guest line listing to: " << guestListingPath << std::endl;
+            }
+
+            std::vector<std::string> registrationHooks;
+            if (generateVuMicroprograms())
+            {
+                registrationHooks.push_back(VUCodeGenerator::kRegistrationFunction);
+            }
+            m_codeGenerator->setRegistrationHooks(registrationHooks);
+            m_codeGenerator->setWatchpoints(m_config.watchpoints);
+
             std::string registerFunctions = m_codeGenerator->generateFunctionRegistration(m_functions, m_generatedStubs);
 
             fs::path registerPath = fs::path(m_config.outputPath) / "register_functions.cpp";
@@ -1147,6 +1176,23 @@ namespace ps2recomp
         }
     }
 
+    bool PS2Recompiler::generateVuMicroprograms()
+    {
+        if (m_vuPrograms.empty())
+        {
+            return false;
+        }
+
+        VUCodeGenerator generator;
+        fs::path outputPath = fs::path(m_config.outputPath) / "vu_microprograms.cpp";
+        if (!writeToFile(outputPath.string(), generator.generateFile(m_vuPrograms)))
+        {
+            throw std::runtime_error("Failed to write VU microprograms: " + outputPath.string());
+        }
+        std::cout << "Wrote " << m_vuPrograms.size() << " VU microprogram(s) to: " << outputPath << std::endl;
+        return true;
+    }
+
     bool PS2Recompiler::generateStubHeader()
     {
         try
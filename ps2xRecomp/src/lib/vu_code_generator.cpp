@@ -0,0 +1,609 @@
+#include "ps2recomp/vu_code_generator.h"
+#include "ps2recomp/instructions.h"
+#include "ps2recomp/vu_decoder.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+namespace ps2recomp
+{
+    namespace
+    {
+        constexpr uint32_t kPcMask = VUDecoder::kMicroMemorySize / 8u - 1u;
+
+        std::string vf(uint32_t reg)
+        {
+            return fmt::format("vf{}", reg);
+        }
+
+        std::string vi(uint32_t reg)
+        {
+            return reg == 0 ? std::string("0") : fmt::format("vi{}", reg);
+        }
+
+        std::string lane(uint32_t reg, uint32_t field)
+        {
+            return fmt::format("ps2_vu::lane(vf{}, {})", reg, field);
+        }
+
+        // VF0 and VI0 are constant; writes to them are dropped.
+        std::string setVf(uint32_t reg, const std::string &value, uint32_t dest)
+        {
+            if (reg == 0 || dest == 0)
+                return {};
+            if (dest == 0xF)
+                return fmt::format("vf{} = {};", reg, value);
+            return fmt::format("vf{0} = PS2_VBLEND(vf{0}, {1}, ps2_vu::destMask(0x{2:X}));", reg, value, dest);
+        }
+
+        std::string setVi(uint32_t reg, const std::string &value)
+        {
+            if (reg == 0)
+                return {};
+            return fmt::format("vi{} = static_cast<uint16_t>({});", reg, value);
+        }
+
+        bool readsFlags(const VUInstruction &inst)
+        {
+            if (inst.iBit || !inst.lowerType2)
+                return false;
+            switch (inst.lowerFunction)
+            {
+            case VU_LOWER_FSEQ:
+            case VU_LOWER_FSAND:
+            case VU_LOWER_FSOR:
+            case VU_LOWER_FMEQ:
+            case VU_LOWER_FMAND:
+            case VU_LOWER_FMOR:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        bool hasControlFlow(const VUInstruction &inst)
+        {
+            return !inst.iBit && (inst.isBranch || inst.isJump);
+        }
+    }
+
+    std::string VUCodeGenerator::getProgramName(const VUMicroprogram &program)
+    {
+        return fmt::format("vu_microprogram_{:04x}_{:016x}", program.loadAddress, program.hash);
+    }
+
+    VUCodeGenerator::UpperCode VUCodeGenerator::translateUpper(const VUInstruction &inst, bool flagsUsed) const
+    {
+        enum class Op
+        {
+            Add,
+            Sub,
+            Mul,
+            Madd,
+            Msub,
+            Max,
+            Min,
+        };
+        const auto arithmetic = [&](Op op, const std::string &t) -> std::string
+        {
+            const std::string fs = vf(inst.fs);
+            switch (op)
+            {
+            case Op::Add:
+                return fmt::format("PS2_VADD({}, {})", fs, t);
+            case Op::Sub:
+                return fmt::format("PS2_VSUB({}, {})", fs, t);
+            case Op::Mul:
+                return fmt::format("PS2_VMUL({}, {})", fs, t);
+            case Op::Madd:
+                return fmt::format("PS2_VADD(acc, PS2_VMUL({}, {}))", fs, t);
+            case Op::Msub:
+                return fmt::format("PS2_VSUB(acc, PS2_VMUL({}, {}))", fs, t);
+            case Op::Max:
+                return fmt::format("PS2_VMAX({}, {})", fs, t);
+            default:
+                return fmt::format("PS2_VMIN({}, {})", fs, t);
+            }
+        };
+        const std::string broadcast = fmt::format("PS2_VBROADCAST({}, {})", vf(inst.ft), inst.bc);
+        const std::string vector = vf(inst.ft);
+        const std::string q = "PS2_VSPLAT(q)";
+        const std::string i = "PS2_VSPLAT(i)";
+
+        std::string value;
+        bool toAcc = false;
+        bool setsFlags = true;
+        uint32_t reg = inst.fd;
+        const uint8_t f = inst.upperFunction;
+
+        if (!inst.upperSpecial)
+        {
+            static constexpr Op kBroadcastOps[7] = {Op::Add, Op::Sub, Op::Madd, Op::Msub, Op::Max, Op::Min, Op::Mul};
+            if (f < VU0_S1_VMULq)
+            {
+                const Op op = kBroadcastOps[f >> 2];
+                setsFlags = op != Op::Max && op != Op::Min;
+                value = arithmetic(op, broadcast);
+            }
+            else
+            {
+                switch (f)
+                {
+                case VU0_S1_VMULq: value = arithmetic(Op::Mul, q); break;
+                case VU0_S1_VMAXi: value = arithmetic(Op::Max, i); setsFlags = false; break;
+                case VU0_S1_VMULi: value = arithmetic(Op::Mul, i); break;
+                case VU0_S1_VMINIi: value = arithmetic(Op::Min, i); setsFlags = false; break;
+                case VU0_S1_VADDq: value = arithmetic(Op::Add, q); break;
+                case VU0_S1_VMADDq: value = arithmetic(Op::Madd, q); break;
+                case VU0_S1_VADDi: value = arithmetic(Op::Add, i); break;
+                case VU0_S1_VMADDi: value = arithmetic(Op::Madd, i); break;
+                case VU0_S1_VSUBq: value = arithmetic(Op::Sub, q); break;
+                case VU0_S1_VMSUBq: value = arithmetic(Op::Msub, q); break;
+                case VU0_S1_VSUBi: value = arithmetic(Op::Sub, i); break;
+                case VU0_S1_VMSUBi: value = arithmetic(Op::Msub, i); break;
+                case VU0_S1_VADD: value = arithmetic(Op::Add, vector); break;
+                case VU0_S1_VMADD: value = arithmetic(Op::Madd, vector); break;
+                case VU0_S1_VMUL: value = arithmetic(Op::Mul, vector); break;
+                case VU0_S1_VMAX: value = arithmetic(Op::Max, vector); setsFlags = false; break;
+                case VU0_S1_VSUB: value = arithmetic(Op::Sub, vector); break;
+                case VU0_S1_VMSUB: value = arithmetic(Op::Msub, vector); break;
+                case VU0_S1_VOPMSUB:
+                    value = fmt::format("PS2_VSUB(acc, ps2_vu::outerProduct({}, {}))", vf(inst.fs), vector);
+                    break;
+                case VU0_S1_VMINI: value = arithmetic(Op::Min, vector); setsFlags = false; break;
+                default:
+                    return {};
+                }
+            }
+        }
+        else if (f < VU0_S2_VITOF0 || (f >= VU0_S2_VMULAx && f <= VU0_S2_VMULAw))
+        {
+            static constexpr Op kAccBroadcastOps[4] = {Op::Add, Op::Sub, Op::Madd, Op::Msub};
+            value = arithmetic(f < VU0_S2_VITOF0 ? kAccBroadcastOps[f >> 2] : Op::Mul, broadcast);
+            toAcc = true;
+        }
+        else if (f <= VU0_S2_VFTOI15)
+        {
+            static constexpr const char *kScales[4] = {"1.0f", "16.0f", "4096.0f", "32768.0f"};
+            value = f < VU0_S2_VFTOI0 ? fmt::format("ps2_vu::fixedToFloat({}, 1.0f / {})", vf(inst.fs), kScales[inst.bc])
+                                      : fmt::format("ps2_vu::floatToFixed({}, {})", vf(inst.fs), kScales[inst.bc]);
+            reg = inst.ft;
+            setsFlags = false;
+        }
+        else
+        {
+            toAcc = true;
+            switch (f)
+            {
+            case VU0_S2_VABS:
+                value = fmt::format("PS2_VABS({})", vf(inst.fs));
+                reg = inst.ft;
+                toAcc = false;
+                setsFlags = false;
+                break;
+            case VU0_S2_VCLIPw:
+                return {fmt::format("const uint32_t upClip = ps2_vu::clipFlags(vu.clip, {}, {});", vf(inst.fs),
+                                    lane(inst.ft, 3)),
+                        "vu.clip = upClip;"};
+            case VU0_S2_VMULAq: value = arithmetic(Op::Mul, q); break;
+            case VU0_S2_VMULAi: value = arithmetic(Op::Mul, i); break;
+            case VU0_S2_VADDAq: value = arithmetic(Op::Add, q); break;
+            case VU0_S2_VMADDAq: value = arithmetic(Op::Madd, q); break;
+            case VU0_S2_VADDAi: value = arithmetic(Op::Add, i); break;
+            case VU0_S2_VMADDAi: value = arithmetic(Op::Madd, i); break;
+            case VU0_S2_VSUBAq: value = arithmetic(Op::Sub, q); break;
+            case VU0_S2_VMSUBAq: value = arithmetic(Op::Msub, q); break;
+            case VU0_S2_VSUBAi: value = arithmetic(Op::Sub, i); break;
+            case VU0_S2_VMSUBAi: value = arithmetic(Op::Msub, i); break;
+            case VU0_S2_VADDA: value = arithmetic(Op::Add, vector); break;
+            case VU0_S2_VMADDA: value = arithmetic(Op::Madd, vector); break;
+            case VU0_S2_VMULA: value = arithmetic(Op::Mul, vector); break;
+            case VU0_S2_VSUBA: value = arithmetic(Op::Sub, vector); break;
+            case VU0_S2_VMSUBA: value = arithmetic(Op::Msub, vector); break;
+            case VU0_S2_VOPMULA:
+                value = fmt::format("ps2_vu::outerProduct({}, {})", vf(inst.fs), vector);
+                break;
+            default: // NOP
+                return {};
+            }
+        }
+
+        const bool flags = setsFlags && flagsUsed;
+        std::string commit;
+        if (toAcc)
+        {
+            if (inst.dest == 0xF)
+                commit = "acc = up;";
+            else if (inst.dest != 0)
+                commit = fmt::format("acc = PS2_VBLEND(acc, up, ps2_vu::destMask(0x{:X}));", inst.dest);
+        }
+        else
+        {
+            commit = setVf(reg, "up", inst.dest);
+        }
+        if (flags)
+            commit += fmt::format("{}ps2_vu::setFlags(vu, up, 0x{:X});", commit.empty() ? "" : " ", inst.dest);
+        if (commit.empty())
+            return {};
+        return {fmt::format("const __m128 up = {};", value), commit};
+    }
+
+    std::string VUCodeGenerator::translateLower(const VUInstruction &inst) const
+    {
+        if (inst.iBit)
+            return {};
+
+        const uint32_t dest = inst.lowerDest;
+        const std::string fs = vf(inst.is);
+        const std::string offsetIs = fmt::format("static_cast<uint32_t>({} + ({}))", vi(inst.is), inst.imm11);
+        const std::string offsetIt = fmt::format("static_cast<uint32_t>({} + ({}))", vi(inst.it), inst.imm11);
+        const uint32_t pc = inst.address / 8u;
+
+        if (inst.lowerType2)
+        {
+            switch (inst.lowerFunction)
+            {
+            case VU_LOWER_LQ:
+                return setVf(inst.it, fmt::format("ps2_vu::loadQword(vu, {})", offsetIs), dest);
+            case VU_LOWER_SQ:
+                return fmt::format("ps2_vu::storeQword(vu, {}, {}, 0x{:X});", offsetIt, fs, dest);
+            case VU_LOWER_ILW:
+                return setVi(inst.it, fmt::format("ps2_vu::loadInteger(vu, {}, 0x{:X})", offsetIs, dest));
+            case VU_LOWER_ISW:
+                return fmt::format("ps2_vu::storeInteger(vu, {}, {}, 0x{:X});", offsetIs, vi(inst.it), dest);
+            case VU_LOWER_IADDIU:
+                return setVi(inst.it, fmt::format("{} + 0x{:X}u", vi(inst.is), inst.imm15));
+            case VU_LOWER_ISUBIU:
+                return setVi(inst.it, fmt::format("{} - 0x{:X}u", vi(inst.is), inst.imm15));
+            case VU_LOWER_FCEQ:
+                return setVi(1, fmt::format("(vu.clip & 0xFFFFFFu) == 0x{:X}u ? 1u : 0u", inst.imm24));
+            case VU_LOWER_FCSET:
+                return fmt::format("vu.clip = 0x{:X}u;", inst.imm24);
+            case VU_LOWER_FCAND:
+                return setVi(1, fmt::format("(vu.clip & 0x{:X}u) ? 1u : 0u", inst.imm24));
+            case VU_LOWER_FCOR:
+                return setVi(1, fmt::format("((vu.clip | 0x{:X}u) & 0xFFFFFFu) == 0xFFFFFFu ? 1u : 0u", inst.imm24));
+            case VU_LOWER_FSEQ:
+                return setVi(inst.it, fmt::format("(vu.status & 0xFFFu) == 0x{:X}u ? 1u : 0u", inst.imm12));
+            case VU_LOWER_FSSET:
+                return fmt::format("vu.status = (vu.status & 0x3Fu) | 0x{:X}u;", inst.imm12 & 0xFC0u);
+            case VU_LOWER_FSAND:
+                return setVi(inst.it, fmt::format("vu.status & 0x{:X}u", inst.imm12));
+            case VU_LOWER_FSOR:
+                return setVi(inst.it, fmt::format("(vu.status & 0xFFFu) | 0x{:X}u", inst.imm12));
+            case VU_LOWER_FMEQ:
+                return setVi(inst.it, fmt::format("(vu.mac & 0xFFFFu) == {} ? 1u : 0u", vi(inst.is)));
+            case VU_LOWER_FMAND:
+                return setVi(inst.it, fmt::format("vu.mac & {}", vi(inst.is)));
+            case VU_LOWER_FMOR:
+                return setVi(inst.it, fmt::format("vu.mac | {}", vi(inst.is)));
+            case VU_LOWER_FCGET:
+                return setVi(inst.it, "vu.clip & 0xFFFu");
+            case VU_LOWER_BAL:
+            case VU_LOWER_JALR:
+                return setVi(inst.it, fmt::format("0x{:X}u", pc + 2u));
+            default: // branches are handled around the pair
+                return {};
+            }
+        }
+
+        if (!inst.lowerSpecial)
+        {
+            const int32_t imm5 = static_cast<int32_t>(inst.id ^ 0x10u) - 0x10;
+            switch (inst.lowerFunction)
+            {
+            case VU0_S1_VIADD:
+                return setVi(inst.id, fmt::format("{} + {}", vi(inst.is), vi(inst.it)));
+            case VU0_S1_VISUB:
+                return setVi(inst.id, fmt::format("{} - {}", vi(inst.is), vi(inst.it)));
+            case VU0_S1_VIADDI:
+                return setVi(inst.it, fmt::format("{} + ({})", vi(inst.is), imm5));
+            case VU0_S1_VIAND:
+                return setVi(inst.id, fmt::format("{} & {}", vi(inst.is), vi(inst.it)));
+            case VU0_S1_VIOR:
+                return setVi(inst.id, fmt::format("{} | {}", vi(inst.is), vi(inst.it)));
+            default:
+                return {};
+            }
+        }
+
+        const auto efu = [&](const std::string &value)
+        {
+            return fmt::format("p = {};", value);
+        };
+        switch (inst.lowerFunction)
+        {
+        case VU0_S2_VMOVE:
+            return setVf(inst.it, fs, dest);
+        case VU0_S2_VMR32:
+            return setVf(inst.it, fmt::format("_mm_shuffle_ps({0}, {0}, _MM_SHUFFLE(0, 3, 2, 1))", fs), dest);
+        case VU0_S2_VLQI:
+            return setVf(inst.it, fmt::format("ps2_vu::loadQword(vu, {})", vi(inst.is)), dest) + " " +
+                   setVi(inst.is, fmt::format("{} + 1u", vi(inst.is)));
+        case VU0_S2_VSQI:
+            return fmt::format("ps2_vu::storeQword(vu, {}, {}, 0x{:X}); ", vi(inst.it), fs, dest) +
+                   setVi(inst.it, fmt::format("{} + 1u", vi(inst.it)));
+        case VU0_S2_VLQD:
+            return setVi(inst.is, fmt::format("{} - 1u", vi(inst.is))) + " " +
+                   setVf(inst.it, fmt::format("ps2_vu::loadQword(vu, {})", vi(inst.is)), dest);
+        case VU0_S2_VSQD:
+            return setVi(inst.it, fmt::format("{} - 1u", vi(inst.it))) + " " +
+                   fmt::format("ps2_vu::storeQword(vu, {}, {}, 0x{:X});", vi(inst.it), fs, dest);
+        case VU0_S2_VDIV:
+            return fmt::format("q = ps2_vu::divide(vu, {}, {});", lane(inst.is, inst.fsf), lane(inst.it, inst.ftf));
+        case VU0_S2_VSQRT:
+            return fmt::format("q = ps2_vu::squareRoot(vu, {});", lane(inst.it, inst.ftf));
+        case VU0_S2_VRSQRT:
+            return fmt::format("q = ps2_vu::reciprocalRoot(vu, {}, {});", lane(inst.is, inst.fsf),
+                               lane(inst.it, inst.ftf));
+        case VU0_S2_VMTIR:
+            return setVi(inst.it, fmt::format("ps2_vu::floatBits({})", lane(inst.is, inst.fsf)));
+        case VU0_S2_VMFIR:
+            return setVf(inst.it,
+                         fmt::format("_mm_castsi128_ps(_mm_set1_epi32(static_cast<int16_t>({})))", vi(inst.is)), dest);
+        case VU0_S2_VILWR:
+            return setVi(inst.it, fmt::format("ps2_vu::loadInteger(vu, {}, 0x{:X})", vi(inst.is), dest));
+        case VU0_S2_VISWR:
+            return fmt::format("ps2_vu::storeInteger(vu, {}, {}, 0x{:X});", vi(inst.is), vi(inst.it), dest);
+        case VU0_S2_VRNEXT:
+            return "ps2_vu::randomNext(vu); " + setVf(inst.it, "PS2_VSPLAT(ps2_vu::randomValue(vu))", dest);
+        case VU0_S2_VRGET:
+            return setVf(inst.it, "PS2_VSPLAT(ps2_vu::randomValue(vu))", dest);
+        case VU0_S2_VRINIT:
+            return fmt::format("vu.r = ps2_vu::floatBits({}) & 0x7FFFFFu;", lane(inst.is, inst.fsf));
+        case VU0_S2_VRXOR:
+            return fmt::format("vu.r = (vu.r ^ ps2_vu::floatBits({})) & 0x7FFFFFu;", lane(inst.is, inst.fsf));
+        case VU_LOWER_S2_MFP:
+            return setVf(inst.it, "PS2_VSPLAT(p)", dest);
+        case VU_LOWER_S2_XTOP:
+            return setVi(inst.it, "ps2_vu::xtop(vu)");
+        case VU_LOWER_S2_XITOP:
+            return setVi(inst.it, "ps2_vu::xitop(vu)");
+        case VU_LOWER_S2_XGKICK:
+            return fmt::format("ps2_vu::xgkick(vu, {});", vi(inst.is));
+        case VU_LOWER_S2_ESADD:
+        case VU_LOWER_S2_ERSADD:
+        case VU_LOWER_S2_ELENG:
+        case VU_LOWER_S2_ERLENG:
+        {
+            static constexpr const char *kForms[4] = {"sum", "1.0f / sum", "std::sqrt(sum)", "1.0f / std::sqrt(sum)"};
+            return fmt::format("const __m128 squares = PS2_VMUL({0}, {0}); const float sum = ps2_vu::lane(squares, 0) + "
+                               "ps2_vu::lane(squares, 1) + ps2_vu::lane(squares, 2); {1}",
+                               fs, efu(kForms[inst.lowerFunction - VU_LOWER_S2_ESADD]));
+        }
+        case VU_LOWER_S2_EATANxy:
+            return efu(fmt::format("std::atan2({}, {})", lane(inst.is, 1), lane(inst.is, 0)));
+        case VU_LOWER_S2_EATANxz:
+            return efu(fmt::format("std::atan2({}, {})", lane(inst.is, 2), lane(inst.is, 0)));
+        case VU_LOWER_S2_ESUM:
+            return efu(fmt::format("{} + {} + {} + {}", lane(inst.is, 0), lane(inst.is, 1), lane(inst.is, 2),
+                                   lane(inst.is, 3)));
+        case VU_LOWER_S2_ESQRT:
+            return efu(fmt::format("std::sqrt(std::fabs({}))", lane(inst.is, inst.fsf)));
+        case VU_LOWER_S2_ERSQRT:
+            return efu(fmt::format("1.0f / std::sqrt(std::fabs({}))", lane(inst.is, inst.fsf)));
+        case VU_LOWER_S2_ERCPR:
+            return efu(fmt::format("1.0f / {}", lane(inst.is, inst.fsf)));
+        case VU_LOWER_S2_ESIN:
+            return efu(fmt::format("std::sin({})", lane(inst.is, inst.fsf)));
+        case VU_LOWER_S2_EATAN:
+            return efu(fmt::format("std::atan({})", lane(inst.is, inst.fsf)));
+        case VU_LOWER_S2_EEXP:
+            return efu(fmt::format("std::exp(-{})", lane(inst.is, inst.fsf)));
+        default: // WAITQ, WAITP: FDIV/EFU results are never in flight
+            return {};
+        }
+    }
+
+    std::string VUCodeGenerator::translateBranchCondition(const VUInstruction &inst) const
+    {
+        switch (inst.lowerFunction)
+        {
+        case VU_LOWER_IBEQ:
+            return fmt::format("{} == {}", vi(inst.it), vi(inst.is));
+        case VU_LOWER_IBNE:
+            return fmt::format("{} != {}", vi(inst.it), vi(inst.is));
+        case VU_LOWER_IBLTZ:
+            return fmt::format("static_cast<int16_t>({}) < 0", vi(inst.is));
+        case VU_LOWER_IBGTZ:
+            return fmt::format("static_cast<int16_t>({}) > 0", vi(inst.is));
+        case VU_LOWER_IBLEZ:
+            return fmt::format("static_cast<int16_t>({}) <= 0", vi(inst.is));
+        case VU_LOWER_IBGEZ:
+            return fmt::format("static_cast<int16_t>({}) >= 0", vi(inst.is));
+        default: // B, BAL, JR, JALR
+            return "true";
+        }
+    }
+
+    std::string VUCodeGenerator::translatePair(const VUInstruction &inst, bool flagsUsed, const std::string &indent) const
+    {
+        std::stringstream ss;
+        const UpperCode upper = translateUpper(inst, flagsUsed);
+        ss << indent << "{\n";
+        if (!upper.compute.empty())
+            ss << indent << "    " << upper.compute << "\n";
+        if (hasControlFlow(inst))
+        {
+            ss << indent << "    branchTaken = " << translateBranchCondition(inst) << ";\n";
+            if (inst.isJump)
+                ss << indent << "    branchTarget = " << vi(inst.is) << ";\n";
+        }
+        const std::string lower = translateLower(inst);
+        if (!lower.empty())
+            ss << indent << "    " << lower << "\n";
+        if (!upper.commit.empty())
+            ss << indent << "    " << upper.commit << "\n";
+        if (inst.iBit)
+            ss << indent << "    i = ps2_vu::floatFromBits(0x" << std::hex << std::uppercase << inst.lower << std::dec
+               << std::nouppercase << "u);\n";
+        ss << indent << "}\n";
+        return ss.str();
+    }
+
+    std::string VUCodeGenerator::generateProgram(const VUMicroprogram &program) const
+    {
+        const auto &instructions = program.instructions;
+        const uint32_t firstPc = program.loadAddress / 8u;
+        const uint32_t count = static_cast<uint32_t>(instructions.size());
+        const auto inProgram = [&](uint32_t pc)
+        {
+            return pc >= firstPc && pc < firstPc + count;
+        };
+
+        const bool flagsUsed = std::any_of(instructions.begin(), instructions.end(), readsFlags);
+        const bool branches = std::any_of(instructions.begin(), instructions.end(), hasControlFlow);
+        std::set<uint32_t> vfRegs;
+        std::set<uint32_t> viRegs;
+        for (const auto &inst : instructions)
+        {
+            for (uint32_t reg : {inst.ft, inst.fs, inst.fd})
+                vfRegs.insert(reg);
+            if (!inst.iBit)
+            {
+                for (uint32_t reg : {inst.it, inst.is, inst.id})
+                {
+                    vfRegs.insert(reg);
+                    viRegs.insert(reg & 0xFu);
+                }
+            }
+        }
+        vfRegs.erase(0);
+        viRegs.erase(0);
+        viRegs.insert(1); // FCAND/FCOR/FCEQ
+
+        std::stringstream ss;
+        ss << "// VU microprogram at 0x" << std::hex << program.loadAddress << ", " << std::dec << program.code.size()
+           << " bytes, uploaded from 0x" << std::hex << program.elfAddress << std::dec << "\n";
+        ss << "uint32_t " << getProgramName(program) << "(ps2_vu::State &vu, uint32_t pc)\n{\n";
+        ss << "    const __m128 vf0 = vu.vf[0];\n";
+        for (uint32_t reg : vfRegs)
+            ss << "    __m128 vf" << reg << " = vu.vf[" << reg << "];\n";
+        for (uint32_t reg : viRegs)
+            ss << "    uint16_t vi" << reg << " = vu.vi[" << reg << "];\n";
+        ss << "    __m128 acc = vu.acc;\n";
+        ss << "    float q = vu.q;\n";
+        ss << "    float p = vu.p;\n";
+        ss << "    float i = vu.i;\n";
+        if (branches)
+        {
+            ss << "    bool branchTaken = false;\n";
+            ss << "    uint32_t branchTarget = 0;\n";
+        }
+        ss << "    (void)vf0;\n\n";
+
+        if (branches)
+            ss << "dispatch:\n";
+        ss << "    switch (pc)\n    {\n";
+        for (uint32_t k = 0; k < count; ++k)
+            ss << "    case 0x" << std::hex << firstPc + k << ": goto L_" << firstPc + k << std::dec << ";\n";
+        ss << "    default: goto leave;\n    }\n\n";
+
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            const VUInstruction &inst = instructions[k];
+            const uint32_t pc = firstPc + k;
+            ss << "L_" << std::hex << pc << std::dec << ":\n";
+
+            const bool control = hasControlFlow(inst);
+            const VUInstruction *delay = k + 1 < count ? &instructions[k + 1] : nullptr;
+            if (!inst.valid ||
+                ((control || inst.eBit) &&
+                 (!delay || !delay->valid || hasControlFlow(*delay) || (control && delay->eBit))))
+            {
+                // Let the interpreter take pairs it alone handles.
+                ss << fmt::format("    pc = 0x{:x};\n    goto leave;\n", pc);
+                continue;
+            }
+
+            ss << translatePair(inst, flagsUsed, "    ");
+            if (!control && !inst.eBit)
+            {
+                if (k + 1 == count)
+                    ss << fmt::format("    pc = 0x{:x};\n    goto leave;\n", (pc + 1u) & kPcMask);
+                continue;
+            }
+
+            ss << "    // delay slot\n" << translatePair(*delay, flagsUsed, "    ");
+            const uint32_t after = (pc + 2u) & kPcMask;
+            if (inst.eBit)
+            {
+                if (control && !inst.isJump)
+                    ss << fmt::format("    vu.tpc = branchTaken ? 0x{:x}u : 0x{:x}u;\n", inst.branchTarget, after);
+                else if (control)
+                    ss << fmt::format("    vu.tpc = branchTarget & 0x{:x}u;\n", kPcMask);
+                else
+                    ss << fmt::format("    vu.tpc = 0x{:x}u;\n", after);
+                ss << "    pc = ps2_vu::kEnd;\n    goto leave;\n";
+                continue;
+            }
+
+            if (inst.isJump)
+            {
+                ss << "    pc = branchTarget;\n";
+                ss << "    if (--vu.budget == 0)\n        goto leave;\n";
+                ss << "    goto dispatch;\n";
+                continue;
+            }
+
+            ss << "    if (branchTaken)\n    {\n";
+            if (inProgram(inst.branchTarget))
+            {
+                ss << fmt::format("        if (--vu.budget == 0)\n        {{\n            pc = 0x{:x};\n"
+                                  "            goto leave;\n        }}\n        goto L_{:x};\n",
+                                  inst.branchTarget, inst.branchTarget);
+            }
+            else
+            {
+                ss << fmt::format("        --vu.budget;\n        pc = 0x{:x};\n        goto leave;\n", inst.branchTarget);
+            }
+            ss << "    }\n";
+            if (inProgram(after) && after > pc)
+                ss << fmt::format("    goto L_{:x};\n", after);
+            else
+                ss << fmt::format("    pc = 0x{:x};\n    goto leave;\n", after);
+        }
+
+        ss << "\nleave:\n";
+        for (uint32_t reg : vfRegs)
+            ss << "    vu.vf[" << reg << "] = vf" << reg << ";\n";
+        for (uint32_t reg : viRegs)
+            ss << "    vu.vi[" << reg << "] = vi" << reg << ";\n";
+        ss << "    vu.acc = acc;\n";
+        ss << "    vu.q = q;\n";
+        ss << "    vu.p = p;\n";
+        ss << "    vu.i = i;\n";
+        ss << "    return pc;\n";
+        ss << "}\n";
+        return ss.str();
+    }
+
+    std::string VUCodeGenerator::generateFile(const std::vector<VUMicroprogram> &programs) const
+    {
+        std::stringstream ss;
+        ss << "#include \"ps2_runtime_macros.h\"\n";
+        ss << "#include \"ps2_runtime.h\"\n";
+        ss << "#include \"ps2_vu.h\"\n";
+        ss << "#include <cmath>\n\n";
+
+        for (const auto &program : programs)
+            ss << generateProgram(program) << "\n";
+
+        ss << "void " << kRegistrationFunction << "(PS2Runtime &runtime)\n{\n";
+        for (const auto &program : programs)
+        {
+            const uint32_t size = static_cast<uint32_t>(program.code.size());
+            // The same upload may target either VU; VU0 only has 4KB of micro memory.
+            const uint32_t units = program.loadAddress + size <= 4096u ? 2u : 1u;
+            for (uint32_t unit = 2 - units; unit < 2; ++unit)
+            {
+                ss << fmt::format("    runtime.memory().registerVuProgram({{{}, 0x{:x}, 0x{:x}, 0x{:016x}ull, {}}});\n", unit,
+                                  program.loadAddress, size, program.hash, getProgramName(program));
+            }
+        }
+        ss << "}\n";
+        return ss.str();
+    }
+
+} // namespace ps2recomp
@@ -0,0 +1,308 @@
+#include "ps2recomp/vu_decoder.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <tuple>
+
+namespace ps2recomp
+{
+    namespace
+    {
+        constexpr uint32_t kVifMpg = 0x4A;
+        // Bytes allowed between one MPG's data and the next MPG code (a DMA tag
+        // plus a few VIFcodes such as NOP or FLUSHE).
+        constexpr uint32_t kMpgChainWindow = 32;
+
+        uint32_t readWord(const uint8_t *p)
+        {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        bool isMpgAt(const Section &section, uint32_t offset)
+        {
+            if (offset + 4u > section.size || ((section.address + offset) & 7u) != 4u)
+                return false;
+            return ((readWord(section.data + offset) >> 24) & 0x7Fu) == kVifMpg;
+        }
+    }
+
+    VUInstruction VUDecoder::decodePair(uint32_t address, uint32_t lower, uint32_t upper) const
+    {
+        VUInstruction inst;
+        inst.address = address;
+        inst.upper = upper;
+        inst.lower = lower;
+        inst.iBit = (upper >> 31) & 1u;
+        inst.eBit = (upper >> 30) & 1u;
+        inst.mBit = (upper >> 29) & 1u;
+        inst.dBit = (upper >> 28) & 1u;
+        inst.tBit = (upper >> 27) & 1u;
+
+        const bool upperValid = decodeUpper(inst);
+        const bool lowerValid = inst.iBit || decodeLower(inst);
+        inst.valid = upperValid && lowerValid;
+        return inst;
+    }
+
+    bool VUDecoder::decodeUpper(VUInstruction &inst) const
+    {
+        const uint32_t word = inst.upper;
+        inst.dest = static_cast<uint8_t>((word >> 21) & 0xFu);
+        inst.ft = static_cast<uint8_t>((word >> 16) & 0x1Fu);
+        inst.fs = static_cast<uint8_t>((word >> 11) & 0x1Fu);
+        inst.fd = static_cast<uint8_t>((word >> 6) & 0x1Fu);
+        inst.bc = static_cast<uint8_t>(word & 3u);
+
+        const uint8_t function = static_cast<uint8_t>(word & 0x3Fu);
+        if (function < VU0_S1_VIADD)
+        {
+            inst.upperFunction = function;
+            return true;
+        }
+        if (function < 0x3C)
+            return false;
+
+        inst.upperSpecial = true;
+        inst.upperFunction = static_cast<uint8_t>((inst.fd << 2) | inst.bc);
+        return inst.upperFunction <= VU0_S2_VNOP && inst.upperFunction != 0x2B;
+    }
+
+    bool VUDecoder::decodeLower(VUInstruction &inst) const
+    {
+        const uint32_t word = inst.lower;
+        inst.lowerDest = static_cast<uint8_t>((word >> 21) & 0xFu);
+        inst.it = static_cast<uint8_t>((word >> 16) & 0x1Fu);
+        inst.is = static_cast<uint8_t>((word >> 11) & 0x1Fu);
+        inst.id = static_cast<uint8_t>((word >> 6) & 0x1Fu);
+        inst.fsf = static_cast<uint8_t>((word >> 21) & 3u);
+        inst.ftf = static_cast<uint8_t>((word >> 23) & 3u);
+        inst.imm11 = static_cast<int32_t>((word & 0x7FFu) ^ 0x400u) - 0x400;
+        inst.imm12 = ((word >> 10) & 0x800u) | (word & 0x7FFu);
+        inst.imm15 = ((word >> 10) & 0x7800u) | (word & 0x7FFu);
+        inst.imm24 = word & 0xFFFFFFu;
+
+        if (word & 0x80000000u)
+        {
+            const uint8_t function = static_cast<uint8_t>(word & 0x3Fu);
+            switch (function)
+            {
+            case VU0_S1_VIADD:
+            case VU0_S1_VISUB:
+            case VU0_S1_VIADDI:
+            case VU0_S1_VIAND:
+            case VU0_S1_VIOR:
+                inst.lowerFunction = function;
+                return true;
+            default:
+                break;
+            }
+            if (function < 0x3C)
+                return false;
+
+            inst.lowerSpecial = true;
+            inst.lowerFunction = static_cast<uint8_t>((inst.id << 2) | (word & 3u));
+            switch (inst.lowerFunction)
+            {
+            case VU0_S2_VMOVE:
+            case VU0_S2_VMR32:
+            case VU0_S2_VLQI:
+            case VU0_S2_VSQI:
+            case VU0_S2_VLQD:
+            case VU0_S2_VSQD:
+            case VU0_S2_VDIV:
+            case VU0_S2_VSQRT:
+            case VU0_S2_VRSQRT:
+            case VU0_S2_VWAITQ:
+            case VU0_S2_VMTIR:
+            case VU0_S2_VMFIR:
+            case VU0_S2_VILWR:
+            case VU0_S2_VISWR:
+            case VU0_S2_VRNEXT:
+            case VU0_S2_VRGET:
+            case VU0_S2_VRINIT:
+            case VU0_S2_VRXOR:
+            case VU_LOWER_S2_MFP:
+            case VU_LOWER_S2_XTOP:
+            case VU_LOWER_S2_XITOP:
+            case VU_LOWER_S2_XGKICK:
+            case VU_LOWER_S2_ESADD:
+            case VU_LOWER_S2_ERSADD:
+            case VU_LOWER_S2_ELENG:
+            case VU_LOWER_S2_ERLENG:
+            case VU_LOWER_S2_EATANxy:
+            case VU_LOWER_S2_EATANxz:
+            case VU_LOWER_S2_ESUM:
+            case VU_LOWER_S2_ESQRT:
+            case VU_LOWER_S2_ERSQRT:
+            case VU_LOWER_S2_ERCPR:
+            case VU_LOWER_S2_WAITP:
+            case VU_LOWER_S2_ESIN:
+            case VU_LOWER_S2_EATAN:
+            case VU_LOWER_S2_EEXP:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        inst.lowerType2 = true;
+        inst.lowerFunction = static_cast<uint8_t>(word >> 25);
+        const uint32_t pc = inst.address / 8u;
+        switch (inst.lowerFunction)
+        {
+        case VU_LOWER_B:
+        case VU_LOWER_BAL:
+        case VU_LOWER_IBEQ:
+        case VU_LOWER_IBNE:
+        case VU_LOWER_IBLTZ:
+        case VU_LOWER_IBGTZ:
+        case VU_LOWER_IBLEZ:
+        case VU_LOWER_IBGEZ:
+            inst.isBranch = true;
+            inst.branchTarget = static_cast<uint32_t>(static_cast<int32_t>(pc) + 1 + inst.imm11) &
+                                (kMicroMemorySize / 8u - 1u);
+            return true;
+        case VU_LOWER_JR:
+        case VU_LOWER_JALR:
+            inst.isJump = true;
+            return true;
+        case VU_LOWER_LQ:
+        case VU_LOWER_SQ:
+        case VU_LOWER_ILW:
+        case VU_LOWER_ISW:
+        case VU_LOWER_IADDIU:
+        case VU_LOWER_ISUBIU:
+        case VU_LOWER_FCEQ:
+        case VU_LOWER_FCSET:
+        case VU_LOWER_FCAND:
+        case VU_LOWER_FCOR:
+        case VU_LOWER_FSEQ:
+        case VU_LOWER_FSSET:
+        case VU_LOWER_FSAND:
+        case VU_LOWER_FSOR:
+        case VU_LOWER_FMEQ:
+        case VU_LOWER_FMAND:
+        case VU_LOWER_FMOR:
+        case VU_LOWER_FCGET:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    std::vector<VUInstruction> VUDecoder::decodeProgram(const uint8_t *code, uint32_t size, uint32_t loadAddress) const
+    {
+        std::vector<VUInstruction> instructions;
+        instructions.reserve(size / 8u);
+        for (uint32_t offset = 0; offset + 8u <= size; offset += 8u)
+        {
+            instructions.push_back(decodePair(loadAddress + offset, readWord(code + offset), readWord(code + offset + 4u)));
+        }
+        return instructions;
+    }
+
+    std::vector<VUMicroprogram> VUDecoder::findMicroprograms(const std::vector<Section> &sections) const
+    {
+        std::vector<VUMicroprogram> programs;
+        std::set<std::tuple<uint32_t, size_t, uint64_t>> seen;
+
+        for (const auto &section : sections)
+        {
+            if (section.isBSS || !section.data || section.size < 16)
+                continue;
+
+            uint32_t offset = 4;
+            while (offset + 4u <= section.size)
+            {
+                if (!isMpgAt(section, offset))
+                {
+                    offset += 4;
+                    continue;
+                }
+
+                VUMicroprogram program;
+                program.elfAddress = section.address + offset + 4u;
+                uint32_t scan = offset;
+                uint32_t loadEnd = 0;
+                bool first = true;
+                while (isMpgAt(section, scan))
+                {
+                    const uint32_t code = readWord(section.data + scan);
+                    const uint32_t bytes = (((code >> 16) & 0xFFu) ? ((code >> 16) & 0xFFu) : 256u) * 8u;
+                    const uint32_t load = ((code & 0xFFFFu) * 8u) & (kMicroMemorySize - 1u);
+                    if (scan + 4u + bytes > section.size || load + bytes > kMicroMemorySize ||
+                        (!first && load != loadEnd))
+                        break;
+                    if (first)
+                        program.loadAddress = load;
+                    program.code.insert(program.code.end(), section.data + scan + 4u, section.data + scan + 4u + bytes);
+                    loadEnd = load + bytes;
+                    first = false;
+
+                    // Look for the next MPG of the same upload just past this one's data.
+                    uint32_t next = scan + 4u + bytes;
+                    scan = 0;
+                    for (uint32_t probe = next; probe <= next + kMpgChainWindow && probe + 4u <= section.size; probe += 4)
+                    {
+                        if (isMpgAt(section, probe))
+                        {
+                            scan = probe;
+                            break;
+                        }
+                    }
+                    if (!scan)
+                    {
+                        scan = next;
+                        break;
+                    }
+                }
+
+                const uint32_t resume = std::max(scan, offset + 4u);
+                if (program.code.empty())
+                {
+                    offset += 4;
+                    continue;
+                }
+
+                program.instructions = decodeProgram(program.code.data(), static_cast<uint32_t>(program.code.size()),
+                                                     program.loadAddress);
+                const bool allValid = std::all_of(program.instructions.begin(), program.instructions.end(),
+                                                  [](const VUInstruction &inst) { return inst.valid; });
+                const bool ends = std::any_of(program.instructions.begin(), program.instructions.end(),
+                                              [](const VUInstruction &inst) { return inst.eBit; });
+                const bool blank = std::all_of(program.code.begin(), program.code.end(),
+                                               [](uint8_t byte) { return byte == 0; });
+                if (!allValid || !ends || blank)
+                {
+                    offset += 4;
+                    continue;
+                }
+
+                program.hash = contentHash(program.code.data(), program.code.size());
+                if (seen.emplace(program.loadAddress, program.code.size(), program.hash).second)
+                {
+                    programs.push_back(std::move(program));
+                }
+                offset = resume;
+            }
+        }
+
+        std::cout << "Found " << programs.size() << " VU microprogram upload(s)" << std::endl;
+        return programs;
+    }
+
+    uint64_t VUDecoder::contentHash(const uint8_t *bytes, size_t size, uint64_t seed)
+    {
+        uint64_t hash = seed;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+} // namespace ps2recomp
@@ -28,8 +28,17 @@ extern "C"
 
 namespace ThreadNaming
 {
+    // Last name given to this thread through SetCurrentThreadName, empty if none.
+    inline thread_local std::string t_currentThreadName;
+
+    inline const std::string &CurrentThreadName()
+    {
+        return t_currentThreadName;
+    }
+
     inline void SetCurrentThreadName(std::string_view name)
     {
+        t_currentThreadName = name;
 #if defined(_WIN32) 
         using SetThreadDescriptionFn = HRESULT(WINAPI*)(HANDLE, PCWSTR);
 
@@ -0,0 +1,48 @@
+#ifndef PS2_ASYNC_IO_H
+#define PS2_ASYNC_IO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ps2_async_io
+{
+    enum class Op
+    {
+        Open,
+        Read,
+        Write
+    };
+
+    struct Request
+    {
+        Op op = Op::Read;
+        std::string path; // Open
+        int flags = 0;    // Open: host open(2) flags
+        int mode = 0;     // Open: permission bits for O_CREAT
+        int fd = -1;      // Read/Write: host descriptor
+        void *buffer = nullptr;
+        size_t size = 0;
+        uint64_t offset = 0;
+    };
+
+    // 0 is never a valid ticket.
+    using Ticket = uint64_t;
+
+    // Queues a host file operation. On Linux it goes to an io_uring ring set up
+    // through raw syscalls; elsewhere, or when the kernel refuses the ring, a
+    // small worker pool runs it. Buffers and descriptors must stay valid until
+    // the ticket is consumed by poll() or wait().
+    Ticket submit(Request request);
+
+    // Returns true and consumes the ticket once the operation has finished.
+    // result is the new descriptor or byte count, or -errno on failure.
+    bool poll(Ticket ticket, int64_t &result);
+
+    // Blocks until the operation finishes and consumes the ticket.
+    int64_t wait(Ticket ticket);
+
+    const char *backendName();
+}
+
+#endif // PS2_ASYNC_IO_H
@@ -0,0 +1,36 @@
+#ifndef PS2_BENCHMARK_H
+#define PS2_BENCHMARK_H
+
+#include "ps2_callstats.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Headless benchmark runs: what was measured and how it is reported.
+namespace ps2_benchmark
+{
+    struct Report
+    {
+        uint64_t frames = 0; // VBlanks delivered to the guest
+        double seconds = 0.0;
+        uint64_t dispatches = 0; // recompiled blocks entered from the dispatch loop
+        uint64_t syscalls = 0;
+        uint64_t dmaStarts = 0;
+        uint64_t gifCopies = 0;
+        uint64_t gsWrites = 0;
+        uint64_t vifWrites = 0;
+        uint64_t peakRssBytes = 0;
+        bool guestExited = false; // stopped before reaching the frame count
+        std::vector<ps2_callstats::HandlerStats> calls; // per-handler counts, when counting was on
+    };
+
+    // High-water mark of the process resident set, or 0 if unknown.
+    uint64_t peakResidentBytes();
+
+    std::string toJson(const Report &report);
+    // Writes toJson to path, or to stdout when path is empty.
+    bool writeReport(const Report &report, const std::string &path);
+}
+
+#endif // PS2_BENCHMARK_H
@@ -83,6 +83,7 @@
     X(fioRmdir)               \
     X(fioGetstat)             \
     X(fioRemove)              \
+    X(fioSync)                \
                               \
     X(GsSetCrt)               \
     X(GsGetIMR)               \
@@ -460,7 +461,6 @@
     X(sceSifInitRpc)                          \
     X(sceSifIsAliveIop)                       \
     X(sceSifLoadElf)                          \
-    X(sceSifLoadElfPart)                      \
     X(sceSifLoadFileReset)                    \
     X(sceSifLoadIopHeap)                      \
     X(sceSifLoadModuleBuffer)                 \
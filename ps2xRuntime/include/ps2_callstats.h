@@ -0,0 +1,167 @@
+#ifndef PS2_CALLSTATS_H
+#define PS2_CALLSTATS_H
+
+#include "ps2_call_list.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct R5900Context;
+class PS2Runtime;
+
+// Call counts and latency histograms for the HLE handlers: every entry of
+// PS2_SYSCALL_LIST and PS2_STUB_LIST, plus each syscall number taken by
+// ps2_syscalls::dispatchNumericSyscall. Each host thread counts into its own
+// block without locks; snapshot() merges the blocks on demand. While
+// counting is off every counted call is one relaxed load and a branch.
+namespace ps2_callstats
+{
+    enum class Id : uint32_t
+    {
+#define PS2_CALLSTATS_SYSCALL_ID(name) Syscall_##name,
+        PS2_SYSCALL_LIST(PS2_CALLSTATS_SYSCALL_ID)
+#undef PS2_CALLSTATS_SYSCALL_ID
+#define PS2_CALLSTATS_STUB_ID(name) Stub_##name,
+        PS2_STUB_LIST(PS2_CALLSTATS_STUB_ID)
+#undef PS2_CALLSTATS_STUB_ID
+        FirstNumericSyscall,
+    };
+
+    enum class Kind
+    {
+        Syscall,
+        Stub,
+        NumericSyscall,
+    };
+
+    // Numeric syscalls are counted by absolute number, so the negative
+    // (interrupt context) forms share a slot; the last slot takes anything larger.
+    inline constexpr uint32_t kNumericSyscallSlots = 256;
+    inline constexpr uint32_t kIdCount = static_cast<uint32_t>(Id::FirstNumericSyscall) + kNumericSyscallSlots;
+    // Bucket 0 counts calls under 2 ns and bucket b calls of [2^b, 2^(b+1)) ns;
+    // the last bucket is open-ended.
+    inline constexpr uint32_t kLatencyBuckets = 32;
+
+    inline Id numericSyscallId(uint32_t number)
+    {
+        const int32_t value = static_cast<int32_t>(number);
+        const uint32_t magnitude = value < 0 ? 0u - number : number;
+        const uint32_t slot = magnitude < kNumericSyscallSlots ? magnitude : kNumericSyscallSlots - 1u;
+        return static_cast<Id>(static_cast<uint32_t>(Id::FirstNumericSyscall) + slot);
+    }
+
+    Kind kind(Id id);
+    std::string name(Id id);
+
+    struct Options
+    {
+        std::filesystem::path outputPath; // JSON written by stop() and by the dump signal
+    };
+
+    inline std::atomic<bool> g_enabled{false};
+
+    inline bool enabled()
+    {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t nowNs()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    // Slow path behind enabled().
+    void record(Id id, uint64_t ns);
+
+    // Times the enclosing block and counts it against id. A call that started
+    // while counting was on is recorded even if counting stopped meanwhile.
+    class Scope
+    {
+    public:
+        explicit Scope(Id id)
+            : m_id(id), m_active(enabled())
+        {
+            if (m_active) [[unlikely]]
+                m_start = nowNs();
+        }
+
+        ~Scope()
+        {
+            if (m_active) [[unlikely]]
+                record(m_id, nowNs() - m_start);
+        }
+
+        // Not counted after all, e.g. a syscall number nobody handles.
+        void discard()
+        {
+            m_active = false;
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Id m_id;
+        bool m_active;
+        uint64_t m_start = 0;
+    };
+
+    // Counting wrapper with the recompiled function signature, for code that
+    // binds handlers by address instead of calling them by name.
+    template <Id id, void (*Handler)(uint8_t *, R5900Context *, PS2Runtime *)>
+    void counted(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
+    {
+        Scope scope(id);
+        Handler(rdram, ctx, runtime);
+    }
+
+    struct HandlerStats
+    {
+        Id id{};
+        std::string name;
+        Kind kind = Kind::Syscall;
+        uint64_t calls = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+        std::array<uint64_t, kLatencyBuckets> buckets{};
+
+        // Upper bound of the bucket holding the given fraction of calls.
+        uint64_t percentileNs(double fraction) const;
+    };
+
+    // false if already counting.
+    bool start(const Options &options);
+    // Stops counting and writes Options::outputPath if set; false if the file could not be written.
+    bool stop();
+    bool running();
+
+    // Every handler called at least once, merged across threads, most total
+    // time first. Safe while counting: calls in flight may be missed.
+    std::vector<HandlerStats> snapshot();
+    // JSON array of snapshot entries, one object per line.
+    std::string json(const std::vector<HandlerStats> &stats);
+    // Fixed-width table for logs.
+    std::string text(const std::vector<HandlerStats> &stats);
+    bool write(const std::filesystem::path &path);
+    // Writes Options::outputPath, or the text table to stderr when there is none.
+    bool dump();
+
+    // SIGUSR1 calls dump() from a helper thread. POSIX only; false elsewhere.
+    bool installDumpSignal();
+
+    // Zeroes every counter. Only call while no thread is counting.
+    void reset();
+}
+
+#define PS2_CALL_STATS_SYSCALL(name) ::ps2_callstats::Scope ps2CallStats_(::ps2_callstats::Id::Syscall_##name)
+#define PS2_CALL_STATS_STUB(name) ::ps2_callstats::Scope ps2CallStats_(::ps2_callstats::Id::Stub_##name)
+
+#endif // PS2_CALLSTATS_H
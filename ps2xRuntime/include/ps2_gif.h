@@ -0,0 +1,132 @@
+#ifndef PS2_GIF_H
+#define PS2_GIF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// GIF packet decoding. Each GIF path (PATH1 from VU1 XGKICK, PATH2 from VIF1
+// DIRECT, PATH3 from the GIF DMA channel) feeds its own Parser, which turns
+// GIFtags and their PACKED / REGLIST / IMAGE payloads into plain GS register
+// writes appended to a CommandStream.
+namespace ps2_gif
+{
+    // GS general registers, by their A+D address.
+    enum Reg : uint8_t
+    {
+        PRIM = 0x00,
+        RGBAQ = 0x01,
+        ST = 0x02,
+        UV = 0x03,
+        XYZF2 = 0x04,
+        XYZ2 = 0x05,
+        TEX0_1 = 0x06,
+        TEX0_2 = 0x07,
+        CLAMP_1 = 0x08,
+        CLAMP_2 = 0x09,
+        FOG = 0x0A,
+        XYZF3 = 0x0C,
+        XYZ3 = 0x0D,
+        TEX1_1 = 0x14,
+        TEX1_2 = 0x15,
+        TEX2_1 = 0x16,
+        TEX2_2 = 0x17,
+        XYOFFSET_1 = 0x18,
+        XYOFFSET_2 = 0x19,
+        PRMODECONT = 0x1A,
+        PRMODE = 0x1B,
+        TEXCLUT = 0x1C,
+        SCANMSK = 0x22,
+        MIPTBP1_1 = 0x34,
+        MIPTBP1_2 = 0x35,
+        MIPTBP2_1 = 0x36,
+        MIPTBP2_2 = 0x37,
+        TEXA = 0x3B,
+        FOGCOL = 0x3D,
+        TEXFLUSH = 0x3F,
+        SCISSOR_1 = 0x40,
+        SCISSOR_2 = 0x41,
+        ALPHA_1 = 0x42,
+        ALPHA_2 = 0x43,
+        DIMX = 0x44,
+        DTHE = 0x45,
+        COLCLAMP = 0x46,
+        TEST_1 = 0x47,
+        TEST_2 = 0x48,
+        PABE = 0x49,
+        FBA_1 = 0x4A,
+        FBA_2 = 0x4B,
+        FRAME_1 = 0x4C,
+        FRAME_2 = 0x4D,
+        ZBUF_1 = 0x4E,
+        ZBUF_2 = 0x4F,
+        BITBLTBUF = 0x50,
+        TRXPOS = 0x51,
+        TRXREG = 0x52,
+        TRXDIR = 0x53,
+        HWREG = 0x54,
+        SIGNAL = 0x60,
+        FINISH = 0x61,
+        LABEL = 0x62,
+        REG_COUNT = 0x63,
+    };
+
+    // Register writes in issue order, one entry per write. Kept as parallel
+    // arrays so a consumer walking the stream touches one byte and one qword per
+    // command. IMAGE-mode payload is stored once in `image`; its HWREG entry
+    // holds (bytes << 32) | offset into that buffer.
+    struct CommandStream
+    {
+        std::vector<uint8_t> reg;
+        std::vector<uint64_t> value;
+        std::vector<uint8_t> image;
+
+        size_t size() const { return reg.size(); }
+        bool empty() const { return reg.empty(); }
+        void push(uint8_t r, uint64_t v)
+        {
+            reg.push_back(r);
+            value.push_back(v);
+        }
+        void clear()
+        {
+            reg.clear();
+            value.clear();
+            image.clear();
+        }
+    };
+
+    // Streaming decoder for one path. Packets may be split across feed() calls
+    // at any qword boundary; trailing bytes short of a qword are ignored.
+    class Parser
+    {
+    public:
+        void feed(const uint8_t *data, size_t bytes, CommandStream &out);
+        void reset();
+
+        // True between packets, i.e. when the last tag had EOP and no data is owed.
+        bool idle() const { return m_loops == 0 && m_eop; }
+
+    private:
+        enum class Mode : uint8_t
+        {
+            Packed = 0,
+            Reglist = 1,
+            Image = 2,
+        };
+
+        void readTag(const uint8_t *qword, CommandStream &out);
+        void packed(const uint8_t *qword, CommandStream &out);
+        void nextRegister();
+
+        uint64_t m_regs = 0;
+        uint32_t m_nreg = 0;
+        uint32_t m_regIndex = 0;
+        uint32_t m_loops = 0;
+        Mode m_mode = Mode::Packed;
+        bool m_eop = true;
+        uint32_t m_q = 0x3F800000u; // internal Q from the last PACKED ST, 1.0f
+    };
+}
+
+#endif // PS2_GIF_H
@@ -0,0 +1,70 @@
+#ifndef PS2_GS_DISPLAY_H
+#define PS2_GS_DISPLAY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct GSRegisters;
+
+// PCRTC output: reads the two display circuits out of GS VRAM, converts them to
+// RGBA8 and merges them the way PMODE asks for.
+namespace ps2_gs_display
+{
+    // Converted pixels keep the GS alpha range (0x80 = 1.0).
+    void convertCT16(const uint16_t *src, uint32_t *dst, size_t count);
+    void convertCT24(const uint32_t *src, uint32_t *dst, size_t count);
+
+    // dst = rc1 * a + rc2 * (1 - a). a is ALP when useAlp is set, otherwise the
+    // rc1 pixel alpha (0x80 = 1.0, saturating).
+    void blendRow(const uint32_t *rc1, const uint32_t *rc2, uint32_t *dst, size_t count, bool useAlp, uint8_t alp);
+
+    // Reusable buffers so composing a frame does not allocate once warmed up.
+    struct Scratch
+    {
+        std::vector<uint16_t> raw;
+        std::vector<uint32_t> circuit[2];
+    };
+
+    // Writes the displayed picture into dst (width x height RGBA8, opaque), black
+    // outside the display area. Returns false when an enabled circuit scans out a
+    // format the PCRTC path here does not read (the Z formats).
+    bool compose(const uint8_t *vram, const GSRegisters &gs, uint32_t *dst, uint32_t width, uint32_t height, Scratch &scratch);
+
+    // Lock-free handoff of whole frames from one producer to one consumer. The
+    // producer fills back() and publishes it; the consumer acquires the newest
+    // published frame as front(). Neither side ever waits for the other, and
+    // frames published while the consumer was busy are dropped.
+    class TripleBuffer
+    {
+    public:
+        // Not thread-safe; call before either side starts.
+        void resize(uint32_t width, uint32_t height);
+        uint32_t width() const { return m_width; }
+        uint32_t height() const { return m_height; }
+
+        uint32_t *back() { return m_slots[m_back].data(); }
+        void publish();
+
+        // True when a frame newer than front() was published.
+        bool acquire();
+        const uint32_t *front() const { return m_slots[m_front].data(); }
+
+        uint64_t published() const { return m_published.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr uint32_t kIndexMask = 3u;
+        static constexpr uint32_t kFresh = 4u; // middle slot holds an unseen frame
+
+        std::vector<uint32_t> m_slots[3];
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        uint32_t m_back = 0;                 // producer only
+        uint32_t m_front = 1;                // consumer only
+        std::atomic<uint32_t> m_middle{2u};  // slot index plus kFresh
+        std::atomic<uint64_t> m_published{0};
+    };
+}
+
+#endif // PS2_GS_DISPLAY_H
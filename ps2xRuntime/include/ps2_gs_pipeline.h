@@ -0,0 +1,108 @@
+#ifndef PS2_GS_PIPELINE_H
+#define PS2_GS_PIPELINE_H
+
+#include "ps2_gif.h"
+#include "ps2_gs_raster.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct GSRegisters;
+
+// GS side of the GIF: applies decoded register writes to the GS state. Image
+// transfers (BITBLTBUF/TRXPOS/TRXREG/TRXDIR + HWREG) are written into VRAM,
+// vertex kicks are assembled into primitives for the software rasterizer, and
+// SIGNAL/FINISH/LABEL update the privileged CSR and SIGLBLID.
+namespace ps2_gs_pipeline
+{
+    class Context
+    {
+    public:
+        void attach(uint8_t *vram, GSRegisters *privileged);
+        void execute(const ps2_gif::CommandStream &stream);
+
+        uint64_t reg(uint8_t r) const { return m_regs[r]; }
+        // Vertices kicked by XYZ2/XYZF2 since attach().
+        uint64_t vertexKicks() const { return m_vertexKicks; }
+
+    private:
+        void write(uint8_t reg, uint64_t value, const ps2_gif::CommandStream &stream);
+        void kick(uint64_t xyz, bool withFog, bool draw);
+        ps2_gs_raster::DrawState drawState(uint64_t attrs) const;
+        void startTransfer(uint32_t dir);
+        void transferData(const uint8_t *data, size_t bytes);
+        size_t transferPixels(const uint8_t *data, size_t bytes);
+
+        uint8_t *m_vram = nullptr;
+        GSRegisters *m_privileged = nullptr;
+        uint64_t m_regs[ps2_gif::REG_COUNT] = {};
+        uint64_t m_vertexKicks = 0;
+
+        ps2_gs_raster::Rasterizer m_raster;
+        ps2_gs_raster::Vertex m_queue[3];
+        uint32_t m_queued = 0; // vertices held for the current primitive
+
+        struct Transfer
+        {
+            bool active = false;
+            uint32_t psm = 0;
+            uint32_t bpp = 0;
+            uint32_t bp = 0;
+            uint32_t bw = 0;
+            uint32_t x = 0;
+            uint32_t y = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint64_t pixel = 0; // pixels written so far
+        };
+        Transfer m_transfer;
+        std::vector<uint8_t> m_carry; // bytes short of a whole pixel
+        std::vector<uint8_t> m_copy;  // local->local staging
+    };
+
+    // Runs a Context on a consumer thread. The producer hands over a filled
+    // stream and gets back an empty one that reuses an earlier batch's storage.
+    class Pipeline
+    {
+    public:
+        ~Pipeline();
+
+        void attach(uint8_t *vram, GSRegisters *privileged);
+        void submit(ps2_gif::CommandStream &stream);
+        // Runs fn on the consumer thread once every batch submitted before it
+        // has been applied, so it sees VRAM exactly as of this point.
+        void fence(std::function<void()> fn);
+        // Waits until every submitted batch has been applied.
+        void drain();
+        void stop();
+
+        // Only meaningful after drain().
+        const Context &context() const { return m_context; }
+
+    private:
+        struct Batch
+        {
+            ps2_gif::CommandStream stream;
+            std::function<void()> fence;
+        };
+
+        void enqueue(std::unique_lock<std::mutex> &lock, Batch batch);
+        void run();
+
+        Context m_context;
+        std::mutex m_mutex;
+        std::condition_variable m_workCv;
+        std::condition_variable m_idleCv;
+        std::deque<Batch> m_queue;
+        std::vector<ps2_gif::CommandStream> m_free;
+        std::thread m_thread;
+        bool m_busy = false;
+        bool m_stop = false;
+    };
+}
+
+#endif // PS2_GS_PIPELINE_H
@@ -0,0 +1,138 @@
+#ifndef PS2_GS_RASTER_H
+#define PS2_GS_RASTER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Software GS drawing straight into swizzled VRAM. Primitives are set up as
+// they arrive, binned into 64x32 screen tiles (one PSMCT32 page), and drawn at
+// flush() with every tile on its own worker. A tile keeps its primitives in
+// submission order, so the result matches drawing them one after another.
+namespace ps2_gs_raster
+{
+    enum class PrimKind : uint8_t
+    {
+        Point,
+        Line,
+        Triangle,
+        Sprite,
+    };
+
+    // Drawing environment decoded from the GS registers of the selected context.
+    // Every field is 32 bits wide so states compare with memcmp.
+    struct DrawState
+    {
+        // FRAME / ZBUF
+        uint32_t fbp; // block address
+        uint32_t fbw;
+        uint32_t fpsm;
+        uint32_t fbmsk;
+        uint32_t zbp;
+        uint32_t zpsm;
+        uint32_t zmsk;
+        // TEST
+        uint32_t ate, atst, aref, afail;
+        uint32_t date, datm;
+        uint32_t zte, ztst;
+        // ALPHA, PABE, FBA, COLCLAMP
+        uint32_t abe, blendA, blendB, blendC, blendD, fix;
+        uint32_t pabe, fba, colclamp;
+        // TEX0, CLAMP, TEXA
+        uint32_t tme, fst;
+        uint32_t tbp, tbw, tpsm, tw, th, tcc, tfx;
+        uint32_t cbp, cpsm;
+        uint32_t wms, wmt, minu, maxu, minv, maxv;
+        uint32_t ta0, aem, ta1;
+        // Shading and fog
+        uint32_t iip, fge, fogcol;
+        // SCISSOR, inclusive
+        uint32_t scax0, scax1, scay0, scay1;
+    };
+
+    struct Vertex
+    {
+        int32_t x = 0; // 12.4 window coordinates (XYOFFSET removed)
+        int32_t y = 0;
+        uint32_t z = 0;
+        uint8_t r = 0, g = 0, b = 0, a = 0;
+        uint8_t fog = 0;
+        float s = 0.0f, t = 0.0f, q = 1.0f;
+        float u = 0.0f, v = 0.0f; // texels, from UV
+    };
+
+    // Runs count jobs on a fixed set of workers plus the calling thread. Jobs are
+    // dealt round-robin into per-worker deques; a worker that runs dry steals
+    // from the back of the others.
+    class WorkStealingPool
+    {
+    public:
+        explicit WorkStealingPool(unsigned workers);
+        ~WorkStealingPool();
+
+        // Workers plus the caller.
+        unsigned participants() const { return static_cast<unsigned>(m_queues.size()); }
+        void run(size_t count, const std::function<void(size_t)> &job);
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<size_t> items;
+        };
+
+        bool take(unsigned self, size_t &item);
+        void work(unsigned self);
+        void workerLoop(unsigned self);
+
+        std::vector<std::unique_ptr<Queue>> m_queues; // [0] is the caller
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        const std::function<void(size_t)> *m_job = nullptr;
+        std::atomic<size_t> m_remaining{0};
+        uint64_t m_generation = 0;
+        bool m_stop = false;
+    };
+
+    class Rasterizer
+    {
+    public:
+        // threads == 0 picks PS2_GS_THREADS or the host core count.
+        explicit Rasterizer(unsigned threads = 0);
+        ~Rasterizer();
+
+        void setVram(uint8_t *vram) { m_vram = vram; }
+        void draw(PrimKind kind, const Vertex *vertices, const DrawState &state);
+        // Draws everything binned so far.
+        void flush();
+        size_t pending() const;
+        unsigned threads() const;
+
+        static constexpr uint32_t kTileWidth = 64;
+        static constexpr uint32_t kTileHeight = 32;
+
+    private:
+        struct Setup;
+
+        void drawTile(uint32_t tile);
+
+        uint8_t *m_vram = nullptr;
+        unsigned m_threadCount = 0;
+        std::unique_ptr<WorkStealingPool> m_pool;
+        std::vector<DrawState> m_states;
+        std::vector<Setup> m_prims;
+        std::vector<std::vector<uint32_t>> m_bins;
+        std::vector<uint32_t> m_activeTiles;
+    };
+}
+
+#endif // PS2_GS_RASTER_H
@@ -0,0 +1,52 @@
+#ifndef PS2_GS_SWIZZLE_H
+#define PS2_GS_SWIZZLE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// GS local memory layout for host<->local transfers.
+// VRAM is organised in 8 KiB pages of 32 blocks of 256 bytes; pixels inside a
+// block are spread over four columns in a per-format order. bp is a block
+// address (64-word units, as in BITBLTBUF DBP/SBP), bw is the buffer width in
+// 64-pixel units. Addresses wrap at the end of the 4 MiB VRAM like the GS does.
+namespace ps2_gs_swizzle
+{
+    constexpr uint32_t PSMCT32 = 0x00;
+    constexpr uint32_t PSMCT24 = 0x01;
+    constexpr uint32_t PSMCT16 = 0x02;
+    constexpr uint32_t PSMCT16S = 0x0A;
+    constexpr uint32_t PSMT8 = 0x13;
+    constexpr uint32_t PSMT4 = 0x14;
+    constexpr uint32_t PSMZ32 = 0x30;
+    constexpr uint32_t PSMZ24 = 0x31;
+    constexpr uint32_t PSMZ16 = 0x32;
+    constexpr uint32_t PSMZ16S = 0x3A;
+
+    bool isSupported(uint32_t psm);
+
+    // Bytes per row of a linear host image of the given width (PSMT4 rows start on
+    // a byte boundary, first pixel in the low nibble).
+    size_t rowBytes(uint32_t psm, uint32_t width);
+
+    // Byte offset of a pixel in VRAM for every format except PSMT4. Lets a caller
+    // read-modify-write a pixel with one address computation.
+    uint32_t pixelOffset(uint32_t psm, uint32_t bp, uint32_t bw, uint32_t x, uint32_t y);
+
+    // Raw pixel value: 32/24-bit color or depth, 16-bit color or depth, 8-bit or
+    // 4-bit index.
+    uint32_t readPixel(const uint8_t *vram, uint32_t psm, uint32_t bp, uint32_t bw, uint32_t x, uint32_t y);
+    void writePixel(uint8_t *vram, uint32_t psm, uint32_t bp, uint32_t bw, uint32_t x, uint32_t y, uint32_t value);
+
+    // Copies a w x h rectangle at (x, y) between VRAM and a linear host image whose
+    // rows are pitch bytes apart. Whole blocks inside the rectangle go through the
+    // block kernels; edges fall back to per-pixel addressing. PSMCT24 keeps the
+    // upper byte of each VRAM word, as the GS does.
+    void writeImage(uint8_t *vram, uint32_t psm, uint32_t bp, uint32_t bw,
+                    uint32_t x, uint32_t y, uint32_t w, uint32_t h,
+                    const uint8_t *src, size_t pitch);
+    void readImage(const uint8_t *vram, uint32_t psm, uint32_t bp, uint32_t bw,
+                   uint32_t x, uint32_t y, uint32_t w, uint32_t h,
+                   uint8_t *dst, size_t pitch);
+}
+
+#endif // PS2_GS_SWIZZLE_H
@@ -0,0 +1,177 @@
+#ifndef PS2_LOG_H
+#define PS2_LOG_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+// Runtime logging. Call sites format into a fixed per-message buffer and push
+// it onto a lock-free ring; a writer thread drains the ring to stdout (below
+// Warn) or stderr. Every call site is rate limited on its own, and levels below
+// PS2_LOG_COMPILE_LEVEL are compiled out entirely.
+//
+//   PS2_LOG_DEBUG(VBlank, "[pollVBlank] tick=" << tick);
+//   PS2_LOG_RATE(::ps2_log::Level::Warn, ::ps2_log::Category::Io, 5, "slow path " << path);
+//
+// PS2_LOG_LEVEL picks the runtime threshold, e.g. "warn" or "info,vblank=trace,memory=debug".
+namespace ps2_log
+{
+    enum class Level : uint8_t
+    {
+        Trace,
+        Debug,
+        Info,
+        Warn,
+        Error,
+        Off
+    };
+
+    enum class Category : uint8_t
+    {
+        Runtime,
+        Dispatch,
+        Memory,
+        Syscall,
+        Io,
+        VBlank,
+        Interrupt,
+        Gs,
+        Dma,
+        Vif,
+        Vu,
+        Count
+    };
+
+    constexpr size_t kCategoryCount = static_cast<size_t>(Category::Count);
+    // Messages per second each call site may emit before it is suppressed.
+    constexpr uint32_t kDefaultRate = 50;
+    // Longer messages are truncated.
+    constexpr size_t kMaxMessage = 240;
+
+    inline std::atomic<uint8_t> g_thresholds[kCategoryCount] = {
+        static_cast<uint8_t>(Level::Info), static_cast<uint8_t>(Level::Info), static_cast<uint8_t>(Level::Info),
+        static_cast<uint8_t>(Level::Info), static_cast<uint8_t>(Level::Info), static_cast<uint8_t>(Level::Info),
+        static_cast<uint8_t>(Level::Info), static_cast<uint8_t>(Level::Info), static_cast<uint8_t>(Level::Info),
+        static_cast<uint8_t>(Level::Info), static_cast<uint8_t>(Level::Info)};
+
+    inline bool enabled(Level level, Category category)
+    {
+        return static_cast<uint8_t>(level) >= g_thresholds[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+    }
+
+    void setLevel(Category category, Level level);
+    void setLevel(Level level); // every category
+    // Applies a PS2_LOG_LEVEL style spec. Unknown names are reported and skipped.
+    bool configure(std::string_view spec);
+    const char *name(Category category);
+
+    // Receives each message on the writer thread instead of stdout/stderr;
+    // pass an empty function to restore the default.
+    using Sink = std::function<void(Level level, Category category, std::string_view text)>;
+    void setSink(Sink sink);
+
+    // Blocks until every message pushed so far has been written.
+    void flush();
+    // Messages lost because the ring was full.
+    uint64_t droppedCount();
+
+    void write(Level level, Category category, std::string_view text);
+
+    // Fixed-window limiter, one per call site.
+    class RateLimit
+    {
+    public:
+        explicit RateLimit(uint32_t perSecond) : m_perSecond(perSecond) {}
+        // suppressed receives how many calls were dropped since the last one let through.
+        bool allow(uint64_t &suppressed);
+
+    private:
+        const uint32_t m_perSecond;
+        std::atomic<int64_t> m_windowStart{-1};
+        std::atomic<uint32_t> m_count{0};
+        std::atomic<uint64_t> m_suppressed{0};
+    };
+
+    // Formats one message without allocating and hands it to write() when done.
+    class Line
+    {
+    public:
+        Line(Level level, Category category, uint64_t suppressed);
+        ~Line();
+        Line(const Line &) = delete;
+        Line &operator=(const Line &) = delete;
+
+        std::ostream &stream() { return m_stream; }
+
+    private:
+        class Buffer : public std::streambuf
+        {
+        public:
+            Buffer(char *begin, char *end) { setp(begin, end); }
+            size_t size() const { return static_cast<size_t>(pptr() - pbase()); }
+
+        protected:
+            int_type overflow(int_type ch) override { return traits_type::not_eof(ch); } // truncate
+        };
+
+        Level m_level;
+        Category m_category;
+        uint64_t m_suppressed;
+        char m_text[kMaxMessage];
+        Buffer m_buffer;
+        std::ostream m_stream;
+    };
+}
+
+#ifndef PS2_LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define PS2_LOG_COMPILE_LEVEL 1 // Debug and up
+#else
+#define PS2_LOG_COMPILE_LEVEL 0 // everything
+#endif
+#endif
+
+namespace ps2_log
+{
+    // Whether call sites at level survive PS2_LOG_COMPILE_LEVEL. At level 0
+    // everything does; spelled out so -Wtype-limits has nothing to compare.
+#if PS2_LOG_COMPILE_LEVEL > 0
+    constexpr bool compiledIn(Level level) { return static_cast<int>(level) >= PS2_LOG_COMPILE_LEVEL; }
+#else
+    constexpr bool compiledIn(Level) { return true; }
+#endif
+}
+
+#define PS2_LOG_RATE(level, category, perSecond, message)                                      \
+    do                                                                                        \
+    {                                                                                         \
+        if constexpr (::ps2_log::compiledIn(level))                                           \
+        {                                                                                     \
+            if (::ps2_log::enabled((level), (category)))                                      \
+            {                                                                                 \
+                static ::ps2_log::RateLimit ps2LogLimit_(perSecond);                          \
+                uint64_t ps2LogSuppressed_ = 0;                                               \
+                if (ps2LogLimit_.allow(ps2LogSuppressed_))                                    \
+                {                                                                             \
+                    ::ps2_log::Line ps2LogLine_((level), (category), ps2LogSuppressed_);      \
+                    ps2LogLine_.stream() << message;                                          \
+                }                                                                             \
+            }                                                                                 \
+        }                                                                                     \
+    } while (0)
+
+#define PS2_LOG_AT(level, category, message) \
+    PS2_LOG_RATE(::ps2_log::Level::level, ::ps2_log::Category::category, ::ps2_log::kDefaultRate, message)
+
+#define PS2_LOG_TRACE(category, message) PS2_LOG_AT(Trace, category, message)
+#define PS2_LOG_DEBUG(category, message) PS2_LOG_AT(Debug, category, message)
+#define PS2_LOG_INFO(category, message) PS2_LOG_AT(Info, category, message)
+#define PS2_LOG_WARN(category, message) PS2_LOG_AT(Warn, category, message)
+#define PS2_LOG_ERROR(category, message) PS2_LOG_AT(Error, category, message)
+
+#endif // PS2_LOG_H
@@ -1,11 +1,17 @@
 #ifndef PS2_MEMORY_H
 #define PS2_MEMORY_H
 
+#include "ps2_gs_display.h"
+#include "ps2_gs_pipeline.h"
+#include "ps2_vif.h"
+#include "ps2_vu.h"
 #include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <unordered_map>
 #include <atomic>
+#include <functional>
+#include <mutex>
 #if defined(_MSC_VER)
     #include <intrin.h>
 #elif defined(USE_SSE2NEON)
@@ -40,6 +46,7 @@ constexpr uint32_t PS2_VU1_DATA_BASE = 0x1100C000;
 constexpr uint32_t PS2_VU1_MEM_BASE = PS2_VU1_CODE_BASE; // Alias used by older code paths
 constexpr uint32_t PS2_VU1_CODE_SIZE = 16u * 1024u;      // 16KB Micro Memory
 constexpr uint32_t PS2_VU1_DATA_SIZE = 16u * 1024u;      // 16KB Data Memory (VU Mem)
+constexpr uint32_t PS2_VU_MEM_SIZE = PS2_VU1_DATA_BASE + PS2_VU1_DATA_SIZE - PS2_VU0_CODE_BASE;
 
 constexpr uint32_t PS2_GS_BASE = 0x12000000;
 constexpr uint32_t PS2_GS_PRIV_REG_BASE = PS2_GS_BASE; // GS Privileged Registers
@@ -56,6 +63,12 @@ inline constexpr uint32_t PS2_FIO_O_TRUNC = 0x0400;
 inline constexpr uint32_t PS2_FIO_O_EXCL = 0x0800;
 inline constexpr uint32_t PS2_FIO_O_NOWAIT = 0x8000;
 
+// fioSync modes and results (ps2sdk fileio.h).
+inline constexpr uint32_t PS2_FIO_WAIT = 0;
+inline constexpr uint32_t PS2_FIO_NOWAIT = 1;
+inline constexpr int32_t PS2_FIO_COMPLETE = 1;
+inline constexpr int32_t PS2_FIO_INCOMPLETE = 0;
+
 inline constexpr uint32_t PS2_FIO_SEEK_SET = 0;
 inline constexpr uint32_t PS2_FIO_SEEK_CUR = 1;
 inline constexpr uint32_t PS2_FIO_SEEK_END = 2;
@@ -186,6 +199,23 @@ struct GSRegisters
 static_assert(sizeof(GSRegisters) == (19u * sizeof(uint64_t)), "GSRegisters layout changed unexpectedly");
 static_assert(alignof(GSRegisters) == alignof(uint64_t), "GSRegisters alignment must remain 64-bit");
 
+// CSR bits the GS raises and the EE acknowledges by writing 1: SIGNAL,
+// FINISH, HSINT, VSINT and EDWINT.
+constexpr uint64_t kGsCsrEventBits = 0x1Fu;
+
+// CSR and SIGLBLID are changed by both the EE and the GS consumer thread
+// (SIGNAL, FINISH, LABEL), so each change is one atomic read-modify-write.
+template <typename Update>
+inline void updateGsRegister(uint64_t &reg, Update update)
+{
+    std::atomic_ref<uint64_t> shared(reg);
+    uint64_t current = shared.load(std::memory_order_relaxed);
+    while (!shared.compare_exchange_weak(current, update(current), std::memory_order_acq_rel,
+                                         std::memory_order_relaxed))
+    {
+    }
+}
+
 // PS2 VIF (VPU Interface) registers
 struct VIFRegisters
 {
@@ -276,6 +306,46 @@ public:
     bool writeIORegister(uint32_t address, uint32_t value);
     uint32_t readIORegister(uint32_t address);
 
+    // DMAC. Peripheral-bound data (GIF, VIF0/1) reaches the channel's sink in
+    // contiguous runs; the SPR channels copy between RAM and the scratchpad.
+    using DmaSink = std::function<void(const uint8_t *data, uint32_t bytes)>;
+    using DmaCompletionHandler = std::function<void(uint32_t channelBase)>;
+    void setDmaSink(uint32_t channelBase, DmaSink sink);
+    void setDmaCompletionHandler(DmaCompletionHandler handler);
+    // Quadwords the DMAC may move per frame, 0 for no limit. A channel that runs
+    // out keeps STR set and carries on from advanceDma(), called once per frame.
+    void setDmaBudget(uint32_t qwordsPerFrame);
+    void advanceDma();
+
+    // GIF paths (1 = VU1 XGKICK, 2 = VIF1 DIRECT, 3 = GIF DMA/FIFO). Packets are
+    // decoded on the calling thread and applied to VRAM by the GS pipeline.
+    void submitGifPacket(uint32_t path, const uint8_t *data, uint32_t bytes);
+    // Blocks until queued GS work has reached VRAM.
+    void flushGs() { m_gsPipeline.drain(); }
+
+    // Display output for the host. Once enabled, publishFrame() composes what the
+    // PCRTC shows after all GS work queued so far, on the GS thread, and hands it
+    // to frames(). DISPFB writes publish a frame on their own.
+    void enableFrameOutput(uint32_t width, uint32_t height);
+    void publishFrame();
+    ps2_gs_display::TripleBuffer &frames() { return m_frames; }
+
+    // VIF0/VIF1 command streams, from DMA or the VIF FIFOs. MSCAL/MSCNT start
+    // microprograms through the unit's handler.
+    void feedVif(uint32_t unit, const uint8_t *data, uint32_t bytes);
+    void setVuMicroHandler(uint32_t unit, ps2_vif::Processor::MicroHandler handler);
+    // Recompiled microprograms, picked by content hash when their upload lands.
+    void registerVuProgram(const ps2_vu::ProgramInfo &info);
+    ps2_vu::VectorUnit &vu(uint32_t unit) { return m_vu[unit ? 1 : 0]; }
+    // A VU is driven by its VIF; hold this while running it from the EE.
+    std::unique_lock<std::mutex> lockVu(uint32_t unit) { return std::unique_lock<std::mutex>(m_vifMutex[unit ? 1 : 0]); }
+    bool isPath3Masked() const { return m_vif[1].path3Masked(); }
+
+    // VU micro and data memory, also mapped into EE space at PS2_VU0_CODE_BASE.
+    uint8_t *getVUCode(uint32_t unit) { return m_vuMemory + ((unit ? PS2_VU1_CODE_BASE : PS2_VU0_CODE_BASE) - PS2_VU0_CODE_BASE); }
+    uint8_t *getVUData(uint32_t unit) { return m_vuMemory + ((unit ? PS2_VU1_DATA_BASE : PS2_VU0_DATA_BASE) - PS2_VU0_CODE_BASE); }
+    VIFRegisters &vif(uint32_t unit) { return unit ? vif1_regs : vif0_regs; }
+
     // Track code modifications for self-modifying code
     void registerCodeRegion(uint32_t start, uint32_t end);
     bool isCodeModified(uint32_t address, uint32_t size);
@@ -309,6 +379,7 @@ public:
     uint8_t *m_gsVRAM;
     VIFRegisters vif0_regs;
     VIFRegisters vif1_regs;
+    uint8_t *m_vuMemory;
     DMARegisters dma_regs[10]; // 10 DMA channels
 
     // TLB entries
@@ -330,9 +401,42 @@ public:
     };
     std::vector<CodeRegion> m_codeRegions;
 
+    struct DmaChannelState
+    {
+        bool active = false;
+        bool endAfterPacket = false;
+        uint32_t interleaveCount = 0; // qwords moved in the current TQWC slice
+    };
+    std::mutex m_dmaMutex;
+    DmaSink m_dmaSinks[10];
+    DmaCompletionHandler m_dmaCompletion;
+    DmaChannelState m_dmaState[10];
+    uint32_t m_dmaBudgetPerFrame = 0;
+    uint32_t m_dmaBudgetLeft = 0;
+
+    std::mutex m_gifMutex;
+    ps2_gif::Parser m_gifPaths[3];
+    ps2_gif::CommandStream m_gifStream;
+    std::atomic<bool> m_frameOutput{false};
+    ps2_gs_display::TripleBuffer m_frames;
+    ps2_gs_display::Scratch m_frameScratch; // GS thread only
+    ps2_gs_pipeline::Pipeline m_gsPipeline;
+
+    std::mutex m_vifMutex[2];
+    ps2_vif::Processor m_vif[2];
+    ps2_vu::VectorUnit m_vu[2];
+
+    void writeDmacRegister(uint32_t address, uint32_t value);
+    bool runDma(uint32_t channel);
+    void finishDma(uint32_t channel, std::vector<uint32_t> &completed);
+
     bool isAddressInRegion(uint32_t address, const CodeRegion &region);
     void markModified(uint32_t address, uint32_t size);
     bool isScratchpad(uint32_t address) const;
+    uint8_t *vuMemoryPtr(uint32_t physAddr, uint32_t bytes);
+    // vuMemoryPtr for EE stores; retires recompiled programs the store overlaps.
+    uint8_t *vuStorePtr(uint32_t physAddr, uint32_t bytes);
+    uint32_t *vifRegisterPtr(uint32_t address);
 };
 
 #endif // PS2_MEMORY_H
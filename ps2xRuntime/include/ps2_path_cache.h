@@ -0,0 +1,34 @@
+#ifndef PS2_PATH_CACHE_H
+#define PS2_PATH_CACHE_H
+
+#include <filesystem>
+
+namespace ps2_path_cache
+{
+    enum class EntryKind
+    {
+        Missing,
+        File,
+        Directory
+    };
+
+    // Maps a guest-relative path onto the host tree under root, matching each
+    // component case-insensitively (an exact-case entry wins when both exist).
+    // Components past the first missing one are appended verbatim, so callers
+    // that are about to create the entry still get a usable path.
+    // Directory listings and found paths are cached, so repeated hits are hash
+    // probes with no stat/readdir. Misses are not cached and first apply any
+    // pending inotify events, so a file created outside the runtime is found
+    // on the next lookup.
+    EntryKind resolve(const std::filesystem::path &root, const std::filesystem::path &relative,
+                      std::filesystem::path &resolvedOut);
+
+    // Drops cached state for hostPath's directory. Call after creating, removing
+    // or renaming entries. On Linux, changes made outside the runtime are picked
+    // up through inotify as well.
+    void invalidate(const std::filesystem::path &hostPath);
+
+    void clear();
+}
+
+#endif // PS2_PATH_CACHE_H
@@ -0,0 +1,105 @@
+#ifndef PS2_PROFILER_H
+#define PS2_PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+struct R5900Context;
+
+// Sampling profiler over guest PCs. A sampler thread reads ctx->pc of every
+// registered guest thread at a fixed rate (the recompiled code stores it at
+// each branch and call), maps it to the containing function through
+// ps2_symbols and counts collapsed stacks, one line per unique stack:
+//
+//   GameThread;main;UpdateFrame;DrawModel 412
+//
+// which flamegraph.pl and speedscope read directly. Samples are wall clock, so
+// a thread blocked in a syscall is charged to the function that made it.
+//
+// Guest call stacks come from a shadow stack: with PS2_PROFILE_CALLS defined,
+// PS2_PROFILE_CALL (emitted around every JAL/JALR call) pushes the callee.
+// Without it each stack is just the thread and the current function.
+namespace ps2_profiler
+{
+    constexpr size_t kMaxCallDepth = 64;
+
+    struct Options
+    {
+        uint32_t hz = 1000; // samples per second for each guest thread
+        std::filesystem::path outputPath; // collapsed stacks, written by stop()
+    };
+
+    struct ThreadState
+    {
+        const R5900Context *ctx = nullptr;
+        std::string name;
+        std::atomic<uint32_t> depth{0}; // may exceed kMaxCallDepth; deeper calls are not recorded
+        std::atomic<uint32_t> calls[kMaxCallDepth] = {};
+    };
+
+    inline thread_local ThreadState *t_thread = nullptr;
+
+    // Keeps the calling guest thread registered for sampling while alive.
+    class ThreadScope
+    {
+    public:
+        ThreadScope(const R5900Context *ctx, std::string_view name);
+        ~ThreadScope();
+        ThreadScope(const ThreadScope &) = delete;
+        ThreadScope &operator=(const ThreadScope &) = delete;
+
+    private:
+        ThreadState m_state;
+        ThreadState *m_previous;
+    };
+
+    // One shadow call stack frame.
+    class CallScope
+    {
+    public:
+        explicit CallScope(uint32_t target) : m_state(t_thread)
+        {
+            if (!m_state)
+                return;
+            const uint32_t depth = m_state->depth.load(std::memory_order_relaxed);
+            if (depth < kMaxCallDepth)
+                m_state->calls[depth].store(target, std::memory_order_relaxed);
+            m_state->depth.store(depth + 1, std::memory_order_release);
+        }
+
+        ~CallScope()
+        {
+            if (m_state)
+                m_state->depth.store(m_state->depth.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+        }
+
+        CallScope(const CallScope &) = delete;
+        CallScope &operator=(const CallScope &) = delete;
+
+    private:
+        ThreadState *m_state;
+    };
+
+    // false if already running or hz is zero.
+    bool start(const Options &options);
+    // Stops sampling and writes Options::outputPath if set; false if the file could not be written.
+    bool stop();
+    bool running();
+
+    // Samples taken so far as collapsed stacks, and their total count.
+    std::string collapsed();
+    uint64_t sampleCount();
+    void reset();
+}
+
+#if defined(PS2_PROFILE_CALLS) && PS2_PROFILE_CALLS
+#define PS2_PROFILE_CALL(target) ::ps2_profiler::CallScope ps2ProfileCall_(target)
+#else
+#define PS2_PROFILE_CALL(target) ((void)0)
+#endif
+
+#endif // PS2_PROFILER_H
@@ -17,11 +17,13 @@
 #endif
 #include <atomic>
 #include <mutex>
+#include <thread>
 #include <filesystem>
 #include <iostream>
 #include <iomanip>
 
 #include "ps2_memory.h"
+#include "ps2_watch.h"
 
 enum PS2Exception
 {
@@ -188,160 +190,6 @@ inline void setReturnU64(R5900Context *ctx, uint64_t value)
     ctx->r[3] = _mm_set_epi64x(0, static_cast<int64_t>(static_cast<uint32_t>(value >> 32)));
 }
 
-inline constexpr uint32_t PS2_PATH_WATCH_ADDR = 0x00369F2Fu;
-inline constexpr uint32_t PS2_PATH_WATCH_BYTES = 32u;
-inline constexpr uint32_t PS2_PATH_WATCH_MAX_LOGS = 512u;
-inline std::atomic<uint32_t> g_ps2PathWatchLogCount{0};
-
-inline uint32_t ps2PathWatchPhysAddr()
-{
-    return PS2_PATH_WATCH_ADDR & PS2_RAM_MASK;
-}
-
-inline bool ps2PathWatchIntersects(uint32_t writeAddr, uint32_t writeSize)
-{
-    const uint64_t writeStart = writeAddr;
-    const uint64_t writeEnd = writeStart + static_cast<uint64_t>(writeSize);
-    const uint64_t watchStart = ps2PathWatchPhysAddr();
-    const uint64_t watchEnd = watchStart + static_cast<uint64_t>(PS2_PATH_WATCH_BYTES);
-    return writeEnd > watchStart && writeStart < watchEnd;
-}
-
-inline void ps2PathWatchDumpPrefix(const uint8_t *rdram)
-{
-    if (!rdram)
-    {
-        return;
-    }
-
-    const uint32_t base = ps2PathWatchPhysAddr();
-    auto flags = std::cout.flags();
-    std::cout << " buf=" << std::hex;
-    for (uint32_t i = 0; i < 16u; ++i)
-    {
-        const uint32_t addr = (base + i) & PS2_RAM_MASK;
-        std::cout << static_cast<uint32_t>(rdram[addr]);
-        if (i + 1u < 16u)
-        {
-            std::cout << '.';
-        }
-    }
-    std::cout.flags(flags);
-}
-
-inline uint8_t ps2PathWatchExtractByteFromWrite(uint32_t writeAddr, uint32_t watchAddr, uint64_t valueLo, uint64_t valueHi)
-{
-    const uint32_t byteIndex = watchAddr - writeAddr;
-    if (byteIndex < 8u)
-    {
-        return static_cast<uint8_t>((valueLo >> (byteIndex * 8u)) & 0xFFu);
-    }
-    return static_cast<uint8_t>((valueHi >> ((byteIndex - 8u) * 8u)) & 0xFFu);
-}
-
-inline void ps2TraceGuestWrite(uint8_t *rdram,
-                               uint32_t guestAddr,
-                               uint32_t size,
-                               uint64_t valueLo,
-                               uint64_t valueHi,
-                               const char *op,
-                               const R5900Context *ctx)
-{
-    if (!rdram || size == 0u)
-    {
-        return;
-    }
-
-    const uint32_t writeAddr = guestAddr & PS2_RAM_MASK;
-    if (!ps2PathWatchIntersects(writeAddr, size))
-    {
-        return;
-    }
-
-    const uint32_t logIndex = g_ps2PathWatchLogCount.fetch_add(1, std::memory_order_relaxed);
-    if (logIndex >= PS2_PATH_WATCH_MAX_LOGS)
-    {
-        return;
-    }
-
-    const uint32_t watchAddr = ps2PathWatchPhysAddr();
-    const bool touchesFirstByte = (watchAddr >= writeAddr) && (watchAddr < writeAddr + size);
-    const uint8_t oldByte = rdram[watchAddr];
-    const uint8_t newByte = touchesFirstByte ? ps2PathWatchExtractByteFromWrite(writeAddr, watchAddr, valueLo, valueHi) : oldByte;
-
-    const uint32_t pc = ctx ? ctx->pc : 0u;
-    const uint32_t ra = ctx ? static_cast<uint32_t>(_mm_extract_epi32(ctx->r[31], 0)) : 0u;
-    const uint32_t sp = ctx ? static_cast<uint32_t>(_mm_extract_epi32(ctx->r[29], 0)) : 0u;
-
-    auto flags = std::cout.flags();
-    std::cout << "[watch:path-write] #" << (logIndex + 1u)
-              << " op=" << op
-              << " addr=0x" << std::hex << writeAddr
-              << " size=0x" << size
-              << " pc=0x" << pc
-              << " ra=0x" << ra
-              << " sp=0x" << sp
-              << " vLo=0x" << valueLo;
-    if (size > 8u)
-    {
-        std::cout << " vHi=0x" << valueHi;
-    }
-    if (touchesFirstByte)
-    {
-        std::cout << " firstByte:" << static_cast<uint32_t>(oldByte)
-                  << "->" << static_cast<uint32_t>(newByte);
-        if (oldByte != 0u && newByte == 0u)
-        {
-            std::cout << " (ZEROED)";
-        }
-    }
-    ps2PathWatchDumpPrefix(rdram);
-    std::cout.flags(flags);
-    std::cout << std::endl;
-}
-
-inline void ps2TraceGuestRangeWrite(uint8_t *rdram,
-                                    uint32_t guestAddr,
-                                    uint32_t size,
-                                    const char *op,
-                                    const R5900Context *ctx)
-{
-    if (!rdram || size == 0u)
-    {
-        return;
-    }
-
-    const uint32_t writeAddr = guestAddr & PS2_RAM_MASK;
-    if (!ps2PathWatchIntersects(writeAddr, size))
-    {
-        return;
-    }
-
-    const uint32_t logIndex = g_ps2PathWatchLogCount.fetch_add(1, std::memory_order_relaxed);
-    if (logIndex >= PS2_PATH_WATCH_MAX_LOGS)
-    {
-        return;
-    }
-
-    const uint32_t pc = ctx ? ctx->pc : 0u;
-    const uint32_t ra = ctx ? static_cast<uint32_t>(_mm_extract_epi32(ctx->r[31], 0)) : 0u;
-    const uint32_t sp = ctx ? static_cast<uint32_t>(_mm_extract_epi32(ctx->r[29], 0)) : 0u;
-    const uint8_t firstByte = rdram[ps2PathWatchPhysAddr()];
-
-    auto flags = std::cout.flags();
-    std::cout << "[watch:path-range] #" << (logIndex + 1u)
-              << " op=" << op
-              << " addr=0x" << std::hex << writeAddr
-              << " size=0x" << size
-              << " pc=0x" << pc
-              << " ra=0x" << ra
-              << " sp=0x" << sp
-              << " firstByte=" << static_cast<uint32_t>(firstByte);
-    ps2PathWatchDumpPrefix(rdram);
-    std::cout.flags(flags);
-    std::cout << std::endl;
-}
-
 class PS2Runtime
 {
 public:
@@ -355,9 +203,38 @@ public:
         std::filesystem::path cdImage;
     };
 
+    // Headless runs open no window, present nothing, run on the Unlimited
+    // clock, and stop after a fixed number of frames with a benchmark report.
+    struct HeadlessOptions
+    {
+        uint64_t frames = 0;    // 0 runs until the guest exits
+        std::string reportPath; // JSON report; empty prints it to stdout
+    };
+
+    // Where VBlank comes from. RealTime ticks at 60Hz, FastForward ticks at
+    // 60Hz times a multiplier, and Unlimited raises a VBlank whenever the
+    // guest reaches a frame-wait point (WaitSema on the main thread,
+    // sceGsSyncV, pollVBlank) so the guest runs as fast as the host allows.
+    // Without a wait point for 1ms it delivers one from the timer thread.
+    enum class ClockMode
+    {
+        RealTime,
+        FastForward,
+        Unlimited
+    };
+
     PS2Runtime();
     ~PS2Runtime();
 
+    // Call before initialize(). Selects the Unlimited clock.
+    void setHeadless(const HeadlessOptions &options);
+    bool isHeadless() const { return m_headless; }
+
+    // May be changed while the guest runs.
+    void setClockMode(ClockMode mode, double multiplier = 1.0);
+    ClockMode clockMode() const { return m_clockMode.load(std::memory_order_relaxed); }
+    double clockMultiplier() const { return m_clockMultiplier.load(std::memory_order_relaxed); }
+
     bool initialize(const char *title = "PS2 Game");
     bool loadELF(const std::string &elfPath);
     void run();
@@ -471,6 +348,9 @@ private:
     void coalesceGuestHeapLocked();
 
     void HandleIntegerOverflow(R5900Context *ctx);
+    std::thread startGameThread(std::atomic<bool> &finished);
+    void stopGameThread(std::thread &gameThread, const std::atomic<bool> &finished);
+    void runHeadless();
 
 private:
     PS2Memory m_memory;
@@ -486,6 +366,13 @@ private:
     std::unordered_map<uint32_t, RecompiledFunction> m_functionTable;
     std::atomic<bool> m_stopRequested{false};
 
+    bool m_headless = false;
+    HeadlessOptions m_headlessOptions;
+    std::atomic<ClockMode> m_clockMode{ClockMode::RealTime};
+    std::atomic<double> m_clockMultiplier{1.0};
+    std::atomic<uint64_t> m_dispatchCount{0};
+    std::atomic<uint64_t> m_syscallCount{0};
+
     // TODO remove this later
     std::atomic<uint32_t> m_debugPc{0};
     std::atomic<uint32_t> m_debugRa{0};
@@ -12,6 +12,7 @@
 #endif
 
 #include "ps2_runtime.h"
+#include "ps2_profiler.h"
 
 static inline int32_t Ps2ExtractEpi32(__m128i v, int index)
 {
@@ -123,6 +124,11 @@ static inline uint32_t ps2_clz32(uint32_t x)
 #define PS2_VDIV(a, b) _mm_div_ps((__m128)(a), (__m128)(b))
 #define PS2_VMULQ(a, q) _mm_mul_ps((__m128)(a), _mm_set1_ps(q))
 #define PS2_VBLEND(a, b, mask) PS2_BLENDV_PS((__m128)(a), (__m128)(b), (__m128)(mask))
+#define PS2_VMAX(a, b) _mm_max_ps((__m128)(a), (__m128)(b))
+#define PS2_VMIN(a, b) _mm_min_ps((__m128)(a), (__m128)(b))
+#define PS2_VABS(a) _mm_andnot_ps(_mm_set1_ps(-0.0f), (__m128)(a))
+#define PS2_VSPLAT(f) _mm_set1_ps(f)
+#define PS2_VBROADCAST(a, field) _mm_shuffle_ps((__m128)(a), (__m128)(a), _MM_SHUFFLE(field, field, field, field))
 
 // Memory access helpers - Hybrid Fast/Slow Path
 // Fast path: Direct RDRAM access (masked).
@@ -228,68 +234,72 @@ static inline void Ps2FastWrite128(uint8_t *rdram, uint32_t addr, __m128i value)
         ? runtime->Load128(rdram, ctx, _addr)                 \
         : FAST_READ128(_addr); }())
 
-#define WRITE8(addr, val)                                                            \
-    do                                                                               \
-    {                                                                                \
-        uint32_t _addr = (addr);                                                     \
-        if (PS2Runtime::isSpecialAddress(_addr))                                     \
-            runtime->Store8(rdram, ctx, _addr, (val));                               \
-        else                                                                         \
-        {                                                                            \
-            ps2TraceGuestWrite(rdram, _addr, 1u, (uint8_t)(val), 0u, "WRITE8", ctx); \
-            FAST_WRITE8(_addr, (val));                                               \
-        }                                                                            \
-    } while (0)
-
-#define WRITE16(addr, val)                                                             \
+#define WRITE8(addr, val)                                                              \
     do                                                                                 \
     {                                                                                  \
         uint32_t _addr = (addr);                                                       \
         if (PS2Runtime::isSpecialAddress(_addr))                                       \
-            runtime->Store16(rdram, ctx, _addr, (val));                                \
+            runtime->Store8(rdram, ctx, _addr, (val));                                 \
         else                                                                           \
         {                                                                              \
-            ps2TraceGuestWrite(rdram, _addr, 2u, (uint16_t)(val), 0u, "WRITE16", ctx); \
-            FAST_WRITE16(_addr, (val));                                                \
+            ps2_watch::noteWrite(rdram, _addr, 1u, (uint8_t)(val), 0u, "WRITE8", ctx); \
+            FAST_WRITE8(_addr, (val));                                                 \
         }                                                                              \
     } while (0)
 
-#define WRITE32(addr, val)                                                             \
-    do                                                                                 \
-    {                                                                                  \
-        uint32_t _addr = (addr);                                                       \
-        if (PS2Runtime::isSpecialAddress(_addr))                                       \
-            runtime->Store32(rdram, ctx, _addr, (val));                                \
-        else                                                                           \
-        {                                                                              \
-            ps2TraceGuestWrite(rdram, _addr, 4u, (uint32_t)(val), 0u, "WRITE32", ctx); \
-            FAST_WRITE32(_addr, (val));                                                \
-        }                                                                              \
+#define WRITE16(addr, val)                                                               \
+    do                                                                                   \
+    {                                                                                    \
+        uint32_t _addr = (addr);                                                         \
+        if (PS2Runtime::isSpecialAddress(_addr))                                         \
+            runtime->Store16(rdram, ctx, _addr, (val));                                  \
+        else                                                                             \
+        {                                                                                \
+            ps2_watch::noteWrite(rdram, _addr, 2u, (uint16_t)(val), 0u, "WRITE16", ctx); \
+            FAST_WRITE16(_addr, (val));                                                  \
+        }                                                                                \
     } while (0)
 
-#define WRITE64(addr, val)                                                             \
-    do                                                                                 \
-    {                                                                                  \
-        uint32_t _addr = (addr);                                                       \
-        if (PS2Runtime::isSpecialAddress(_addr))                                       \
-            runtime->Store64(rdram, ctx, _addr, (val));                                \
-        else                                                                           \
-        {                                                                              \
-            ps2TraceGuestWrite(rdram, _addr, 8u, (uint64_t)(val), 0u, "WRITE64", ctx); \
-            FAST_WRITE64(_addr, (val));                                                \
-        }                                                                              \
+#define WRITE32(addr, val)                                                               \
+    do                                                                                   \
+    {                                                                                    \
+        uint32_t _addr = (addr);                                                         \
+        if (PS2Runtime::isSpecialAddress(_addr))                                         \
+            runtime->Store32(rdram, ctx, _addr, (val));                                  \
+        else                                                                             \
+        {                                                                                \
+            ps2_watch::noteWrite(rdram, _addr, 4u, (uint32_t)(val), 0u, "WRITE32", ctx); \
+            FAST_WRITE32(_addr, (val));                                                  \
+        }                                                                                \
     } while (0)
 
-#define WRITE128(addr, val)                              \
-    do                                                   \
-    {                                                    \
-        uint32_t _addr = (addr);                         \
-        if (PS2Runtime::isSpecialAddress(_addr))         \
-            runtime->Store128(rdram, ctx, _addr, (val)); \
-        else                                             \
-        {                                                \
-            FAST_WRITE128(_addr, (val));                 \
-        }                                                \
+#define WRITE64(addr, val)                                                               \
+    do                                                                                   \
+    {                                                                                    \
+        uint32_t _addr = (addr);                                                         \
+        if (PS2Runtime::isSpecialAddress(_addr))                                         \
+            runtime->Store64(rdram, ctx, _addr, (val));                                  \
+        else                                                                             \
+        {                                                                                \
+            ps2_watch::noteWrite(rdram, _addr, 8u, (uint64_t)(val), 0u, "WRITE64", ctx); \
+            FAST_WRITE64(_addr, (val));                                                  \
+        }                                                                                \
+    } while (0)
+
+#define WRITE128(addr, val)                                                                  \
+    do                                                                                       \
+    {                                                                                        \
+        uint32_t _addr = (addr);                                                             \
+        __m128i _val = (val);                                                                \
+        if (PS2Runtime::isSpecialAddress(_addr))                                             \
+            runtime->Store128(rdram, ctx, _addr, _val);                                      \
+        else                                                                                 \
+        {                                                                                    \
+            if (PS2_WATCHPOINTS && ps2_watch::mayHit(_addr, 16u))                            \
+                ps2_watch::noteWrite(rdram, _addr, 16u, (uint64_t)_mm_cvtsi128_si64(_val),   \
+                                     (uint64_t)_mm_extract_epi64(_val, 1), "WRITE128", ctx); \
+            FAST_WRITE128(_addr, _val);                                                      \
+        }                                                                                    \
     } while (0)
 
 // Packed Compare Greater Than (PCGT)
@@ -426,8 +436,9 @@ inline __m128i ps2_u64_to_epi64_pair(uint64_t value)
 // Additional VU0 operations
 #define PS2_VSQRT(x) sqrtf(x)
 #define PS2_VRSQRT(x) (1.0f / sqrtf(x))
-#define PS2_VCALLMS(addr) // VU0 microprogram calls not supported directly
-#define PS2_VCALLMSR(reg) // VU0 microprogram calls not supported directly
+// VU0 micro mode: VCALLMS takes a byte offset, VCALLMSR the CMSAR0 value (doublewords).
+#define PS2_VCALLMS(addr) runtime->executeVU0Microprogram(rdram, ctx, (addr))
+#define PS2_VCALLMSR(cmsar) runtime->executeVU0Microprogram(rdram, ctx, ((cmsar) & 0x1FFu) << 3)
 
 #define GPR_U32(ctx_ptr, reg_idx) ((reg_idx == 0) ? 0U : static_cast<uint32_t>(PS2_EXTRACT_EPI32_0(ctx_ptr->r[reg_idx])))
 #define GPR_S32(ctx_ptr, reg_idx) ((reg_idx == 0) ? 0 : PS2_EXTRACT_EPI32_0(ctx_ptr->r[reg_idx]))
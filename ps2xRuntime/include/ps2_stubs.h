@@ -3,6 +3,7 @@
 
 #include "ps2_runtime.h"
 #include "ps2_call_list.h"
+#include "ps2_callstats.h"
 #include <cstdint>
 
 namespace ps2_stubs
@@ -14,6 +15,9 @@ namespace ps2_stubs
     void syMalloc(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime);
     void sndr_trans_func(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime);
 
+    // Runs sceCdCallback handlers for CD commands that finished since the last poll.
+    void pollCdCallbacks(uint8_t *rdram, PS2Runtime *runtime);
+
     void TODO(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime);
     void TODO_NAMED(const char *name, uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime);
 }
@@ -0,0 +1,29 @@
+#ifndef PS2_SYMBOLS_H
+#define PS2_SYMBOLS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Guest function names and extents, emitted by the recompiler into
+// register_functions.cpp. Used to turn sampled guest PCs into names.
+namespace ps2_symbols
+{
+    struct FunctionSymbol
+    {
+        uint32_t start;
+        uint32_t end; // exclusive
+        const char *name;
+    };
+
+    // The table must outlive the runtime (the generated one is static).
+    void registerFunctions(const FunctionSymbol *symbols, size_t count);
+    void clear();
+
+    // Fills symbol with the function containing pc; false if none does.
+    bool find(uint32_t pc, FunctionSymbol &symbol);
+    // Symbol name, or "0x<pc>" for addresses outside every known function.
+    std::string describe(uint32_t pc);
+}
+
+#endif // PS2_SYMBOLS_H
@@ -3,6 +3,7 @@
 
 #include "ps2_runtime.h"
 #include "ps2_call_list.h"
+#include "ps2_callstats.h"
 #include <mutex>
 #include <atomic>
 #include <thread>
@@ -25,7 +26,10 @@ namespace ps2_syscalls
 
     // Drain pending VBlank ticks and dispatch INTC handlers inline.
     // Must be called from the main dispatch loop (same thread as guest code).
+    // This is a frame-wait point: the Unlimited clock raises a VBlank here.
     void pollVBlank(uint8_t *rdram, PS2Runtime *runtime);
+    // VBlanks delivered to the guest so far.
+    uint64_t vblankCount();
 
     // Register the calling thread as the main dispatch thread.
     // Only the main thread polls VBlank in cooperative WaitSema.
@@ -0,0 +1,103 @@
+#ifndef PS2_TRACE_H
+#define PS2_TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Timeline tracing in the Chrome trace event format (chrome://tracing,
+// ui.perfetto.dev). Each host thread appends begin/end/instant events to its
+// own buffer without locks; the buffer grows in chunks up to a fixed cap and
+// nothing is formatted until the trace is written. While tracing is off every
+// trace point is one relaxed load and a branch. Event names and categories
+// must be string literals: only the pointer is stored.
+namespace ps2_trace
+{
+    enum class Phase : char
+    {
+        Begin = 'B',
+        End = 'E',
+        Instant = 'i',
+    };
+
+    struct Options
+    {
+        std::filesystem::path outputPath; // written by stop()
+        size_t eventsPerThread = size_t{1} << 16; // later events are dropped and counted
+    };
+
+    inline std::atomic<bool> g_enabled{false};
+
+    inline bool enabled()
+    {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    // Slow path behind enabled(). argName may be nullptr for no argument.
+    void record(Phase phase, const char *category, const char *name, const char *argName = nullptr, uint64_t arg = 0);
+
+    // Begin/end pair for the enclosing block. The end is recorded whenever the
+    // begin was, even if tracing stopped in between, so pairs stay balanced.
+    class Scope
+    {
+    public:
+        Scope(const char *category, const char *name, const char *argName = nullptr, uint64_t arg = 0)
+            : m_category(category), m_name(name), m_active(enabled())
+        {
+            if (m_active) [[unlikely]]
+                record(Phase::Begin, category, name, argName, arg);
+        }
+
+        ~Scope()
+        {
+            if (m_active) [[unlikely]]
+                record(Phase::End, m_category, m_name);
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *m_category;
+        const char *m_name;
+        bool m_active;
+    };
+
+    // false if already tracing.
+    bool start(const Options &options);
+    // Stops recording and writes Options::outputPath if set; false if the file could not be written.
+    bool stop();
+    bool running();
+
+    // Everything recorded so far, as Chrome trace JSON. Safe while tracing:
+    // events still being appended are simply not included.
+    std::string json();
+    bool write(const std::filesystem::path &path);
+    // Writes json() to Options::outputPath; for on-demand snapshots.
+    bool writeSnapshot();
+
+    uint64_t eventCount();
+    uint64_t droppedCount();
+    // Discards recorded events. Only call while no thread is recording.
+    void reset();
+}
+
+#define PS2_TRACE_CONCAT_INNER(a, b) a##b
+#define PS2_TRACE_CONCAT(a, b) PS2_TRACE_CONCAT_INNER(a, b)
+
+#define PS2_TRACE_SCOPE(category, name) \
+    ::ps2_trace::Scope PS2_TRACE_CONCAT(ps2TraceScope_, __LINE__)(category, name)
+
+#define PS2_TRACE_SCOPE_ARG(category, name, argName, arg) \
+    ::ps2_trace::Scope PS2_TRACE_CONCAT(ps2TraceScope_, __LINE__)(category, name, argName, static_cast<uint64_t>(arg))
+
+#define PS2_TRACE_INSTANT(category, name, argName, arg)                                                         \
+    do                                                                                                          \
+    {                                                                                                           \
+        if (::ps2_trace::enabled()) [[unlikely]]                                                                \
+            ::ps2_trace::record(::ps2_trace::Phase::Instant, category, name, argName, static_cast<uint64_t>(arg)); \
+    } while (0)
+
+#endif // PS2_TRACE_H
@@ -0,0 +1,111 @@
+#ifndef PS2_VIF_H
+#define PS2_VIF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct VIFRegisters;
+
+// VIF command processing. A Processor walks the VIFcode stream of one VIF
+// (unit 0 feeds VU0, unit 1 feeds VU1 and GIF PATH2), updating its VIF
+// registers, unpacking vertex data into VU data memory, uploading microcode
+// and starting microprograms.
+namespace ps2_vif
+{
+    enum Command : uint8_t
+    {
+        NOP = 0x00,
+        STCYCL = 0x01,
+        OFFSET = 0x02,
+        BASE = 0x03,
+        ITOP = 0x04,
+        STMOD = 0x05,
+        MSKPATH3 = 0x06,
+        MARK = 0x07,
+        FLUSHE = 0x10,
+        FLUSH = 0x11,
+        FLUSHA = 0x13,
+        MSCAL = 0x14,
+        MSCALF = 0x15,
+        MSCNT = 0x17,
+        STMASK = 0x20,
+        STROW = 0x30,
+        STCOL = 0x31,
+        MPG = 0x4A,
+        DIRECT = 0x50,
+        DIRECTHL = 0x51,
+        UNPACK = 0x60, // 0x60-0x7F
+    };
+
+    // Parameters of one UNPACK, decoded from the VIFcode and the VIF registers.
+    struct Unpack
+    {
+        uint32_t vn = 0;   // components - 1
+        uint32_t vl = 0;   // 0 = 32-bit, 1 = 16-bit, 2 = 8-bit, 3 = V4-5 (with vn 3)
+        bool masked = false;
+        bool zeroExtend = false;
+        uint32_t addr = 0; // destination qword
+        uint32_t num = 0;  // qwords written
+        uint32_t cl = 1;
+        uint32_t wl = 1;
+        uint32_t mode = 0; // STMOD: 0 normal, 1 offset, 2 difference
+        uint32_t mask = 0;
+    };
+
+    // Bytes of source data an UNPACK consumes, rounded up to whole words.
+    uint32_t unpackBytes(const Unpack &u);
+    // Expands u.num vectors from src into VU data memory (wrapping at
+    // dataQwords, a power of two). row is updated in difference mode.
+    void unpack(const Unpack &u, const uint8_t *src, uint8_t *vuData, uint32_t dataQwords,
+                uint32_t row[4], const uint32_t col[4]);
+
+    class Processor
+    {
+    public:
+        // MSCAL/MSCALF pass a start address in doublewords; MSCNT passes kContinue.
+        using MicroHandler = std::function<void(uint32_t startPc)>;
+        using DirectHandler = std::function<void(const uint8_t *data, uint32_t bytes)>;
+        // MPG wrote bytes of microcode at a micro memory byte offset.
+        using UploadHandler = std::function<void(uint32_t offset, uint32_t bytes)>;
+        static constexpr uint32_t kContinue = 0xFFFFFFFFu;
+
+        void attach(uint32_t unit, VIFRegisters *regs, uint8_t *code, uint32_t codeSize, uint8_t *data,
+                    uint32_t dataSize);
+        void setMicroHandler(MicroHandler handler) { m_micro = std::move(handler); }
+        void setDirectHandler(DirectHandler handler) { m_direct = std::move(handler); }
+        void setUploadHandler(UploadHandler handler) { m_upload = std::move(handler); }
+
+        // Consumes whole 32-bit words; a command whose data is split across
+        // calls is completed by the next feed().
+        void feed(const uint8_t *data, size_t bytes);
+        void reset();
+
+        bool path3Masked() const { return m_path3Masked; }
+        uint64_t commands() const { return m_commands; }
+
+    private:
+        uint32_t dataWords(uint32_t code) const;
+        void execute(uint32_t code, const uint8_t *data);
+        void startMicro(uint32_t pc);
+
+        uint32_t m_unit = 0;
+        VIFRegisters *m_regs = nullptr;
+        uint8_t *m_code = nullptr;
+        uint32_t m_codeSize = 0;
+        uint8_t *m_data = nullptr;
+        uint32_t m_dataSize = 0;
+        MicroHandler m_micro;
+        DirectHandler m_direct;
+        UploadHandler m_upload;
+
+        uint32_t m_pendingCode = 0;
+        uint32_t m_pendingWords = 0;   // data words still owed to m_pendingCode
+        std::vector<uint8_t> m_pending; // data gathered so far (not used for DIRECT)
+        bool m_path3Masked = false;
+        uint64_t m_commands = 0;
+    };
+}
+
+#endif // PS2_VIF_H
@@ -0,0 +1,290 @@
+#ifndef PS2_VU_H
+#define PS2_VU_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#elif defined(USE_SSE2NEON)
+    #include "sse2neon.h"
+#else
+    #include <immintrin.h> // For SSE/AVX instructions
+    #include <smmintrin.h> // For SSE4.1 instructions
+#endif
+
+struct VIFRegisters;
+
+// VU micro mode. A VectorUnit runs the microprogram in its micro memory when
+// VIF MSCAL/MSCNT (or VCALLMS on VU0) starts it: uploads (VIF MPG) are hashed
+// as they arrive, and a program recompiled ahead of time with matching
+// contents runs natively; anything else goes through the interpreter.
+namespace ps2_vu
+{
+    class VectorUnit;
+
+    // Architectural state, shared by the interpreter and recompiled programs.
+    struct alignas(16) State
+    {
+        __m128 vf[32];
+        __m128 acc;
+        uint16_t vi[16];
+        float q = 0.0f;
+        float p = 0.0f;
+        float i = 0.0f;
+        uint32_t r = 0;
+        uint32_t status = 0;
+        uint32_t mac = 0;
+        uint32_t clip = 0;
+        uint32_t tpc = 0; // where MSCNT resumes
+        uint8_t *data = nullptr;
+        uint32_t dataMask = 0; // qwords - 1
+        uint32_t budget = 0;   // taken branches left before the run is cut short
+        VectorUnit *unit = nullptr;
+    };
+
+    // Returns the next pc (in doublewords) to run, or kEnd once the E-bit
+    // delay slot has executed.
+    using Program = uint32_t (*)(State &vu, uint32_t pc);
+    constexpr uint32_t kEnd = 0xFFFFFFFFu;
+
+    struct ProgramInfo
+    {
+        uint32_t unit = 1;
+        uint32_t start = 0; // micro memory byte offset of the upload
+        uint32_t size = 0;  // bytes
+        uint64_t hash = 0;  // contentHash of the uploaded bytes
+        Program entry = nullptr;
+    };
+
+    // FNV-1a, continued across consecutive uploads by passing the last result.
+    constexpr uint64_t kHashSeed = 0xCBF29CE484222325ull;
+    uint64_t contentHash(const uint8_t *bytes, size_t size, uint64_t seed = kHashSeed);
+
+    // Lane select for a dest field (bit 3 = x ... bit 0 = w).
+    inline __m128 destMask(uint32_t dest)
+    {
+        return _mm_castsi128_ps(_mm_setr_epi32((dest & 8u) ? -1 : 0, (dest & 4u) ? -1 : 0, (dest & 2u) ? -1 : 0,
+                                               (dest & 1u) ? -1 : 0));
+    }
+
+    // OPMULA/OPMSUB: fs.yzx * ft.zxy, w left as zero.
+    inline __m128 outerProduct(__m128 fs, __m128 ft)
+    {
+        const __m128 product = _mm_mul_ps(_mm_shuffle_ps(fs, fs, _MM_SHUFFLE(3, 0, 2, 1)),
+                                          _mm_shuffle_ps(ft, ft, _MM_SHUFFLE(3, 1, 0, 2)));
+        return _mm_blend_ps(product, _mm_setzero_ps(), 0x8);
+    }
+
+    inline float lane(__m128 v, uint32_t index)
+    {
+        alignas(16) float f[4];
+        _mm_store_ps(f, v);
+        return f[index & 3u];
+    }
+
+    inline __m128 loadQword(const State &vu, uint32_t addr)
+    {
+        return _mm_load_ps(reinterpret_cast<const float *>(vu.data + (addr & vu.dataMask) * 16u));
+    }
+
+    inline void storeQword(State &vu, uint32_t addr, __m128 value, uint32_t dest)
+    {
+        float *p = reinterpret_cast<float *>(vu.data + (addr & vu.dataMask) * 16u);
+        _mm_store_ps(p, dest == 0xFu ? value : _mm_blendv_ps(_mm_load_ps(p), value, destMask(dest)));
+    }
+
+    inline uint16_t loadInteger(const State &vu, uint32_t addr, uint32_t dest)
+    {
+        const uint32_t field = dest & 8u ? 0u : dest & 4u ? 1u : dest & 2u ? 2u : 3u;
+        uint16_t value;
+        std::memcpy(&value, vu.data + (addr & vu.dataMask) * 16u + field * 4u, sizeof(value));
+        return value;
+    }
+
+    inline void storeInteger(State &vu, uint32_t addr, uint16_t value, uint32_t dest)
+    {
+        uint8_t *p = vu.data + (addr & vu.dataMask) * 16u;
+        const uint32_t word = value;
+        for (uint32_t field = 0; field < 4; ++field)
+        {
+            if (dest & (8u >> field))
+                std::memcpy(p + field * 4u, &word, sizeof(word));
+        }
+    }
+
+    // MAC flags (zero 0-3, sign 4-7, x in the high bit of each group) and the
+    // Z/S bits of the status flag, with their sticky copies.
+    inline void setFlags(State &vu, __m128 result, uint32_t dest)
+    {
+        static constexpr uint8_t kReverse[16] = {0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15};
+        const uint32_t zero = kReverse[_mm_movemask_ps(_mm_cmpeq_ps(result, _mm_setzero_ps()))] & dest;
+        const uint32_t sign = kReverse[_mm_movemask_ps(result)] & dest;
+        vu.mac = zero | (sign << 4);
+        const uint32_t bits = (zero ? 1u : 0u) | (sign ? 2u : 0u);
+        vu.status = (vu.status & ~0xFu) | bits | (bits << 6);
+    }
+
+    // CLIP shifts the previous judgements up by six and tests x, y, z against +-|w|.
+    inline uint32_t clipFlags(uint32_t previous, __m128 fs, float w)
+    {
+        const __m128 limit = _mm_set1_ps(std::fabs(w));
+        const int above = _mm_movemask_ps(_mm_cmpgt_ps(fs, limit));
+        const int below = _mm_movemask_ps(_mm_cmplt_ps(fs, _mm_sub_ps(_mm_setzero_ps(), limit)));
+        uint32_t flags = 0;
+        for (uint32_t c = 0; c < 3; ++c)
+            flags |= ((above >> c) & 1u) << (c * 2u) | ((below >> c) & 1u) << (c * 2u + 1u);
+        return ((previous << 6) | flags) & 0xFFFFFFu;
+    }
+
+    // FTOI saturates instead of producing the x86 integer indefinite value.
+    inline __m128 floatToFixed(__m128 value, float scale)
+    {
+        const __m128 scaled = _mm_mul_ps(value, _mm_set1_ps(scale));
+        const __m128i truncated = _mm_cvttps_epi32(scaled);
+        const __m128 overflow = _mm_cmpge_ps(scaled, _mm_set1_ps(2147483648.0f));
+        return _mm_blendv_ps(_mm_castsi128_ps(truncated), _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)), overflow);
+    }
+
+    inline __m128 fixedToFloat(__m128 value, float scale)
+    {
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_castps_si128(value)), _mm_set1_ps(scale));
+    }
+
+    // DIV/SQRT/RSQRT write Q; a zero divisor or negative root sets D or I.
+    inline float divide(State &vu, float fs, float ft)
+    {
+        if (ft == 0.0f)
+        {
+            vu.status |= 0x820u;
+            return std::signbit(fs) != std::signbit(ft) ? -3.40282347e38f : 3.40282347e38f;
+        }
+        vu.status &= ~0x30u;
+        return fs / ft;
+    }
+
+    inline float squareRoot(State &vu, float ft)
+    {
+        vu.status = (vu.status & ~0x30u) | (ft < 0.0f ? 0x410u : 0u);
+        return std::sqrt(std::fabs(ft));
+    }
+
+    inline float reciprocalRoot(State &vu, float fs, float ft)
+    {
+        const float root = squareRoot(vu, ft);
+        return divide(vu, fs, root);
+    }
+
+    // R holds a 23-bit mantissa; reads see it as a float in [1, 2).
+    inline float randomValue(const State &vu)
+    {
+        const uint32_t bits = 0x3F800000u | (vu.r & 0x7FFFFFu);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    inline void randomNext(State &vu)
+    {
+        uint32_t x = vu.r;
+        const uint32_t bit = ((x >> 4) ^ (x >> 22)) & 1u;
+        vu.r = ((x << 1) | bit) & 0x7FFFFFu;
+    }
+
+    inline uint32_t floatBits(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    inline float floatFromBits(uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void xgkick(State &vu, uint16_t addr);
+    uint16_t xtop(const State &vu);
+    uint16_t xitop(const State &vu);
+
+    class VectorUnit
+    {
+    public:
+        // XGKICK hands over one GIF packet (up to its EOP tag) from data memory.
+        using KickHandler = std::function<void(const uint8_t *packet, uint32_t bytes)>;
+
+        VectorUnit();
+
+        void attach(uint32_t unit, uint8_t *code, uint32_t codeSize, uint8_t *data, uint32_t dataSize,
+                    const VIFRegisters *vif);
+        void setKickHandler(KickHandler handler) { m_kick = std::move(handler); }
+        void registerProgram(const ProgramInfo &info);
+
+        // VIF MPG wrote bytes at the given micro memory offset.
+        void upload(uint32_t offset, uint32_t bytes);
+        // The EE stored into micro memory; matching programs are re-hashed
+        // the next time they are started.
+        void invalidate(uint32_t offset, uint32_t bytes);
+        // MSCAL/MSCNT; ps2_vif::Processor::kContinue resumes at TPC.
+        void start(uint32_t pc);
+        void reset();
+
+        State &state() { return m_state; }
+        const VIFRegisters *vif() const { return m_vif; }
+        void kick(uint16_t addr);
+
+        uint64_t compiledRuns() const { return m_compiledRuns; }
+        uint64_t interpretedRuns() const { return m_interpretedRuns; }
+
+        static constexpr uint32_t kBranchBudget = 1u << 22;
+
+    private:
+        struct Resident
+        {
+            uint32_t start; // bytes
+            uint32_t end;
+            Program entry;
+        };
+
+        Program residentAt(uint32_t pc) const;
+        // residentAt, or a registered program around pc whose bytes still
+        // match after direct stores.
+        Program resolve(uint32_t pc);
+        void dropResident(uint32_t start, uint32_t end);
+        // Runs pairs from pc until the program ends or branches into a
+        // recompiled program; returns the next pc or kEnd.
+        uint32_t interpret(uint32_t pc);
+
+        uint32_t m_unit = 1;
+        uint8_t *m_code = nullptr;
+        uint32_t m_codeSize = 0;
+        const VIFRegisters *m_vif = nullptr;
+        KickHandler m_kick;
+        State m_state;
+        std::vector<uint8_t> m_packet;
+
+        std::map<std::tuple<uint32_t, uint32_t, uint64_t>, Program> m_programs;
+        std::vector<Resident> m_resident;
+        // Registered (start, size) ranges hashed since the last store that did not match.
+        std::set<std::pair<uint32_t, uint32_t>> m_mismatched;
+        // Consecutive MPGs with adjacent addresses hash as one upload.
+        bool m_uploading = false;
+        uint32_t m_uploadStart = 0;
+        uint32_t m_uploadEnd = 0;
+        uint64_t m_uploadHash = kHashSeed;
+
+        uint64_t m_compiledRuns = 0;
+        uint64_t m_interpretedRuns = 0;
+    };
+}
+
+#endif // PS2_VU_H
@@ -0,0 +1,107 @@
+#ifndef PS2_WATCH_H
+#define PS2_WATCH_H
+
+#include "ps2_memory.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct R5900Context;
+
+// Guest write watchpoints. Every guest store calls noteWrite(); while nothing
+// is armed that is a single relaxed load, and with PS2_WATCHPOINTS=0 it
+// compiles away. Armed ranges mark their 4KB pages in a bitmap so stores to
+// other pages still return without taking the slow path. Hits are formatted on
+// the storing thread and written by ps2_log (Memory category), so console I/O
+// never blocks it.
+//
+// Ranges come from PS2_WATCH, the runner's --watch flag, or general.watchpoints
+// in the recompiler TOML, e.g. "0x00369F2F:32,0x00100000-0x00100100=heap".
+#ifndef PS2_WATCHPOINTS
+#define PS2_WATCHPOINTS 1
+#endif
+
+namespace ps2_watch
+{
+    constexpr uint32_t kPageShift = 12;
+    constexpr uint32_t kPageCount = PS2_RAM_SIZE >> kPageShift;
+    // Hits logged per watchpoint; later hits are only counted.
+    constexpr uint32_t kMaxLoggedHits = 512;
+
+    struct Watchpoint
+    {
+        uint32_t address = 0; // physical RDRAM address
+        uint32_t size = 0;
+        std::string label;
+        uint64_t hits = 0;
+    };
+
+    inline std::atomic<uint32_t> g_armed{0};
+    inline std::atomic<uint64_t> g_pages[kPageCount / 64] = {};
+
+    inline bool pageArmed(uint32_t page)
+    {
+        return (g_pages[page >> 6].load(std::memory_order_relaxed) >> (page & 63u)) & 1u;
+    }
+
+    // Cheap filter: true when [address, address + size) may touch a watchpoint.
+    inline bool mayHit(uint32_t address, uint32_t size)
+    {
+        if (g_armed.load(std::memory_order_relaxed) == 0 || size == 0)
+            return false;
+        const uint32_t first = (address & PS2_RAM_MASK) >> kPageShift;
+        const uint32_t last = ((address & PS2_RAM_MASK) + size - 1u) >> kPageShift;
+        for (uint32_t page = first; page <= last && page < kPageCount; ++page)
+        {
+            if (pageArmed(page))
+                return true;
+        }
+        return false;
+    }
+
+    // Slow paths, only reached when mayHit() passed. recordWrite runs before the
+    // store (it reports old -> new bytes); recordRangeWrite after a bulk copy.
+    void recordWrite(const uint8_t *rdram, uint32_t address, uint32_t size,
+                     uint64_t valueLo, uint64_t valueHi, const char *op, const R5900Context *ctx);
+    void recordRangeWrite(const uint8_t *rdram, uint32_t address, uint32_t size,
+                          const char *op, const R5900Context *ctx);
+
+    inline void noteWrite(const uint8_t *rdram, uint32_t address, uint32_t size,
+                          uint64_t valueLo, uint64_t valueHi, const char *op, const R5900Context *ctx)
+    {
+#if PS2_WATCHPOINTS
+        if (mayHit(address, size)) [[unlikely]]
+            recordWrite(rdram, address, size, valueLo, valueHi, op, ctx);
+#else
+        (void)rdram, (void)address, (void)size, (void)valueLo, (void)valueHi, (void)op, (void)ctx;
+#endif
+    }
+
+    inline void noteRangeWrite(const uint8_t *rdram, uint32_t address, uint32_t size,
+                               const char *op, const R5900Context *ctx)
+    {
+#if PS2_WATCHPOINTS
+        if (mayHit(address, size)) [[unlikely]]
+            recordRangeWrite(rdram, address, size, op, ctx);
+#else
+        (void)rdram, (void)address, (void)size, (void)op, (void)ctx;
+#endif
+    }
+
+    // Exact test against the armed ranges, for callers that log extra context.
+    bool overlaps(uint32_t address, uint32_t size);
+
+    // Returns false for an empty range.
+    bool add(uint32_t address, uint32_t size, std::string label = {});
+    void clear();
+    // Adds every range in a spec ("addr:size", "start-end", optional "=label",
+    // comma separated). Malformed entries are reported and skipped.
+    bool configure(std::string_view spec);
+    std::vector<Watchpoint> list();
+}
+
+#endif // PS2_WATCH_H
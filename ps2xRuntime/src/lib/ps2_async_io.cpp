@@ -0,0 +1,467 @@
+#include "ps2_async_io.h"
+#include "ThreadNaming.h"
+#include "ps2_log.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define PS2_ASYNC_IO_URING 1
+#endif
+#endif
+#ifndef PS2_ASYNC_IO_URING
+#define PS2_ASYNC_IO_URING 0
+#endif
+
+namespace
+{
+    using ps2_async_io::Op;
+    using ps2_async_io::Request;
+    using ps2_async_io::Ticket;
+
+    constexpr unsigned kRingEntries = 256;
+    constexpr unsigned kPoolThreads = 2;
+
+    int64_t executeBlocking(const Request &request)
+    {
+        int64_t result = -1;
+        switch (request.op)
+        {
+        case Op::Open:
+#ifdef _WIN32
+            result = ::_open(request.path.c_str(), request.flags, request.mode);
+#else
+            result = ::open(request.path.c_str(), request.flags, request.mode);
+#endif
+            break;
+        case Op::Read:
+#ifdef _WIN32
+            result = ::_lseeki64(request.fd, static_cast<__int64>(request.offset), SEEK_SET) < 0
+                         ? -1
+                         : ::_read(request.fd, request.buffer, static_cast<unsigned int>(request.size));
+#else
+            do
+            {
+                result = ::pread(request.fd, request.buffer, request.size, static_cast<off_t>(request.offset));
+            } while (result < 0 && errno == EINTR);
+#endif
+            break;
+        case Op::Write:
+#ifdef _WIN32
+            result = ::_lseeki64(request.fd, static_cast<__int64>(request.offset), SEEK_SET) < 0
+                         ? -1
+                         : ::_write(request.fd, request.buffer, static_cast<unsigned int>(request.size));
+#else
+            do
+            {
+                result = ::pwrite(request.fd, request.buffer, request.size, static_cast<off_t>(request.offset));
+            } while (result < 0 && errno == EINTR);
+#endif
+            break;
+        }
+        return result < 0 ? -static_cast<int64_t>(errno) : result;
+    }
+
+#if PS2_ASYNC_IO_URING
+    // Minimal single-issuer io_uring: one SQ producer and one CQ consumer, both
+    // serialised by AsyncIoEngine's mutex. waitForCompletion only enters the
+    // kernel, so one thread at a time may call it without that mutex.
+    class IoUring
+    {
+    public:
+        ~IoUring()
+        {
+            if (m_sqes)
+                ::munmap(m_sqes, m_sqesSize);
+            if (m_cqRing && m_cqRing != m_sqRing)
+                ::munmap(m_cqRing, m_cqRingSize);
+            if (m_sqRing)
+                ::munmap(m_sqRing, m_sqRingSize);
+            if (m_fd >= 0)
+                ::close(m_fd);
+        }
+
+        bool init(unsigned entries)
+        {
+            io_uring_params params{};
+            m_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+            if (m_fd < 0)
+                return false;
+            if (!supportsOps())
+                return false;
+
+            m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (singleMmap)
+            {
+                m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+            }
+
+            m_sqRing = mapRing(m_sqRingSize, IORING_OFF_SQ_RING);
+            if (!m_sqRing)
+                return false;
+            m_cqRing = singleMmap ? m_sqRing : mapRing(m_cqRingSize, IORING_OFF_CQ_RING);
+            if (!m_cqRing)
+                return false;
+            m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            m_sqes = static_cast<io_uring_sqe *>(mapRing(m_sqesSize, IORING_OFF_SQES));
+            if (!m_sqes)
+                return false;
+
+            uint8_t *sq = static_cast<uint8_t *>(m_sqRing);
+            m_sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+            m_sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+            m_sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+            m_sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+            m_sqEntries = params.sq_entries;
+
+            uint8_t *cq = static_cast<uint8_t *>(m_cqRing);
+            m_cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+            m_cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+            m_cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+            m_cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        bool push(Ticket ticket, const Request &request)
+        {
+            const unsigned tail = *m_sqTail;
+            if (tail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqEntries)
+                return false;
+
+            const unsigned index = tail & m_sqMask;
+            io_uring_sqe &sqe = m_sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            switch (request.op)
+            {
+            case Op::Open:
+                sqe.opcode = IORING_OP_OPENAT;
+                sqe.fd = AT_FDCWD;
+                sqe.addr = reinterpret_cast<uintptr_t>(request.path.c_str());
+                sqe.len = static_cast<uint32_t>(request.mode);
+                sqe.open_flags = static_cast<uint32_t>(request.flags);
+                break;
+            case Op::Read:
+            case Op::Write:
+                sqe.opcode = request.op == Op::Read ? IORING_OP_READ : IORING_OP_WRITE;
+                sqe.fd = request.fd;
+                sqe.addr = reinterpret_cast<uintptr_t>(request.buffer);
+                sqe.len = static_cast<uint32_t>(request.size);
+                sqe.off = request.offset;
+                break;
+            }
+            sqe.user_data = ticket;
+            m_sqArray[index] = index;
+            __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+            // If this enter fails the entry stays queued and the next one submits it.
+            enter(1, 0, 0);
+            return true;
+        }
+
+        template <typename Fn>
+        void reap(Fn &&onCompletion)
+        {
+            unsigned head = *m_cqHead;
+            const unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head)
+            {
+                const io_uring_cqe &cqe = m_cqes[head & m_cqMask];
+                onCompletion(static_cast<Ticket>(cqe.user_data), static_cast<int64_t>(cqe.res));
+            }
+            __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+        }
+
+        void waitForCompletion()
+        {
+            const unsigned unsubmitted = *m_sqTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+            enter(unsubmitted, 1, IORING_ENTER_GETEVENTS);
+        }
+
+    private:
+        int enter(unsigned toSubmit, unsigned minComplete, unsigned flags)
+        {
+            long ret;
+            do
+            {
+                ret = ::syscall(__NR_io_uring_enter, m_fd, toSubmit, minComplete, flags, nullptr, 0);
+            } while (ret < 0 && errno == EINTR);
+            return static_cast<int>(ret);
+        }
+
+        void *mapRing(size_t size, off_t offset)
+        {
+            void *ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, offset);
+            return ptr == MAP_FAILED ? nullptr : ptr;
+        }
+
+        // OPENAT/READ/WRITE arrived in 5.6 together with the probe interface.
+        bool supportsOps()
+        {
+            constexpr unsigned kProbeOps = 256;
+            std::vector<uint8_t> storage(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op));
+            auto *probe = reinterpret_cast<io_uring_probe *>(storage.data());
+            if (::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0)
+                return false;
+
+            for (const unsigned op : {unsigned(IORING_OP_OPENAT), unsigned(IORING_OP_READ), unsigned(IORING_OP_WRITE)})
+            {
+                if (op > probe->last_op || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0)
+                    return false;
+            }
+            return true;
+        }
+
+        int m_fd = -1;
+        void *m_sqRing = nullptr;
+        void *m_cqRing = nullptr;
+        io_uring_sqe *m_sqes = nullptr;
+        size_t m_sqRingSize = 0;
+        size_t m_cqRingSize = 0;
+        size_t m_sqesSize = 0;
+        unsigned *m_sqHead = nullptr;
+        unsigned *m_sqTail = nullptr;
+        unsigned *m_sqArray = nullptr;
+        unsigned m_sqMask = 0;
+        unsigned m_sqEntries = 0;
+        unsigned *m_cqHead = nullptr;
+        unsigned *m_cqTail = nullptr;
+        unsigned m_cqMask = 0;
+        io_uring_cqe *m_cqes = nullptr;
+    };
+#endif
+
+    class AsyncIoEngine
+    {
+    public:
+        AsyncIoEngine()
+        {
+#if PS2_ASYNC_IO_URING
+            const char *disable = std::getenv("PS2_DISABLE_IO_URING");
+            if (!(disable && *disable && *disable != '0'))
+            {
+                auto ring = std::make_unique<IoUring>();
+                if (ring->init(kRingEntries))
+                {
+                    m_ring = std::move(ring);
+                }
+            }
+#endif
+            PS2_LOG_INFO(Io, "[asyncIo] backend: " << backendName());
+        }
+
+        ~AsyncIoEngine()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            for (std::thread &worker : m_workers)
+            {
+                worker.join();
+            }
+        }
+
+        const char *backendName() const
+        {
+#if PS2_ASYNC_IO_URING
+            if (m_ring)
+                return "io_uring";
+#endif
+            return "thread pool";
+        }
+
+        Ticket submit(Request request)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            const Ticket ticket = ++m_nextTicket;
+            Request &stored = m_inflight.emplace(ticket, std::move(request)).first->second;
+
+#if PS2_ASYNC_IO_URING
+            if (m_ring)
+            {
+                if (!m_ring->push(ticket, stored))
+                {
+                    // Ring full: finish the operation here rather than drop it,
+                    // without holding up pollers and waiters of other tickets.
+                    const Request pending = stored;
+                    lock.unlock();
+                    const int64_t result = executeBlocking(pending);
+                    lock.lock();
+                    m_inflight.erase(ticket);
+                    m_done[ticket] = result;
+                    lock.unlock();
+                    m_doneCv.notify_all();
+                }
+                return ticket;
+            }
+#endif
+            if (m_workers.empty())
+            {
+                for (unsigned i = 0; i < kPoolThreads; ++i)
+                {
+                    m_workers.emplace_back([this]()
+                                           { runWorker(); });
+                }
+            }
+            m_queue.push_back(ticket);
+            lock.unlock();
+            m_wake.notify_one();
+            return ticket;
+        }
+
+        bool poll(Ticket ticket, int64_t &result)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            reapRing();
+            return takeResult(ticket, result);
+        }
+
+        int64_t wait(Ticket ticket)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            int64_t result = -EBADF;
+            while (true)
+            {
+                reapRing();
+                if (takeResult(ticket, result))
+                    return result;
+                if (m_inflight.find(ticket) == m_inflight.end())
+                    return -EBADF;
+
+#if PS2_ASYNC_IO_URING
+                if (m_ring && !m_ringWaiter)
+                {
+                    // One waiter blocks in the kernel with the lock released and
+                    // reaps for everyone; completions stay in the CQ until then,
+                    // so none can be missed between the check above and the syscall.
+                    m_ringWaiter = true;
+                    lock.unlock();
+                    m_ring->waitForCompletion();
+                    lock.lock();
+                    m_ringWaiter = false;
+                    reapRing();
+                    m_doneCv.notify_all();
+                    continue;
+                }
+#endif
+                m_doneCv.wait(lock);
+            }
+        }
+
+    private:
+        // Caller holds m_mutex. While a wait() is blocked in the kernel only it
+        // reaps: emptying the CQ under it could leave it blocked for good.
+        void reapRing()
+        {
+#if PS2_ASYNC_IO_URING
+            if (m_ring && !m_ringWaiter)
+            {
+                m_ring->reap([this](Ticket ticket, int64_t result)
+                             {
+                                 m_inflight.erase(ticket);
+                                 m_done[ticket] = result; });
+            }
+#endif
+        }
+
+        bool takeResult(Ticket ticket, int64_t &result)
+        {
+            auto it = m_done.find(ticket);
+            if (it == m_done.end())
+                return false;
+            result = it->second;
+            m_done.erase(it);
+            return true;
+        }
+
+        void runWorker()
+        {
+            ThreadNaming::SetCurrentThreadName("FioAsyncThread");
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
+            {
+                m_wake.wait(lock, [this]()
+                            { return m_stop || !m_queue.empty(); });
+                if (m_stop)
+                    return;
+
+                const Ticket ticket = m_queue.front();
+                m_queue.pop_front();
+                const Request request = m_inflight.at(ticket);
+                lock.unlock();
+
+                const int64_t result = executeBlocking(request);
+
+                lock.lock();
+                m_inflight.erase(ticket);
+                m_done[ticket] = result;
+                m_doneCv.notify_all();
+            }
+        }
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_doneCv;
+        Ticket m_nextTicket = 0;
+        std::unordered_map<Ticket, Request> m_inflight;
+        std::unordered_map<Ticket, int64_t> m_done;
+        std::deque<Ticket> m_queue;
+        std::vector<std::thread> m_workers;
+        bool m_stop = false;
+#if PS2_ASYNC_IO_URING
+        std::unique_ptr<IoUring> m_ring;
+        bool m_ringWaiter = false; // a wait() is blocked in io_uring_enter
+#endif
+    };
+
+    AsyncIoEngine &engine()
+    {
+        static AsyncIoEngine instance;
+        return instance;
+    }
+}
+
+namespace ps2_async_io
+{
+    Ticket submit(Request request)
+    {
+        return engine().submit(std::move(request));
+    }
+
+    bool poll(Ticket ticket, int64_t &result)
+    {
+        return engine().poll(ticket, result);
+    }
+
+    int64_t wait(Ticket ticket)
+    {
+        return engine().wait(ticket);
+    }
+
+    const char *backendName()
+    {
+        return engine().backendName();
+    }
+}
@@ -0,0 +1,84 @@
+#include "ps2_benchmark.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace ps2_benchmark
+{
+    uint64_t peakResidentBytes()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+        return 0;
+#else
+        struct rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+#if defined(__APPLE__)
+        return static_cast<uint64_t>(usage.ru_maxrss); // bytes
+#else
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024u; // kilobytes
+#endif
+#endif
+    }
+
+    std::string toJson(const Report &report)
+    {
+        const auto perSecond = [&](uint64_t count)
+        {
+            return report.seconds > 0.0 ? static_cast<double>(count) / report.seconds : 0.0;
+        };
+
+        std::ostringstream ss;
+        ss << "{\n";
+        ss << "  \"frames\": " << report.frames << ",\n";
+        ss << "  \"seconds\": " << report.seconds << ",\n";
+        ss << "  \"fps\": " << perSecond(report.frames) << ",\n";
+        ss << "  \"dispatches\": " << report.dispatches << ",\n";
+        ss << "  \"dispatches_per_second\": " << perSecond(report.dispatches) << ",\n";
+        ss << "  \"syscalls\": " << report.syscalls << ",\n";
+        ss << "  \"dma_starts\": " << report.dmaStarts << ",\n";
+        ss << "  \"gif_copies\": " << report.gifCopies << ",\n";
+        ss << "  \"gs_writes\": " << report.gsWrites << ",\n";
+        ss << "  \"vif_writes\": " << report.vifWrites << ",\n";
+        ss << "  \"peak_rss_bytes\": " << report.peakRssBytes << ",\n";
+        ss << "  \"guest_exited\": " << (report.guestExited ? "true" : "false");
+        if (!report.calls.empty())
+            ss << ",\n  \"calls\": " << ps2_callstats::json(report.calls);
+        ss << "\n";
+        ss << "}\n";
+        return ss.str();
+    }
+
+    bool writeReport(const Report &report, const std::string &path)
+    {
+        const std::string json = toJson(report);
+        if (path.empty())
+        {
+            std::cout << json << std::flush;
+            return true;
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cerr << "[benchmark] could not write report to " << path << std::endl;
+            return false;
+        }
+        file << json;
+        return static_cast<bool>(file);
+    }
+}
@@ -0,0 +1,363 @@
+#include "ps2_callstats.h"
+#include <ThreadNaming.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using namespace ps2_callstats;
+
+    constexpr uint32_t kSyscallCount = 0
+#define PS2_CALLSTATS_COUNT(name) +1
+        PS2_SYSCALL_LIST(PS2_CALLSTATS_COUNT);
+#undef PS2_CALLSTATS_COUNT
+    constexpr uint32_t kListedCount = static_cast<uint32_t>(Id::FirstNumericSyscall);
+
+    constexpr const char *kListedNames[] = {
+#define PS2_CALLSTATS_NAME(name) #name,
+        PS2_SYSCALL_LIST(PS2_CALLSTATS_NAME)
+        PS2_STUB_LIST(PS2_CALLSTATS_NAME)
+#undef PS2_CALLSTATS_NAME
+    };
+    static_assert(sizeof(kListedNames) / sizeof(kListedNames[0]) == kListedCount);
+
+    struct Counters
+    {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> totalNs{0};
+        std::atomic<uint64_t> maxNs{0};
+        std::array<std::atomic<uint64_t>, kLatencyBuckets> buckets{};
+    };
+
+    // Written only by its own thread, so plain load/store pairs are enough;
+    // the atomics only keep snapshot() from reading torn values. Blocks are
+    // never freed, so a thread that exits leaves its counts behind.
+    struct ThreadCounters
+    {
+        std::array<Counters, kIdCount> handlers;
+    };
+
+    std::mutex g_blocksMutex;
+    std::vector<std::unique_ptr<ThreadCounters>> g_blocks;
+    thread_local ThreadCounters *t_block = nullptr;
+
+    std::mutex g_controlMutex;
+    Options g_options;
+
+    ThreadCounters *threadBlock()
+    {
+        if (t_block)
+            return t_block;
+
+        auto block = std::make_unique<ThreadCounters>();
+        std::lock_guard<std::mutex> lock(g_blocksMutex);
+        t_block = block.get();
+        g_blocks.push_back(std::move(block));
+        return t_block;
+    }
+
+    void add(std::atomic<uint64_t> &counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    uint32_t bucketFor(uint64_t ns)
+    {
+        if (ns < 2)
+            return 0;
+        return std::min<uint32_t>(static_cast<uint32_t>(std::bit_width(ns)) - 1u, kLatencyBuckets - 1u);
+    }
+
+    const char *kindName(Kind kind)
+    {
+        switch (kind)
+        {
+        case Kind::Syscall:
+            return "syscall";
+        case Kind::Stub:
+            return "stub";
+        default:
+            return "numeric";
+        }
+    }
+
+    uint64_t meanNs(const HandlerStats &stats)
+    {
+        return stats.calls ? stats.totalNs / stats.calls : 0;
+    }
+
+#if !defined(_WIN32)
+    int g_signalPipe[2] = {-1, -1};
+
+    void onDumpSignal(int)
+    {
+        const int savedErrno = errno;
+        const char byte = 1;
+        [[maybe_unused]] const ssize_t written = ::write(g_signalPipe[1], &byte, 1);
+        errno = savedErrno;
+    }
+
+    void dumpLoop()
+    {
+        ThreadNaming::SetCurrentThreadName("CallStatsDump");
+        char byte = 0;
+        while (true)
+        {
+            const ssize_t got = ::read(g_signalPipe[0], &byte, 1);
+            if (got > 0)
+                dump();
+            else if (got < 0 && errno == EINTR)
+                continue;
+            else
+                break;
+        }
+    }
+#endif
+}
+
+namespace ps2_callstats
+{
+    Kind kind(Id id)
+    {
+        const uint32_t index = static_cast<uint32_t>(id);
+        if (index < kSyscallCount)
+            return Kind::Syscall;
+        if (index < kListedCount)
+            return Kind::Stub;
+        return Kind::NumericSyscall;
+    }
+
+    std::string name(Id id)
+    {
+        const uint32_t index = static_cast<uint32_t>(id);
+        if (index < kListedCount)
+            return kListedNames[index];
+
+        const uint32_t slot = index - kListedCount;
+        char text[32];
+        std::snprintf(text, sizeof(text), slot + 1u < kNumericSyscallSlots ? "syscall 0x%02X" : "syscall 0x%02X+", slot);
+        return text;
+    }
+
+    void record(Id id, uint64_t ns)
+    {
+        Counters &counters = threadBlock()->handlers[static_cast<uint32_t>(id)];
+        add(counters.calls, 1);
+        add(counters.totalNs, ns);
+        if (ns > counters.maxNs.load(std::memory_order_relaxed))
+            counters.maxNs.store(ns, std::memory_order_relaxed);
+        add(counters.buckets[bucketFor(ns)], 1);
+    }
+
+    uint64_t HandlerStats::percentileNs(double fraction) const
+    {
+        const double wanted = fraction * static_cast<double>(calls);
+        uint64_t seen = 0;
+        for (uint32_t b = 0; b < kLatencyBuckets; ++b)
+        {
+            seen += buckets[b];
+            if (seen > 0 && static_cast<double>(seen) >= wanted)
+                return b + 1u < kLatencyBuckets ? std::min(uint64_t{2} << b, maxNs) : maxNs;
+        }
+        return maxNs;
+    }
+
+    bool start(const Options &options)
+    {
+        std::lock_guard<std::mutex> lock(g_controlMutex);
+        if (g_enabled.load(std::memory_order_acquire))
+            return false;
+        g_options = options;
+        g_enabled.store(true, std::memory_order_release);
+        return true;
+    }
+
+    bool stop()
+    {
+        std::lock_guard<std::mutex> lock(g_controlMutex);
+        if (!g_enabled.exchange(false, std::memory_order_acq_rel))
+            return true;
+        if (g_options.outputPath.empty())
+            return true;
+        return write(g_options.outputPath);
+    }
+
+    bool running()
+    {
+        return enabled();
+    }
+
+    std::vector<HandlerStats> snapshot()
+    {
+        std::vector<HandlerStats> merged(kIdCount);
+        {
+            std::lock_guard<std::mutex> lock(g_blocksMutex);
+            for (const auto &block : g_blocks)
+            {
+                for (uint32_t i = 0; i < kIdCount; ++i)
+                {
+                    const Counters &counters = block->handlers[i];
+                    const uint64_t calls = counters.calls.load(std::memory_order_relaxed);
+                    if (calls == 0)
+                        continue;
+
+                    HandlerStats &stats = merged[i];
+                    stats.calls += calls;
+                    stats.totalNs += counters.totalNs.load(std::memory_order_relaxed);
+                    stats.maxNs = std::max(stats.maxNs, counters.maxNs.load(std::memory_order_relaxed));
+                    for (uint32_t b = 0; b < kLatencyBuckets; ++b)
+                        stats.buckets[b] += counters.buckets[b].load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::vector<HandlerStats> called;
+        for (uint32_t i = 0; i < kIdCount; ++i)
+        {
+            if (merged[i].calls == 0)
+                continue;
+            HandlerStats &stats = merged[i];
+            stats.id = static_cast<Id>(i);
+            stats.name = name(stats.id);
+            stats.kind = kind(stats.id);
+            called.push_back(std::move(stats));
+        }
+        std::stable_sort(called.begin(), called.end(), [](const HandlerStats &a, const HandlerStats &b)
+                         { return a.totalNs > b.totalNs; });
+        return called;
+    }
+
+    std::string json(const std::vector<HandlerStats> &stats)
+    {
+        std::string out = "[";
+        char number[96];
+        for (size_t i = 0; i < stats.size(); ++i)
+        {
+            const HandlerStats &entry = stats[i];
+            out += i == 0 ? "\n" : ",\n";
+            out += "  {\"name\": \"" + entry.name + "\", \"kind\": \"" + kindName(entry.kind) + "\"";
+            std::snprintf(number, sizeof(number), ", \"calls\": %llu, \"total_ns\": %llu, \"mean_ns\": %llu",
+                          static_cast<unsigned long long>(entry.calls),
+                          static_cast<unsigned long long>(entry.totalNs),
+                          static_cast<unsigned long long>(meanNs(entry)));
+            out += number;
+            std::snprintf(number, sizeof(number), ", \"p50_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu",
+                          static_cast<unsigned long long>(entry.percentileNs(0.5)),
+                          static_cast<unsigned long long>(entry.percentileNs(0.99)),
+                          static_cast<unsigned long long>(entry.maxNs));
+            out += number;
+
+            // log2 buckets up to the last one used; see kLatencyBuckets.
+            uint32_t used = kLatencyBuckets;
+            while (used > 0 && entry.buckets[used - 1] == 0)
+                --used;
+            out += ", \"histogram\": [";
+            for (uint32_t b = 0; b < used; ++b)
+            {
+                if (b != 0)
+                    out += ", ";
+                out += std::to_string(entry.buckets[b]);
+            }
+            out += "]}";
+        }
+        out += stats.empty() ? "]" : "\n]";
+        return out;
+    }
+
+    std::string text(const std::vector<HandlerStats> &stats)
+    {
+        std::string out;
+        char line[192];
+        std::snprintf(line, sizeof(line), "%-32s %-8s %12s %14s %10s %10s %12s\n", "handler", "kind", "calls",
+                      "total ms", "mean ns", "p99 ns", "max ns");
+        out += line;
+        for (const HandlerStats &entry : stats)
+        {
+            std::snprintf(line, sizeof(line), "%-32s %-8s %12llu %14.3f %10llu %10llu %12llu\n", entry.name.c_str(),
+                          kindName(entry.kind), static_cast<unsigned long long>(entry.calls),
+                          static_cast<double>(entry.totalNs) / 1e6, static_cast<unsigned long long>(meanNs(entry)),
+                          static_cast<unsigned long long>(entry.percentileNs(0.99)),
+                          static_cast<unsigned long long>(entry.maxNs));
+            out += line;
+        }
+        return out;
+    }
+
+    bool write(const std::filesystem::path &path)
+    {
+        const std::vector<HandlerStats> stats = snapshot();
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << json(stats) << '\n';
+        if (!out)
+        {
+            std::cerr << "[callstats] failed to write " << path.string() << std::endl;
+            return false;
+        }
+        std::cout << "[callstats] " << stats.size() << " handlers written to " << path.string() << std::endl;
+        return true;
+    }
+
+    bool dump()
+    {
+        std::filesystem::path path;
+        {
+            std::lock_guard<std::mutex> lock(g_controlMutex);
+            path = g_options.outputPath;
+        }
+        if (!path.empty())
+            return write(path);
+        std::cerr << text(snapshot()) << std::flush;
+        return true;
+    }
+
+    bool installDumpSignal()
+    {
+#if defined(_WIN32)
+        return false;
+#else
+        static std::once_flag once;
+        static bool installed = false;
+        std::call_once(once, []()
+                       {
+            if (::pipe(g_signalPipe) != 0)
+                return;
+            std::thread(dumpLoop).detach();
+
+            struct sigaction action{};
+            action.sa_handler = onDumpSignal;
+            action.sa_flags = SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            installed = ::sigaction(SIGUSR1, &action, nullptr) == 0; });
+        return installed;
+#endif
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(g_blocksMutex);
+        for (const auto &block : g_blocks)
+        {
+            for (Counters &counters : block->handlers)
+            {
+                counters.calls.store(0, std::memory_order_relaxed);
+                counters.totalNs.store(0, std::memory_order_relaxed);
+                counters.maxNs.store(0, std::memory_order_relaxed);
+                for (auto &bucket : counters.buckets)
+                    bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
@@ -0,0 +1,372 @@
+#include "ps2_memory.h"
+#include "ps2_log.h"
+#include "ps2_trace.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t kDmacChannelBases[10] = {
+        0x10008000u, 0x10009000u, 0x1000A000u, 0x1000B000u, 0x1000B400u,
+        0x1000C000u, 0x1000C400u, 0x1000C800u, 0x1000D000u, 0x1000D400u};
+    constexpr const char *kDmacChannelNames[10] = {
+        "DMA VIF0", "DMA VIF1", "DMA GIF", "DMA fromIPU", "DMA toIPU",
+        "DMA SIF0", "DMA SIF1", "DMA SIF2", "DMA fromSPR", "DMA toSPR"};
+
+    enum DmacChannel : uint32_t
+    {
+        kVif0 = 0,
+        kVif1 = 1,
+        kGif = 2,
+        kFromIpu = 3,
+        kToIpu = 4,
+        kSif0 = 5,
+        kSif1 = 6,
+        kSif2 = 7,
+        kFromSpr = 8,
+        kToSpr = 9,
+    };
+
+    constexpr uint32_t kChcr = 0x00;
+    constexpr uint32_t kMadr = 0x10;
+    constexpr uint32_t kQwc = 0x20;
+    constexpr uint32_t kTadr = 0x30;
+    constexpr uint32_t kAsr0 = 0x40;
+    constexpr uint32_t kAsr1 = 0x50;
+    constexpr uint32_t kSadr = 0x80;
+
+    constexpr uint32_t kDStat = 0x1000E010u;
+    constexpr uint32_t kDSqwc = 0x1000E030u;
+
+    constexpr uint32_t kChcrDir = 0x1;
+    constexpr uint32_t kChcrTte = 0x40;
+    constexpr uint32_t kChcrTie = 0x80;
+    constexpr uint32_t kChcrStr = 0x100;
+
+    constexpr uint32_t kModeChain = 1;
+    constexpr uint32_t kModeInterleave = 2;
+
+    // A runaway chain (a NEXT loop with no END) must not hang the guest thread.
+    constexpr uint32_t kMaxTagsPerRun = 1u << 16;
+
+    int dmacChannelIndex(uint32_t channelBase)
+    {
+        for (uint32_t i = 0; i < 10; ++i)
+        {
+            if (kDmacChannelBases[i] == channelBase)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Channels whose data leaves memory; the others are fed by a peripheral that
+    // is not modelled, so only fromSPR has a source to read from.
+    bool readsMemory(uint32_t channel, uint32_t chcr)
+    {
+        switch (channel)
+        {
+        case kVif1:
+            return (chcr & kChcrDir) != 0;
+        case kVif0:
+        case kGif:
+        case kToIpu:
+        case kSif1:
+        case kSif2:
+        case kToSpr:
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+void PS2Memory::setDmaSink(uint32_t channelBase, DmaSink sink)
+{
+    const int channel = dmacChannelIndex(channelBase);
+    if (channel < 0)
+        return;
+    std::lock_guard<std::mutex> lock(m_dmaMutex);
+    m_dmaSinks[channel] = std::move(sink);
+}
+
+void PS2Memory::setDmaCompletionHandler(DmaCompletionHandler handler)
+{
+    std::lock_guard<std::mutex> lock(m_dmaMutex);
+    m_dmaCompletion = std::move(handler);
+}
+
+void PS2Memory::setDmaBudget(uint32_t qwordsPerFrame)
+{
+    std::lock_guard<std::mutex> lock(m_dmaMutex);
+    m_dmaBudgetPerFrame = qwordsPerFrame;
+    m_dmaBudgetLeft = qwordsPerFrame;
+}
+
+void PS2Memory::advanceDma()
+{
+    std::vector<uint32_t> completed;
+    DmaCompletionHandler completion;
+    {
+        std::lock_guard<std::mutex> lock(m_dmaMutex);
+        m_dmaBudgetLeft = m_dmaBudgetPerFrame;
+        for (uint32_t channel = 0; channel < 10; ++channel)
+        {
+            if (m_dmaState[channel].active && runDma(channel))
+                finishDma(channel, completed);
+        }
+        completion = m_dmaCompletion;
+    }
+
+    // Handlers run guest interrupt code, which may start the next transfer.
+    if (completion)
+    {
+        for (uint32_t channelBase : completed)
+            completion(channelBase);
+    }
+}
+
+void PS2Memory::writeDmacRegister(uint32_t address, uint32_t value)
+{
+    std::vector<uint32_t> completed;
+    DmaCompletionHandler completion;
+    {
+        std::lock_guard<std::mutex> lock(m_dmaMutex);
+        if (address == kDStat)
+        {
+            // Writing 1 clears a CIS bit and toggles a CIM bit.
+            uint32_t &stat = m_ioRegisters[kDStat];
+            stat &= ~(value & 0x0000E3FFu);
+            stat ^= value & 0x63FF0000u;
+            return;
+        }
+
+        m_ioRegisters[address] = value;
+        const int channel = dmacChannelIndex(address & ~0xFFu);
+        if (channel < 0 || (address & 0xFFu) != kChcr || !(value & kChcrStr))
+            return;
+
+        m_dmaStartCount.fetch_add(1, std::memory_order_relaxed);
+        DmaChannelState &state = m_dmaState[channel];
+        state = DmaChannelState{};
+        state.active = true;
+        if (runDma(static_cast<uint32_t>(channel)))
+            finishDma(static_cast<uint32_t>(channel), completed);
+        completion = m_dmaCompletion;
+    }
+
+    if (completion)
+    {
+        for (uint32_t channelBase : completed)
+            completion(channelBase);
+    }
+}
+
+void PS2Memory::finishDma(uint32_t channel, std::vector<uint32_t> &completed)
+{
+    m_dmaState[channel].active = false;
+    m_ioRegisters[kDmacChannelBases[channel] + kChcr] &= ~kChcrStr;
+    m_ioRegisters[kDStat] |= 1u << channel;
+    completed.push_back(kDmacChannelBases[channel]);
+}
+
+// Moves data until the channel finishes (true) or the frame budget runs out
+// (false). All progress lives in the channel registers, as on the real DMAC, so
+// a deferred channel resumes exactly where it stopped.
+bool PS2Memory::runDma(uint32_t channel)
+{
+    const uint32_t base = kDmacChannelBases[channel];
+    uint32_t &chcr = m_ioRegisters[base + kChcr];
+    uint32_t &madr = m_ioRegisters[base + kMadr];
+    uint32_t &qwcReg = m_ioRegisters[base + kQwc];
+    uint32_t &tadr = m_ioRegisters[base + kTadr];
+    uint32_t &sadr = m_ioRegisters[base + kSadr];
+    DmaChannelState &state = m_dmaState[channel];
+    const uint32_t mode = (chcr >> 2) & 3u;
+    const bool limited = m_dmaBudgetPerFrame != 0;
+    PS2_TRACE_SCOPE_ARG("dma", kDmacChannelNames[channel], "madr", madr);
+
+    if (channel != kFromSpr && !readsMemory(channel, chcr))
+    {
+        // Nothing on the host side produces this data; finish straight away.
+        qwcReg = 0;
+        return true;
+    }
+
+    // RAM or scratchpad (bit 31) pointer for a DMA address, with the number of
+    // bytes readable before the region wraps.
+    auto resolve = [&](uint32_t addr, uint32_t &span) -> uint8_t *
+    {
+        if (addr & 0x80000000u)
+        {
+            const uint32_t offset = addr & (PS2_SCRATCHPAD_SIZE - 16u);
+            span = PS2_SCRATCHPAD_SIZE - offset;
+            return m_scratchpad + offset;
+        }
+        const uint32_t offset = addr & (PS2_RAM_MASK & ~15u);
+        span = PS2_RAM_SIZE - offset;
+        return m_rdram + offset;
+    };
+
+    // One contiguous run of qwords, split only where a region wraps.
+    auto moveRun = [&](uint32_t count)
+    {
+        uint32_t bytes = count * 16u;
+        while (bytes > 0)
+        {
+            uint32_t memSpan = 0;
+            uint8_t *mem = resolve(madr, memSpan);
+            uint32_t chunk = std::min(bytes, memSpan);
+            if (channel == kFromSpr || channel == kToSpr)
+            {
+                const uint32_t sprOffset = sadr & (PS2_SCRATCHPAD_SIZE - 16u);
+                chunk = std::min(chunk, PS2_SCRATCHPAD_SIZE - sprOffset);
+                if (channel == kToSpr)
+                    std::memcpy(m_scratchpad + sprOffset, mem, chunk);
+                else
+                    std::memcpy(mem, m_scratchpad + sprOffset, chunk);
+                sadr = (sadr + chunk) & (PS2_SCRATCHPAD_SIZE - 1u);
+            }
+            else if (m_dmaSinks[channel])
+            {
+                m_dmaSinks[channel](mem, chunk);
+            }
+            madr += chunk;
+            bytes -= chunk;
+        }
+    };
+
+    auto readTag = [&](uint32_t addr) -> uint64_t
+    {
+        uint32_t span = 0;
+        const uint8_t *p = resolve(addr, span);
+        uint64_t tag = 0;
+        std::memcpy(&tag, p, sizeof(tag));
+        return tag;
+    };
+
+    const uint32_t sqwc = m_ioRegisters[kDSqwc];
+    const uint32_t skipQwc = sqwc & 0xFFu;
+    const uint32_t sliceQwc = (sqwc >> 16) & 0xFFu;
+
+    for (uint32_t tags = 0; tags < kMaxTagsPerRun; ++tags)
+    {
+        uint32_t qwc = qwcReg & 0xFFFFu;
+        while (qwc > 0)
+        {
+            uint32_t count = qwc;
+            if (mode == kModeInterleave && sliceQwc != 0)
+                count = std::min(count, sliceQwc - state.interleaveCount);
+            if (limited)
+            {
+                count = std::min(count, m_dmaBudgetLeft);
+                if (count == 0)
+                    return false;
+                m_dmaBudgetLeft -= count;
+            }
+
+            moveRun(count);
+            qwc -= count;
+            qwcReg = qwc;
+
+            if (mode == kModeInterleave && sliceQwc != 0)
+            {
+                state.interleaveCount += count;
+                if (state.interleaveCount == sliceQwc)
+                {
+                    state.interleaveCount = 0;
+                    madr += skipQwc * 16u;
+                }
+            }
+        }
+
+        if (mode != kModeChain || state.endAfterPacket)
+            return true;
+
+        if (channel == kFromSpr)
+        {
+            // Destination chain: tags arrive in the scratchpad data stream.
+            const uint64_t tag = readTag(0x80000000u | sadr);
+            sadr = (sadr + 16u) & (PS2_SCRATCHPAD_SIZE - 1u);
+            const uint32_t id = static_cast<uint32_t>((tag >> 28) & 7u);
+            chcr = (chcr & 0xFFFFu) | (static_cast<uint32_t>(tag) & 0xFFFF0000u);
+            madr = static_cast<uint32_t>(tag >> 32) & ~15u;
+            qwcReg = static_cast<uint32_t>(tag & 0xFFFFu);
+            if (id == 7 || ((tag & 0x80000000ull) && (chcr & kChcrTie)))
+                state.endAfterPacket = true;
+            continue;
+        }
+
+        // Source chain.
+        const uint64_t tag = readTag(tadr);
+        const uint32_t id = static_cast<uint32_t>((tag >> 28) & 7u);
+        const uint32_t tagQwc = static_cast<uint32_t>(tag & 0xFFFFu);
+        const uint32_t addr = static_cast<uint32_t>(tag >> 32) & ~15u;
+        chcr = (chcr & 0xFFFFu) | (static_cast<uint32_t>(tag) & 0xFFFF0000u);
+
+        if ((chcr & kChcrTte) && (channel == kVif0 || channel == kVif1) && m_dmaSinks[channel])
+        {
+            // VIF channels receive the upper half of the tag (two VIFcodes).
+            uint32_t span = 0;
+            m_dmaSinks[channel](resolve(tadr, span) + 8, 8);
+        }
+
+        const uint32_t asp = (chcr >> 4) & 3u;
+        switch (id)
+        {
+        case 0: // refe
+            madr = addr;
+            tadr += 16u;
+            state.endAfterPacket = true;
+            break;
+        case 1: // cnt
+            madr = tadr + 16u;
+            tadr = madr + tagQwc * 16u;
+            break;
+        case 2: // next
+            madr = tadr + 16u;
+            tadr = addr;
+            break;
+        case 3: // ref
+        case 4: // refs
+            madr = addr;
+            tadr += 16u;
+            break;
+        case 5: // call
+            madr = tadr + 16u;
+            if (asp >= 2)
+            {
+                PS2_LOG_WARN(Dma, "[DMAC] call stack overflow on channel " << channel);
+                state.endAfterPacket = true;
+                break;
+            }
+            m_ioRegisters[base + (asp == 0 ? kAsr0 : kAsr1)] = madr + tagQwc * 16u;
+            chcr = (chcr & ~0x30u) | ((asp + 1u) << 4);
+            tadr = addr;
+            break;
+        case 6: // ret
+            madr = tadr + 16u;
+            if (asp > 0)
+            {
+                tadr = m_ioRegisters[base + (asp == 2 ? kAsr1 : kAsr0)];
+                chcr = (chcr & ~0x30u) | ((asp - 1u) << 4);
+            }
+            else
+            {
+                state.endAfterPacket = true;
+            }
+            break;
+        default: // end
+            madr = tadr + 16u;
+            state.endAfterPacket = true;
+            break;
+        }
+
+        if ((tag & 0x80000000ull) && (chcr & kChcrTie))
+            state.endAfterPacket = true;
+        qwcReg = tagQwc;
+    }
+
+    PS2_LOG_WARN(Dma, "[DMAC] channel " << channel << " chain did not end after "
+                                        << kMaxTagsPerRun << " tags; stopping it");
+    return true;
+}
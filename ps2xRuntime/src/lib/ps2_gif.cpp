@@ -0,0 +1,167 @@
+#include "ps2_gif.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    inline uint64_t loadU64(const uint8_t *p)
+    {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t loadU32(const uint8_t *p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+}
+
+namespace ps2_gif
+{
+    void Parser::reset()
+    {
+        *this = Parser{};
+    }
+
+    void Parser::feed(const uint8_t *data, size_t bytes, CommandStream &out)
+    {
+        const uint8_t *end = data + (bytes & ~static_cast<size_t>(15));
+        while (data < end)
+        {
+            if (m_loops == 0)
+            {
+                readTag(data, out);
+                data += 16;
+                continue;
+            }
+
+            switch (m_mode)
+            {
+            case Mode::Packed:
+                packed(data, out);
+                data += 16;
+                break;
+
+            case Mode::Reglist:
+                // Two 64-bit register values per qword; a lone last value is
+                // followed by padding.
+                for (int half = 0; half < 2 && m_loops != 0; ++half)
+                {
+                    const uint32_t desc = static_cast<uint32_t>(m_regs >> (m_regIndex * 4u)) & 0xFu;
+                    if (desc < 0xE)
+                        out.push(static_cast<uint8_t>(desc), loadU64(data + half * 8));
+                    nextRegister();
+                }
+                data += 16;
+                break;
+
+            case Mode::Image:
+            {
+                // Copy every image qword available in this run at once.
+                const size_t qwords = std::min<size_t>(m_loops, static_cast<size_t>(end - data) / 16u);
+                const size_t run = qwords * 16u;
+                const size_t offset = out.image.size();
+                out.image.insert(out.image.end(), data, data + run);
+                if (!out.empty() && out.reg.back() == HWREG &&
+                    (out.value.back() & 0xFFFFFFFFu) + (out.value.back() >> 32) == offset)
+                {
+                    out.value.back() += static_cast<uint64_t>(run) << 32;
+                }
+                else
+                {
+                    out.push(HWREG, (static_cast<uint64_t>(run) << 32) | offset);
+                }
+                m_loops -= static_cast<uint32_t>(qwords);
+                data += run;
+                break;
+            }
+            }
+        }
+    }
+
+    // GIFtag: NLOOP bits 0-14, EOP 15, PRE 46, PRIM 47-57, FLG 58-59, NREG 60-63,
+    // REGS 64-127.
+    void Parser::readTag(const uint8_t *qword, CommandStream &out)
+    {
+        const uint64_t lo = loadU64(qword);
+        m_regs = loadU64(qword + 8);
+        m_loops = static_cast<uint32_t>(lo & 0x7FFFu);
+        m_eop = (lo & 0x8000u) != 0;
+        const uint32_t flg = static_cast<uint32_t>(lo >> 58) & 3u;
+        m_mode = flg == 0 ? Mode::Packed : (flg == 1 ? Mode::Reglist : Mode::Image); // 3 behaves as IMAGE
+        const uint32_t nreg = static_cast<uint32_t>(lo >> 60);
+        m_nreg = nreg ? nreg : 16u;
+        m_regIndex = 0;
+
+        if (m_mode == Mode::Packed && (lo & (1ull << 46)))
+            out.push(PRIM, (lo >> 47) & 0x7FFu);
+    }
+
+    void Parser::nextRegister()
+    {
+        if (++m_regIndex == m_nreg)
+        {
+            m_regIndex = 0;
+            --m_loops;
+        }
+    }
+
+    void Parser::packed(const uint8_t *qword, CommandStream &out)
+    {
+        const uint32_t desc = static_cast<uint32_t>(m_regs >> (m_regIndex * 4u)) & 0xFu;
+        const uint64_t lo = loadU64(qword);
+        const uint64_t hi = loadU64(qword + 8);
+
+        switch (desc)
+        {
+        case 0x0: // PRIM
+            out.push(PRIM, lo & 0x7FFu);
+            break;
+        case 0x1: // RGBAQ: one channel per word, Q from the last ST
+            out.push(RGBAQ, (lo & 0xFFu) | ((lo >> 24) & 0xFF00u) | ((hi & 0xFFu) << 16) |
+                                ((hi >> 8) & 0xFF000000u) | (static_cast<uint64_t>(m_q) << 32));
+            break;
+        case 0x2: // ST, Q kept for the next RGBAQ
+            m_q = loadU32(qword + 8);
+            out.push(ST, lo);
+            break;
+        case 0x3: // UV
+            out.push(UV, (lo & 0x3FFFu) | ((lo >> 16) & 0x3FFF0000u));
+            break;
+        case 0x4: // XYZF2, ADC selects the no-kick XYZF3
+        {
+            const uint64_t value = (lo & 0xFFFFu) | ((lo >> 16) & 0xFFFF0000u) |
+                                   (((hi >> 4) & 0xFFFFFFu) << 32) | (((hi >> 36) & 0xFFu) << 56);
+            out.push((hi & (1ull << 47)) ? XYZF3 : XYZF2, value);
+            break;
+        }
+        case 0x5: // XYZ2, ADC selects XYZ3
+        {
+            const uint64_t value = (lo & 0xFFFFu) | ((lo >> 16) & 0xFFFF0000u) | ((hi & 0xFFFFFFFFu) << 32);
+            out.push((hi & (1ull << 47)) ? XYZ3 : XYZ2, value);
+            break;
+        }
+        case 0xA: // FOG
+            out.push(FOG, ((hi >> 36) & 0xFFu) << 56);
+            break;
+        case 0xB: // reserved
+            break;
+        case 0xE: // A+D
+        {
+            const uint8_t reg = static_cast<uint8_t>(hi & 0xFFu);
+            if (reg < REG_COUNT)
+                out.push(reg, lo);
+            break;
+        }
+        case 0xF: // NOP
+            break;
+        default: // TEX0_x, CLAMP_x, XYZF3, XYZ3 take the low 64 bits unchanged
+            out.push(static_cast<uint8_t>(desc), lo);
+            break;
+        }
+        nextRegister();
+    }
+}
@@ -0,0 +1,274 @@
+#include "ps2_gs_display.h"
+#include "ps2_gs_swizzle.h"
+#include "ps2_memory.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    using namespace ps2_gs_swizzle;
+
+    struct Circuit
+    {
+        uint32_t bp = 0;
+        uint32_t bw = 0;
+        uint32_t psm = 0;
+        uint32_t dbx = 0;
+        uint32_t dby = 0;
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    // DISPFB: FBP bits 0-8, FBW 9-14, PSM 15-19, DBX 32-42, DBY 43-53.
+    // DISPLAY: DX bits 0-11, DY 12-22, MAGH 23-26, MAGV 27-28, DW 32-43, DH 44-54.
+    Circuit decodeCircuit(uint64_t dispfb, uint64_t display, uint32_t maxWidth, uint32_t maxHeight)
+    {
+        Circuit c;
+        const uint32_t fbw = static_cast<uint32_t>((dispfb >> 9) & 0x3F);
+        c.bp = static_cast<uint32_t>(dispfb & 0x1FF) * 32u;
+        c.bw = fbw ? fbw : (maxWidth + 63u) / 64u;
+        c.psm = static_cast<uint32_t>((dispfb >> 15) & 0x1F);
+        c.dbx = static_cast<uint32_t>((dispfb >> 32) & 0x7FF);
+        c.dby = static_cast<uint32_t>((dispfb >> 43) & 0x7FF);
+
+        const uint32_t magh = static_cast<uint32_t>((display >> 23) & 0xF) + 1u;
+        const uint32_t magv = static_cast<uint32_t>((display >> 27) & 0x3) + 1u;
+        const uint32_t dw = static_cast<uint32_t>((display >> 32) & 0xFFF);
+        const uint32_t dh = static_cast<uint32_t>((display >> 44) & 0x7FF);
+        c.x = static_cast<uint32_t>(display & 0xFFF) / magh;
+        c.y = static_cast<uint32_t>((display >> 12) & 0x7FF) / magv;
+        // Zero-sized areas come from registers nobody set up; show the whole window.
+        c.width = dw ? (dw + 1u) / magh : maxWidth;
+        c.height = dh ? (dh + 1u) / magv : maxHeight;
+        return c;
+    }
+
+    bool readableFormat(uint32_t psm)
+    {
+        return psm == PSMCT32 || psm == PSMCT24 || psm == PSMCT16 || psm == PSMCT16S;
+    }
+
+    // Reads w x h pixels of a circuit as RGBA8 into out (pitch in pixels).
+    void readCircuit(const uint8_t *vram, const Circuit &c, uint32_t w, uint32_t h,
+                     uint32_t *out, uint32_t pitch, std::vector<uint16_t> &raw)
+    {
+        if (c.psm == PSMCT16 || c.psm == PSMCT16S)
+        {
+            raw.resize(static_cast<size_t>(w) * h);
+            readImage(vram, c.psm, c.bp, c.bw, c.dbx, c.dby, w, h,
+                      reinterpret_cast<uint8_t *>(raw.data()), static_cast<size_t>(w) * 2u);
+            for (uint32_t y = 0; y < h; ++y)
+                ps2_gs_display::convertCT16(raw.data() + static_cast<size_t>(y) * w, out + static_cast<size_t>(y) * pitch, w);
+            return;
+        }
+
+        // PSMCT24 shares the PSMCT32 layout; the upper byte is not part of the pixel.
+        readImage(vram, PSMCT32, c.bp, c.bw, c.dbx, c.dby, w, h,
+                  reinterpret_cast<uint8_t *>(out), static_cast<size_t>(pitch) * 4u);
+        if (c.psm == PSMCT24)
+        {
+            for (uint32_t y = 0; y < h; ++y)
+                ps2_gs_display::convertCT24(out + static_cast<size_t>(y) * pitch, out + static_cast<size_t>(y) * pitch, w);
+        }
+    }
+
+    void forceOpaque(uint32_t *pixels, size_t count)
+    {
+        const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i *p = reinterpret_cast<__m128i *>(pixels + i);
+            _mm_storeu_si128(p, _mm_or_si128(_mm_loadu_si128(p), opaque));
+        }
+        for (; i < count; ++i)
+            pixels[i] |= 0xFF000000u;
+    }
+}
+
+namespace ps2_gs_display
+{
+    void convertCT16(const uint16_t *src, uint32_t *dst, size_t count)
+    {
+        const __m128i maskR = _mm_set1_epi32(0x001F);
+        const __m128i maskG = _mm_set1_epi32(0x03E0);
+        const __m128i maskB = _mm_set1_epi32(0x7C00);
+        const __m128i maskA = _mm_set1_epi32(0x8000);
+        auto expand = [&](__m128i p)
+        {
+            const __m128i r = _mm_slli_epi32(_mm_and_si128(p, maskR), 3);
+            const __m128i g = _mm_slli_epi32(_mm_and_si128(p, maskG), 6);
+            const __m128i b = _mm_slli_epi32(_mm_and_si128(p, maskB), 9);
+            const __m128i a = _mm_slli_epi32(_mm_and_si128(p, maskA), 16);
+            return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+        };
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), expand(_mm_cvtepu16_epi32(v)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4), expand(_mm_cvtepu16_epi32(_mm_srli_si128(v, 8))));
+        }
+        for (; i < count; ++i)
+        {
+            const uint32_t p = src[i];
+            dst[i] = ((p & 0x001Fu) << 3) | ((p & 0x03E0u) << 6) | ((p & 0x7C00u) << 9) | ((p & 0x8000u) << 16);
+        }
+    }
+
+    void convertCT24(const uint32_t *src, uint32_t *dst, size_t count)
+    {
+        const __m128i rgb = _mm_set1_epi32(0x00FFFFFF);
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0x80000000u));
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_or_si128(_mm_and_si128(v, rgb), alpha));
+        }
+        for (; i < count; ++i)
+            dst[i] = (src[i] & 0x00FFFFFFu) | 0x80000000u;
+    }
+
+    void blendRow(const uint32_t *rc1, const uint32_t *rc2, uint32_t *dst, size_t count, bool useAlp, uint8_t alp)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i full = _mm_set1_epi16(255);
+        const __m128i round = _mm_set1_epi16(128);
+        const __m128i fixedAlpha = _mm_set1_epi32(alp);
+        const __m128i maxAlpha = _mm_set1_epi32(255);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rc1 + i));
+            const __m128i c2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rc2 + i));
+            const __m128i a32 = useAlp ? fixedAlpha
+                                       : _mm_min_epi32(_mm_slli_epi32(_mm_srli_epi32(c1, 24), 1), maxAlpha);
+            const __m128i a16 = _mm_or_si128(a32, _mm_slli_epi32(a32, 16));
+            const __m128i aLo = _mm_unpacklo_epi32(a16, a16);
+            const __m128i aHi = _mm_unpackhi_epi32(a16, a16);
+
+            auto mix = [&](__m128i p1, __m128i p2, __m128i a)
+            {
+                __m128i x = _mm_add_epi16(_mm_mullo_epi16(p1, a), _mm_mullo_epi16(p2, _mm_sub_epi16(full, a)));
+                x = _mm_add_epi16(x, round);
+                return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+            };
+            const __m128i lo = mix(_mm_unpacklo_epi8(c1, zero), _mm_unpacklo_epi8(c2, zero), aLo);
+            const __m128i hi = mix(_mm_unpackhi_epi8(c1, zero), _mm_unpackhi_epi8(c2, zero), aHi);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+        }
+        for (; i < count; ++i)
+        {
+            const uint32_t a = useAlp ? alp : std::min<uint32_t>((rc1[i] >> 24) * 2u, 255u);
+            uint32_t out = 0;
+            for (uint32_t shift = 0; shift < 32; shift += 8)
+            {
+                uint32_t x = ((rc1[i] >> shift) & 0xFFu) * a + ((rc2[i] >> shift) & 0xFFu) * (255u - a) + 128u;
+                out |= (((x + (x >> 8)) >> 8) & 0xFFu) << shift;
+            }
+            dst[i] = out;
+        }
+    }
+
+    bool compose(const uint8_t *vram, const GSRegisters &gs, uint32_t *dst, uint32_t width, uint32_t height, Scratch &scratch)
+    {
+        if (!vram)
+        {
+            std::memset(dst, 0, static_cast<size_t>(width) * height * 4u);
+            return true;
+        }
+
+        // PMODE: EN1 bit 0, EN2 bit 1, MMOD bit 5, SLBG bit 7, ALP bits 8-15.
+        bool enabled[2] = {(gs.pmode & 1u) != 0, (gs.pmode & 2u) != 0};
+        // Titles that only point DISPFB1 at a buffer never touch PMODE; show circuit 1.
+        if (!enabled[0] && !enabled[1])
+            enabled[0] = true;
+
+        const Circuit circuits[2] = {
+            decodeCircuit(gs.dispfb1, gs.display1, width, height),
+            decodeCircuit(gs.dispfb2, gs.display2, width, height),
+        };
+
+        uint32_t originX = UINT32_MAX;
+        uint32_t originY = UINT32_MAX;
+        for (int i = 0; i < 2; ++i)
+        {
+            if (!enabled[i])
+                continue;
+            if (!readableFormat(circuits[i].psm))
+                return false;
+            originX = std::min(originX, circuits[i].x);
+            originY = std::min(originY, circuits[i].y);
+        }
+
+        const size_t pixels = static_cast<size_t>(width) * height;
+        for (int i = 0; i < 2; ++i)
+        {
+            if (!enabled[i])
+                continue;
+            const Circuit &c = circuits[i];
+            std::vector<uint32_t> &target = scratch.circuit[i];
+            target.assign(pixels, 0);
+            const uint32_t offX = c.x - originX;
+            const uint32_t offY = c.y - originY;
+            if (offX >= width || offY >= height)
+                continue;
+            const uint32_t w = std::min(c.width, width - offX);
+            const uint32_t h = std::min(c.height, height - offY);
+            readCircuit(vram, c, w, h, target.data() + static_cast<size_t>(offY) * width + offX, width, scratch.raw);
+        }
+
+        if (enabled[0] && enabled[1])
+        {
+            const bool useAlp = (gs.pmode & 0x20u) != 0;
+            const uint8_t alp = static_cast<uint8_t>((gs.pmode >> 8) & 0xFF);
+            const uint32_t *rc2 = scratch.circuit[1].data();
+            if (gs.pmode & 0x80u)
+            {
+                // SLBG: blend against BGCOLOR instead of circuit 2.
+                const uint32_t bg = static_cast<uint32_t>(gs.bgcolor & 0xFFFFFFu);
+                std::fill(scratch.circuit[1].begin(), scratch.circuit[1].end(), bg);
+            }
+            blendRow(scratch.circuit[0].data(), rc2, dst, pixels, useAlp, alp);
+        }
+        else
+        {
+            const std::vector<uint32_t> &only = enabled[0] ? scratch.circuit[0] : scratch.circuit[1];
+            std::memcpy(dst, only.data(), pixels * 4u);
+        }
+
+        forceOpaque(dst, pixels);
+        return true;
+    }
+
+    void TripleBuffer::resize(uint32_t width, uint32_t height)
+    {
+        m_width = width;
+        m_height = height;
+        for (auto &slot : m_slots)
+            slot.assign(static_cast<size_t>(width) * height, 0xFF000000u);
+        m_back = 0;
+        m_front = 1;
+        m_middle.store(2u, std::memory_order_relaxed);
+        m_published.store(0, std::memory_order_relaxed);
+    }
+
+    void TripleBuffer::publish()
+    {
+        m_back = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel) & kIndexMask;
+        m_published.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool TripleBuffer::acquire()
+    {
+        if ((m_middle.load(std::memory_order_acquire) & kFresh) == 0)
+            return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+}
@@ -0,0 +1,500 @@
+#include "ps2_gs_pipeline.h"
+#include "ps2_gs_swizzle.h"
+#include "ps2_memory.h"
+#include <ThreadNaming.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    using namespace ps2_gif;
+
+    // Batches queued ahead of the consumer before the producer waits.
+    constexpr size_t kMaxQueuedBatches = 8;
+    constexpr size_t kMaxFreeBatches = 4;
+
+    uint32_t bitsPerPixel(uint32_t psm)
+    {
+        switch (psm)
+        {
+        case ps2_gs_swizzle::PSMCT32: return 32;
+        case ps2_gs_swizzle::PSMCT24: return 24;
+        case ps2_gs_swizzle::PSMCT16:
+        case ps2_gs_swizzle::PSMCT16S: return 16;
+        case ps2_gs_swizzle::PSMT8: return 8;
+        case ps2_gs_swizzle::PSMT4: return 4;
+        default: return 0;
+        }
+    }
+
+    inline uint32_t field(uint64_t value, uint32_t shift, uint32_t bits)
+    {
+        return static_cast<uint32_t>(value >> shift) & ((1u << bits) - 1u);
+    }
+
+    // Vertices per primitive for PRIM types 0-6 (point, line, line strip,
+    // triangle, triangle strip, fan, sprite); type 7 is reserved.
+    constexpr uint32_t kVerticesPerPrim[8] = {1, 2, 2, 3, 3, 3, 2, 0};
+
+    inline float asFloat(uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+namespace ps2_gs_pipeline
+{
+    void Context::attach(uint8_t *vram, GSRegisters *privileged)
+    {
+        m_vram = vram;
+        m_privileged = privileged;
+        std::fill(std::begin(m_regs), std::end(m_regs), 0);
+        m_vertexKicks = 0;
+        m_transfer = Transfer{};
+        m_carry.clear();
+        m_raster.setVram(vram);
+        m_queued = 0;
+    }
+
+    void Context::execute(const CommandStream &stream)
+    {
+        const size_t count = stream.size();
+        const uint8_t *regs = stream.reg.data();
+        const uint64_t *values = stream.value.data();
+        for (size_t i = 0; i < count; ++i)
+            write(regs[i], values[i], stream);
+        m_raster.flush();
+    }
+
+    void Context::write(uint8_t reg, uint64_t value, const CommandStream &stream)
+    {
+        switch (reg)
+        {
+        case PRIM:
+            m_queued = 0;
+            break;
+        case XYZ2:
+        case XYZF2:
+            ++m_vertexKicks;
+            m_regs[reg] = value;
+            kick(value, reg == XYZF2, true);
+            return;
+        case XYZ3:
+        case XYZF3:
+            m_regs[reg] = value;
+            kick(value, reg == XYZF3, false);
+            return;
+        case TEX0_1:
+        case TEX0_2:
+        case TEXFLUSH:
+            // The next texture may be something drawn by primitives still binned.
+            m_raster.flush();
+            break;
+        case TRXDIR:
+            m_raster.flush();
+            startTransfer(static_cast<uint32_t>(value & 3u));
+            break;
+        case HWREG:
+            transferData(stream.image.data() + (value & 0xFFFFFFFFu), static_cast<size_t>(value >> 32));
+            return;
+        case SIGNAL:
+            m_raster.flush();
+            // ID bits 0-31 under the IDMSK mask in bits 32-63.
+            if (m_privileged)
+            {
+                const uint64_t mask = value >> 32;
+                updateGsRegister(m_privileged->siglblid, [&](uint64_t id)
+                                 { return (id & ~mask) | (value & mask); });
+                std::atomic_ref<uint64_t>(m_privileged->csr).fetch_or(0x1u, std::memory_order_acq_rel);
+            }
+            break;
+        case FINISH:
+            m_raster.flush();
+            if (m_privileged)
+                std::atomic_ref<uint64_t>(m_privileged->csr).fetch_or(0x2u, std::memory_order_acq_rel);
+            break;
+        case LABEL:
+            if (m_privileged)
+            {
+                const uint64_t mask = (value >> 32) << 32;
+                updateGsRegister(m_privileged->siglblid, [&](uint64_t id)
+                                 { return (id & ~mask) | ((value << 32) & mask); });
+            }
+            break;
+        default:
+            break;
+        }
+        m_regs[reg] = value;
+    }
+
+    // Appends a vertex to the queue and draws once the primitive is complete.
+    // XYZ2: X 0-15, Y 16-31, Z 32-63. XYZF2: Z 32-55, F 56-63.
+    void Context::kick(uint64_t xyz, bool withFog, bool draw)
+    {
+        const uint64_t prim = m_regs[PRIM];
+        const uint32_t type = field(prim, 0, 3);
+        const uint32_t needed = kVerticesPerPrim[type];
+        if (needed == 0)
+            return;
+
+        const uint64_t attrs = (m_regs[PRMODECONT] & 1u) ? prim : m_regs[PRMODE];
+        const uint32_t ctxt = field(attrs, 9, 1);
+        const uint64_t offset = m_regs[XYOFFSET_1 + ctxt];
+        const uint64_t rgbaq = m_regs[RGBAQ];
+        const uint64_t st = m_regs[ST];
+        const uint64_t uv = m_regs[UV];
+
+        ps2_gs_raster::Vertex &v = m_queue[m_queued++];
+        v.x = static_cast<int32_t>(field(xyz, 0, 16)) - static_cast<int32_t>(field(offset, 0, 16));
+        v.y = static_cast<int32_t>(field(xyz, 16, 16)) - static_cast<int32_t>(field(offset, 32, 16));
+        v.z = withFog ? field(xyz, 32, 24) : static_cast<uint32_t>(xyz >> 32);
+        v.fog = static_cast<uint8_t>(withFog ? (xyz >> 56) : (m_regs[FOG] >> 56));
+        v.r = static_cast<uint8_t>(rgbaq);
+        v.g = static_cast<uint8_t>(rgbaq >> 8);
+        v.b = static_cast<uint8_t>(rgbaq >> 16);
+        v.a = static_cast<uint8_t>(rgbaq >> 24);
+        v.q = asFloat(static_cast<uint32_t>(rgbaq >> 32));
+        v.s = asFloat(static_cast<uint32_t>(st));
+        v.t = asFloat(static_cast<uint32_t>(st >> 32));
+        v.u = field(uv, 0, 14) / 16.0f;
+        v.v = field(uv, 16, 14) / 16.0f;
+
+        if (m_queued < needed)
+            return;
+
+        if (draw && m_vram)
+        {
+            static constexpr ps2_gs_raster::PrimKind kinds[7] = {
+                ps2_gs_raster::PrimKind::Point, ps2_gs_raster::PrimKind::Line, ps2_gs_raster::PrimKind::Line,
+                ps2_gs_raster::PrimKind::Triangle, ps2_gs_raster::PrimKind::Triangle,
+                ps2_gs_raster::PrimKind::Triangle, ps2_gs_raster::PrimKind::Sprite};
+            m_raster.draw(kinds[type], m_queue, drawState(attrs));
+        }
+
+        switch (type)
+        {
+        case 2: // line strip continues from the last vertex
+            m_queue[0] = m_queue[1];
+            m_queued = 1;
+            break;
+        case 4: // triangle strip drops the oldest vertex
+            m_queue[0] = m_queue[1];
+            m_queue[1] = m_queue[2];
+            m_queued = 2;
+            break;
+        case 5: // fan keeps its first vertex
+            m_queue[1] = m_queue[2];
+            m_queued = 2;
+            break;
+        default:
+            m_queued = 0;
+            break;
+        }
+    }
+
+    // FRAME: FBP 0-8, FBW 16-21, PSM 24-29, FBMSK 32-63. ZBUF: ZBP 0-8, PSM 24-27, ZMSK 32.
+    // TEST: ATE 0, ATST 1-3, AREF 4-11, AFAIL 12-13, DATE 14, DATM 15, ZTE 16, ZTST 17-18.
+    // ALPHA: A 0-1, B 2-3, C 4-5, D 6-7, FIX 32-39. TEX0: TBP0 0-13, TBW 14-19,
+    // PSM 20-25, TW 26-29, TH 30-33, TCC 34, TFX 35-36, CBP 37-50, CPSM 51-54.
+    // CLAMP: WMS 0-1, WMT 2-3, MINU 4-13, MAXU 14-23, MINV 24-33, MAXV 34-43.
+    ps2_gs_raster::DrawState Context::drawState(uint64_t attrs) const
+    {
+        const uint32_t ctxt = field(attrs, 9, 1);
+        const uint64_t frame = m_regs[FRAME_1 + ctxt];
+        const uint64_t zbuf = m_regs[ZBUF_1 + ctxt];
+        const uint64_t test = m_regs[TEST_1 + ctxt];
+        const uint64_t alpha = m_regs[ALPHA_1 + ctxt];
+        const uint64_t tex0 = m_regs[TEX0_1 + ctxt];
+        const uint64_t clamp = m_regs[CLAMP_1 + ctxt];
+        const uint64_t texa = m_regs[TEXA];
+        const uint64_t scissor = m_regs[SCISSOR_1 + ctxt];
+
+        ps2_gs_raster::DrawState s{};
+        s.fbp = field(frame, 0, 9) * 32u;
+        s.fbw = std::max(field(frame, 16, 6), 1u);
+        s.fpsm = field(frame, 24, 6);
+        s.fbmsk = static_cast<uint32_t>(frame >> 32);
+        s.zbp = field(zbuf, 0, 9) * 32u;
+        s.zpsm = field(zbuf, 24, 4) | 0x30u;
+        s.zmsk = field(zbuf, 32, 1);
+
+        s.ate = field(test, 0, 1);
+        s.atst = field(test, 1, 3);
+        s.aref = field(test, 4, 8);
+        s.afail = field(test, 12, 2);
+        s.date = field(test, 14, 1);
+        s.datm = field(test, 15, 1);
+        s.zte = field(test, 16, 1);
+        s.ztst = field(test, 17, 2);
+
+        s.abe = field(attrs, 6, 1);
+        s.blendA = field(alpha, 0, 2);
+        s.blendB = field(alpha, 2, 2);
+        s.blendC = field(alpha, 4, 2);
+        s.blendD = field(alpha, 6, 2);
+        s.fix = field(alpha, 32, 8);
+        s.pabe = field(m_regs[PABE], 0, 1);
+        s.fba = field(m_regs[FBA_1 + ctxt], 0, 1);
+        s.colclamp = field(m_regs[COLCLAMP], 0, 1);
+
+        s.tme = field(attrs, 4, 1);
+        s.fst = field(attrs, 8, 1);
+        if (s.tme)
+        {
+            s.tbp = field(tex0, 0, 14);
+            s.tbw = std::max(field(tex0, 14, 6), 1u);
+            s.tpsm = field(tex0, 20, 6);
+            s.tw = std::min(field(tex0, 26, 4), 10u);
+            s.th = std::min(field(tex0, 30, 4), 10u);
+            s.tcc = field(tex0, 34, 1);
+            s.tfx = field(tex0, 35, 2);
+            s.cbp = field(tex0, 37, 14);
+            s.cpsm = field(tex0, 51, 4);
+            s.wms = field(clamp, 0, 2);
+            s.wmt = field(clamp, 2, 2);
+            s.minu = field(clamp, 4, 10);
+            s.maxu = field(clamp, 14, 10);
+            s.minv = field(clamp, 24, 10);
+            s.maxv = field(clamp, 34, 10);
+            s.ta0 = field(texa, 0, 8);
+            s.aem = field(texa, 15, 1);
+            s.ta1 = field(texa, 32, 8);
+        }
+
+        s.iip = field(attrs, 3, 1);
+        s.fge = field(attrs, 5, 1);
+        s.fogcol = field(m_regs[FOGCOL], 0, 24);
+
+        s.scax0 = field(scissor, 0, 11);
+        s.scax1 = field(scissor, 16, 11);
+        s.scay0 = field(scissor, 32, 11);
+        s.scay1 = field(scissor, 48, 11);
+        return s;
+    }
+
+    // BITBLTBUF: SBP 0-13, SBW 16-21, SPSM 24-29, DBP 32-45, DBW 48-53, DPSM 56-61.
+    // TRXPOS: SSAX 0-10, SSAY 16-26, DSAX 32-42, DSAY 48-58. TRXREG: RRW 0-11, RRH 32-43.
+    void Context::startTransfer(uint32_t dir)
+    {
+        const uint64_t bitblt = m_regs[BITBLTBUF];
+        const uint64_t pos = m_regs[TRXPOS];
+        const uint64_t size = m_regs[TRXREG];
+        const uint32_t width = field(size, 0, 12);
+        const uint32_t height = field(size, 32, 12);
+        m_transfer = Transfer{};
+        m_carry.clear();
+        if (!m_vram || width == 0 || height == 0)
+            return;
+
+        const uint32_t dpsm = field(bitblt, 56, 6);
+        if (dir == 0)
+        {
+            m_transfer.psm = dpsm;
+            m_transfer.bpp = bitsPerPixel(dpsm);
+            if (m_transfer.bpp == 0)
+            {
+                std::cerr << "[GS] host->local transfer in unsupported psm 0x" << std::hex << dpsm << std::dec
+                          << " dropped" << std::endl;
+                return;
+            }
+            m_transfer.active = true;
+            m_transfer.bp = field(bitblt, 32, 14);
+            m_transfer.bw = std::max(field(bitblt, 48, 6), 1u);
+            m_transfer.x = field(pos, 32, 11);
+            m_transfer.y = field(pos, 48, 11);
+            m_transfer.width = width;
+            m_transfer.height = height;
+        }
+        else if (dir == 2)
+        {
+            // Local->local copy through a linear staging image in the source format.
+            const uint32_t spsm = field(bitblt, 24, 6);
+            if (!ps2_gs_swizzle::isSupported(spsm) || !ps2_gs_swizzle::isSupported(dpsm))
+                return;
+            const size_t pitch = ps2_gs_swizzle::rowBytes(spsm, width);
+            m_copy.resize(pitch * height);
+            ps2_gs_swizzle::readImage(m_vram, spsm, field(bitblt, 0, 14), std::max(field(bitblt, 16, 6), 1u),
+                                      field(pos, 0, 11), field(pos, 16, 11), width, height, m_copy.data(), pitch);
+            ps2_gs_swizzle::writeImage(m_vram, dpsm, field(bitblt, 32, 14), std::max(field(bitblt, 48, 6), 1u),
+                                       field(pos, 32, 11), field(pos, 48, 11), width, height, m_copy.data(), pitch);
+        }
+        // dir 1 (local->host) needs a reader on the EE side; nothing consumes it yet.
+    }
+
+    void Context::transferData(const uint8_t *data, size_t bytes)
+    {
+        if (!m_transfer.active)
+            return;
+
+        if (!m_carry.empty())
+        {
+            // Complete the partial pixel left over from the previous HWREG run.
+            const size_t need = m_transfer.bpp / 8u - m_carry.size();
+            const size_t take = std::min(need, bytes);
+            m_carry.insert(m_carry.end(), data, data + take);
+            data += take;
+            bytes -= take;
+            if (m_carry.size() < m_transfer.bpp / 8u)
+                return;
+            transferPixels(m_carry.data(), m_carry.size());
+            m_carry.clear();
+        }
+
+        const size_t used = transferPixels(data, bytes);
+        if (m_transfer.active && used < bytes)
+            m_carry.assign(data + used, data + bytes);
+    }
+
+    // Writes whole pixels from a linear stream continuing at m_transfer.pixel;
+    // returns the bytes consumed.
+    size_t Context::transferPixels(const uint8_t *data, size_t bytes)
+    {
+        Transfer &t = m_transfer;
+        const uint64_t total = static_cast<uint64_t>(t.width) * t.height;
+        uint64_t pixels = std::min<uint64_t>(bytes * 8u / t.bpp, total - t.pixel);
+        const size_t consumed = static_cast<size_t>(pixels * t.bpp / 8u);
+        const size_t pitch = ps2_gs_swizzle::rowBytes(t.psm, t.width);
+
+        uint32_t row = static_cast<uint32_t>(t.pixel / t.width);
+        uint32_t col = static_cast<uint32_t>(t.pixel % t.width);
+        if (col != 0)
+        {
+            const uint32_t lead = static_cast<uint32_t>(std::min<uint64_t>(pixels, t.width - col));
+            ps2_gs_swizzle::writeImage(m_vram, t.psm, t.bp, t.bw, t.x + col, t.y + row, lead, 1, data, pitch);
+            data += lead * t.bpp / 8u;
+            pixels -= lead;
+            t.pixel += lead;
+            row = static_cast<uint32_t>(t.pixel / t.width);
+        }
+
+        const uint32_t rows = static_cast<uint32_t>(pixels / t.width);
+        if (rows != 0)
+        {
+            ps2_gs_swizzle::writeImage(m_vram, t.psm, t.bp, t.bw, t.x, t.y + row, t.width, rows, data, pitch);
+            data += rows * pitch;
+            pixels -= static_cast<uint64_t>(rows) * t.width;
+            t.pixel += static_cast<uint64_t>(rows) * t.width;
+            row += rows;
+        }
+
+        if (pixels != 0)
+        {
+            ps2_gs_swizzle::writeImage(m_vram, t.psm, t.bp, t.bw, t.x, t.y + row,
+                                       static_cast<uint32_t>(pixels), 1, data, pitch);
+            t.pixel += pixels;
+        }
+
+        if (t.pixel == total)
+        {
+            t.active = false;
+            m_carry.clear();
+        }
+        return consumed;
+    }
+
+    Pipeline::~Pipeline()
+    {
+        stop();
+    }
+
+    void Pipeline::attach(uint8_t *vram, GSRegisters *privileged)
+    {
+        drain();
+        m_context.attach(vram, privileged);
+    }
+
+    void Pipeline::submit(CommandStream &stream)
+    {
+        if (stream.empty())
+            return;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        enqueue(lock, Batch{std::move(stream), {}});
+        if (!m_free.empty())
+        {
+            stream = std::move(m_free.back());
+            m_free.pop_back();
+        }
+        else
+        {
+            stream = CommandStream{};
+        }
+        lock.unlock();
+        m_workCv.notify_one();
+    }
+
+    void Pipeline::fence(std::function<void()> fn)
+    {
+        if (!fn)
+            return;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        enqueue(lock, Batch{{}, std::move(fn)});
+        lock.unlock();
+        m_workCv.notify_one();
+    }
+
+    void Pipeline::enqueue(std::unique_lock<std::mutex> &lock, Batch batch)
+    {
+        if (!m_thread.joinable())
+        {
+            m_stop = false;
+            m_thread = std::thread(&Pipeline::run, this);
+        }
+        m_idleCv.wait(lock, [this]() { return m_queue.size() < kMaxQueuedBatches; });
+        m_queue.push_back(std::move(batch));
+    }
+
+    void Pipeline::drain()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idleCv.wait(lock, [this]() { return m_queue.empty() && !m_busy; });
+    }
+
+    void Pipeline::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_workCv.notify_all();
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    void Pipeline::run()
+    {
+        ThreadNaming::SetCurrentThreadName("GsPipelineThread");
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_workCv.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty())
+                break; // stopping with nothing left to apply
+
+            Batch batch = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+            lock.unlock();
+
+            if (batch.fence)
+            {
+                batch.fence();
+            }
+            else
+            {
+                m_context.execute(batch.stream);
+                batch.stream.clear();
+            }
+
+            lock.lock();
+            if (!batch.fence && m_free.size() < kMaxFreeBatches)
+                m_free.push_back(std::move(batch.stream));
+            m_busy = false;
+            m_idleCv.notify_all();
+        }
+    }
+}
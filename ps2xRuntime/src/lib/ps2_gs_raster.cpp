@@ -0,0 +1,780 @@
+#include "ps2_gs_raster.h"
+#include "ps2_gs_swizzle.h"
+#include "ps2_memory.h"
+#include <ThreadNaming.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    using namespace ps2_gs_swizzle;
+    using ps2_gs_raster::DrawState;
+    using ps2_gs_raster::Rasterizer;
+
+    constexpr uint32_t kMaxCoord = 2047;
+    constexpr uint32_t kTileCols = (kMaxCoord + 1) / Rasterizer::kTileWidth;
+    constexpr uint32_t kTileRows = (kMaxCoord + 1) / Rasterizer::kTileHeight;
+    // Primitives binned before draw() flushes on its own, to bound memory.
+    constexpr size_t kMaxPendingPrims = 16384;
+
+    struct Plane
+    {
+        float c = 0.0f;
+        float dx = 0.0f;
+        float dy = 0.0f;
+    };
+
+    inline int clampByte(int v)
+    {
+        return v < 0 ? 0 : (v > 255 ? 255 : v);
+    }
+
+    inline int64_t floorDiv(int64_t a, int64_t b)
+    {
+        int64_t q = a / b;
+        if ((a % b != 0) && ((a < 0) != (b < 0)))
+            --q;
+        return q;
+    }
+
+    inline int64_t ceilDiv(int64_t a, int64_t b)
+    {
+        return -floorDiv(-a, b);
+    }
+
+    inline int32_t ceil16(int32_t v)
+    {
+        return (v + 15) >> 4;
+    }
+
+    // Expands a 16-bit texel or framebuffer pixel. TEXA supplies alpha for
+    // textures; framebuffer pixels map STP to 0x80.
+    inline uint32_t expand16(uint32_t p, const DrawState *texa)
+    {
+        const uint32_t rgb = ((p & 0x1Fu) << 3) | ((p & 0x3E0u) << 6) | ((p & 0x7C00u) << 9);
+        uint32_t alpha;
+        if (!texa)
+            alpha = (p & 0x8000u) ? 0x80u : 0u;
+        else if (p & 0x8000u)
+            alpha = texa->ta1;
+        else
+            alpha = (texa->aem && (p & 0x7FFFu) == 0) ? 0u : texa->ta0;
+        return rgb | (alpha << 24);
+    }
+
+    inline uint32_t pack16(uint32_t c)
+    {
+        return ((c >> 3) & 0x1Fu) | ((c >> 6) & 0x3E0u) | ((c >> 9) & 0x7C00u) | ((c >> 16) & 0x8000u);
+    }
+
+    inline int wrapCoord(int c, uint32_t size, uint32_t mode, uint32_t minc, uint32_t maxc)
+    {
+        switch (mode)
+        {
+        case 0: // REPEAT
+            return c & static_cast<int>(size - 1u);
+        case 1: // CLAMP
+            return std::clamp(c, 0, static_cast<int>(size) - 1);
+        case 2: // REGION_CLAMP
+            return std::clamp(c, static_cast<int>(minc), static_cast<int>(maxc));
+        default: // REGION_REPEAT: MINU is a mask, MAXU a fixed value
+            return static_cast<int>((static_cast<uint32_t>(c) & minc) | maxc);
+        }
+    }
+
+    // RGBA8 texel with GS alpha (0x80 = 1.0).
+    uint32_t fetchTexel(const uint8_t *vram, const DrawState &s, int u, int v)
+    {
+        const uint32_t x = static_cast<uint32_t>(wrapCoord(u, 1u << s.tw, s.wms, s.minu, s.maxu)) & kMaxCoord;
+        const uint32_t y = static_cast<uint32_t>(wrapCoord(v, 1u << s.th, s.wmt, s.minv, s.maxv)) & kMaxCoord;
+        uint32_t raw = readPixel(vram, s.tpsm, s.tbp, s.tbw, x, y);
+
+        switch (s.tpsm)
+        {
+        case PSMCT32:
+            return raw;
+        case PSMCT24:
+            return raw | ((s.aem && raw == 0) ? 0u : (s.ta0 << 24));
+        case PSMCT16:
+        case PSMCT16S:
+            return expand16(raw, &s);
+        case PSMT8:
+        case PSMT4:
+        {
+            // CLUT stored as a 16x16 (8-bit, CSM1 with bits 3 and 4 swapped) or
+            // 8x2 (4-bit) image at CBP.
+            uint32_t cx, cy;
+            if (s.tpsm == PSMT8)
+            {
+                const uint32_t idx = (raw & 0xE7u) | ((raw & 0x08u) << 1) | ((raw & 0x10u) >> 1);
+                cx = idx & 15u;
+                cy = idx >> 4;
+            }
+            else
+            {
+                cx = raw & 7u;
+                cy = raw >> 3;
+            }
+            const uint32_t entry = readPixel(vram, s.cpsm, s.cbp, 1, cx, cy);
+            if (s.cpsm == PSMCT32)
+                return entry;
+            return expand16(entry, &s);
+        }
+        default:
+            return 0;
+        }
+    }
+
+    // One pixel through texture function, fog, tests, blending and write-back.
+    void shadePixel(uint8_t *vram, const DrawState &s, int x, int y, uint32_t z,
+                    int r, int g, int b, int a, int fog, float tu, float tv)
+    {
+        if (s.tme)
+        {
+            const uint32_t t = fetchTexel(vram, s, static_cast<int>(std::floor(tu)), static_cast<int>(std::floor(tv)));
+            const int tr = t & 0xFF, tg = (t >> 8) & 0xFF, tb = (t >> 16) & 0xFF, ta = t >> 24;
+            switch (s.tfx)
+            {
+            case 0: // MODULATE
+                r = (tr * r) >> 7;
+                g = (tg * g) >> 7;
+                b = (tb * b) >> 7;
+                if (s.tcc)
+                    a = (ta * a) >> 7;
+                break;
+            case 1: // DECAL
+                r = tr;
+                g = tg;
+                b = tb;
+                if (s.tcc)
+                    a = ta;
+                break;
+            case 2: // HIGHLIGHT
+                r = ((tr * r) >> 7) + a;
+                g = ((tg * g) >> 7) + a;
+                b = ((tb * b) >> 7) + a;
+                if (s.tcc)
+                    a = ta + a;
+                break;
+            default: // HIGHLIGHT2
+                r = ((tr * r) >> 7) + a;
+                g = ((tg * g) >> 7) + a;
+                b = ((tb * b) >> 7) + a;
+                if (s.tcc)
+                    a = ta;
+                break;
+            }
+            r = clampByte(r);
+            g = clampByte(g);
+            b = clampByte(b);
+            a = clampByte(a);
+        }
+
+        if (s.fge)
+        {
+            r = (fog * r + (255 - fog) * static_cast<int>(s.fogcol & 0xFFu)) >> 8;
+            g = (fog * g + (255 - fog) * static_cast<int>((s.fogcol >> 8) & 0xFFu)) >> 8;
+            b = (fog * b + (255 - fog) * static_cast<int>((s.fogcol >> 16) & 0xFFu)) >> 8;
+        }
+
+        bool writeFb = true;
+        bool writeZ = !s.zmsk;
+        uint32_t fbMask = s.fbmsk;
+        if (s.ate)
+        {
+            bool pass;
+            const int aref = static_cast<int>(s.aref);
+            switch (s.atst)
+            {
+            case 0: pass = false; break;
+            case 1: pass = true; break;
+            case 2: pass = a < aref; break;
+            case 3: pass = a <= aref; break;
+            case 4: pass = a == aref; break;
+            case 5: pass = a >= aref; break;
+            case 6: pass = a > aref; break;
+            default: pass = a != aref; break;
+            }
+            if (!pass)
+            {
+                switch (s.afail)
+                {
+                case 0: return; // KEEP
+                case 1: writeZ = false; break; // FB_ONLY
+                case 2: writeFb = false; break; // ZB_ONLY
+                default: writeZ = false; fbMask |= 0xFF000000u; break; // RGB_ONLY
+                }
+            }
+        }
+
+        const uint32_t fx = static_cast<uint32_t>(x);
+        const uint32_t fy = static_cast<uint32_t>(y);
+        const bool fb16 = s.fpsm == PSMCT16 || s.fpsm == PSMCT16S;
+        uint8_t *fbPtr = vram + pixelOffset(s.fpsm, s.fbp, s.fbw, fx, fy);
+        uint32_t dst;
+        if (fb16)
+        {
+            uint16_t half;
+            std::memcpy(&half, fbPtr, sizeof(half));
+            dst = half;
+        }
+        else
+        {
+            std::memcpy(&dst, fbPtr, sizeof(dst));
+        }
+        const uint32_t dstColor = fb16 ? expand16(dst, nullptr)
+                                       : (s.fpsm == PSMCT24 ? ((dst & 0xFFFFFFu) | 0x80000000u) : dst);
+
+        if (s.date && s.fpsm != PSMCT24)
+        {
+            const bool dstBit = fb16 ? (dst & 0x8000u) != 0 : (dst & 0x80000000u) != 0;
+            if (dstBit != (s.datm != 0))
+                return;
+        }
+
+        if (s.zte)
+        {
+            const uint32_t zMax = (s.zpsm == PSMZ32) ? 0xFFFFFFFFu : (s.zpsm == PSMZ24 ? 0xFFFFFFu : 0xFFFFu);
+            z = std::min(z, zMax);
+            if (s.ztst != 1)
+            {
+                if (s.ztst == 0)
+                    return;
+                const uint32_t zDst = readPixel(vram, s.zpsm, s.zbp, s.fbw, fx, fy);
+                if (s.ztst == 2 ? z < zDst : z <= zDst)
+                    return;
+            }
+            if (writeZ)
+                writePixel(vram, s.zpsm, s.zbp, s.fbw, fx, fy, z);
+        }
+
+        if (!writeFb)
+            return;
+
+        if (s.abe && !(s.pabe && a < 0x80))
+        {
+            // ((A - B) * C >> 7) + D, each of A/B/D one of Cs, Cd, 0 and C one of As, Ad, FIX.
+            const int src[3] = {r, g, b};
+            const int ad = static_cast<int>(dstColor >> 24);
+            const int cValue = s.blendC == 0 ? a : (s.blendC == 1 ? ad : static_cast<int>(s.fix));
+            int out[3];
+            for (int c = 0; c < 3; ++c)
+            {
+                const int cd = static_cast<int>((dstColor >> (c * 8)) & 0xFFu);
+                const int av = s.blendA == 0 ? src[c] : (s.blendA == 1 ? cd : 0);
+                const int bv = s.blendB == 0 ? src[c] : (s.blendB == 1 ? cd : 0);
+                const int dv = s.blendD == 0 ? src[c] : (s.blendD == 1 ? cd : 0);
+                out[c] = (((av - bv) * cValue) >> 7) + dv;
+            }
+            r = out[0];
+            g = out[1];
+            b = out[2];
+        }
+
+        if (s.colclamp)
+        {
+            r = clampByte(r);
+            g = clampByte(g);
+            b = clampByte(b);
+        }
+        if (s.fba)
+            a |= 0x80;
+
+        uint32_t color = static_cast<uint32_t>(r & 0xFF) | (static_cast<uint32_t>(g & 0xFF) << 8) |
+                         (static_cast<uint32_t>(b & 0xFF) << 16) | (static_cast<uint32_t>(a & 0xFF) << 24);
+        if (fb16)
+        {
+            const uint32_t mask16 = pack16(fbMask);
+            const uint16_t half = static_cast<uint16_t>((pack16(color) & ~mask16) | (dst & mask16));
+            std::memcpy(fbPtr, &half, sizeof(half));
+        }
+        else
+        {
+            if (s.fpsm == PSMCT24)
+                fbMask |= 0xFF000000u;
+            color = (color & ~fbMask) | (dst & fbMask);
+            std::memcpy(fbPtr, &color, sizeof(color));
+        }
+    }
+
+    void planeFrom3(Plane &p, const float *a, float x0, float y0, float dx1, float dy1, float dx2, float dy2, float invDet)
+    {
+        const float d1 = a[1] - a[0];
+        const float d2 = a[2] - a[0];
+        p.dx = (d1 * dy2 - d2 * dy1) * invDet;
+        p.dy = (d2 * dx1 - d1 * dx2) * invDet;
+        p.c = a[0] - p.dx * x0 - p.dy * y0;
+    }
+
+    unsigned defaultThreads()
+    {
+        if (const char *env = std::getenv("PS2_GS_THREADS"))
+        {
+            const long value = std::strtol(env, nullptr, 10);
+            if (value > 0)
+                return static_cast<unsigned>(value);
+        }
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+namespace ps2_gs_raster
+{
+    WorkStealingPool::WorkStealingPool(unsigned workers)
+    {
+        for (unsigned i = 0; i <= workers; ++i)
+            m_queues.push_back(std::make_unique<Queue>());
+        for (unsigned i = 1; i <= workers; ++i)
+            m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread &thread : m_threads)
+            thread.join();
+    }
+
+    void WorkStealingPool::run(size_t count, const std::function<void(size_t)> &job)
+    {
+        if (count == 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &job;
+            m_remaining.store(count, std::memory_order_relaxed);
+            for (size_t i = 0; i < count; ++i)
+            {
+                Queue &queue = *m_queues[i % m_queues.size()];
+                std::lock_guard<std::mutex> queueLock(queue.mutex);
+                queue.items.push_back(i);
+            }
+            ++m_generation;
+        }
+        m_wake.notify_all();
+
+        work(0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_remaining.load(std::memory_order_acquire) == 0; });
+    }
+
+    bool WorkStealingPool::take(unsigned self, size_t &item)
+    {
+        {
+            Queue &own = *m_queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.items.empty())
+            {
+                item = own.items.front();
+                own.items.pop_front();
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < m_queues.size(); ++offset)
+        {
+            Queue &victim = *m_queues[(self + offset) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.items.empty())
+            {
+                item = victim.items.back();
+                victim.items.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkStealingPool::work(unsigned self)
+    {
+        size_t item;
+        while (take(self, item))
+        {
+            (*m_job)(item);
+            if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_done.notify_all();
+            }
+        }
+    }
+
+    void WorkStealingPool::workerLoop(unsigned self)
+    {
+        ThreadNaming::SetCurrentThreadName("GsRasterThread");
+        uint64_t seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&]() { return m_stop || m_generation != seen; });
+                if (m_stop)
+                    return;
+                seen = m_generation;
+            }
+            work(self);
+        }
+    }
+
+    struct Rasterizer::Setup
+    {
+        PrimKind kind = PrimKind::Triangle;
+        uint32_t state = 0;
+        int32_t minX = 0, minY = 0, maxX = -1, maxY = -1; // inclusive pixels
+        // Triangles cover samples where A*X + B*Y + C >= bias (12.4 units).
+        int64_t ea[3] = {}, eb[3] = {}, ec[3] = {}, bias[3] = {};
+        // Attributes as planes over pixel coordinates.
+        Plane r, g, b, a, f, s, t, q;
+        double zc = 0.0, zdx = 0.0, zdy = 0.0;
+        Vertex v[2]; // lines and points
+    };
+
+    Rasterizer::Rasterizer(unsigned threads)
+        : m_threadCount(threads ? threads : defaultThreads())
+    {
+        m_bins.resize(kTileCols * kTileRows);
+    }
+
+    Rasterizer::~Rasterizer() = default;
+
+    unsigned Rasterizer::threads() const
+    {
+        return m_threadCount;
+    }
+
+    size_t Rasterizer::pending() const
+    {
+        return m_prims.size();
+    }
+
+    void Rasterizer::draw(PrimKind kind, const Vertex *vertices, const DrawState &state)
+    {
+        if (!m_vram)
+            return;
+
+        Setup setup;
+        setup.kind = kind;
+
+        // Attribute planes. Colors are flat (last vertex) unless IIP is set;
+        // sprites are always flat.
+        const Vertex &last = vertices[kind == PrimKind::Triangle ? 2 : (kind == PrimKind::Point ? 0 : 1)];
+        auto flat = [](Plane &p, float value)
+        {
+            p.c = value;
+            p.dx = 0.0f;
+            p.dy = 0.0f;
+        };
+        auto texS = [&](const Vertex &vx) { return state.fst ? vx.u : vx.s; };
+        auto texT = [&](const Vertex &vx) { return state.fst ? vx.v : vx.t; };
+        auto texQ = [&](const Vertex &vx) { return state.fst ? 1.0f : vx.q; };
+
+        int32_t minX, minY, maxX, maxY;
+        if (kind == PrimKind::Triangle)
+        {
+            const Vertex &v0 = vertices[0];
+            const Vertex *v1 = &vertices[1];
+            const Vertex *v2 = &vertices[2];
+            int64_t area = static_cast<int64_t>(v1->x - v0.x) * (v2->y - v0.y) -
+                           static_cast<int64_t>(v2->x - v0.x) * (v1->y - v0.y);
+            if (area == 0)
+                return;
+            if (area < 0)
+                std::swap(v1, v2);
+
+            const Vertex *vs[3] = {&v0, v1, v2};
+            for (int e = 0; e < 3; ++e)
+            {
+                const Vertex &pa = *vs[e];
+                const Vertex &pb = *vs[(e + 1) % 3];
+                const int64_t A = -(static_cast<int64_t>(pb.y) - pa.y);
+                const int64_t B = static_cast<int64_t>(pb.x) - pa.x;
+                setup.ea[e] = A;
+                setup.eb[e] = B;
+                setup.ec[e] = -(A * pa.x + B * pa.y);
+                // Top-left rule: exactly one of two triangles sharing an edge owns it.
+                setup.bias[e] = (A > 0 || (A == 0 && B < 0)) ? 0 : 1;
+            }
+
+            minX = ceil16(std::min({v0.x, v1->x, v2->x}));
+            minY = ceil16(std::min({v0.y, v1->y, v2->y}));
+            maxX = std::max({v0.x, v1->x, v2->x}) >> 4;
+            maxY = std::max({v0.y, v1->y, v2->y}) >> 4;
+
+            const float x0 = v0.x / 16.0f, y0 = v0.y / 16.0f;
+            const float dx1 = v1->x / 16.0f - x0, dy1 = v1->y / 16.0f - y0;
+            const float dx2 = v2->x / 16.0f - x0, dy2 = v2->y / 16.0f - y0;
+            const float det = dx1 * dy2 - dx2 * dy1;
+            const float invDet = 1.0f / det;
+            auto plane3 = [&](Plane &p, float a0, float a1, float a2)
+            {
+                const float values[3] = {a0, a1, a2};
+                planeFrom3(p, values, x0, y0, dx1, dy1, dx2, dy2, invDet);
+            };
+
+            if (state.iip)
+            {
+                plane3(setup.r, v0.r, v1->r, v2->r);
+                plane3(setup.g, v0.g, v1->g, v2->g);
+                plane3(setup.b, v0.b, v1->b, v2->b);
+                plane3(setup.a, v0.a, v1->a, v2->a);
+                plane3(setup.f, v0.fog, v1->fog, v2->fog);
+            }
+            else
+            {
+                flat(setup.r, last.r);
+                flat(setup.g, last.g);
+                flat(setup.b, last.b);
+                flat(setup.a, last.a);
+                flat(setup.f, last.fog);
+            }
+            plane3(setup.s, texS(v0), texS(*v1), texS(*v2));
+            plane3(setup.t, texT(v0), texT(*v1), texT(*v2));
+            plane3(setup.q, texQ(v0), texQ(*v1), texQ(*v2));
+
+            // Depth needs more precision than float carries for 24/32-bit Z.
+            const double dz1 = static_cast<double>(v1->z) - v0.z;
+            const double dz2 = static_cast<double>(v2->z) - v0.z;
+            const double ddet = static_cast<double>(dx1) * dy2 - static_cast<double>(dx2) * dy1;
+            setup.zdx = (dz1 * dy2 - dz2 * dy1) / ddet;
+            setup.zdy = (dz2 * dx1 - dz1 * dx2) / ddet;
+            setup.zc = v0.z - setup.zdx * x0 - setup.zdy * y0;
+        }
+        else if (kind == PrimKind::Sprite)
+        {
+            const Vertex &v0 = vertices[0];
+            const Vertex &v1 = vertices[1];
+            const bool flipX = v1.x < v0.x;
+            const bool flipY = v1.y < v0.y;
+            const Vertex &left = flipX ? v1 : v0, &right = flipX ? v0 : v1;
+            const Vertex &top = flipY ? v1 : v0, &bottom = flipY ? v0 : v1;
+            if (left.x == right.x || top.y == bottom.y)
+                return;
+
+            // Covers samples with X0 <= X < X1.
+            minX = ceil16(left.x);
+            maxX = ceil16(right.x) - 1;
+            minY = ceil16(top.y);
+            maxY = ceil16(bottom.y) - 1;
+
+            flat(setup.r, last.r);
+            flat(setup.g, last.g);
+            flat(setup.b, last.b);
+            flat(setup.a, last.a);
+            flat(setup.f, last.fog);
+            auto linear = [&](Plane &p, float ax, float bx, float ay, float by)
+            {
+                const float spanX = (right.x - left.x) / 16.0f;
+                const float spanY = (bottom.y - top.y) / 16.0f;
+                p.dx = (bx - ax) / spanX;
+                p.dy = (by - ay) / spanY;
+                p.c = ax - p.dx * (left.x / 16.0f) - p.dy * (top.y / 16.0f);
+            };
+            linear(setup.s, texS(left), texS(right), texS(top), texS(bottom));
+            linear(setup.t, texT(left), texT(right), texT(top), texT(bottom));
+            flat(setup.q, texQ(v1));
+            setup.zc = v1.z;
+        }
+        else
+        {
+            setup.v[0] = vertices[0];
+            setup.v[1] = kind == PrimKind::Line ? vertices[1] : vertices[0];
+            minX = (std::min(setup.v[0].x, setup.v[1].x) + 8) >> 4;
+            minY = (std::min(setup.v[0].y, setup.v[1].y) + 8) >> 4;
+            maxX = (std::max(setup.v[0].x, setup.v[1].x) + 8) >> 4;
+            maxY = (std::max(setup.v[0].y, setup.v[1].y) + 8) >> 4;
+        }
+
+        setup.minX = std::max(minX, static_cast<int32_t>(state.scax0));
+        setup.minY = std::max(minY, static_cast<int32_t>(state.scay0));
+        setup.maxX = std::min({maxX, static_cast<int32_t>(state.scax1), static_cast<int32_t>(kMaxCoord)});
+        setup.maxY = std::min({maxY, static_cast<int32_t>(state.scay1), static_cast<int32_t>(kMaxCoord)});
+        if (setup.minX > setup.maxX || setup.minY > setup.maxY)
+            return;
+
+        if (m_states.empty() || std::memcmp(&m_states.back(), &state, sizeof(DrawState)) != 0)
+            m_states.push_back(state);
+        setup.state = static_cast<uint32_t>(m_states.size() - 1);
+
+        const uint32_t index = static_cast<uint32_t>(m_prims.size());
+        m_prims.push_back(setup);
+        for (uint32_t ty = static_cast<uint32_t>(setup.minY) / kTileHeight; ty <= static_cast<uint32_t>(setup.maxY) / kTileHeight; ++ty)
+        {
+            for (uint32_t tx = static_cast<uint32_t>(setup.minX) / kTileWidth; tx <= static_cast<uint32_t>(setup.maxX) / kTileWidth; ++tx)
+            {
+                std::vector<uint32_t> &bin = m_bins[ty * kTileCols + tx];
+                if (bin.empty())
+                    m_activeTiles.push_back(ty * kTileCols + tx);
+                bin.push_back(index);
+            }
+        }
+
+        if (m_prims.size() >= kMaxPendingPrims)
+            flush();
+    }
+
+    void Rasterizer::flush()
+    {
+        if (m_activeTiles.empty())
+        {
+            m_prims.clear();
+            m_states.clear();
+            return;
+        }
+
+        if (m_threadCount > 1 && m_activeTiles.size() > 1)
+        {
+            if (!m_pool)
+                m_pool = std::make_unique<WorkStealingPool>(m_threadCount - 1);
+            const std::function<void(size_t)> job = [this](size_t i) { drawTile(m_activeTiles[i]); };
+            m_pool->run(m_activeTiles.size(), job);
+        }
+        else
+        {
+            for (uint32_t tile : m_activeTiles)
+                drawTile(tile);
+        }
+
+        for (uint32_t tile : m_activeTiles)
+            m_bins[tile].clear();
+        m_activeTiles.clear();
+        m_prims.clear();
+        m_states.clear();
+    }
+
+    void Rasterizer::drawTile(uint32_t tile)
+    {
+        const int32_t tileX0 = static_cast<int32_t>((tile % kTileCols) * kTileWidth);
+        const int32_t tileY0 = static_cast<int32_t>((tile / kTileCols) * kTileHeight);
+        const int32_t tileX1 = tileX0 + static_cast<int32_t>(kTileWidth) - 1;
+        const int32_t tileY1 = tileY0 + static_cast<int32_t>(kTileHeight) - 1;
+        const __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+        for (uint32_t index : m_bins[tile])
+        {
+            const Setup &p = m_prims[index];
+            const DrawState &st = m_states[p.state];
+            const int32_t x0 = std::max(p.minX, tileX0);
+            const int32_t x1 = std::min(p.maxX, tileX1);
+            const int32_t y0 = std::max(p.minY, tileY0);
+            const int32_t y1 = std::min(p.maxY, tileY1);
+            if (x0 > x1 || y0 > y1)
+                continue;
+
+            if (p.kind == PrimKind::Point || p.kind == PrimKind::Line)
+            {
+                const Vertex &a = p.v[0];
+                const Vertex &b = p.v[1];
+                const int32_t dx = b.x - a.x;
+                const int32_t dy = b.y - a.y;
+                // Lines leave out their last pixel so strips do not draw joints twice.
+                const int32_t steps = p.kind == PrimKind::Point ? 1 : std::max(std::abs(dx), std::abs(dy)) / 16;
+                for (int32_t i = 0; i < steps; ++i)
+                {
+                    const float t = p.kind == PrimKind::Point ? 0.0f : static_cast<float>(i) / steps;
+                    const int32_t px = (a.x + static_cast<int32_t>(dx * t) + 8) >> 4;
+                    const int32_t py = (a.y + static_cast<int32_t>(dy * t) + 8) >> 4;
+                    if (px < x0 || px > x1 || py < y0 || py > y1)
+                        continue;
+                    auto lerp = [t](float from, float to) { return from + (to - from) * t; };
+                    const Vertex &c = st.iip ? a : b;
+                    const float w = st.iip ? t : 0.0f;
+                    auto mix = [w](float from, float to) { return from + (to - from) * w; };
+                    const float qv = st.fst ? 1.0f : lerp(a.q, b.q);
+                    const float su = st.fst ? lerp(a.u, b.u) : lerp(a.s, b.s) / qv * static_cast<float>(1u << st.tw);
+                    const float tv = st.fst ? lerp(a.v, b.v) : lerp(a.t, b.t) / qv * static_cast<float>(1u << st.th);
+                    shadePixel(m_vram, st, px, py, static_cast<uint32_t>(lerp(static_cast<float>(a.z), static_cast<float>(b.z))),
+                               static_cast<int>(mix(c.r, b.r)), static_cast<int>(mix(c.g, b.g)),
+                               static_cast<int>(mix(c.b, b.b)), static_cast<int>(mix(c.a, b.a)),
+                               static_cast<int>(mix(c.fog, b.fog)), su, tv);
+                }
+                continue;
+            }
+
+            const float texW = static_cast<float>(1u << st.tw);
+            const float texH = static_cast<float>(1u << st.th);
+            for (int32_t y = y0; y <= y1; ++y)
+            {
+                int32_t spanX0 = x0;
+                int32_t spanX1 = x1;
+                if (p.kind == PrimKind::Triangle)
+                {
+                    // Solve each edge for the covered x range on this row.
+                    const int64_t sampleY = static_cast<int64_t>(y) * 16;
+                    int64_t lo = spanX0;
+                    int64_t hi = spanX1;
+                    for (int e = 0; e < 3 && lo <= hi; ++e)
+                    {
+                        const int64_t k = p.bias[e] - (p.eb[e] * sampleY + p.ec[e]);
+                        const int64_t a16 = p.ea[e] * 16;
+                        if (a16 > 0)
+                            lo = std::max(lo, ceilDiv(k, a16));
+                        else if (a16 < 0)
+                            hi = std::min(hi, floorDiv(k, a16));
+                        else if (k > 0)
+                            hi = lo - 1;
+                    }
+                    if (lo > hi)
+                        continue;
+                    spanX0 = static_cast<int32_t>(lo);
+                    spanX1 = static_cast<int32_t>(hi);
+                }
+
+                // Four pixels per step: interpolants in SSE, then per-pixel tests.
+                const float fy = static_cast<float>(y);
+                auto rowBase = [fy](const Plane &pl) { return _mm_set1_ps(pl.c + pl.dy * fy); };
+                const __m128 rBase = rowBase(p.r), gBase = rowBase(p.g), bBase = rowBase(p.b), aBase = rowBase(p.a);
+                const __m128 fBase = rowBase(p.f), sBase = rowBase(p.s), tBase = rowBase(p.t), qBase = rowBase(p.q);
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 maxByte = _mm_set1_ps(255.0f);
+                const double zRow = p.zc + p.zdy * y;
+
+                for (int32_t x = spanX0; x <= spanX1; x += 4)
+                {
+                    const int count = std::min(4, spanX1 - x + 1);
+                    const __m128 fx = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane);
+                    auto eval = [&fx](__m128 base, const Plane &pl) { return _mm_add_ps(base, _mm_mul_ps(fx, _mm_set1_ps(pl.dx))); };
+                    auto toBytes = [&](__m128 v)
+                    {
+                        return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(v, zero), maxByte));
+                    };
+
+                    alignas(16) int32_t rv[4], gv[4], bv[4], av[4], fv[4];
+                    alignas(16) float uv[4], vv[4];
+                    _mm_store_si128(reinterpret_cast<__m128i *>(rv), toBytes(eval(rBase, p.r)));
+                    _mm_store_si128(reinterpret_cast<__m128i *>(gv), toBytes(eval(gBase, p.g)));
+                    _mm_store_si128(reinterpret_cast<__m128i *>(bv), toBytes(eval(bBase, p.b)));
+                    _mm_store_si128(reinterpret_cast<__m128i *>(av), toBytes(eval(aBase, p.a)));
+                    _mm_store_si128(reinterpret_cast<__m128i *>(fv), toBytes(eval(fBase, p.f)));
+                    if (st.tme)
+                    {
+                        __m128 su = eval(sBase, p.s);
+                        __m128 tv = eval(tBase, p.t);
+                        if (!st.fst)
+                        {
+                            const __m128 qv = eval(qBase, p.q);
+                            su = _mm_mul_ps(_mm_div_ps(su, qv), _mm_set1_ps(texW));
+                            tv = _mm_mul_ps(_mm_div_ps(tv, qv), _mm_set1_ps(texH));
+                        }
+                        _mm_store_ps(uv, su);
+                        _mm_store_ps(vv, tv);
+                    }
+
+                    for (int i = 0; i < count; ++i)
+                    {
+                        const double zf = zRow + p.zdx * (x + i);
+                        const uint32_t z = zf <= 0.0 ? 0u : (zf >= 4294967295.0 ? 0xFFFFFFFFu : static_cast<uint32_t>(zf));
+                        shadePixel(m_vram, st, x + i, y, z, rv[i], gv[i], bv[i], av[i], fv[i],
+                                   st.tme ? uv[i] : 0.0f, st.tme ? vv[i] : 0.0f);
+                    }
+                }
+            }
+        }
+    }
+}
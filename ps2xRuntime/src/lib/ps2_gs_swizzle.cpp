@@ -0,0 +1,644 @@
+#include "ps2_gs_swizzle.h"
+#include "ps2_memory.h"
+#include <cstring>
+
+namespace
+{
+    using namespace ps2_gs_swizzle;
+
+    constexpr uint32_t kBlockBytes = 256u;
+    constexpr uint32_t kBlockMask = static_cast<uint32_t>(PS2_GS_VRAM_SIZE / kBlockBytes) - 1u;
+    constexpr uint32_t kVramMask = static_cast<uint32_t>(PS2_GS_VRAM_SIZE) - 1u;
+
+    // Block order inside a page.
+    constexpr uint8_t kBlock32[4][8] = {
+        {0, 1, 4, 5, 16, 17, 20, 21},
+        {2, 3, 6, 7, 18, 19, 22, 23},
+        {8, 9, 12, 13, 24, 25, 28, 29},
+        {10, 11, 14, 15, 26, 27, 30, 31},
+    };
+
+    constexpr uint8_t kBlock16[8][4] = {
+        {0, 2, 8, 10},
+        {1, 3, 9, 11},
+        {4, 6, 12, 14},
+        {5, 7, 13, 15},
+        {16, 18, 24, 26},
+        {17, 19, 25, 27},
+        {20, 22, 28, 30},
+        {21, 23, 29, 31},
+    };
+
+    constexpr uint8_t kBlock16S[8][4] = {
+        {0, 2, 16, 18},
+        {1, 3, 17, 19},
+        {8, 10, 24, 26},
+        {9, 11, 25, 27},
+        {4, 6, 20, 22},
+        {5, 7, 21, 23},
+        {12, 14, 28, 30},
+        {13, 15, 29, 31},
+    };
+
+    // PSMT8 and PSMT4 pages use the same block order as PSMCT32 and PSMCT16.
+    constexpr const uint8_t (&kBlock8)[4][8] = kBlock32;
+    constexpr const uint8_t (&kBlock4)[8][4] = kBlock16;
+
+    // Element order inside a block: words, halfwords, bytes and nibbles.
+    constexpr uint8_t kColumn32[8][8] = {
+        {0, 1, 4, 5, 8, 9, 12, 13},
+        {2, 3, 6, 7, 10, 11, 14, 15},
+        {16, 17, 20, 21, 24, 25, 28, 29},
+        {18, 19, 22, 23, 26, 27, 30, 31},
+        {32, 33, 36, 37, 40, 41, 44, 45},
+        {34, 35, 38, 39, 42, 43, 46, 47},
+        {48, 49, 52, 53, 56, 57, 60, 61},
+        {50, 51, 54, 55, 58, 59, 62, 63},
+    };
+
+    constexpr uint8_t kColumn16[8][16] = {
+        {0, 2, 8, 10, 16, 18, 24, 26, 1, 3, 9, 11, 17, 19, 25, 27},
+        {4, 6, 12, 14, 20, 22, 28, 30, 5, 7, 13, 15, 21, 23, 29, 31},
+        {32, 34, 40, 42, 48, 50, 56, 58, 33, 35, 41, 43, 49, 51, 57, 59},
+        {36, 38, 44, 46, 52, 54, 60, 62, 37, 39, 45, 47, 53, 55, 61, 63},
+        {64, 66, 72, 74, 80, 82, 88, 90, 65, 67, 73, 75, 81, 83, 89, 91},
+        {68, 70, 76, 78, 84, 86, 92, 94, 69, 71, 77, 79, 85, 87, 93, 95},
+        {96, 98, 104, 106, 112, 114, 120, 122, 97, 99, 105, 107, 113, 115, 121, 123},
+        {100, 102, 108, 110, 116, 118, 124, 126, 101, 103, 109, 111, 117, 119, 125, 127},
+    };
+
+    constexpr uint8_t kColumn8[16][16] = {
+        {0, 4, 16, 20, 32, 36, 48, 52, 2, 6, 18, 22, 34, 38, 50, 54},
+        {8, 12, 24, 28, 40, 44, 56, 60, 10, 14, 26, 30, 42, 46, 58, 62},
+        {33, 37, 49, 53, 1, 5, 17, 21, 35, 39, 51, 55, 3, 7, 19, 23},
+        {41, 45, 57, 61, 9, 13, 25, 29, 43, 47, 59, 63, 11, 15, 27, 31},
+        {96, 100, 112, 116, 64, 68, 80, 84, 98, 102, 114, 118, 66, 70, 82, 86},
+        {104, 108, 120, 124, 72, 76, 88, 92, 106, 110, 122, 126, 74, 78, 90, 94},
+        {65, 69, 81, 85, 97, 101, 113, 117, 67, 71, 83, 87, 99, 103, 115, 119},
+        {73, 77, 89, 93, 105, 109, 121, 125, 75, 79, 91, 95, 107, 111, 123, 127},
+        {128, 132, 144, 148, 160, 164, 176, 180, 130, 134, 146, 150, 162, 166, 178, 182},
+        {136, 140, 152, 156, 168, 172, 184, 188, 138, 142, 154, 158, 170, 174, 186, 190},
+        {161, 165, 177, 181, 129, 133, 145, 149, 163, 167, 179, 183, 131, 135, 147, 151},
+        {169, 173, 185, 189, 137, 141, 153, 157, 171, 175, 187, 191, 139, 143, 155, 159},
+        {224, 228, 240, 244, 192, 196, 208, 212, 226, 230, 242, 246, 194, 198, 210, 214},
+        {232, 236, 248, 252, 200, 204, 216, 220, 234, 238, 250, 254, 202, 206, 218, 222},
+        {193, 197, 209, 213, 225, 229, 241, 245, 195, 199, 211, 215, 227, 231, 243, 247},
+        {201, 205, 217, 221, 233, 237, 249, 253, 203, 207, 219, 223, 235, 239, 251, 255},
+    };
+
+    constexpr uint16_t kColumn4[16][32] = {
+        {0, 8, 32, 40, 64, 72, 96, 104, 2, 10, 34, 42, 66, 74, 98, 106, 4, 12, 36, 44, 68, 76, 100, 108, 6, 14, 38, 46, 70, 78, 102, 110},
+        {16, 24, 48, 56, 80, 88, 112, 120, 18, 26, 50, 58, 82, 90, 114, 122, 20, 28, 52, 60, 84, 92, 116, 124, 22, 30, 54, 62, 86, 94, 118, 126},
+        {65, 73, 97, 105, 1, 9, 33, 41, 67, 75, 99, 107, 3, 11, 35, 43, 69, 77, 101, 109, 5, 13, 37, 45, 71, 79, 103, 111, 7, 15, 39, 47},
+        {81, 89, 113, 121, 17, 25, 49, 57, 83, 91, 115, 123, 19, 27, 51, 59, 85, 93, 117, 125, 21, 29, 53, 61, 87, 95, 119, 127, 23, 31, 55, 63},
+        {192, 200, 224, 232, 128, 136, 160, 168, 194, 202, 226, 234, 130, 138, 162, 170, 196, 204, 228, 236, 132, 140, 164, 172, 198, 206, 230, 238, 134, 142, 166, 174},
+        {208, 216, 240, 248, 144, 152, 176, 184, 210, 218, 242, 250, 146, 154, 178, 186, 212, 220, 244, 252, 148, 156, 180, 188, 214, 222, 246, 254, 150, 158, 182, 190},
+        {129, 137, 161, 169, 193, 201, 225, 233, 131, 139, 163, 171, 195, 203, 227, 235, 133, 141, 165, 173, 197, 205, 229, 237, 135, 143, 167, 175, 199, 207, 231, 239},
+        {145, 153, 177, 185, 209, 217, 241, 249, 147, 155, 179, 187, 211, 219, 243, 251, 149, 157, 181, 189, 213, 221, 245, 253, 151, 159, 183, 191, 215, 223, 247, 255},
+        {256, 264, 288, 296, 320, 328, 352, 360, 258, 266, 290, 298, 322, 330, 354, 362, 260, 268, 292, 300, 324, 332, 356, 364, 262, 270, 294, 302, 326, 334, 358, 366},
+        {272, 280, 304, 312, 336, 344, 368, 376, 274, 282, 306, 314, 338, 346, 370, 378, 276, 284, 308, 316, 340, 348, 372, 380, 278, 286, 310, 318, 342, 350, 374, 382},
+        {321, 329, 353, 361, 257, 265, 289, 297, 323, 331, 355, 363, 259, 267, 291, 299, 325, 333, 357, 365, 261, 269, 293, 301, 327, 335, 359, 367, 263, 271, 295, 303},
+        {337, 345, 369, 377, 273, 281, 305, 313, 339, 347, 371, 379, 275, 283, 307, 315, 341, 349, 373, 381, 277, 285, 309, 317, 343, 351, 375, 383, 279, 287, 311, 319},
+        {448, 456, 480, 488, 384, 392, 416, 424, 450, 458, 482, 490, 386, 394, 418, 426, 452, 460, 484, 492, 388, 396, 420, 428, 454, 462, 486, 494, 390, 398, 422, 430},
+        {464, 472, 496, 504, 400, 408, 432, 440, 466, 474, 498, 506, 402, 410, 434, 442, 468, 476, 500, 508, 404, 412, 436, 444, 470, 478, 502, 510, 406, 414, 438, 446},
+        {385, 393, 417, 425, 449, 457, 481, 489, 387, 395, 419, 427, 451, 459, 483, 491, 389, 397, 421, 429, 453, 461, 485, 493, 391, 399, 423, 431, 455, 463, 487, 495},
+        {401, 409, 433, 441, 465, 473, 497, 505, 403, 411, 435, 443, 467, 475, 499, 507, 405, 413, 437, 445, 469, 477, 501, 509, 407, 415, 439, 447, 471, 479, 503, 511},
+    };
+
+    // Z formats share the color layouts with the block order inside a page
+    // flipped by 24 (BlockXor).
+    template <uint32_t BlockXor = 0>
+    uint32_t blockNumber32(uint32_t bp, uint32_t bw, uint32_t x, uint32_t y)
+    {
+        return (bp + (y >> 5) * bw * 32u + (x >> 6) * 32u + (kBlock32[(y >> 3) & 3][(x >> 3) & 7] ^ BlockXor)) & kBlockMask;
+    }
+
+    template <uint32_t BlockXor = 0>
+    uint32_t blockNumber16(uint32_t bp, uint32_t bw, uint32_t x, uint32_t y)
+    {
+        return (bp + (y >> 6) * bw * 32u + (x >> 6) * 32u + (kBlock16[(y >> 3) & 7][(x >> 4) & 3] ^ BlockXor)) & kBlockMask;
+    }
+
+    template <uint32_t BlockXor = 0>
+    uint32_t blockNumber16S(uint32_t bp, uint32_t bw, uint32_t x, uint32_t y)
+    {
+        return (bp + (y >> 6) * bw * 32u + (x >> 6) * 32u + (kBlock16S[(y >> 3) & 7][(x >> 4) & 3] ^ BlockXor)) & kBlockMask;
+    }
+
+    // 8-bit and 4-bit pages are 128 pixels wide, so a row of pages spans bw/2 pages.
+    uint32_t blockNumber8(uint32_t bp, uint32_t bw, uint32_t x, uint32_t y)
+    {
+        return (bp + (y >> 6) * (bw >> 1) * 32u + (x >> 7) * 32u + kBlock8[(y >> 4) & 3][(x >> 4) & 7]) & kBlockMask;
+    }
+
+    uint32_t blockNumber4(uint32_t bp, uint32_t bw, uint32_t x, uint32_t y)
+    {
+        return (bp + (y >> 7) * (bw >> 1) * 32u + (x >> 7) * 32u + kBlock4[(y >> 4) & 7][(x >> 5) & 3]) & kBlockMask;
+    }
+
+    template <uint32_t BlockXor = 0>
+    uint32_t wordAddress(uint32_t bp, uint32_t bw, uint32_t x, uint32_t y)
+    {
+        return blockNumber32<BlockXor>(bp, bw, x, y) * kBlockBytes + kColumn32[y & 7][x & 7] * 4u;
+    }
+
+    uint32_t halfAddress(uint32_t psm, uint32_t bp, uint32_t bw, uint32_t x, uint32_t y)
+    {
+        uint32_t block;
+        switch (psm)
+        {
+        case PSMCT16S: block = blockNumber16S(bp, bw, x, y); break;
+        case PSMZ16: block = blockNumber16<24>(bp, bw, x, y); break;
+        case PSMZ16S: block = blockNumber16S<24>(bp, bw, x, y); break;
+        default: block = blockNumber16(bp, bw, x, y); break;
+        }
+        return block * kBlockBytes + kColumn16[y & 7][x & 15] * 2u;
+    }
+
+    uint32_t byteAddress(uint32_t bp, uint32_t bw, uint32_t x, uint32_t y)
+    {
+        return blockNumber8(bp, bw, x, y) * kBlockBytes + kColumn8[y & 15][x & 15];
+    }
+
+    // Nibble index from the start of VRAM.
+    uint32_t nibbleAddress(uint32_t bp, uint32_t bw, uint32_t x, uint32_t y)
+    {
+        return blockNumber4(bp, bw, x, y) * (kBlockBytes * 2u) + kColumn4[y & 15][x & 31];
+    }
+
+    uint32_t loadHost(uint32_t psm, const uint8_t *row, uint32_t x)
+    {
+        switch (psm)
+        {
+        case PSMCT32:
+        {
+            uint32_t value;
+            std::memcpy(&value, row + x * 4u, sizeof(value));
+            return value;
+        }
+        case PSMCT24:
+            return static_cast<uint32_t>(row[x * 3u]) |
+                   (static_cast<uint32_t>(row[x * 3u + 1u]) << 8) |
+                   (static_cast<uint32_t>(row[x * 3u + 2u]) << 16);
+        case PSMCT16:
+        case PSMCT16S:
+        {
+            uint16_t value;
+            std::memcpy(&value, row + x * 2u, sizeof(value));
+            return value;
+        }
+        case PSMT8:
+            return row[x];
+        default:
+            return (row[x >> 1] >> ((x & 1u) * 4u)) & 0xFu;
+        }
+    }
+
+    void storeHost(uint32_t psm, uint8_t *row, uint32_t x, uint32_t value)
+    {
+        switch (psm)
+        {
+        case PSMCT32:
+            std::memcpy(row + x * 4u, &value, sizeof(value));
+            break;
+        case PSMCT24:
+            row[x * 3u] = static_cast<uint8_t>(value);
+            row[x * 3u + 1u] = static_cast<uint8_t>(value >> 8);
+            row[x * 3u + 2u] = static_cast<uint8_t>(value >> 16);
+            break;
+        case PSMCT16:
+        case PSMCT16S:
+        {
+            const uint16_t half = static_cast<uint16_t>(value);
+            std::memcpy(row + x * 2u, &half, sizeof(half));
+            break;
+        }
+        case PSMT8:
+            row[x] = static_cast<uint8_t>(value);
+            break;
+        default:
+        {
+            const uint32_t shift = (x & 1u) * 4u;
+            row[x >> 1] = static_cast<uint8_t>((row[x >> 1] & ~(0xFu << shift)) | ((value & 0xFu) << shift));
+            break;
+        }
+        }
+    }
+
+    // A PSMCT32 block is four 64-byte columns; each column interleaves two rows of
+    // eight pixels in pairs, so two 64-bit unpacks per output vector place them.
+    void writeBlock32(uint8_t *block, const uint8_t *src, size_t pitch)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            const uint8_t *row0 = src + static_cast<size_t>(column * 2) * pitch;
+            const uint8_t *row1 = row0 + pitch;
+            const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0));
+            const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 16));
+            const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1));
+            const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 16));
+            __m128i *dst = reinterpret_cast<__m128i *>(block + column * 64);
+            _mm_storeu_si128(dst + 0, _mm_unpacklo_epi64(a0, b0));
+            _mm_storeu_si128(dst + 1, _mm_unpackhi_epi64(a0, b0));
+            _mm_storeu_si128(dst + 2, _mm_unpacklo_epi64(a1, b1));
+            _mm_storeu_si128(dst + 3, _mm_unpackhi_epi64(a1, b1));
+        }
+    }
+
+    void readBlock32(const uint8_t *block, uint8_t *dst, size_t pitch)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            const __m128i *src = reinterpret_cast<const __m128i *>(block + column * 64);
+            const __m128i c0 = _mm_loadu_si128(src + 0);
+            const __m128i c1 = _mm_loadu_si128(src + 1);
+            const __m128i c2 = _mm_loadu_si128(src + 2);
+            const __m128i c3 = _mm_loadu_si128(src + 3);
+            uint8_t *row0 = dst + static_cast<size_t>(column * 2) * pitch;
+            uint8_t *row1 = row0 + pitch;
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row0), _mm_unpacklo_epi64(c0, c1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row0 + 16), _mm_unpacklo_epi64(c2, c3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row1), _mm_unpackhi_epi64(c0, c1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row1 + 16), _mm_unpackhi_epi64(c2, c3));
+        }
+    }
+
+    // PSMCT16 columns hold pixels x and x + 8 in the same word, then follow the
+    // PSMCT32 pair order; one 16-bit interleave in front of the 32-bit pattern.
+    void writeBlock16(uint8_t *block, const uint8_t *src, size_t pitch)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            const uint8_t *row0 = src + static_cast<size_t>(column * 2) * pitch;
+            const uint8_t *row1 = row0 + pitch;
+            const __m128i r0lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0));
+            const __m128i r0hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 16));
+            const __m128i r1lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1));
+            const __m128i r1hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 16));
+            const __m128i a0 = _mm_unpacklo_epi16(r0lo, r0hi);
+            const __m128i a1 = _mm_unpackhi_epi16(r0lo, r0hi);
+            const __m128i b0 = _mm_unpacklo_epi16(r1lo, r1hi);
+            const __m128i b1 = _mm_unpackhi_epi16(r1lo, r1hi);
+            __m128i *dst = reinterpret_cast<__m128i *>(block + column * 64);
+            _mm_storeu_si128(dst + 0, _mm_unpacklo_epi64(a0, b0));
+            _mm_storeu_si128(dst + 1, _mm_unpackhi_epi64(a0, b0));
+            _mm_storeu_si128(dst + 2, _mm_unpacklo_epi64(a1, b1));
+            _mm_storeu_si128(dst + 3, _mm_unpackhi_epi64(a1, b1));
+        }
+    }
+
+    void readBlock16(const uint8_t *block, uint8_t *dst, size_t pitch)
+    {
+        // Even halfwords to the low qword, odd halfwords to the high qword.
+        const __m128i split = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+        for (int column = 0; column < 4; ++column)
+        {
+            const __m128i *src = reinterpret_cast<const __m128i *>(block + column * 64);
+            const __m128i c0 = _mm_loadu_si128(src + 0);
+            const __m128i c1 = _mm_loadu_si128(src + 1);
+            const __m128i c2 = _mm_loadu_si128(src + 2);
+            const __m128i c3 = _mm_loadu_si128(src + 3);
+            const __m128i a0 = _mm_shuffle_epi8(_mm_unpacklo_epi64(c0, c1), split);
+            const __m128i b0 = _mm_shuffle_epi8(_mm_unpackhi_epi64(c0, c1), split);
+            const __m128i a1 = _mm_shuffle_epi8(_mm_unpacklo_epi64(c2, c3), split);
+            const __m128i b1 = _mm_shuffle_epi8(_mm_unpackhi_epi64(c2, c3), split);
+            uint8_t *row0 = dst + static_cast<size_t>(column * 2) * pitch;
+            uint8_t *row1 = row0 + pitch;
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row0), _mm_unpacklo_epi64(a0, a1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row0 + 16), _mm_unpackhi_epi64(a0, a1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row1), _mm_unpacklo_epi64(b0, b1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row1 + 16), _mm_unpackhi_epi64(b0, b1));
+        }
+    }
+
+    // PSMCT24 goes through the 32-bit kernels with the VRAM alpha byte preserved.
+    void writeBlock24(uint8_t *block, const uint8_t *src, size_t pitch)
+    {
+        alignas(16) uint8_t pixels[8 * 32];
+        readBlock32(block, pixels, 32);
+        for (uint32_t y = 0; y < 8; ++y)
+        {
+            const uint8_t *in = src + y * pitch;
+            uint8_t *out = pixels + y * 32u;
+            for (uint32_t x = 0; x < 8; ++x)
+            {
+                out[x * 4u] = in[x * 3u];
+                out[x * 4u + 1u] = in[x * 3u + 1u];
+                out[x * 4u + 2u] = in[x * 3u + 2u];
+            }
+        }
+        writeBlock32(block, pixels, 32);
+    }
+
+    void readBlock24(const uint8_t *block, uint8_t *dst, size_t pitch)
+    {
+        alignas(16) uint8_t pixels[8 * 32];
+        readBlock32(block, pixels, 32);
+        for (uint32_t y = 0; y < 8; ++y)
+        {
+            const uint8_t *in = pixels + y * 32u;
+            uint8_t *out = dst + y * pitch;
+            for (uint32_t x = 0; x < 8; ++x)
+            {
+                out[x * 3u] = in[x * 4u];
+                out[x * 3u + 1u] = in[x * 4u + 1u];
+                out[x * 3u + 2u] = in[x * 4u + 2u];
+            }
+        }
+    }
+
+    void writeBlock8(uint8_t *block, const uint8_t *src, size_t pitch)
+    {
+        for (uint32_t y = 0; y < 16; ++y)
+        {
+            const uint8_t *in = src + y * pitch;
+            for (uint32_t x = 0; x < 16; ++x)
+                block[kColumn8[y][x]] = in[x];
+        }
+    }
+
+    void readBlock8(const uint8_t *block, uint8_t *dst, size_t pitch)
+    {
+        for (uint32_t y = 0; y < 16; ++y)
+        {
+            uint8_t *out = dst + y * pitch;
+            for (uint32_t x = 0; x < 16; ++x)
+                out[x] = block[kColumn8[y][x]];
+        }
+    }
+
+    void writeBlock4(uint8_t *block, const uint8_t *src, size_t pitch)
+    {
+        for (uint32_t y = 0; y < 16; ++y)
+        {
+            const uint8_t *in = src + y * pitch;
+            for (uint32_t x = 0; x < 32; ++x)
+            {
+                const uint32_t nibble = kColumn4[y][x];
+                const uint32_t shift = (nibble & 1u) * 4u;
+                const uint32_t value = (in[x >> 1] >> ((x & 1u) * 4u)) & 0xFu;
+                uint8_t &byte = block[nibble >> 1];
+                byte = static_cast<uint8_t>((byte & ~(0xFu << shift)) | (value << shift));
+            }
+        }
+    }
+
+    void readBlock4(const uint8_t *block, uint8_t *dst, size_t pitch)
+    {
+        for (uint32_t y = 0; y < 16; ++y)
+        {
+            uint8_t *out = dst + y * pitch;
+            for (uint32_t x = 0; x < 32; x += 2)
+            {
+                const uint32_t lo = kColumn4[y][x];
+                const uint32_t hi = kColumn4[y][x + 1u];
+                out[x >> 1] = static_cast<uint8_t>(((block[lo >> 1] >> ((lo & 1u) * 4u)) & 0xFu) |
+                                                   (((block[hi >> 1] >> ((hi & 1u) * 4u)) & 0xFu) << 4));
+            }
+        }
+    }
+
+    struct BlockKernels
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t (*blockNumber)(uint32_t, uint32_t, uint32_t, uint32_t);
+        void (*write)(uint8_t *, const uint8_t *, size_t);
+        void (*read)(const uint8_t *, uint8_t *, size_t);
+    };
+
+    const BlockKernels *kernelsFor(uint32_t psm)
+    {
+        static const BlockKernels k32{8, 8, blockNumber32<>, writeBlock32, readBlock32};
+        static const BlockKernels k24{8, 8, blockNumber32<>, writeBlock24, readBlock24};
+        static const BlockKernels k16{16, 8, blockNumber16<>, writeBlock16, readBlock16};
+        static const BlockKernels k16S{16, 8, blockNumber16S<>, writeBlock16, readBlock16};
+        static const BlockKernels k8{16, 16, blockNumber8, writeBlock8, readBlock8};
+        static const BlockKernels k4{32, 16, blockNumber4, writeBlock4, readBlock4};
+        switch (psm)
+        {
+        case PSMCT32:
+            return &k32;
+        case PSMCT24:
+            return &k24;
+        case PSMCT16:
+            return &k16;
+        case PSMCT16S:
+            return &k16S;
+        case PSMT8:
+            return &k8;
+        case PSMT4:
+            return &k4;
+        default:
+            return nullptr;
+        }
+    }
+
+    // Host byte offset of pixel column x in a row; block kernels for PSMT4 start
+    // on 32-pixel boundaries, so the division is always exact there.
+    size_t hostOffset(uint32_t psm, uint32_t x)
+    {
+        return (psm == PSMT4) ? (x >> 1) : rowBytes(psm, x);
+    }
+
+    template <bool Write, typename VramPtr, typename HostPtr>
+    void transfer(VramPtr vram, uint32_t psm, uint32_t bp, uint32_t bw,
+                  uint32_t x0, uint32_t y0, uint32_t w, uint32_t h,
+                  HostPtr host, size_t pitch)
+    {
+        const BlockKernels *kernels = kernelsFor(psm);
+        if (!vram || !host || !kernels || w == 0 || h == 0)
+        {
+            return;
+        }
+
+        auto pixel = [&](uint32_t x, uint32_t y)
+        {
+            if constexpr (Write)
+                writePixel(vram, psm, bp, bw, x0 + x, y0 + y, loadHost(psm, host + y * pitch, x));
+            else
+                storeHost(psm, host + y * pitch, x, readPixel(vram, psm, bp, bw, x0 + x, y0 + y));
+        };
+
+        const uint32_t bwMask = kernels->width - 1u;
+        const uint32_t bhMask = kernels->height - 1u;
+        // Block-aligned interior in image coordinates.
+        const uint32_t ax = ((x0 + bwMask) & ~bwMask) - x0;
+        const uint32_t ay = ((y0 + bhMask) & ~bhMask) - y0;
+        // PSMT4 block kernels need the host row to start on a whole byte.
+        const bool blocksUsable = ax < w && (psm != PSMT4 || (ax & 1u) == 0);
+        const uint32_t ex = blocksUsable ? ax + ((w - ax) & ~bwMask) : ax;
+        const uint32_t ey = (ay < h) ? ay + ((h - ay) & ~bhMask) : ay;
+
+        for (uint32_t y = 0; y < h;)
+        {
+            if (y < ay || y >= ey)
+            {
+                for (uint32_t x = 0; x < w; ++x)
+                    pixel(x, y);
+                ++y;
+                continue;
+            }
+
+            for (uint32_t x = 0; x < w;)
+            {
+                if (x < ax || x >= ex)
+                {
+                    for (uint32_t row = 0; row < kernels->height; ++row)
+                        pixel(x, y + row);
+                    ++x;
+                    continue;
+                }
+
+                const size_t block = static_cast<size_t>(kernels->blockNumber(bp, bw, x0 + x, y0 + y)) * kBlockBytes;
+                const size_t offset = y * pitch + hostOffset(psm, x);
+                if constexpr (Write)
+                    kernels->write(vram + block, host + offset, pitch);
+                else
+                    kernels->read(vram + block, host + offset, pitch);
+                x += kernels->width;
+            }
+            y += kernels->height;
+        }
+    }
+}
+
+namespace ps2_gs_swizzle
+{
+    bool isSupported(uint32_t psm)
+    {
+        return kernelsFor(psm) != nullptr;
+    }
+
+    size_t rowBytes(uint32_t psm, uint32_t width)
+    {
+        switch (psm)
+        {
+        case PSMCT32:
+            return static_cast<size_t>(width) * 4u;
+        case PSMCT24:
+            return static_cast<size_t>(width) * 3u;
+        case PSMCT16:
+        case PSMCT16S:
+            return static_cast<size_t>(width) * 2u;
+        case PSMT8:
+            return width;
+        case PSMT4:
+            return (static_cast<size_t>(width) + 1u) / 2u;
+        default:
+            return static_cast<size_t>(width) * 4u;
+        }
+    }
+
+    uint32_t pixelOffset(uint32_t psm, uint32_t bp, uint32_t bw, uint32_t x, uint32_t y)
+    {
+        switch (psm)
+        {
+        case PSMCT32:
+        case PSMCT24:
+            return wordAddress(bp, bw, x, y);
+        case PSMZ32:
+        case PSMZ24:
+            return wordAddress<24>(bp, bw, x, y);
+        case PSMCT16:
+        case PSMCT16S:
+        case PSMZ16:
+        case PSMZ16S:
+            return halfAddress(psm, bp, bw, x, y);
+        case PSMT8:
+            return byteAddress(bp, bw, x, y);
+        default:
+            return 0;
+        }
+    }
+
+    uint32_t readPixel(const uint8_t *vram, uint32_t psm, uint32_t bp, uint32_t bw, uint32_t x, uint32_t y)
+    {
+        switch (psm)
+        {
+        case PSMCT32:
+        case PSMCT24:
+        case PSMZ32:
+        case PSMZ24:
+        {
+            uint32_t value;
+            std::memcpy(&value, vram + pixelOffset(psm, bp, bw, x, y), sizeof(value));
+            return (psm == PSMCT24 || psm == PSMZ24) ? (value & 0x00FFFFFFu) : value;
+        }
+        case PSMCT16:
+        case PSMCT16S:
+        case PSMZ16:
+        case PSMZ16S:
+        {
+            uint16_t value;
+            std::memcpy(&value, vram + halfAddress(psm, bp, bw, x, y), sizeof(value));
+            return value;
+        }
+        case PSMT8:
+            return vram[byteAddress(bp, bw, x, y)];
+        case PSMT4:
+        {
+            const uint32_t nibble = nibbleAddress(bp, bw, x, y);
+            return (vram[(nibble >> 1) & kVramMask] >> ((nibble & 1u) * 4u)) & 0xFu;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    void writePixel(uint8_t *vram, uint32_t psm, uint32_t bp, uint32_t bw, uint32_t x, uint32_t y, uint32_t value)
+    {
+        switch (psm)
+        {
+        case PSMCT32:
+        case PSMZ32:
+            std::memcpy(vram + pixelOffset(psm, bp, bw, x, y), &value, sizeof(value));
+            break;
+        case PSMCT24:
+        case PSMZ24:
+        {
+            uint8_t *dst = vram + pixelOffset(psm, bp, bw, x, y);
+            dst[0] = static_cast<uint8_t>(value);
+            dst[1] = static_cast<uint8_t>(value >> 8);
+            dst[2] = static_cast<uint8_t>(value >> 16);
+            break;
+        }
+        case PSMCT16:
+        case PSMCT16S:
+        case PSMZ16:
+        case PSMZ16S:
+        {
+            const uint16_t half = static_cast<uint16_t>(value);
+            std::memcpy(vram + halfAddress(psm, bp, bw, x, y), &half, sizeof(half));
+            break;
+        }
+        case PSMT8:
+            vram[byteAddress(bp, bw, x, y)] = static_cast<uint8_t>(value);
+            break;
+        case PSMT4:
+        {
+            const uint32_t nibble = nibbleAddress(bp, bw, x, y);
+            const uint32_t shift = (nibble & 1u) * 4u;
+            uint8_t &byte = vram[(nibble >> 1) & kVramMask];
+            byte = static_cast<uint8_t>((byte & ~(0xFu << shift)) | ((value & 0xFu) << shift));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    void writeImage(uint8_t *vram, uint32_t psm, uint32_t bp, uint32_t bw,
+                    uint32_t x, uint32_t y, uint32_t w, uint32_t h,
+                    const uint8_t *src, size_t pitch)
+    {
+        transfer<true>(vram, psm, bp, bw, x, y, w, h, src, pitch);
+    }
+
+    void readImage(const uint8_t *vram, uint32_t psm, uint32_t bp, uint32_t bw,
+                   uint32_t x, uint32_t y, uint32_t w, uint32_t h,
+                   uint8_t *dst, size_t pitch)
+    {
+        transfer<false>(vram, psm, bp, bw, x, y, w, h, dst, pitch);
+    }
+}
@@ -0,0 +1,344 @@
+#include "ps2_log.h"
+#include <ThreadNaming.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    using namespace ps2_log;
+
+    constexpr size_t kRingSize = 4096; // power of two
+    constexpr auto kIdleSleep = std::chrono::milliseconds(1);
+
+    constexpr const char *kCategoryNames[kCategoryCount] = {
+        "runtime", "dispatch", "memory", "syscall", "io", "vblank", "interrupt", "gs", "dma", "vif", "vu"};
+    constexpr const char *kLevelNames[] = {"trace", "debug", "info", "warn", "error", "off"};
+
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence{0};
+        Level level = Level::Info;
+        Category category = Category::Runtime;
+        uint16_t length = 0;
+        char text[kMaxMessage + 32]; // message plus the suppression note
+    };
+
+    // Bounded MPSC ring (Vyukov's sequence-numbered slots): producers claim a
+    // slot with one CAS, the writer thread is the only consumer.
+    class Logger
+    {
+    public:
+        Logger()
+        {
+            for (size_t i = 0; i < kRingSize; ++i)
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            m_writer = std::thread([this]()
+                                   {
+                ThreadNaming::SetCurrentThreadName("LogWriterThread");
+                writerLoop(); });
+        }
+
+        void push(Level level, Category category, std::string_view text)
+        {
+            if (m_stopped.load(std::memory_order_acquire))
+            {
+                emit(level, category, text); // after shutdown: write directly
+                return;
+            }
+
+            uint64_t pos = m_head.load(std::memory_order_relaxed);
+            Slot *slot = nullptr;
+            while (true)
+            {
+                slot = &m_slots[pos & (kRingSize - 1)];
+                const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+                if (diff == 0)
+                {
+                    if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                else
+                {
+                    pos = m_head.load(std::memory_order_relaxed);
+                }
+            }
+
+            slot->level = level;
+            slot->category = category;
+            slot->length = static_cast<uint16_t>(std::min(text.size(), sizeof(slot->text)));
+            std::memcpy(slot->text, text.data(), slot->length);
+            slot->sequence.store(pos + 1, std::memory_order_release);
+        }
+
+        void flush()
+        {
+            const uint64_t target = m_head.load(std::memory_order_acquire);
+            while (!m_stopped.load(std::memory_order_acquire) &&
+                   m_written.load(std::memory_order_acquire) < target)
+            {
+                std::this_thread::sleep_for(kIdleSleep);
+            }
+        }
+
+        void stop()
+        {
+            if (m_stopped.exchange(true, std::memory_order_acq_rel))
+                return;
+            if (m_writer.joinable())
+                m_writer.join();
+        }
+
+        void setSink(Sink sink)
+        {
+            std::lock_guard<std::mutex> lock(m_sinkMutex);
+            m_sink = std::move(sink);
+        }
+
+        uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        void writerLoop()
+        {
+            uint64_t reportedDrops = 0;
+            while (true)
+            {
+                const bool stopping = m_stopped.load(std::memory_order_acquire);
+                size_t drained = 0;
+                Slot *slot = nullptr;
+                while ((slot = &m_slots[m_tail & (kRingSize - 1)])->sequence.load(std::memory_order_acquire) == m_tail + 1)
+                {
+                    emit(slot->level, slot->category, std::string_view(slot->text, slot->length));
+                    slot->sequence.store(m_tail + kRingSize, std::memory_order_release);
+                    ++m_tail;
+                    ++drained;
+                    m_written.store(m_tail, std::memory_order_release);
+                }
+
+                const uint64_t drops = m_dropped.load(std::memory_order_relaxed);
+                if (drops != reportedDrops)
+                {
+                    std::cerr << "[log] " << (drops - reportedDrops) << " message(s) dropped, ring full\n";
+                    reportedDrops = drops;
+                }
+                if (drained != 0)
+                {
+                    std::cout.flush();
+                    std::cerr.flush();
+                }
+                if (stopping)
+                    break;
+                if (drained == 0)
+                    std::this_thread::sleep_for(kIdleSleep);
+            }
+        }
+
+        void emit(Level level, Category category, std::string_view text)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_sinkMutex);
+                if (m_sink)
+                {
+                    m_sink(level, category, text);
+                    return;
+                }
+            }
+            std::ostream &out = (level >= Level::Warn) ? std::cerr : std::cout;
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+            out.put('\n');
+        }
+
+        std::array<Slot, kRingSize> m_slots;
+        alignas(64) std::atomic<uint64_t> m_head{0};
+        alignas(64) uint64_t m_tail = 0; // writer thread only
+        std::atomic<uint64_t> m_written{0};
+        std::atomic<uint64_t> m_dropped{0};
+        std::atomic<bool> m_stopped{false};
+        std::thread m_writer;
+        std::mutex m_sinkMutex;
+        Sink m_sink;
+    };
+
+    Logger &logger()
+    {
+        // Never destroyed: statics may still log during exit. The writer is
+        // drained and joined from atexit instead.
+        static Logger *instance = []()
+        {
+            Logger *created = new Logger();
+            std::atexit([]()
+                        { logger().stop(); });
+            return created;
+        }();
+        return *instance;
+    }
+
+    bool parseLevel(std::string_view text, Level &level)
+    {
+        for (size_t i = 0; i < std::size(kLevelNames); ++i)
+        {
+            if (text == kLevelNames[i])
+            {
+                level = static_cast<Level>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string_view trim(std::string_view text)
+    {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+            text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+            text.remove_suffix(1);
+        return text;
+    }
+
+    // PS2_LOG_LEVEL applies before the first message is even considered.
+    const bool g_environmentApplied = []()
+    {
+        if (const char *spec = std::getenv("PS2_LOG_LEVEL"))
+            configure(spec);
+        return true;
+    }();
+}
+
+namespace ps2_log
+{
+    void setLevel(Category category, Level level)
+    {
+        if (category < Category::Count)
+            g_thresholds[static_cast<size_t>(category)].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+    }
+
+    void setLevel(Level level)
+    {
+        for (auto &threshold : g_thresholds)
+            threshold.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+    }
+
+    bool configure(std::string_view spec)
+    {
+        bool ok = true;
+        while (!spec.empty())
+        {
+            const size_t comma = spec.find(',');
+            const std::string_view item = trim(spec.substr(0, comma));
+            spec = (comma == std::string_view::npos) ? std::string_view{} : spec.substr(comma + 1);
+            if (item.empty())
+                continue;
+
+            const size_t equals = item.find('=');
+            Level level = Level::Info;
+            if (equals == std::string_view::npos)
+            {
+                if (parseLevel(item, level))
+                {
+                    setLevel(level);
+                    continue;
+                }
+            }
+            else if (parseLevel(trim(item.substr(equals + 1)), level))
+            {
+                const std::string_view categoryName = trim(item.substr(0, equals));
+                bool found = false;
+                for (size_t i = 0; i < kCategoryCount; ++i)
+                {
+                    if (categoryName == kCategoryNames[i])
+                    {
+                        setLevel(static_cast<Category>(i), level);
+                        found = true;
+                        break;
+                    }
+                }
+                if (found)
+                    continue;
+            }
+
+            std::cerr << "[log] ignoring log level setting '" << item << "'" << std::endl;
+            ok = false;
+        }
+        return ok;
+    }
+
+    const char *name(Category category)
+    {
+        return category < Category::Count ? kCategoryNames[static_cast<size_t>(category)] : "?";
+    }
+
+    void setSink(Sink sink)
+    {
+        logger().setSink(std::move(sink));
+    }
+
+    void flush()
+    {
+        logger().flush();
+    }
+
+    uint64_t droppedCount()
+    {
+        return logger().dropped();
+    }
+
+    void write(Level level, Category category, std::string_view text)
+    {
+        logger().push(level, category, text);
+    }
+
+    bool RateLimit::allow(uint64_t &suppressed)
+    {
+        const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count();
+        int64_t windowStart = m_windowStart.load(std::memory_order_relaxed);
+        if ((windowStart < 0 || now - windowStart >= 1000) &&
+            m_windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+        {
+            m_count.store(0, std::memory_order_relaxed);
+        }
+
+        if (m_count.fetch_add(1, std::memory_order_relaxed) < m_perSecond)
+        {
+            suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        m_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Line::Line(Level level, Category category, uint64_t suppressed)
+        : m_level(level), m_category(category), m_suppressed(suppressed),
+          m_buffer(m_text, m_text + sizeof(m_text)), m_stream(&m_buffer)
+    {
+    }
+
+    Line::~Line()
+    {
+        std::string_view text(m_text, m_buffer.size());
+        char withNote[kMaxMessage + 32];
+        if (m_suppressed != 0)
+        {
+            const size_t room = sizeof(withNote) - text.size();
+            const int note = std::snprintf(withNote + text.size(), room,
+                                           " [+%llu suppressed]", static_cast<unsigned long long>(m_suppressed));
+            std::memcpy(withNote, text.data(), text.size());
+            text = std::string_view(withNote, text.size() + std::min(static_cast<size_t>(std::max(note, 0)), room - 1));
+        }
+        write(m_level, m_category, text);
+    }
+}
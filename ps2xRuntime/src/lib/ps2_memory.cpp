@@ -1,5 +1,8 @@
 #include "ps2_memory.h"
+#include "ps2_gs_swizzle.h"
+#include "ps2_log.h"
 #include <iostream>
+#include <cstdlib>
 #include <cstring>
 #include <stdexcept>
 #include <algorithm>
@@ -84,24 +87,48 @@ namespace
         }
     }
 
-}
+    inline uint64_t loadGsReg(GSRegisters &gs, uint64_t *reg)
+    {
+        if (reg == &gs.csr || reg == &gs.siglblid)
+            return std::atomic_ref<uint64_t>(*reg).load(std::memory_order_acquire);
+        return *reg;
+    }
+
+    // EE store to the bits of a privileged GS register selected by mask.
+    inline void storeGsReg(GSRegisters &gs, uint64_t *reg, uint64_t value, uint64_t mask)
+    {
+        if (reg == &gs.csr)
+        {
+            // Writing 1 to an event bit acknowledges it; writing 0 keeps it.
+            const uint64_t ack = value & mask & kGsCsrEventBits;
+            const uint64_t stored = mask & ~kGsCsrEventBits;
+            updateGsRegister(gs.csr, [&](uint64_t csr)
+                             { return ((csr & ~stored) | (value & stored)) & ~ack; });
+        }
+        else if (reg == &gs.siglblid)
+        {
+            updateGsRegister(gs.siglblid, [&](uint64_t id)
+                             { return (id & ~mask) | (value & mask); });
+        }
+        else
+        {
+            *reg = (*reg & ~mask) | (value & mask);
+        }
+    }
 
-// Helpers for GS VRAM addressing (PSMCT32 path).
-static inline uint32_t gs_vram_offset(uint32_t basePage, uint32_t x, uint32_t y, uint32_t fbw)
-{
-    // basePage is in 2048-byte units; fbw is in blocks of 64 pixels.
-    uint32_t strideBytes = fbw * 64 * 4;
-    return basePage * 2048 + y * strideBytes + x * 4;
 }
 
 PS2Memory::PS2Memory()
-    : m_rdram(nullptr), m_scratchpad(nullptr), iop_ram(nullptr), m_seenGifCopy(false), m_gsVRAM(nullptr)
+    : m_rdram(nullptr), m_scratchpad(nullptr), iop_ram(nullptr), m_seenGifCopy(false), m_gsVRAM(nullptr),
+      m_vuMemory(nullptr)
 {
     ps2SetScratchpadHostPtr(nullptr);
 }
 
 PS2Memory::~PS2Memory()
 {
+    m_gsPipeline.stop();
+
     if (m_rdram)
     {
         delete[] m_rdram;
@@ -126,6 +153,12 @@ PS2Memory::~PS2Memory()
         delete[] iop_ram;
         iop_ram = nullptr;
     }
+
+    if (m_vuMemory)
+    {
+        delete[] m_vuMemory;
+        m_vuMemory = nullptr;
+    }
 }
 
 bool PS2Memory::initialize(size_t ramSize)
@@ -136,13 +169,16 @@ bool PS2Memory::initialize(size_t ramSize)
         delete[] m_scratchpad;
         delete[] iop_ram;
         delete[] m_gsVRAM;
+        delete[] m_vuMemory;
         m_rdram = nullptr;
         m_scratchpad = nullptr;
         ps2SetScratchpadHostPtr(nullptr);
         iop_ram = nullptr;
         m_gsVRAM = nullptr;
+        m_vuMemory = nullptr;
     };
 
+    m_gsPipeline.drain();
     cleanup();
     m_seenGifCopy = false;
     m_dmaStartCount.store(0, std::memory_order_relaxed);
@@ -181,13 +217,65 @@ bool PS2Memory::initialize(size_t ramSize)
         m_gsVRAM = new uint8_t[PS2_GS_VRAM_SIZE];
         std::memset(m_gsVRAM, 0, PS2_GS_VRAM_SIZE);
 
+        // Allocate VU micro/data memory
+        m_vuMemory = new uint8_t[PS2_VU_MEM_SIZE];
+        std::memset(m_vuMemory, 0, PS2_VU_MEM_SIZE);
+
         // Initialize VIF registers
         memset(&vif0_regs, 0, sizeof(vif0_regs));
         memset(&vif1_regs, 0, sizeof(vif1_regs));
+        m_vif[0].attach(0, &vif0_regs, getVUCode(0), PS2_VU0_CODE_SIZE, getVUData(0), PS2_VU0_DATA_SIZE);
+        m_vif[1].attach(1, &vif1_regs, getVUCode(1), PS2_VU1_CODE_SIZE, getVUData(1), PS2_VU1_DATA_SIZE);
+        m_vif[1].setDirectHandler([this](const uint8_t *data, uint32_t bytes)
+        {
+            submitGifPacket(2, data, bytes);
+        });
+        for (uint32_t unit = 0; unit < 2; ++unit)
+        {
+            m_vu[unit].attach(unit, getVUCode(unit), unit ? PS2_VU1_CODE_SIZE : PS2_VU0_CODE_SIZE, getVUData(unit),
+                              unit ? PS2_VU1_DATA_SIZE : PS2_VU0_DATA_SIZE, &vif(unit));
+            m_vif[unit].setMicroHandler([this, unit](uint32_t pc)
+            {
+                m_vu[unit].start(pc);
+            });
+            m_vif[unit].setUploadHandler([this, unit](uint32_t offset, uint32_t bytes)
+            {
+                m_vu[unit].upload(offset, bytes);
+            });
+        }
+        m_vu[1].setKickHandler([this](const uint8_t *packet, uint32_t bytes)
+        {
+            submitGifPacket(1, packet, bytes);
+        });
 
         // Initialize DMA registers
         memset(dma_regs, 0, sizeof(dma_regs));
 
+        m_gsPipeline.attach(m_gsVRAM, &gs_regs);
+        for (auto &path : m_gifPaths)
+            path.reset();
+        m_gifStream.clear();
+
+        for (auto &state : m_dmaState)
+            state = DmaChannelState{};
+        setDmaSink(0x1000A000, [this](const uint8_t *data, uint32_t bytes)
+        {
+            submitGifPacket(3, data, bytes);
+        });
+        setDmaSink(0x10008000, [this](const uint8_t *data, uint32_t bytes)
+        {
+            feedVif(0, data, bytes);
+        });
+        setDmaSink(0x10009000, [this](const uint8_t *data, uint32_t bytes)
+        {
+            feedVif(1, data, bytes);
+        });
+
+        uint32_t dmaBudget = 0;
+        if (const char *budget = std::getenv("PS2_DMA_QW_PER_FRAME"))
+            dmaBudget = static_cast<uint32_t>(std::strtoul(budget, nullptr, 0));
+        setDmaBudget(dmaBudget);
+
         return true;
     }
     catch (const std::exception &e)
@@ -198,6 +286,107 @@ bool PS2Memory::initialize(size_t ramSize)
     }
 }
 
+void PS2Memory::submitGifPacket(uint32_t path, const uint8_t *data, uint32_t bytes)
+{
+    if (path < 1 || path > 3)
+        return;
+    std::lock_guard<std::mutex> lock(m_gifMutex);
+    m_gifPaths[path - 1].feed(data, bytes, m_gifStream);
+    m_gsPipeline.submit(m_gifStream);
+    m_seenGifCopy = true;
+    m_gifCopyCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PS2Memory::enableFrameOutput(uint32_t width, uint32_t height)
+{
+    m_gsPipeline.drain();
+    m_frames.resize(width, height);
+    m_frameOutput.store(true, std::memory_order_release);
+}
+
+void PS2Memory::publishFrame()
+{
+    if (!m_frameOutput.load(std::memory_order_acquire) || !m_gsVRAM)
+        return;
+
+    const GSRegisters display = gs_regs;
+    m_gsPipeline.fence([this, display]()
+    {
+        uint32_t *pixels = m_frames.back();
+        if (!ps2_gs_display::compose(m_gsVRAM, display, pixels, m_frames.width(), m_frames.height(), m_frameScratch))
+        {
+            // I can`t stand a random RAM glitch screen so lets use some magenta to calm down
+            std::fill(pixels, pixels + static_cast<size_t>(m_frames.width()) * m_frames.height(), 0xFFFF00FFu);
+        }
+        m_frames.publish();
+    });
+}
+
+void PS2Memory::feedVif(uint32_t unit, const uint8_t *data, uint32_t bytes)
+{
+    if (unit > 1)
+        return;
+    std::lock_guard<std::mutex> lock(m_vifMutex[unit]);
+    m_vif[unit].feed(data, bytes);
+}
+
+void PS2Memory::setVuMicroHandler(uint32_t unit, ps2_vif::Processor::MicroHandler handler)
+{
+    if (unit > 1)
+        return;
+    std::lock_guard<std::mutex> lock(m_vifMutex[unit]);
+    m_vif[unit].setMicroHandler(std::move(handler));
+}
+
+void PS2Memory::registerVuProgram(const ps2_vu::ProgramInfo &info)
+{
+    if (info.unit > 1)
+        return;
+    std::lock_guard<std::mutex> lock(m_vifMutex[info.unit]);
+    m_vu[info.unit].registerProgram(info);
+}
+
+uint8_t *PS2Memory::vuMemoryPtr(uint32_t physAddr, uint32_t bytes)
+{
+    if (!m_vuMemory || physAddr < PS2_VU0_CODE_BASE || physAddr - PS2_VU0_CODE_BASE + bytes > PS2_VU_MEM_SIZE)
+        return nullptr;
+    return m_vuMemory + (physAddr - PS2_VU0_CODE_BASE);
+}
+
+uint8_t *PS2Memory::vuStorePtr(uint32_t physAddr, uint32_t bytes)
+{
+    uint8_t *vu = vuMemoryPtr(physAddr, bytes);
+    if (!vu)
+        return nullptr;
+    for (uint32_t unit = 0; unit < 2; ++unit)
+    {
+        const uint32_t base = unit ? PS2_VU1_CODE_BASE : PS2_VU0_CODE_BASE;
+        const uint32_t size = unit ? PS2_VU1_CODE_SIZE : PS2_VU0_CODE_SIZE;
+        if (physAddr >= base && physAddr < base + size)
+        {
+            std::lock_guard<std::mutex> lock(m_vifMutex[unit]);
+            m_vu[unit].invalidate(physAddr - base, bytes);
+        }
+    }
+    return vu;
+}
+
+// VIF0 at 0x10003800, VIF1 at 0x10003C00. STAT..TOP sit every 0x10 bytes in
+// VIFRegisters order, then R0-R3 at 0x100 and C0-C3 at 0x140.
+uint32_t *PS2Memory::vifRegisterPtr(uint32_t address)
+{
+    const uint32_t offset = address & 0x3FFu;
+    if (offset & 0xFu)
+        return nullptr;
+    VIFRegisters &regs = vif((address & 0x400u) ? 1u : 0u);
+    uint32_t *fields = reinterpret_cast<uint32_t *>(&regs);
+    if (offset < 0xF0u)
+        return fields + (offset >> 4);
+    if (offset >= 0x100u && offset < 0x180u)
+        return fields + 15u + ((offset - 0x100u) >> 4);
+    return nullptr;
+}
+
 bool PS2Memory::isScratchpad(uint32_t address) const
 {
     return address >= PS2_SCRATCHPAD_BASE &&
@@ -320,6 +509,10 @@ uint8_t PS2Memory::read8(uint32_t address)
         uint32_t shift = (physAddr & 3) * 8;
         return static_cast<uint8_t>((value >> shift) & 0xFF);
     }
+    else if (const uint8_t *vu = vuMemoryPtr(physAddr, 1))
+    {
+        return *vu;
+    }
 
     return 0;
 }
@@ -349,6 +542,12 @@ uint16_t PS2Memory::read16(uint32_t address)
         uint32_t shift = (physAddr & 2) * 8;
         return static_cast<uint16_t>((value >> shift) & 0xFFFF);
     }
+    else if (const uint8_t *vu = vuMemoryPtr(physAddr, 2))
+    {
+        uint16_t value;
+        std::memcpy(&value, vu, sizeof(value));
+        return value;
+    }
 
     return 0;
 }
@@ -364,7 +563,7 @@ uint32_t PS2Memory::read32(uint32_t address)
     {
         uint64_t *reg = gsRegPtr(gs_regs, address);
         uint32_t off = address & 7;
-        uint64_t val = reg ? *reg : 0;
+        uint64_t val = reg ? loadGsReg(gs_regs, reg) : 0;
         return (uint32_t)(val >> (off * 8));
     }
 
@@ -383,6 +582,12 @@ uint32_t PS2Memory::read32(uint32_t address)
     {
         return readIORegister(physAddr);
     }
+    else if (const uint8_t *vu = vuMemoryPtr(physAddr, 4))
+    {
+        uint32_t value;
+        std::memcpy(&value, vu, sizeof(value));
+        return value;
+    }
 
     return 0;
 }
@@ -397,7 +602,7 @@ uint64_t PS2Memory::read64(uint32_t address)
     if (isGsPrivReg(address))
     {
         uint64_t *reg = gsRegPtr(gs_regs, address);
-        return reg ? *reg : 0;
+        return reg ? loadGsReg(gs_regs, reg) : 0;
     }
 
     const bool scratch = isScratchpad(address);
@@ -436,6 +641,10 @@ __m128i PS2Memory::read128(uint32_t address)
         inRange(physAddr, sizeof(__m128i), PS2_RAM_SIZE, "read128 rdram", address);
         return _mm_loadu_si128(reinterpret_cast<__m128i *>(&m_rdram[physAddr]));
     }
+    if (const uint8_t *vu = vuMemoryPtr(physAddr, sizeof(__m128i)))
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(vu));
+    }
 
     // 128-bit reads are primarily for quad-word loads in the EE, which are only valid for RAM areas
     // Return zeroes for unsupported areas
@@ -464,6 +673,10 @@ void PS2Memory::write8(uint32_t address, uint8_t value)
         uint32_t newValue = (m_ioRegisters[regAddr] & mask) | ((uint32_t)value << shift);
         writeIORegister(regAddr, newValue);
     }
+    else if (uint8_t *vu = vuStorePtr(physAddr, 1))
+    {
+        *vu = value;
+    }
 }
 
 void PS2Memory::write16(uint32_t address, uint16_t value)
@@ -492,6 +705,10 @@ void PS2Memory::write16(uint32_t address, uint16_t value)
         uint32_t newValue = (m_ioRegisters[regAddr] & mask) | ((uint32_t)value << shift);
         writeIORegister(regAddr, newValue);
     }
+    else if (uint8_t *vu = vuStorePtr(physAddr, 2))
+    {
+        std::memcpy(vu, &value, sizeof(value));
+    }
 }
 
 void PS2Memory::write32(uint32_t address, uint32_t value)
@@ -508,8 +725,9 @@ void PS2Memory::write32(uint32_t address, uint32_t value)
         {
             uint32_t off = address & 7;
             uint64_t mask = 0xFFFFFFFFULL << (off * 8);
-            uint64_t newVal = (*reg & ~mask) | ((uint64_t)value << (off * 8));
-            *reg = newVal;
+            storeGsReg(gs_regs, reg, (uint64_t)value << (off * 8), mask);
+            if (reg == &gs_regs.dispfb1 || reg == &gs_regs.dispfb2)
+                publishFrame(); // page flip
         }
         return;
     }
@@ -532,6 +750,10 @@ void PS2Memory::write32(uint32_t address, uint32_t value)
     {
         writeIORegister(physAddr, value);
     }
+    else if (uint8_t *vu = vuStorePtr(physAddr, 4))
+    {
+        std::memcpy(vu, &value, sizeof(value));
+    }
 }
 
 void PS2Memory::write64(uint32_t address, uint64_t value)
@@ -546,7 +768,9 @@ void PS2Memory::write64(uint32_t address, uint64_t value)
         uint64_t *reg = gsRegPtr(gs_regs, address);
         if (reg)
         {
-            *reg = value;
+            storeGsReg(gs_regs, reg, value, ~0ULL);
+            if (reg == &gs_regs.dispfb1 || reg == &gs_regs.dispfb2)
+                publishFrame(); // page flip
         }
         return;
     }
@@ -589,6 +813,10 @@ void PS2Memory::write128(uint32_t address, __m128i value)
         inRange(physAddr, sizeof(__m128i), PS2_RAM_SIZE, "write128 rdram", address);
         _mm_storeu_si128(reinterpret_cast<__m128i *>(&m_rdram[physAddr]), value);
     }
+    else if (uint8_t *vu = vuStorePtr(physAddr, sizeof(__m128i)))
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(vu), value);
+    }
     else
     {
         // Non-RAM 128-bit stores are modeled as two 64-bit stores.
@@ -602,95 +830,41 @@ void PS2Memory::write128(uint32_t address, __m128i value)
 
 bool PS2Memory::writeIORegister(uint32_t address, uint32_t value)
 {
-    m_ioRegisters[address] = value;
-
     if (address >= 0x10008000 && address < 0x1000F000)
     {
-        if ((address & 0xFF) == 0x00 && (value & 0x100))
-        {
-            const uint32_t channelBase = address & 0xFFFFFF00;
-            const uint32_t madr = m_ioRegisters[channelBase + 0x10];
-            const uint32_t qwc = m_ioRegisters[channelBase + 0x20];
-            m_dmaStartCount.fetch_add(1, std::memory_order_relaxed);
-
-            if ((channelBase == 0x1000A000 || channelBase == 0x10009000) && m_gsVRAM)
-            {
-                auto doCopy = [&](uint32_t srcAddr, uint32_t qwCount)
-                {
-                    const uint64_t bytes64 = static_cast<uint64_t>(qwCount) * 16ull;
-                    uint32_t bytes = (bytes64 > 0xFFFFFFFFull) ? 0xFFFFFFFFu : static_cast<uint32_t>(bytes64);
-                    uint32_t src = 0;
-                    try
-                    {
-                        src = translateAddress(srcAddr);
-                    }
-                    catch (const std::exception &)
-                    {
-                        return;
-                    }
-                    uint32_t basePage = static_cast<uint32_t>(gs_regs.dispfb1 & 0x1FF);
-                    uint32_t dest = basePage * 2048;
-                    if (dest >= PS2_GS_VRAM_SIZE)
-                    {
-                        return;
-                    }
-                    if (dest + bytes > PS2_GS_VRAM_SIZE)
-                    {
-                        bytes = std::min<uint32_t>(bytes, PS2_GS_VRAM_SIZE - dest);
-                    }
-                    if (src >= PS2_RAM_SIZE)
-                    {
-                        return;
-                    }
-                    if (src + bytes > PS2_RAM_SIZE)
-                    {
-                        bytes = std::min<uint32_t>(bytes, PS2_RAM_SIZE - src);
-                    }
-                    if (bytes == 0)
-                    {
-                        return;
-                    }
-                    std::memcpy(m_gsVRAM + dest, m_rdram + src, bytes);
-                    m_seenGifCopy = true;
-                    m_gifCopyCount.fetch_add(1, std::memory_order_relaxed);
-                };
-
-                if (qwc > 0)
-                {
-                    doCopy(madr, qwc);
-                }
-                else
-                {
-                    uint32_t tadr = m_ioRegisters[channelBase + 0x30];
-                    uint32_t physTag = translateAddress(tadr);
-                    if (physTag + 16 <= PS2_RAM_SIZE)
-                    {
-                        const uint8_t *tp = m_rdram + physTag;
-                        uint64_t tag = loadScalar<uint64_t>(tp, 0, 16, "dma chain tag", tadr);
-                        uint16_t tagQwc = static_cast<uint16_t>(tag & 0xFFFF);
-                        uint32_t id = static_cast<uint32_t>((tag >> 28) & 0x7);
-                        uint32_t addr = static_cast<uint32_t>((tag >> 32) & 0x7FFFFFF);
-                        if (id == 0 || id == 1 || id == 2)
-                        {
-                            doCopy(addr, tagQwc);
-                        }
-                    }
-                }
-                m_ioRegisters[address] &= ~0x100;
-            }
-        }
+        writeDmacRegister(address, value);
         return true;
     }
 
+    m_ioRegisters[address] = value;
+
     if (address >= 0x10000000 && address < 0x10010000)
     {
-        if (address >= 0x10003800 && address < 0x10003A00)
+        if ((address >= 0x10003800 && address < 0x10003A00) || (address >= 0x10003C00 && address < 0x10003E00))
         {
             m_vifWriteCount.fetch_add(1, std::memory_order_relaxed);
+            const uint32_t unit = (address & 0x400u) ? 1u : 0u;
+            std::lock_guard<std::mutex> lock(m_vifMutex[unit]);
+            if ((address & 0x3FFu) == 0x10u && (value & 1u))
+            {
+                // FBRST.RST
+                memset(&vif(unit), 0, sizeof(VIFRegisters));
+                m_vif[unit].reset();
+            }
+            else if ((address & 0x3FFu) == 0x30u)
+            {
+                // Writing MARK clears STAT.MRK.
+                vif(unit).mark = value & 0xFFFFu;
+                vif(unit).stat &= ~0x40u;
+            }
+            return true;
         }
-        if (address >= 0x10003C00 && address < 0x10003E00)
+        if (address >= 0x10004000 && address < 0x10006000)
         {
+            // VIF0/VIF1 FIFO: the words of a 128-bit store arrive one at a time.
             m_vifWriteCount.fetch_add(1, std::memory_order_relaxed);
+            feedVif((address >> 12) & 1u, reinterpret_cast<const uint8_t *>(&value), sizeof(value));
+            return true;
         }
         if (address >= 0x10000200 && address < 0x10000300)
         {
@@ -723,19 +897,17 @@ uint32_t PS2Memory::readIORegister(uint32_t address)
             }
         }
 
-        if (address >= 0x10008000 && address < 0x1000F000)
+        if (address >= 0x10000200 && address < 0x10000300)
         {
-            if ((address & 0xFF) == 0x00)
-            {
-                uint32_t channelStatus = m_ioRegisters[address] & ~0x100;
-                m_ioRegisters[address] = channelStatus;
-                return channelStatus;
-            }
+            return 0;
         }
 
-        if (address >= 0x10000200 && address < 0x10000300)
+        if ((address >= 0x10003800 && address < 0x10003A00) || (address >= 0x10003C00 && address < 0x10003E00))
         {
-            return 0;
+            const uint32_t unit = (address & 0x400u) ? 1u : 0u;
+            std::lock_guard<std::mutex> lock(m_vifMutex[unit]);
+            const uint32_t *reg = vifRegisterPtr(address);
+            return reg ? *reg : 0;
         }
     }
 
@@ -752,15 +924,13 @@ void PS2Memory::registerCodeRegion(uint32_t start, uint32_t end)
 {
     if (end <= start)
     {
-        std::cerr << "Ignoring invalid code region: start=0x" << std::hex << start
-                  << " end=0x" << end << std::dec << std::endl;
+        PS2_LOG_WARN(Memory, "Ignoring invalid code region: start=0x" << std::hex << start << " end=0x" << end << std::dec);
         return;
     }
 
     if ((end - start) > PS2_RAM_SIZE)
     {
-        std::cerr << "Ignoring oversized code region: start=0x" << std::hex << start
-                  << " end=0x" << end << std::dec << std::endl;
+        PS2_LOG_WARN(Memory, "Ignoring oversized code region: start=0x" << std::hex << start << " end=0x" << end << std::dec);
         return;
     }
 
@@ -780,7 +950,7 @@ void PS2Memory::registerCodeRegion(uint32_t start, uint32_t end)
     region.modified.resize(sizeInWords, false);
 
     m_codeRegions.push_back(region);
-    std::cout << "Registered code region: " << std::hex << start << " - " << end << std::dec << std::endl;
+    PS2_LOG_DEBUG(Memory, "Registered code region: " << std::hex << start << " - " << end << std::dec);
 }
 
 bool PS2Memory::isAddressInRegion(uint32_t address, const CodeRegion &region)
@@ -814,7 +984,7 @@ void PS2Memory::markModified(uint32_t address, uint32_t size)
             if (bitIndex < region.modified.size())
             {
                 region.modified[bitIndex] = true;
-                std::cout << "Marked code at " << std::hex << addr << std::dec << " as modified" << std::endl;
+                PS2_LOG_TRACE(Memory, "Marked code at " << std::hex << addr << std::dec << " as modified");
             }
         }
     }
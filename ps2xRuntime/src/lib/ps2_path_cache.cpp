@@ -0,0 +1,329 @@
+#include "ps2_path_cache.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using ps2_path_cache::EntryKind;
+
+    // Unique guest paths are bounded in practice; this only guards against a
+    // title that probes endless generated names.
+    constexpr size_t kMaxCachedResults = 65536;
+    constexpr auto kWatchPollInterval = std::chrono::milliseconds(50);
+
+    std::string foldAscii(std::string value)
+    {
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        return value;
+    }
+
+    std::string directoryKey(const std::filesystem::path &dir)
+    {
+        std::string key = dir.lexically_normal().generic_string();
+        while (key.size() > 1 && key.back() == '/')
+        {
+            key.pop_back();
+        }
+        return key;
+    }
+
+    struct DirectoryListing
+    {
+        std::unordered_map<std::string, bool> exact;         // name -> is directory
+        std::unordered_map<std::string, std::string> folded; // lowercase name -> name
+    };
+
+    struct CachedResult
+    {
+        EntryKind kind = EntryKind::Missing;
+        std::filesystem::path path;
+    };
+
+    class PathCache
+    {
+    public:
+        ~PathCache()
+        {
+#ifdef __linux__
+            if (m_inotifyFd >= 0)
+            {
+                ::close(m_inotifyFd);
+            }
+#endif
+        }
+
+        EntryKind resolve(const std::filesystem::path &root, const std::filesystem::path &relative,
+                          std::filesystem::path &resolvedOut)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            pollWatches(false);
+
+            const std::string resultKey = directoryKey(root) + '\n' + foldAscii(relative.generic_string());
+            auto cached = m_results.find(resultKey);
+            if (cached != m_results.end())
+            {
+                resolvedOut = cached->second.path;
+                return cached->second.kind;
+            }
+
+            // A miss may only reflect a listing that inotify has already
+            // invalidated, so misses apply pending events before answering
+            // and are never cached.
+            CachedResult result = walk(root, relative);
+            if (result.kind == EntryKind::Missing && pollWatches(true))
+            {
+                result = walk(root, relative);
+            }
+            if (result.kind != EntryKind::Missing)
+            {
+                if (m_results.size() >= kMaxCachedResults)
+                {
+                    m_results.clear();
+                }
+                m_results.emplace(resultKey, result);
+            }
+
+            resolvedOut = result.path;
+            return result.kind;
+        }
+
+        void invalidate(const std::filesystem::path &hostPath)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_directories.erase(directoryKey(hostPath));
+            m_directories.erase(directoryKey(hostPath.lexically_normal().parent_path()));
+            m_results.clear();
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_directories.clear();
+            m_results.clear();
+        }
+
+    private:
+        // Caller holds m_mutex. Matches relative against the cached listings under root.
+        CachedResult walk(const std::filesystem::path &root, const std::filesystem::path &relative)
+        {
+            std::filesystem::path current = root;
+            EntryKind kind = listing(root) ? EntryKind::Directory : EntryKind::Missing;
+            bool missing = kind == EntryKind::Missing;
+            for (const auto &component : relative.lexically_normal())
+            {
+                const std::string name = component.string();
+                if (name.empty() || name == "." || name == "/" || name == "\\")
+                {
+                    continue;
+                }
+                if (missing)
+                {
+                    current /= component;
+                    continue;
+                }
+                if (name == "..")
+                {
+                    current = current.parent_path();
+                    continue;
+                }
+
+                const DirectoryListing *dir = kind == EntryKind::Directory ? listing(current) : nullptr;
+                if (!dir)
+                {
+                    missing = true;
+                    current /= component;
+                    continue;
+                }
+
+                auto exact = dir->exact.find(name);
+                if (exact == dir->exact.end())
+                {
+                    auto folded = dir->folded.find(foldAscii(name));
+                    if (folded != dir->folded.end())
+                    {
+                        exact = dir->exact.find(folded->second);
+                    }
+                }
+                if (exact == dir->exact.end())
+                {
+                    missing = true;
+                    current /= component;
+                    continue;
+                }
+
+                current /= exact->first;
+                kind = exact->second ? EntryKind::Directory : EntryKind::File;
+            }
+
+            CachedResult result;
+            result.kind = missing ? EntryKind::Missing : kind;
+            result.path = current;
+            return result;
+        }
+
+        // Caller holds m_mutex. Returns nullptr when dir is not a readable directory.
+        const DirectoryListing *listing(const std::filesystem::path &dir)
+        {
+            const std::string key = directoryKey(dir);
+            auto it = m_directories.find(key);
+            if (it != m_directories.end())
+            {
+                return &it->second;
+            }
+
+            std::error_code ec;
+            std::filesystem::directory_iterator iter(dir, std::filesystem::directory_options::skip_permission_denied, ec);
+            if (ec)
+            {
+                return nullptr;
+            }
+
+            DirectoryListing entries;
+            for (; iter != std::filesystem::directory_iterator(); iter.increment(ec))
+            {
+                if (ec)
+                {
+                    break;
+                }
+                std::error_code typeEc;
+                const std::string name = iter->path().filename().string();
+                entries.exact.emplace(name, iter->is_directory(typeEc) && !typeEc);
+                entries.folded.emplace(foldAscii(name), name);
+            }
+
+            watch(dir, key);
+            return &m_directories.emplace(key, std::move(entries)).first->second;
+        }
+
+        void watch(const std::filesystem::path &dir, const std::string &key)
+        {
+#ifdef __linux__
+            if (m_inotifyFd < 0 && !m_inotifyUnavailable)
+            {
+                m_inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+                m_inotifyUnavailable = m_inotifyFd < 0;
+            }
+            if (m_inotifyFd >= 0)
+            {
+                const int wd = ::inotify_add_watch(m_inotifyFd, dir.c_str(),
+                                                   IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                                       IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+                if (wd >= 0)
+                {
+                    m_watches[wd] = key;
+                }
+            }
+#else
+            (void)dir;
+            (void)key;
+#endif
+        }
+
+        // Caller holds m_mutex. Applies queued inotify events at most every
+        // kWatchPollInterval unless forced, so hot lookups stay free of
+        // syscalls. Returns whether any cached state was dropped.
+        bool pollWatches(bool force)
+        {
+#ifdef __linux__
+            if (m_inotifyFd < 0)
+            {
+                return false;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (!force && now - m_lastPoll < kWatchPollInterval)
+            {
+                return false;
+            }
+            m_lastPoll = now;
+
+            alignas(inotify_event) char buffer[4096];
+            bool changed = false;
+            while (true)
+            {
+                const ssize_t bytes = ::read(m_inotifyFd, buffer, sizeof(buffer));
+                if (bytes <= 0)
+                {
+                    break;
+                }
+
+                for (ssize_t offset = 0; offset < bytes;)
+                {
+                    const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                    changed = true;
+
+                    if ((event->mask & IN_Q_OVERFLOW) != 0)
+                    {
+                        m_directories.clear();
+                        continue;
+                    }
+                    auto it = m_watches.find(event->wd);
+                    if (it == m_watches.end())
+                    {
+                        continue;
+                    }
+                    m_directories.erase(it->second);
+                    if ((event->mask & IN_IGNORED) != 0)
+                    {
+                        m_watches.erase(it);
+                    }
+                }
+            }
+            if (changed)
+            {
+                m_results.clear();
+            }
+            return changed;
+#else
+            (void)force;
+            return false;
+#endif
+        }
+
+        std::mutex m_mutex;
+        std::unordered_map<std::string, DirectoryListing> m_directories;
+        std::unordered_map<std::string, CachedResult> m_results;
+#ifdef __linux__
+        int m_inotifyFd = -1;
+        bool m_inotifyUnavailable = false;
+        std::unordered_map<int, std::string> m_watches;
+        std::chrono::steady_clock::time_point m_lastPoll{};
+#endif
+    };
+
+    PathCache &pathCache()
+    {
+        static PathCache cache;
+        return cache;
+    }
+}
+
+namespace ps2_path_cache
+{
+    EntryKind resolve(const std::filesystem::path &root, const std::filesystem::path &relative,
+                      std::filesystem::path &resolvedOut)
+    {
+        return pathCache().resolve(root, relative, resolvedOut);
+    }
+
+    void invalidate(const std::filesystem::path &hostPath)
+    {
+        pathCache().invalidate(hostPath);
+    }
+
+    void clear()
+    {
+        pathCache().clear();
+    }
+}
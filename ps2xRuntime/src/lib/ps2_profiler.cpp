@@ -0,0 +1,195 @@
+#include "ps2_profiler.h"
+#include "ps2_runtime.h"
+#include "ps2_symbols.h"
+#include <ThreadNaming.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <iostream>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+    using namespace ps2_profiler;
+
+    struct StackKey
+    {
+        std::string thread;
+        std::vector<uint32_t> frames; // function starts, outermost first
+
+        bool operator<(const StackKey &other) const
+        {
+            return std::tie(thread, frames) < std::tie(other.thread, other.frames);
+        }
+    };
+
+    std::mutex g_threadsMutex;
+    std::vector<ThreadState *> g_threads;
+
+    std::mutex g_samplesMutex;
+    std::map<StackKey, uint64_t> g_samples;
+    uint64_t g_sampleCount = 0;
+
+    std::mutex g_controlMutex;
+    std::thread g_sampler;
+    std::atomic<bool> g_running{false};
+    Options g_options;
+
+    uint32_t functionStart(uint32_t pc)
+    {
+        ps2_symbols::FunctionSymbol symbol{};
+        return ps2_symbols::find(pc, symbol) ? symbol.start : pc;
+    }
+
+    // The guest thread keeps writing ctx->pc while we look; a torn or stale
+    // value only misattributes one sample, like any sampling profiler.
+    uint32_t currentPc(const R5900Context *ctx)
+    {
+        return *static_cast<const volatile uint32_t *>(&ctx->pc);
+    }
+
+    void sampleThreads()
+    {
+        StackKey key;
+        std::lock_guard<std::mutex> threadsLock(g_threadsMutex);
+        for (ThreadState *state : g_threads)
+        {
+            const uint32_t pc = currentPc(state->ctx);
+            const uint32_t depth = std::min<uint32_t>(state->depth.load(std::memory_order_acquire), kMaxCallDepth);
+
+            key.thread = state->name;
+            key.frames.clear();
+            for (uint32_t i = 0; i < depth; ++i)
+                key.frames.push_back(functionStart(state->calls[i].load(std::memory_order_relaxed)));
+            const uint32_t current = functionStart(pc);
+            if (key.frames.empty() || key.frames.back() != current)
+                key.frames.push_back(current);
+
+            std::lock_guard<std::mutex> samplesLock(g_samplesMutex);
+            ++g_samples[key];
+            ++g_sampleCount;
+        }
+    }
+
+    void samplerLoop(uint32_t hz)
+    {
+        ThreadNaming::SetCurrentThreadName("ProfilerThread");
+        const auto period = std::chrono::nanoseconds(1000000000ull / hz);
+        auto next = std::chrono::steady_clock::now();
+        while (g_running.load(std::memory_order_acquire))
+        {
+            next += period;
+            const auto now = std::chrono::steady_clock::now();
+            if (next < now)
+                next = now; // fell behind; do not burst to catch up
+            std::this_thread::sleep_until(next);
+            sampleThreads();
+        }
+    }
+
+    // Flamegraph tools split frames on ';' and the count on the last space.
+    void appendFrame(std::string &line, std::string_view name)
+    {
+        for (char c : name)
+            line.push_back((c == ';' || c == ' ') ? '_' : c);
+    }
+}
+
+namespace ps2_profiler
+{
+    ThreadScope::ThreadScope(const R5900Context *ctx, std::string_view name)
+        : m_previous(t_thread)
+    {
+        m_state.ctx = ctx;
+        m_state.name = name;
+        t_thread = &m_state;
+        std::lock_guard<std::mutex> lock(g_threadsMutex);
+        g_threads.push_back(&m_state);
+    }
+
+    ThreadScope::~ThreadScope()
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_threadsMutex);
+            g_threads.erase(std::remove(g_threads.begin(), g_threads.end(), &m_state), g_threads.end());
+        }
+        t_thread = m_previous;
+    }
+
+    bool start(const Options &options)
+    {
+        std::lock_guard<std::mutex> lock(g_controlMutex);
+        if (options.hz == 0 || g_running.load(std::memory_order_acquire))
+            return false;
+        g_options = options;
+        g_running.store(true, std::memory_order_release);
+        g_sampler = std::thread(samplerLoop, options.hz);
+        return true;
+    }
+
+    bool stop()
+    {
+        std::lock_guard<std::mutex> lock(g_controlMutex);
+        if (!g_running.exchange(false, std::memory_order_acq_rel))
+            return true;
+        if (g_sampler.joinable())
+            g_sampler.join();
+
+        if (g_options.outputPath.empty())
+            return true;
+        std::ofstream out(g_options.outputPath, std::ios::binary | std::ios::trunc);
+        out << collapsed();
+        if (!out)
+        {
+            std::cerr << "[profiler] failed to write " << g_options.outputPath.string() << std::endl;
+            return false;
+        }
+        std::cout << "[profiler] " << sampleCount() << " samples written to " << g_options.outputPath.string() << std::endl;
+        return true;
+    }
+
+    bool running()
+    {
+        return g_running.load(std::memory_order_acquire);
+    }
+
+    std::string collapsed()
+    {
+        std::lock_guard<std::mutex> lock(g_samplesMutex);
+        std::string text;
+        std::string line;
+        for (const auto &[key, count] : g_samples)
+        {
+            line.clear();
+            appendFrame(line, key.thread);
+            for (uint32_t frame : key.frames)
+            {
+                line.push_back(';');
+                appendFrame(line, ps2_symbols::describe(frame));
+            }
+            text += line;
+            text += ' ';
+            text += std::to_string(count);
+            text += '\n';
+        }
+        return text;
+    }
+
+    uint64_t sampleCount()
+    {
+        std::lock_guard<std::mutex> lock(g_samplesMutex);
+        return g_sampleCount;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(g_samplesMutex);
+        g_samples.clear();
+        g_sampleCount = 0;
+    }
+}
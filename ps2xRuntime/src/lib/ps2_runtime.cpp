@@ -1,6 +1,11 @@
 #include "ps2_runtime.h"
+#include "ps2_benchmark.h"
 #include "ps2_syscalls.h"
 #include "game_overrides.h"
+#include "ps2_gs_display.h"
+#include "ps2_log.h"
+#include "ps2_profiler.h"
+#include "ps2_trace.h"
 #include "ps2_runtime_macros.h"
 #include <iostream>
 #include <fstream>
@@ -11,6 +16,7 @@
 #include <limits>
 #include <chrono>
 #include <atomic>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 #include "raylib.h"
@@ -175,72 +181,80 @@ namespace
     }
 }
 
-static void UploadFrame(Texture2D &tex, PS2Runtime *rt)
-{
-    // Try to use GS dispfb/display registers to locate the visible buffer.
-    const GSRegisters &gs = rt->memory().gs();
-
-    // DISPFBUF1 fields: FBP bits 0-8, FBW bits 9-14, PSM bits 15-19.
-    uint32_t dispfb = static_cast<uint32_t>(gs.dispfb1 & 0xFFFFFFFFULL);
-    uint32_t fbp = dispfb & 0x1FF;
-    uint32_t fbw = (dispfb >> 9) & 0x3F;
-    uint32_t psm = (dispfb >> 15) & 0x1F;
-
-    // DISPLAY1 fields used here: DW bits 32-43, DH bits 44-54.
-    uint64_t display64 = gs.display1;
-    uint32_t dw = static_cast<uint32_t>((display64 >> 32) & 0xFFF);
-    uint32_t dh = static_cast<uint32_t>((display64 >> 44) & 0x7FF);
-
-    // Default to 640x448 if regs look strange.
-    uint32_t width = (dw + 1);
-    uint32_t height = (dh + 1);
-    if (dw == 0)
-        width = FB_WIDTH;
-    if (dh == 0)
-        height = FB_HEIGHT;
-    if (width > FB_WIDTH)
-        width = FB_WIDTH;
-    if (height > FB_HEIGHT)
-        height = FB_HEIGHT;
-
-    // Only handle PSMCT32 (0).
-    if (psm != 0)
-    {
-        // I can`t stand a random RAM glitch screen so lets use some magenta to calm down
-        Image blank = GenImageColor(FB_WIDTH, FB_HEIGHT, MAGENTA);
-        UpdateTexture(tex, blank.data);
-        UnloadImage(blank);
-        return;
-    }
-
-    uint32_t baseBytes = fbp * 2048;
-    const uint32_t bytesPerPixel = (psm == 2u || psm == 0x0Au) ? 2u : 4u;
-    uint32_t strideBytes = (fbw ? fbw : (FB_WIDTH / 64)) * 64 * bytesPerPixel;
-
-    std::vector<uint8_t> scratch(FB_WIDTH * FB_HEIGHT * 4, 0); // maybe we can do this static
+namespace
+{
+    // Present side of the frame handoff. The GS thread publishes whole frames
+    // at page flips and VBlank; this uploads the newest one, only the rows that
+    // changed since the last upload, without ever blocking the guest.
+    class FramePresenter
+    {
+    public:
+        explicit FramePresenter(PS2Memory &memory)
+            : m_memory(memory)
+        {
+        }
 
-    uint8_t *rdram = rt->memory().getRDRAM();
-    uint8_t *gsvram = rt->memory().getGSVRAM();
-    for (uint32_t y = 0; y < height; ++y)
-    {
-        uint32_t srcOff = baseBytes + y * strideBytes;
-        uint32_t dstOff = y * FB_WIDTH * 4;
-        uint32_t copyW = width * 4;
-        uint32_t srcIdx = srcOff;
-        if (srcIdx + copyW <= PS2_GS_VRAM_SIZE && gsvram)
+        void start()
         {
-            std::memcpy(&scratch[dstOff], gsvram + srcIdx, copyW);
+            m_shown.clear();
+            m_lastPublished = m_memory.frames().published();
+            m_lastPublishTime = std::chrono::steady_clock::now();
         }
-        else
+
+        void present(Texture2D &tex)
         {
-            uint32_t rdramIdx = srcOff & PS2_RAM_MASK;
-            if (rdramIdx + copyW > PS2_RAM_SIZE)
-                copyW = PS2_RAM_SIZE - rdramIdx;
-            std::memcpy(&scratch[dstOff], rdram + rdramIdx, copyW);
+            ps2_gs_display::TripleBuffer &frames = m_memory.frames();
+            const auto now = std::chrono::steady_clock::now();
+            const uint64_t published = frames.published();
+            if (published != m_lastPublished)
+            {
+                m_lastPublished = published;
+                m_lastPublishTime = now;
+            }
+            else if (now - m_lastPublishTime >= kIdleRepublish)
+            {
+                // The guest has not flipped lately (single-buffered, or stuck
+                // in a loading loop); ask for a frame so the screen keeps up.
+                m_memory.publishFrame();
+                m_lastPublishTime = now;
+            }
+
+            if (!frames.acquire())
+                return;
+
+            const size_t rowWords = frames.width();
+            const uint32_t rows = frames.height();
+            const uint32_t *next = frames.front();
+            uint32_t first = 0;
+            uint32_t end = rows;
+            if (m_shown.empty())
+            {
+                m_shown.assign(next, next + rowWords * rows);
+            }
+            else
+            {
+                const size_t rowBytes = rowWords * 4;
+                while (first < end && std::memcmp(next + first * rowWords, m_shown.data() + first * rowWords, rowBytes) == 0)
+                    ++first;
+                while (end > first && std::memcmp(next + (end - 1) * rowWords, m_shown.data() + (end - 1) * rowWords, rowBytes) == 0)
+                    --end;
+                if (first == end)
+                    return; // a static screen costs no texture traffic at all
+                std::memcpy(m_shown.data() + first * rowWords, next + first * rowWords, (end - first) * rowBytes);
+            }
+
+            const Rectangle dirty{0.0f, static_cast<float>(first), static_cast<float>(rowWords), static_cast<float>(end - first)};
+            UpdateTextureRec(tex, dirty, m_shown.data() + first * rowWords);
         }
-    }
 
-    UpdateTexture(tex, scratch.data());
+    private:
+        static constexpr auto kIdleRepublish = std::chrono::milliseconds(50);
+
+        PS2Memory &m_memory;
+        std::vector<uint32_t> m_shown; // what the texture holds
+        uint64_t m_lastPublished = 0;
+        std::chrono::steady_clock::time_point m_lastPublishTime{};
+    };
 }
 
 PS2Runtime::PS2Runtime()
@@ -283,6 +297,14 @@ bool PS2Runtime::initialize(const char *title)
         std::cerr << "Failed to initialize PS2 memory" << std::endl;
         return false;
     }
+    // A finished DMA channel raises its DMAC interrupt on the guest side.
+    m_memory.setDmaCompletionHandler([this](uint32_t channelBase)
+    {
+        ps2_syscalls::dispatchDmacForChannel(m_memory.getRDRAM(), this, channelBase);
+    });
+
+    if (m_headless)
+        return true;
 
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(FB_WIDTH, FB_HEIGHT, title);
@@ -606,11 +628,11 @@ PS2Runtime::RecompiledFunction PS2Runtime::lookupFunction(uint32_t address)
         return it->second;
     }
 
-    std::cerr << "Warning: Function at address 0x" << std::hex << address << std::dec << " not found" << std::endl;
+    PS2_LOG_WARN(Dispatch, "Warning: Function at address 0x" << std::hex << address << std::dec << " not found");
 
     static RecompiledFunction defaultFunction = [](uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     {
-        std::cerr << "Error: Called unimplemented function at address 0x" << std::hex << ctx->pc << std::dec << std::endl;
+        PS2_LOG_ERROR(Dispatch, "Error: Called unimplemented function at address 0x" << std::hex << ctx->pc << std::dec);
 
         runtime->requestStop();
     };
@@ -632,23 +654,36 @@ void PS2Runtime::SignalException(R5900Context *ctx, PS2Exception exception)
 
 void PS2Runtime::executeVU0Microprogram(uint8_t *rdram, R5900Context *ctx, uint32_t address)
 {
-    static std::unordered_map<uint32_t, int> seen;
-    int &count = seen[address];
-    if (count < 3)
-    {
-        std::cout << "[VU0] microprogram @0x" << std::hex << address
-                  << " pc=0x" << ctx->pc
-                  << " ra=0x" << static_cast<uint32_t>(_mm_extract_epi32(ctx->r[31], 0))
-                  << std::dec << std::endl;
-    }
-    ++count;
-
-    // Seed status so dependent code sees success.
-    ctx->vu0_clip_flags = 0;
-    ctx->vu0_clip_flags2 = 0;
-    ctx->vu0_mac_flags = 0;
-    ctx->vu0_status = 0;
-    ctx->vu0_q = 1.0f;
+    (void)rdram;
+    // Micro mode sees the same VF/VI/ACC/Q/P/I as COP2 macro mode, so hand
+    // them to VU0 for the run and take them back afterwards.
+    auto lock = m_memory.lockVu(0);
+    ps2_vu::VectorUnit &vu0 = m_memory.vu(0);
+    ps2_vu::State &vu = vu0.state();
+    std::copy(ctx->vu0_vf + 1, ctx->vu0_vf + 32, vu.vf + 1);
+    std::copy(ctx->vi + 1, ctx->vi + 16, vu.vi + 1);
+    vu.acc = ctx->vu0_acc;
+    vu.q = ctx->vu0_q;
+    vu.p = ctx->vu0_p;
+    vu.i = ctx->vu0_i;
+    vu.r = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_castps_si128(ctx->vu0_r))) & 0x7FFFFFu;
+    vu.status = ctx->vu0_status;
+    vu.mac = ctx->vu0_mac_flags;
+    vu.clip = ctx->vu0_clip_flags;
+
+    vu0.start(address / 8u);
+
+    std::copy(vu.vf + 1, vu.vf + 32, ctx->vu0_vf + 1);
+    std::copy(vu.vi + 1, vu.vi + 16, ctx->vi + 1);
+    ctx->vu0_acc = vu.acc;
+    ctx->vu0_q = vu.q;
+    ctx->vu0_p = vu.p;
+    ctx->vu0_i = vu.i;
+    ctx->vu0_r = _mm_castsi128_ps(_mm_insert_epi32(_mm_castps_si128(ctx->vu0_r), static_cast<int>(vu.r), 0));
+    ctx->vu0_status = static_cast<uint16_t>(vu.status);
+    ctx->vu0_mac_flags = vu.mac;
+    ctx->vu0_clip_flags = vu.clip;
+    ctx->vu0_tpc = vu.tpc * 8u;
 }
 
 void PS2Runtime::vu0StartMicroProgram(uint8_t *rdram, R5900Context *ctx, uint32_t address)
@@ -664,6 +699,9 @@ void PS2Runtime::handleSyscall(uint8_t *rdram, R5900Context *ctx)
 
 void PS2Runtime::handleSyscall(uint8_t *rdram, R5900Context *ctx, uint32_t encodedSyscallId)
 {
+    m_syscallCount.fetch_add(1, std::memory_order_relaxed);
+    PS2_TRACE_SCOPE_ARG("syscall", "syscall", "number", encodedSyscallId != 0 ? encodedSyscallId : getRegU32(ctx, 3));
+
     // Try immediate first
     if (encodedSyscallId != 0 && ps2_syscalls::dispatchNumericSyscall(encodedSyscallId, rdram, ctx, this))
     {
@@ -1190,7 +1228,8 @@ void PS2Runtime::dispatchLoop(uint8_t *rdram, R5900Context *ctx)
             ++samePcCount;
             if ((samePcCount % kSamePcYieldInterval) == 0u)
             {
-                std::cout << "CPU is doing some work at PC 0x" << std::hex << pc << ". PC not updating." << std::endl;
+                PS2_LOG_RATE(ps2_log::Level::Debug, ps2_log::Category::Dispatch, 1,
+                             "CPU is doing some work at PC 0x" << std::hex << pc << ". PC not updating.");
                 std::this_thread::yield();
             }
         }
@@ -1207,6 +1246,7 @@ void PS2Runtime::dispatchLoop(uint8_t *rdram, R5900Context *ctx)
 
         RecompiledFunction fn = lookupFunction(pc);
 
+        m_dispatchCount.fetch_add(1, std::memory_order_relaxed);
         fn(rdram, ctx, this);
 
         if (ctx->pc == 0u)
@@ -1284,7 +1324,7 @@ __m128i PS2Runtime::Load128(uint8_t *rdram, R5900Context *ctx, uint32_t vaddr)
 
 void PS2Runtime::Store8(uint8_t *rdram, R5900Context *ctx, uint32_t vaddr, uint8_t value)
 {
-    ps2TraceGuestWrite(rdram, vaddr, 1u, value, 0u, "WRITE8", ctx);
+    ps2_watch::noteWrite(rdram, vaddr, 1u, value, 0u, "WRITE8", ctx);
     try
     {
         m_memory.write8(vaddr, value);
@@ -1297,7 +1337,7 @@ void PS2Runtime::Store8(uint8_t *rdram, R5900Context *ctx, uint32_t vaddr, uint8
 
 void PS2Runtime::Store16(uint8_t *rdram, R5900Context *ctx, uint32_t vaddr, uint16_t value)
 {
-    ps2TraceGuestWrite(rdram, vaddr, 2u, value, 0u, "WRITE16", ctx);
+    ps2_watch::noteWrite(rdram, vaddr, 2u, value, 0u, "WRITE16", ctx);
     try
     {
         m_memory.write16(vaddr, value);
@@ -1310,7 +1350,7 @@ void PS2Runtime::Store16(uint8_t *rdram, R5900Context *ctx, uint32_t vaddr, uint
 
 void PS2Runtime::Store32(uint8_t *rdram, R5900Context *ctx, uint32_t vaddr, uint32_t value)
 {
-    ps2TraceGuestWrite(rdram, vaddr, 4u, value, 0u, "WRITE32", ctx);
+    ps2_watch::noteWrite(rdram, vaddr, 4u, value, 0u, "WRITE32", ctx);
     try
     {
         m_memory.write32(vaddr, value);
@@ -1323,7 +1363,7 @@ void PS2Runtime::Store32(uint8_t *rdram, R5900Context *ctx, uint32_t vaddr, uint
 
 void PS2Runtime::Store64(uint8_t *rdram, R5900Context *ctx, uint32_t vaddr, uint64_t value)
 {
-    ps2TraceGuestWrite(rdram, vaddr, 8u, value, 0u, "WRITE64", ctx);
+    ps2_watch::noteWrite(rdram, vaddr, 8u, value, 0u, "WRITE64", ctx);
     try
     {
         m_memory.write64(vaddr, value);
@@ -1340,7 +1380,7 @@ void PS2Runtime::Store128(uint8_t *rdram, R5900Context *ctx, uint32_t vaddr, __m
 {
     alignas(16) uint64_t _parts[2];
     _mm_storeu_si128(reinterpret_cast<__m128i *>(_parts), value);
-    ps2TraceGuestWrite(rdram, vaddr, 16u, _parts[0], _parts[1], "WRITE128", ctx);
+    ps2_watch::noteWrite(rdram, vaddr, 16u, _parts[0], _parts[1], "WRITE128", ctx);
     try
     {
         m_memory.write128(vaddr, value);
@@ -1370,30 +1410,31 @@ void PS2Runtime::HandleIntegerOverflow(R5900Context *ctx)
     raiseCop0Exception(ctx, EXCEPTION_INTEGER_OVERFLOW);
 }
 
-void PS2Runtime::run()
+void PS2Runtime::setHeadless(const HeadlessOptions &options)
 {
-    m_stopRequested.store(false, std::memory_order_relaxed);
-    m_cpuContext.r[4] = _mm_setzero_si128();
-    m_cpuContext.r[5] = _mm_setzero_si128();
-    m_cpuContext.r[29] = _mm_set_epi64x(0, static_cast<int64_t>(PS2_RAM_SIZE - 0x10u));
-    m_debugPc.store(m_cpuContext.pc, std::memory_order_relaxed);
-    m_debugRa.store(static_cast<uint32_t>(_mm_extract_epi32(m_cpuContext.r[31], 0)), std::memory_order_relaxed);
-    m_debugSp.store(static_cast<uint32_t>(_mm_extract_epi32(m_cpuContext.r[29], 0)), std::memory_order_relaxed);
-    m_debugGp.store(static_cast<uint32_t>(_mm_extract_epi32(m_cpuContext.r[28], 0)), std::memory_order_relaxed);
-
-    std::cout << "Starting execution at address 0x" << std::hex << m_cpuContext.pc << std::dec << std::endl;
+    m_headless = true;
+    m_headlessOptions = options;
+    setClockMode(ClockMode::Unlimited);
+}
 
-    // A blank image to use as a framebuffer
-    Image blank = GenImageColor(FB_WIDTH, FB_HEIGHT, BLANK);
-    Texture2D frameTex = LoadTextureFromImage(blank);
-    UnloadImage(blank);
+void PS2Runtime::setClockMode(ClockMode mode, double multiplier)
+{
+    if (mode == ClockMode::FastForward && !(multiplier > 0.0))
+    {
+        std::cerr << "[clock] invalid fast-forward multiplier " << multiplier << ", using real time" << std::endl;
+        mode = ClockMode::RealTime;
+    }
+    m_clockMultiplier.store(mode == ClockMode::FastForward ? multiplier : 1.0, std::memory_order_relaxed);
+    m_clockMode.store(mode, std::memory_order_relaxed);
+}
 
+std::thread PS2Runtime::startGameThread(std::atomic<bool> &finished)
+{
     g_activeThreads.store(1, std::memory_order_relaxed);
-    std::atomic<bool> gameThreadFinished{false};
-
-    std::thread gameThread([&]()
-                           {
+    return std::thread([this, &finished]()
+                       {
         ThreadNaming::SetCurrentThreadName("GameThread");
+        ps2_profiler::ThreadScope profile(&m_cpuContext, "GameThread");
         try
         {
             dispatchLoop(m_memory.getRDRAM(), &m_cpuContext);
@@ -1410,7 +1451,71 @@ void PS2Runtime::run()
             std::cerr << "Error during program execution: unknown exception" << std::endl;
         }
         g_activeThreads.fetch_sub(1, std::memory_order_relaxed);
-        gameThreadFinished.store(true, std::memory_order_release); });
+        finished.store(true, std::memory_order_release); });
+}
+
+void PS2Runtime::stopGameThread(std::thread &gameThread, const std::atomic<bool> &finished)
+{
+    requestStop();
+
+    const auto joinDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!finished.load(std::memory_order_acquire) &&
+           std::chrono::steady_clock::now() < joinDeadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (gameThread.joinable())
+    {
+        if (finished.load(std::memory_order_acquire))
+        {
+            gameThread.join();
+        }
+        else
+        {
+            std::cerr << "[run] game thread did not stop within timeout; detaching" << std::endl;
+            gameThread.detach();
+        }
+    }
+
+    const auto workerDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(250);
+    while (g_activeThreads.load(std::memory_order_relaxed) > 0 &&
+           std::chrono::steady_clock::now() < workerDeadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void PS2Runtime::run()
+{
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_cpuContext.r[4] = _mm_setzero_si128();
+    m_cpuContext.r[5] = _mm_setzero_si128();
+    m_cpuContext.r[29] = _mm_set_epi64x(0, static_cast<int64_t>(PS2_RAM_SIZE - 0x10u));
+    m_debugPc.store(m_cpuContext.pc, std::memory_order_relaxed);
+    m_debugRa.store(static_cast<uint32_t>(_mm_extract_epi32(m_cpuContext.r[31], 0)), std::memory_order_relaxed);
+    m_debugSp.store(static_cast<uint32_t>(_mm_extract_epi32(m_cpuContext.r[29], 0)), std::memory_order_relaxed);
+    m_debugGp.store(static_cast<uint32_t>(_mm_extract_epi32(m_cpuContext.r[28], 0)), std::memory_order_relaxed);
+
+    std::cout << "Starting execution at address 0x" << std::hex << m_cpuContext.pc << std::dec << std::endl;
+
+    if (m_headless)
+    {
+        runHeadless();
+        return;
+    }
+
+    // A blank image to use as a framebuffer
+    Image blank = GenImageColor(FB_WIDTH, FB_HEIGHT, BLANK);
+    Texture2D frameTex = LoadTextureFromImage(blank);
+    UnloadImage(blank);
+
+    m_memory.enableFrameOutput(FB_WIDTH, FB_HEIGHT);
+    FramePresenter presenter(m_memory);
+    presenter.start();
+
+    std::atomic<bool> gameThreadFinished{false};
+    std::thread gameThread = startGameThread(gameThreadFinished);
 
     uint64_t tick = 0;
     while (!gameThreadFinished.load(std::memory_order_acquire))
@@ -1448,7 +1553,12 @@ void PS2Runtime::run()
                 lastVif = curVif;
             }
         }
-        UploadFrame(frameTex, this);
+        presenter.present(frameTex);
+
+        if (ps2_trace::running() && IsKeyPressed(KEY_F9))
+        {
+            ps2_trace::writeSnapshot();
+        }
 
         BeginDrawing();
         ClearBackground(BLACK);
@@ -1463,34 +1573,7 @@ void PS2Runtime::run()
         }
     }
 
-    requestStop();
-
-    const auto joinDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-    while (!gameThreadFinished.load(std::memory_order_acquire) &&
-           std::chrono::steady_clock::now() < joinDeadline)
-    {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
-
-    if (gameThread.joinable())
-    {
-        if (gameThreadFinished.load(std::memory_order_acquire))
-        {
-            gameThread.join();
-        }
-        else
-        {
-            std::cerr << "[run] game thread did not stop within timeout; detaching" << std::endl;
-            gameThread.detach();
-        }
-    }
-
-    const auto workerDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(250);
-    while (g_activeThreads.load(std::memory_order_relaxed) > 0 &&
-           std::chrono::steady_clock::now() < workerDeadline)
-    {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
+    stopGameThread(gameThread, gameThreadFinished);
 
     UnloadTexture(frameTex);
     CloseWindow();
@@ -1503,3 +1586,47 @@ void PS2Runtime::run()
                   << " guest worker thread(s) still active during shutdown." << std::endl;
     }
 }
+
+void PS2Runtime::runHeadless()
+{
+    const uint64_t frames = m_headlessOptions.frames;
+    std::cout << "[headless] running " << (frames ? std::to_string(frames) : std::string("unlimited"))
+              << " frame(s)" << std::endl;
+
+    const uint64_t firstFrame = ps2_syscalls::vblankCount();
+    const uint64_t firstDispatch = m_dispatchCount.load(std::memory_order_relaxed);
+    const uint64_t firstSyscall = m_syscallCount.load(std::memory_order_relaxed);
+    const uint64_t firstDma = m_memory.dmaStartCount();
+    const uint64_t firstGif = m_memory.gifCopyCount();
+    const uint64_t firstGs = m_memory.gsWriteCount();
+    const uint64_t firstVif = m_memory.vifWriteCount();
+    const auto begin = std::chrono::steady_clock::now();
+
+    std::atomic<bool> gameThreadFinished{false};
+    std::thread gameThread = startGameThread(gameThreadFinished);
+
+    while (!gameThreadFinished.load(std::memory_order_acquire))
+    {
+        if (frames != 0 && ps2_syscalls::vblankCount() - firstFrame >= frames)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ps2_benchmark::Report report;
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    report.frames = ps2_syscalls::vblankCount() - firstFrame;
+    report.dispatches = m_dispatchCount.load(std::memory_order_relaxed) - firstDispatch;
+    report.syscalls = m_syscallCount.load(std::memory_order_relaxed) - firstSyscall;
+    report.dmaStarts = m_memory.dmaStartCount() - firstDma;
+    report.gifCopies = m_memory.gifCopyCount() - firstGif;
+    report.gsWrites = m_memory.gsWriteCount() - firstGs;
+    report.vifWrites = m_memory.vifWriteCount() - firstVif;
+    report.guestExited = gameThreadFinished.load(std::memory_order_acquire);
+
+    stopGameThread(gameThread, gameThreadFinished);
+
+    report.peakRssBytes = ps2_benchmark::peakResidentBytes();
+    if (ps2_callstats::running())
+        report.calls = ps2_callstats::snapshot();
+    ps2_benchmark::writeReport(report, m_headlessOptions.reportPath);
+}
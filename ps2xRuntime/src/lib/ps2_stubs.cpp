@@ -1,25 +1,48 @@
 #include "ps2_stubs.h"
 #include "ps2_runtime.h"
 #include "ps2_syscalls.h"
+#include "ps2_runtime_macros.h"
+#include "ps2_gs_swizzle.h"
+#include "ps2_path_cache.h"
+#include "ps2_log.h"
+#include "ps2_trace.h"
 #include <iostream>
 #include <algorithm>
 #include <array>
 #include <cctype>
+#include <chrono>
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <condition_variable>
 #include <ctime>
+#include <deque>
 #include <fstream>
+#include <list>
 #include <sstream>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
 #include <filesystem>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <ThreadNaming.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "stubs/helpers/ps2_stubs_helpers_cdimage.inl"
+#include "stubs/helpers/ps2_stubs_helpers_cdcompress.inl"
+#include "stubs/helpers/ps2_stubs_helpers_iso9660.inl"
 #include "stubs/helpers/ps2_stubs_helpers.inl"
+#include "stubs/helpers/ps2_stubs_helpers_cdio.inl"
 
 namespace ps2_stubs
 {
@@ -30,6 +53,11 @@ namespace ps2_stubs
 #include "stubs/ps2_stubs_gs.inl"
 #include "stubs/ps2_stubs_residentEvilCV.inl"
 
+    void pollCdCallbacks(uint8_t *rdram, PS2Runtime *runtime)
+    {
+        dispatchCdCallbacks(rdram, runtime);
+    }
+
     void TODO(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     {
         TODO_NAMED("unknown", rdram, ctx, runtime);
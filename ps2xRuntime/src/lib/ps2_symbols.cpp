@@ -0,0 +1,55 @@
+#include "ps2_symbols.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace
+{
+    std::shared_mutex g_mutex;
+    std::vector<ps2_symbols::FunctionSymbol> g_symbols; // sorted by start
+}
+
+namespace ps2_symbols
+{
+    void registerFunctions(const FunctionSymbol *symbols, size_t count)
+    {
+        std::unique_lock<std::shared_mutex> lock(g_mutex);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (symbols[i].end > symbols[i].start && symbols[i].name)
+                g_symbols.push_back(symbols[i]);
+        }
+        std::sort(g_symbols.begin(), g_symbols.end(), [](const FunctionSymbol &a, const FunctionSymbol &b)
+                  { return a.start < b.start; });
+    }
+
+    void clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(g_mutex);
+        g_symbols.clear();
+    }
+
+    bool find(uint32_t pc, FunctionSymbol &symbol)
+    {
+        std::shared_lock<std::shared_mutex> lock(g_mutex);
+        auto it = std::upper_bound(g_symbols.begin(), g_symbols.end(), pc, [](uint32_t value, const FunctionSymbol &entry)
+                                   { return value < entry.start; });
+        if (it == g_symbols.begin() || pc >= std::prev(it)->end)
+            return false;
+        symbol = *std::prev(it);
+        return true;
+    }
+
+    std::string describe(uint32_t pc)
+    {
+        FunctionSymbol symbol{};
+        if (find(pc, symbol))
+            return symbol.name;
+        char text[16];
+        std::snprintf(text, sizeof(text), "0x%08x", pc);
+        return text;
+    }
+}
@@ -2,6 +2,11 @@
 #include "ps2_runtime.h"
 #include "ps2_runtime_macros.h"
 #include "ps2_stubs.h"
+#include "ps2_async_io.h"
+#include "ps2_path_cache.h"
+#include "ps2_log.h"
+#include "ps2_profiler.h"
+#include "ps2_trace.h"
 #include <iostream>
 
 // Global DMAC memory watchpoint — set by instrumented recompiled code
@@ -25,9 +30,13 @@ uint64_t g_dmacWatchVal = 0;
 #include <memory>
 #include <string>
 
+#include <fcntl.h>
 #ifndef _WIN32
-#include <unistd.h>   // for unlink,rmdir,chdir
+#include <unistd.h>   // for unlink,rmdir,chdir,pread,pwrite
 #include <sys/stat.h> // for mkdir
+#else
+#include <io.h>
+#include <sys/stat.h>
 #endif
 #include <ThreadNaming.h>
 
@@ -46,6 +55,7 @@ namespace ps2_syscalls
 
     bool dispatchNumericSyscall(uint32_t syscallNumber, uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     {
+        ps2_callstats::Scope callStats(ps2_callstats::numericSyscallId(syscallNumber));
         switch (syscallNumber)
         {
         case 0x01:
@@ -300,6 +310,7 @@ namespace ps2_syscalls
             SetMemoryMode(rdram, ctx, runtime);
             return true;
         default:
+            callStats.discard();
             return false;
         }
     }
@@ -420,9 +431,16 @@ namespace ps2_syscalls
 
     void pollVBlank(uint8_t *rdram, PS2Runtime *runtime)
     {
+        raiseVBlankAtWaitPoint(runtime);
         pollVBlankInline(rdram, runtime);
     }
 
+    uint64_t vblankCount()
+    {
+        std::lock_guard<std::mutex> lock(g_vsync_flag_mutex);
+        return g_vsync_tick_counter;
+    }
+
     static std::thread::id g_main_thread_id{};
 
     void setMainThread()
@@ -437,6 +455,6 @@ namespace ps2_syscalls
 
     std::mutex& getGuestExecMutex()
     {
-        return g_guest_exec_mutex;
+        return g_guest_exec_mutex.mutex;
     }
 }
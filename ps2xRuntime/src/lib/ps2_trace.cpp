@@ -0,0 +1,240 @@
+#include "ps2_trace.h"
+#include <ThreadNaming.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    using namespace ps2_trace;
+
+    struct Event
+    {
+        uint64_t ns;
+        const char *category;
+        const char *name;
+        const char *argName;
+        uint64_t arg;
+        Phase phase;
+    };
+
+    // Events are allocated in chunks as a thread records them, so the many
+    // short-lived guest and worker threads only pay for what they use.
+    constexpr size_t kChunkEvents = 1024;
+
+    // Written only by its own thread; count is published with release so the
+    // writer sees complete events, and every chunk below count is allocated
+    // before count moves past it. Buffers are never freed, so a thread that
+    // exits leaves its events behind for the next write.
+    struct ThreadBuffer
+    {
+        uint32_t tid = 0;
+        std::string name;
+        std::unique_ptr<std::unique_ptr<Event[]>[]> chunks; // capacity / kChunkEvents slots, filled on demand
+        size_t capacity = 0;
+        std::atomic<size_t> count{0};
+        std::atomic<uint64_t> dropped{0};
+
+        Event &at(size_t index) const
+        {
+            return chunks[index / kChunkEvents][index % kChunkEvents];
+        }
+    };
+
+    std::mutex g_buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+    thread_local ThreadBuffer *t_buffer = nullptr;
+
+    std::mutex g_controlMutex;
+    Options g_options;
+    std::atomic<size_t> g_capacity{0};
+    const auto g_origin = std::chrono::steady_clock::now();
+
+    ThreadBuffer *threadBuffer()
+    {
+        if (t_buffer)
+            return t_buffer;
+
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->capacity = g_capacity.load(std::memory_order_relaxed);
+        buffer->chunks = std::make_unique<std::unique_ptr<Event[]>[]>((buffer->capacity + kChunkEvents - 1) / kChunkEvents);
+        std::lock_guard<std::mutex> lock(g_buffersMutex);
+        buffer->tid = static_cast<uint32_t>(g_buffers.size() + 1);
+        buffer->name = ThreadNaming::CurrentThreadName();
+        if (buffer->name.empty())
+            buffer->name = "Thread " + std::to_string(buffer->tid);
+        t_buffer = buffer.get();
+        g_buffers.push_back(std::move(buffer));
+        return t_buffer;
+    }
+
+    void appendString(std::string &out, const char *text)
+    {
+        out.push_back('"');
+        for (; *text; ++text)
+        {
+            const char c = *text;
+            if (c == '"' || c == '\\')
+            {
+                out.push_back('\\');
+                out.push_back(c);
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                out.push_back(' ');
+            }
+            else
+            {
+                out.push_back(c);
+            }
+        }
+        out.push_back('"');
+    }
+
+    void appendEvent(std::string &out, uint32_t tid, const Event &event)
+    {
+        char number[64];
+        out += "{\"name\":";
+        appendString(out, event.name);
+        out += ",\"cat\":";
+        appendString(out, event.category);
+        std::snprintf(number, sizeof(number), ",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%u",
+                      static_cast<char>(event.phase), static_cast<unsigned long long>(event.ns / 1000u),
+                      static_cast<unsigned>(event.ns % 1000u), tid);
+        out += number;
+        if (event.phase == Phase::Instant)
+            out += ",\"s\":\"t\"";
+        if (event.argName)
+        {
+            out += ",\"args\":{";
+            appendString(out, event.argName);
+            std::snprintf(number, sizeof(number), ":%llu}", static_cast<unsigned long long>(event.arg));
+            out += number;
+        }
+        out += "},\n";
+    }
+}
+
+namespace ps2_trace
+{
+    void record(Phase phase, const char *category, const char *name, const char *argName, uint64_t arg)
+    {
+        ThreadBuffer *buffer = threadBuffer();
+        const size_t index = buffer->count.load(std::memory_order_relaxed);
+        if (index >= buffer->capacity)
+        {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        std::unique_ptr<Event[]> &chunk = buffer->chunks[index / kChunkEvents];
+        if (!chunk)
+            chunk = std::make_unique<Event[]>(kChunkEvents);
+
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_origin);
+        buffer->at(index) = {static_cast<uint64_t>(ns.count()), category, name, argName, arg, phase};
+        buffer->count.store(index + 1, std::memory_order_release);
+    }
+
+    bool start(const Options &options)
+    {
+        std::lock_guard<std::mutex> lock(g_controlMutex);
+        if (g_enabled.load(std::memory_order_acquire))
+            return false;
+        g_options = options;
+        g_capacity.store(options.eventsPerThread, std::memory_order_relaxed);
+        g_enabled.store(true, std::memory_order_release);
+        return true;
+    }
+
+    bool stop()
+    {
+        std::lock_guard<std::mutex> lock(g_controlMutex);
+        if (!g_enabled.exchange(false, std::memory_order_acq_rel))
+            return true;
+        if (g_options.outputPath.empty())
+            return true;
+        return write(g_options.outputPath);
+    }
+
+    bool running()
+    {
+        return enabled();
+    }
+
+    std::string json()
+    {
+        std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        std::lock_guard<std::mutex> lock(g_buffersMutex);
+        for (const auto &buffer : g_buffers)
+        {
+            out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(buffer->tid) +
+                   ",\"args\":{\"name\":";
+            appendString(out, buffer->name.c_str());
+            out += "}},\n";
+
+            const size_t count = buffer->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; ++i)
+                appendEvent(out, buffer->tid, buffer->at(i));
+        }
+        out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ps2xRuntime\"}}\n]}\n";
+        return out;
+    }
+
+    bool write(const std::filesystem::path &path)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << json();
+        if (!out)
+        {
+            std::cerr << "[trace] failed to write " << path.string() << std::endl;
+            return false;
+        }
+        std::cout << "[trace] " << eventCount() << " events (" << droppedCount() << " dropped) written to "
+                  << path.string() << std::endl;
+        return true;
+    }
+
+    bool writeSnapshot()
+    {
+        std::filesystem::path path;
+        {
+            std::lock_guard<std::mutex> lock(g_controlMutex);
+            path = g_options.outputPath;
+        }
+        return !path.empty() && write(path);
+    }
+
+    uint64_t eventCount()
+    {
+        std::lock_guard<std::mutex> lock(g_buffersMutex);
+        uint64_t total = 0;
+        for (const auto &buffer : g_buffers)
+            total += buffer->count.load(std::memory_order_acquire);
+        return total;
+    }
+
+    uint64_t droppedCount()
+    {
+        std::lock_guard<std::mutex> lock(g_buffersMutex);
+        uint64_t total = 0;
+        for (const auto &buffer : g_buffers)
+            total += buffer->dropped.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(g_buffersMutex);
+        for (const auto &buffer : g_buffers)
+        {
+            buffer->count.store(0, std::memory_order_relaxed);
+            buffer->dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,469 @@
+#include "ps2_vif.h"
+#include "ps2_memory.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    using ps2_vif::Unpack;
+    using UnpackKernel = void (*)(const Unpack &, const uint8_t *, uint8_t *, uint32_t, uint32_t *, const uint32_t *);
+
+    constexpr uint32_t kStatMrk = 0x40;
+    constexpr uint32_t kStatDbf = 0x80;
+
+    inline uint32_t loadU32(const uint8_t *p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // STCYCL treats a zero CL or WL as 256.
+    inline uint32_t cycleLength(uint32_t value)
+    {
+        return value ? value : 256u;
+    }
+
+    template <uint32_t VN, uint32_t VL>
+    constexpr uint32_t elementBytes()
+    {
+        return VL == 3 ? 2u : (VN + 1u) * (4u >> VL);
+    }
+
+    // One source element widened to four 32-bit lanes. V1 broadcasts, V2 repeats
+    // as xyxy, V3 leaves w zero.
+    template <uint32_t VN, uint32_t VL, bool ZeroExtend>
+    inline __m128i loadVector(const uint8_t *src)
+    {
+        if constexpr (VL == 3)
+        {
+            // V4-5: RGBA 5:5:5:1 to 8 bits per channel.
+            uint16_t v;
+            std::memcpy(&v, src, sizeof(v));
+            return _mm_setr_epi32((v & 0x1F) << 3, ((v >> 5) & 0x1F) << 3, ((v >> 10) & 0x1F) << 3, (v >> 15) << 7);
+        }
+        else
+        {
+            constexpr uint32_t bytes = elementBytes<VN, VL>();
+            __m128i raw;
+            if constexpr (bytes == 16)
+            {
+                raw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+            }
+            else if constexpr (bytes == 8)
+            {
+                raw = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src));
+            }
+            else if constexpr (bytes == 4)
+            {
+                raw = _mm_cvtsi32_si128(static_cast<int>(loadU32(src)));
+            }
+            else
+            {
+                alignas(16) uint8_t tmp[16] = {};
+                std::memcpy(tmp, src, bytes);
+                raw = _mm_load_si128(reinterpret_cast<const __m128i *>(tmp));
+            }
+
+            __m128i v;
+            if constexpr (VL == 0)
+                v = raw;
+            else if constexpr (VL == 1)
+                v = ZeroExtend ? _mm_cvtepu16_epi32(raw) : _mm_cvtepi16_epi32(raw);
+            else
+                v = ZeroExtend ? _mm_cvtepu8_epi32(raw) : _mm_cvtepi8_epi32(raw);
+
+            if constexpr (VN == 0)
+                return _mm_shuffle_epi32(v, 0x00);
+            else if constexpr (VN == 1)
+                return _mm_shuffle_epi32(v, 0x44);
+            else
+                return v;
+        }
+    }
+
+    template <uint32_t VN, uint32_t VL, bool ZeroExtend>
+    void unpackKernel(const Unpack &u, const uint8_t *src, uint8_t *vuData, uint32_t qwMask, uint32_t *row,
+                      const uint32_t *col)
+    {
+        constexpr uint32_t step = elementBytes<VN, VL>();
+        __m128i *dst = reinterpret_cast<__m128i *>(vuData);
+        const uint32_t cl = cycleLength(u.cl);
+        const uint32_t wl = cycleLength(u.wl);
+        uint32_t qw = u.addr;
+
+        if (!u.masked && u.mode == 0 && cl >= wl)
+        {
+            // Plain skipping write: WL vectors, then skip CL - WL qwords.
+            const uint32_t skip = cl - wl;
+            for (uint32_t i = 0, pos = 0; i < u.num; ++i)
+            {
+                _mm_storeu_si128(dst + (qw & qwMask), loadVector<VN, VL, ZeroExtend>(src));
+                src += step;
+                ++qw;
+                if (++pos == wl)
+                {
+                    pos = 0;
+                    qw += skip;
+                }
+            }
+            return;
+        }
+
+        // MASK holds a 2-bit selector per component for each of the first four
+        // cycle positions: 0 data, 1 row, 2 column, 3 write-protect.
+        __m128i selData[4], selRow[4], selCol[4], selKeep[4], colValue[4];
+        for (uint32_t r = 0; r < 4; ++r)
+        {
+            const uint32_t bits = u.masked ? (u.mask >> (r * 8u)) & 0xFFu : 0u;
+            int32_t lanes[4][4] = {};
+            for (uint32_t c = 0; c < 4; ++c)
+                lanes[(bits >> (c * 2u)) & 3u][c] = -1;
+            selData[r] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes[0]));
+            selRow[r] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes[1]));
+            selCol[r] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes[2]));
+            selKeep[r] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes[3]));
+            colValue[r] = _mm_set1_epi32(static_cast<int>(col[r]));
+        }
+
+        __m128i rowValue = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row));
+        const uint32_t skip = cl >= wl ? cl - wl : 0u;
+        for (uint32_t i = 0, pos = 0; i < u.num; ++i)
+        {
+            const uint32_t r = std::min(pos, 3u);
+            __m128i value;
+            if (cl >= wl || pos < cl)
+            {
+                value = loadVector<VN, VL, ZeroExtend>(src);
+                src += step;
+                if (u.mode != 0)
+                    value = _mm_add_epi32(value, rowValue);
+                if (u.mode == 2)
+                    rowValue = _mm_blendv_epi8(rowValue, value, selData[r]);
+            }
+            else
+            {
+                // Filling write: vectors past CL in a WL cycle carry no data.
+                value = rowValue;
+            }
+
+            __m128i *out = dst + (qw & qwMask);
+            if (u.masked)
+            {
+                value = _mm_or_si128(_mm_or_si128(_mm_and_si128(value, selData[r]), _mm_and_si128(rowValue, selRow[r])),
+                                     _mm_and_si128(colValue[r], selCol[r]));
+                value = _mm_blendv_epi8(value, _mm_loadu_si128(out), selKeep[r]);
+            }
+            _mm_storeu_si128(out, value);
+
+            ++qw;
+            if (++pos == wl)
+            {
+                pos = 0;
+                qw += skip;
+            }
+        }
+
+        if (u.mode == 2)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row), rowValue);
+    }
+
+    template <uint32_t VN, uint32_t VL>
+    constexpr UnpackKernel kernel(bool zeroExtend)
+    {
+        return zeroExtend ? unpackKernel<VN, VL, true> : unpackKernel<VN, VL, false>;
+    }
+
+    UnpackKernel selectKernel(uint32_t vn, uint32_t vl, bool zeroExtend)
+    {
+        switch (vl * 4u + vn)
+        {
+        case 0: return kernel<0, 0>(zeroExtend);
+        case 1: return kernel<1, 0>(zeroExtend);
+        case 2: return kernel<2, 0>(zeroExtend);
+        case 3: return kernel<3, 0>(zeroExtend);
+        case 4: return kernel<0, 1>(zeroExtend);
+        case 5: return kernel<1, 1>(zeroExtend);
+        case 6: return kernel<2, 1>(zeroExtend);
+        case 7: return kernel<3, 1>(zeroExtend);
+        case 8: return kernel<0, 2>(zeroExtend);
+        case 9: return kernel<1, 2>(zeroExtend);
+        case 10: return kernel<2, 2>(zeroExtend);
+        case 11: return kernel<3, 2>(zeroExtend);
+        case 15: return kernel<3, 3>(false);
+        default: return nullptr; // vl 3 is only defined for V4
+        }
+    }
+}
+
+namespace ps2_vif
+{
+    uint32_t unpackBytes(const Unpack &u)
+    {
+        if (u.vl == 3 && u.vn != 3)
+            return 0;
+        const uint32_t elementBits = u.vl == 3 ? 16u : (u.vn + 1u) * (32u >> u.vl);
+        const uint32_t cl = cycleLength(u.cl);
+        const uint32_t wl = cycleLength(u.wl);
+        const uint32_t elements = cl >= wl ? u.num : (u.num / wl) * cl + std::min(u.num % wl, cl);
+        return (elements * elementBits + 31u) / 32u * 4u;
+    }
+
+    void unpack(const Unpack &u, const uint8_t *src, uint8_t *vuData, uint32_t dataQwords, uint32_t row[4],
+                const uint32_t col[4])
+    {
+        if (const UnpackKernel run = selectKernel(u.vn, u.vl, u.zeroExtend))
+            run(u, src, vuData, dataQwords - 1u, row, col);
+    }
+
+    void Processor::attach(uint32_t unit, VIFRegisters *regs, uint8_t *code, uint32_t codeSize, uint8_t *data,
+                           uint32_t dataSize)
+    {
+        m_unit = unit;
+        m_regs = regs;
+        m_code = code;
+        m_codeSize = codeSize;
+        m_data = data;
+        m_dataSize = dataSize;
+        reset();
+    }
+
+    void Processor::reset()
+    {
+        m_pendingCode = 0;
+        m_pendingWords = 0;
+        m_pending.clear();
+        m_path3Masked = false;
+    }
+
+    // VIFcode: IMMEDIATE bits 0-15, NUM 16-23, CMD 24-30, I 31.
+    uint32_t Processor::dataWords(uint32_t code) const
+    {
+        const uint32_t cmd = (code >> 24) & 0x7Fu;
+        const uint32_t num = (code >> 16) & 0xFFu;
+        const uint32_t imm = code & 0xFFFFu;
+        switch (cmd)
+        {
+        case STMASK:
+            return 1;
+        case STROW:
+        case STCOL:
+            return 4;
+        case MPG:
+            return (num ? num : 256u) * 2u;
+        case DIRECT:
+        case DIRECTHL:
+            return m_unit == 1 ? (imm ? imm : 65536u) * 4u : 0u;
+        default:
+            break;
+        }
+        if ((cmd & 0x60u) != 0x60u || !m_regs)
+            return 0;
+
+        Unpack u;
+        u.vn = (cmd >> 2) & 3u;
+        u.vl = cmd & 3u;
+        u.num = num ? num : 256u;
+        u.cl = m_regs->cycle & 0xFFu;
+        u.wl = (m_regs->cycle >> 8) & 0xFFu;
+        return unpackBytes(u) / 4u;
+    }
+
+    void Processor::feed(const uint8_t *data, size_t bytes)
+    {
+        if (!m_regs)
+            return;
+
+        size_t words = bytes / 4u;
+        while (words != 0)
+        {
+            if (m_pendingWords != 0)
+            {
+                const uint32_t take = static_cast<uint32_t>(std::min<size_t>(m_pendingWords, words));
+                const uint32_t cmd = (m_pendingCode >> 24) & 0x7Fu;
+                if (cmd == DIRECT || cmd == DIRECTHL)
+                {
+                    // Stream to PATH2 in whole qwords; the GIF parser ignores
+                    // anything shorter.
+                    if (m_pending.empty() && (take & 3u) == 0)
+                    {
+                        if (m_direct)
+                            m_direct(data, take * 4u);
+                    }
+                    else
+                    {
+                        m_pending.insert(m_pending.end(), data, data + take * 4u);
+                        const size_t whole = m_pending.size() & ~static_cast<size_t>(15);
+                        if (whole != 0)
+                        {
+                            if (m_direct)
+                                m_direct(m_pending.data(), static_cast<uint32_t>(whole));
+                            m_pending.erase(m_pending.begin(), m_pending.begin() + static_cast<ptrdiff_t>(whole));
+                        }
+                    }
+                    m_pendingWords -= take;
+                }
+                else
+                {
+                    m_pending.insert(m_pending.end(), data, data + take * 4u);
+                    m_pendingWords -= take;
+                    if (m_pendingWords == 0)
+                        execute(m_pendingCode, m_pending.data());
+                }
+                data += take * 4u;
+                words -= take;
+                continue;
+            }
+
+            const uint32_t code = loadU32(data);
+            data += 4;
+            --words;
+            const uint32_t need = dataWords(code);
+            const uint32_t cmd = (code >> 24) & 0x7Fu;
+            if (need != 0 && (need > words || cmd == DIRECT || cmd == DIRECTHL))
+            {
+                m_regs->code = code;
+                m_pendingCode = code;
+                m_pendingWords = need;
+                m_pending.clear();
+                if (cmd == DIRECT || cmd == DIRECTHL)
+                    ++m_commands;
+                continue;
+            }
+            execute(code, need != 0 ? data : nullptr);
+            data += need * 4u;
+            words -= need;
+        }
+    }
+
+    void Processor::execute(uint32_t code, const uint8_t *data)
+    {
+        const uint32_t cmd = (code >> 24) & 0x7Fu;
+        const uint32_t num = (code >> 16) & 0xFFu;
+        const uint32_t imm = code & 0xFFFFu;
+        VIFRegisters &regs = *m_regs;
+        regs.code = code;
+        ++m_commands;
+
+        switch (cmd)
+        {
+        case NOP:
+            break;
+        case STCYCL:
+            regs.cycle = imm;
+            break;
+        case OFFSET:
+            if (m_unit == 1)
+            {
+                regs.ofst = imm & 0x3FFu;
+                regs.stat &= ~kStatDbf;
+                regs.tops = regs.base;
+            }
+            break;
+        case BASE:
+            if (m_unit == 1)
+                regs.base = imm & 0x3FFu;
+            break;
+        case ITOP:
+            regs.itops = imm & 0x3FFu;
+            break;
+        case STMOD:
+            regs.mode = imm & 3u;
+            break;
+        case MSKPATH3:
+            if (m_unit == 1)
+                m_path3Masked = (imm & 0x8000u) != 0;
+            break;
+        case MARK:
+            regs.mark = imm;
+            regs.stat |= kStatMrk;
+            break;
+        case FLUSHE:
+        case FLUSH:
+        case FLUSHA:
+            // Microprograms run to completion inside MSCAL, so nothing is in flight.
+            break;
+        case MSCAL:
+        case MSCALF:
+            startMicro(imm);
+            break;
+        case MSCNT:
+            startMicro(kContinue);
+            break;
+        case STMASK:
+            regs.mask = loadU32(data);
+            break;
+        case STROW:
+            std::memcpy(regs.row, data, sizeof(regs.row));
+            break;
+        case STCOL:
+            std::memcpy(regs.col, data, sizeof(regs.col));
+            break;
+        case MPG:
+        {
+            // NUM doublewords of microcode at IMMEDIATE (in doublewords).
+            const uint32_t bytes = (num ? num : 256u) * 8u;
+            const uint32_t start = (imm * 8u) & (m_codeSize - 1u);
+            uint32_t offset = start;
+            for (uint32_t done = 0; done < bytes;)
+            {
+                const uint32_t run = std::min(bytes - done, m_codeSize - offset);
+                std::memcpy(m_code + offset, data + done, run);
+                done += run;
+                offset = 0;
+            }
+            if (m_upload)
+                m_upload(start, bytes);
+            break;
+        }
+        default:
+            if ((cmd & 0x60u) == 0x60u)
+            {
+                // UNPACK: m bit 4, vn bits 2-3, vl bits 0-1; IMMEDIATE has ADDR
+                // 0-9, USN 14 and FLG 15 (add TOPS, VIF1 only).
+                Unpack u;
+                u.vn = (cmd >> 2) & 3u;
+                u.vl = cmd & 3u;
+                u.masked = (cmd & 0x10u) != 0;
+                u.zeroExtend = (imm & 0x4000u) != 0;
+                u.addr = imm & 0x3FFu;
+                if (m_unit == 1 && (imm & 0x8000u))
+                    u.addr += regs.tops;
+                u.num = num ? num : 256u;
+                u.cl = regs.cycle & 0xFFu;
+                u.wl = (regs.cycle >> 8) & 0xFFu;
+                u.mode = regs.mode & 3u;
+                u.mask = regs.mask;
+                unpack(u, data, m_data, m_dataSize / 16u, regs.row, regs.col);
+                regs.num = 0;
+                break;
+            }
+
+            static uint32_t unknownReports = 0;
+            if (unknownReports < 16)
+            {
+                ++unknownReports;
+                std::cerr << "[VIF" << m_unit << "] unhandled VIFcode 0x" << std::hex << code << std::dec
+                          << std::endl;
+            }
+            break;
+        }
+    }
+
+    // VIF1 double buffering: each start hands TOPS to the program as TOP and
+    // flips TOPS between BASE and BASE + OFFSET.
+    void Processor::startMicro(uint32_t pc)
+    {
+        VIFRegisters &regs = *m_regs;
+        regs.itop = regs.itops;
+        if (m_unit == 1)
+        {
+            regs.top = regs.tops;
+            regs.stat ^= kStatDbf;
+            regs.tops = regs.base + ((regs.stat & kStatDbf) ? regs.ofst : 0u);
+        }
+        if (m_micro)
+            m_micro(pc);
+    }
+}
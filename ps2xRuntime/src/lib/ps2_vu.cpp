@@ -0,0 +1,766 @@
+#include "ps2_vu.h"
+#include "ps2_memory.h"
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    using ps2_vu::State;
+    using ps2_vu::kEnd;
+
+    constexpr uint32_t kIBit = 1u << 31;
+    constexpr uint32_t kEBit = 1u << 30;
+
+    enum class Arith : uint8_t
+    {
+        Add,
+        Sub,
+        Mul,
+        Madd,
+        Msub,
+        Max,
+        Min,
+    };
+
+    enum class Source : uint8_t
+    {
+        Broadcast,
+        Q,
+        I,
+        Vector,
+    };
+
+    // What the upper half of a pair leaves behind; it is written back after
+    // the lower half so that both see the registers as they were.
+    struct UpperResult
+    {
+        enum Target : uint8_t
+        {
+            None,
+            Vf,
+            Acc,
+            Clip,
+        } target = None;
+        uint32_t reg = 0;
+        uint32_t dest = 0;
+        bool flags = false;
+        __m128 value;
+        uint32_t clip = 0;
+    };
+
+    inline uint32_t field(uint32_t word, uint32_t shift)
+    {
+        return (word >> shift) & 0x1Fu;
+    }
+
+    inline __m128 operand(const State &vu, Source source, uint32_t ft, uint32_t bc)
+    {
+        switch (source)
+        {
+        case Source::Broadcast:
+            return _mm_set1_ps(ps2_vu::lane(vu.vf[ft], bc));
+        case Source::Q:
+            return _mm_set1_ps(vu.q);
+        case Source::I:
+            return _mm_set1_ps(vu.i);
+        default:
+            return vu.vf[ft];
+        }
+    }
+
+    inline __m128 arithmetic(const State &vu, Arith op, __m128 fs, __m128 t)
+    {
+        switch (op)
+        {
+        case Arith::Add:
+            return _mm_add_ps(fs, t);
+        case Arith::Sub:
+            return _mm_sub_ps(fs, t);
+        case Arith::Mul:
+            return _mm_mul_ps(fs, t);
+        case Arith::Madd:
+            return _mm_add_ps(vu.acc, _mm_mul_ps(fs, t));
+        case Arith::Msub:
+            return _mm_sub_ps(vu.acc, _mm_mul_ps(fs, t));
+        case Arith::Max:
+            return _mm_max_ps(fs, t);
+        default:
+            return _mm_min_ps(fs, t);
+        }
+    }
+
+    UpperResult evaluateUpper(const State &vu, uint32_t upper)
+    {
+        static constexpr Arith kBroadcastOps[7] = {Arith::Add, Arith::Sub, Arith::Madd, Arith::Msub,
+                                                   Arith::Max, Arith::Min, Arith::Mul};
+        static constexpr Arith kAccBroadcastOps[4] = {Arith::Add, Arith::Sub, Arith::Madd, Arith::Msub};
+        struct Form
+        {
+            Arith op;
+            Source source;
+        };
+        // 0x1C-0x2F, in opcode order.
+        static constexpr Form kForms[20] = {
+            {Arith::Mul, Source::Q},       {Arith::Max, Source::I},       {Arith::Mul, Source::I},
+            {Arith::Min, Source::I},       {Arith::Add, Source::Q},       {Arith::Madd, Source::Q},
+            {Arith::Add, Source::I},       {Arith::Madd, Source::I},      {Arith::Sub, Source::Q},
+            {Arith::Msub, Source::Q},      {Arith::Sub, Source::I},       {Arith::Msub, Source::I},
+            {Arith::Add, Source::Vector},  {Arith::Madd, Source::Vector}, {Arith::Mul, Source::Vector},
+            {Arith::Max, Source::Vector},  {Arith::Sub, Source::Vector},  {Arith::Msub, Source::Vector},
+            {Arith::Add, Source::Vector},  {Arith::Min, Source::Vector}};
+        // Special table 0x1C-0x2F (ACC forms), same layout.
+        static constexpr Form kAccForms[20] = {
+            {Arith::Mul, Source::Q},       {Arith::Add, Source::Vector},  {Arith::Mul, Source::I},
+            {Arith::Add, Source::Vector},  {Arith::Add, Source::Q},       {Arith::Madd, Source::Q},
+            {Arith::Add, Source::I},       {Arith::Madd, Source::I},      {Arith::Sub, Source::Q},
+            {Arith::Msub, Source::Q},      {Arith::Sub, Source::I},       {Arith::Msub, Source::I},
+            {Arith::Add, Source::Vector},  {Arith::Madd, Source::Vector}, {Arith::Mul, Source::Vector},
+            {Arith::Add, Source::Vector},  {Arith::Sub, Source::Vector},  {Arith::Msub, Source::Vector},
+            {Arith::Add, Source::Vector},  {Arith::Add, Source::Vector}};
+
+        UpperResult result;
+        const uint32_t dest = (upper >> 21) & 0xFu;
+        const uint32_t ft = field(upper, 16);
+        const uint32_t fs = field(upper, 11);
+        const uint32_t fd = field(upper, 6);
+        const uint32_t op = upper & 0x3Fu;
+        const uint32_t bc = upper & 3u;
+        result.dest = dest;
+
+        if (op < 0x1Cu)
+        {
+            const Arith arith = kBroadcastOps[op >> 2];
+            result.target = UpperResult::Vf;
+            result.reg = fd;
+            result.flags = arith != Arith::Max && arith != Arith::Min;
+            result.value = arithmetic(vu, arith, vu.vf[fs], operand(vu, Source::Broadcast, ft, bc));
+            return result;
+        }
+        if (op < 0x30u)
+        {
+            const Form &form = kForms[op - 0x1Cu];
+            result.target = UpperResult::Vf;
+            result.reg = fd;
+            result.flags = form.op != Arith::Max && form.op != Arith::Min;
+            if (op == 0x2Eu) // OPMSUB
+                result.value = _mm_sub_ps(vu.acc, ps2_vu::outerProduct(vu.vf[fs], vu.vf[ft]));
+            else
+                result.value = arithmetic(vu, form.op, vu.vf[fs], operand(vu, form.source, ft, bc));
+            return result;
+        }
+        if (op < 0x3Cu)
+            return result;
+
+        const uint32_t special = (fd << 2) | bc;
+        if (special < 0x10u || (special >= 0x18u && special < 0x1Cu))
+        {
+            const Arith arith = special < 0x10u ? kAccBroadcastOps[special >> 2] : Arith::Mul;
+            result.target = UpperResult::Acc;
+            result.flags = true;
+            result.value = arithmetic(vu, arith, vu.vf[fs], operand(vu, Source::Broadcast, ft, bc));
+            return result;
+        }
+        if (special < 0x18u)
+        {
+            static constexpr float kScales[4] = {1.0f, 16.0f, 4096.0f, 32768.0f};
+            result.target = UpperResult::Vf;
+            result.reg = ft;
+            result.value = special < 0x14u ? ps2_vu::fixedToFloat(vu.vf[fs], 1.0f / kScales[bc])
+                                           : ps2_vu::floatToFixed(vu.vf[fs], kScales[bc]);
+            return result;
+        }
+        switch (special)
+        {
+        case 0x1D: // ABS
+            result.target = UpperResult::Vf;
+            result.reg = ft;
+            result.value = _mm_andnot_ps(_mm_set1_ps(-0.0f), vu.vf[fs]);
+            return result;
+        case 0x1F: // CLIP
+            result.target = UpperResult::Clip;
+            result.clip = ps2_vu::clipFlags(vu.clip, vu.vf[fs], ps2_vu::lane(vu.vf[ft], 3));
+            return result;
+        case 0x2B:
+        case 0x2F: // NOP
+            return result;
+        default:
+            break;
+        }
+        if (special >= 0x1Cu && special < 0x30u)
+        {
+            const Form &form = kAccForms[special - 0x1Cu];
+            result.target = UpperResult::Acc;
+            result.flags = true;
+            if (special == 0x2Eu) // OPMULA
+                result.value = ps2_vu::outerProduct(vu.vf[fs], vu.vf[ft]);
+            else
+                result.value = arithmetic(vu, form.op, vu.vf[fs], operand(vu, form.source, ft, bc));
+        }
+        return result;
+    }
+
+    void commitUpper(State &vu, const UpperResult &result)
+    {
+        switch (result.target)
+        {
+        case UpperResult::Vf:
+            if (result.reg != 0)
+                vu.vf[result.reg] = _mm_blendv_ps(vu.vf[result.reg], result.value, ps2_vu::destMask(result.dest));
+            break;
+        case UpperResult::Acc:
+            vu.acc = _mm_blendv_ps(vu.acc, result.value, ps2_vu::destMask(result.dest));
+            break;
+        case UpperResult::Clip:
+            vu.clip = result.clip;
+            break;
+        default:
+            break;
+        }
+        if (result.flags)
+            ps2_vu::setFlags(vu, result.value, result.dest);
+    }
+
+    inline void writeVf(State &vu, uint32_t reg, __m128 value, uint32_t dest)
+    {
+        if (reg != 0)
+            vu.vf[reg] = _mm_blendv_ps(vu.vf[reg], value, ps2_vu::destMask(dest));
+    }
+
+    inline void writeVi(State &vu, uint32_t reg, uint32_t value)
+    {
+        if (reg != 0)
+            vu.vi[reg] = static_cast<uint16_t>(value);
+    }
+
+    inline int32_t simm11(uint32_t lower)
+    {
+        return static_cast<int32_t>((lower & 0x7FFu) ^ 0x400u) - 0x400;
+    }
+
+    // Executes the lower half. Returns the branch target (in doublewords) of a
+    // taken branch or jump, kEnd otherwise.
+    uint32_t executeLower(State &vu, uint32_t lower, uint32_t pc)
+    {
+        const uint32_t dest = (lower >> 21) & 0xFu;
+        const uint32_t it = field(lower, 16);
+        const uint32_t is = field(lower, 11);
+        const uint32_t fsf = (lower >> 21) & 3u;
+        const uint32_t ftf = (lower >> 23) & 3u;
+        const int32_t imm11 = simm11(lower);
+        const uint32_t target = static_cast<uint32_t>(static_cast<int32_t>(pc) + 1 + imm11);
+        const auto viSigned = [&vu](uint32_t reg)
+        {
+            return static_cast<int16_t>(vu.vi[reg]);
+        };
+
+        if (lower & 0x80000000u)
+        {
+            const uint32_t op = lower & 0x3Fu;
+            const uint32_t id = field(lower, 6);
+            switch (op)
+            {
+            case 0x30: // IADD
+                writeVi(vu, id, vu.vi[is] + vu.vi[it]);
+                return kEnd;
+            case 0x31: // ISUB
+                writeVi(vu, id, vu.vi[is] - vu.vi[it]);
+                return kEnd;
+            case 0x32: // IADDI
+                writeVi(vu, it, vu.vi[is] + (static_cast<int32_t>((id ^ 0x10u)) - 0x10));
+                return kEnd;
+            case 0x34: // IAND
+                writeVi(vu, id, vu.vi[is] & vu.vi[it]);
+                return kEnd;
+            case 0x35: // IOR
+                writeVi(vu, id, vu.vi[is] | vu.vi[it]);
+                return kEnd;
+            default:
+                break;
+            }
+            if (op < 0x3Cu)
+                return kEnd;
+
+            const __m128 fs = vu.vf[is];
+            switch ((id << 2) | (op & 3u))
+            {
+            case 0x30: // MOVE
+                writeVf(vu, it, fs, dest);
+                break;
+            case 0x31: // MR32
+                writeVf(vu, it, _mm_shuffle_ps(fs, fs, _MM_SHUFFLE(0, 3, 2, 1)), dest);
+                break;
+            case 0x34: // LQI
+                writeVf(vu, it, ps2_vu::loadQword(vu, vu.vi[is]), dest);
+                writeVi(vu, is, vu.vi[is] + 1u);
+                break;
+            case 0x35: // SQI
+                ps2_vu::storeQword(vu, vu.vi[it], fs, dest);
+                writeVi(vu, it, vu.vi[it] + 1u);
+                break;
+            case 0x36: // LQD
+                writeVi(vu, is, vu.vi[is] - 1u);
+                writeVf(vu, it, ps2_vu::loadQword(vu, vu.vi[is]), dest);
+                break;
+            case 0x37: // SQD
+                writeVi(vu, it, vu.vi[it] - 1u);
+                ps2_vu::storeQword(vu, vu.vi[it], fs, dest);
+                break;
+            case 0x38: // DIV
+                vu.q = ps2_vu::divide(vu, ps2_vu::lane(fs, fsf), ps2_vu::lane(vu.vf[it], ftf));
+                break;
+            case 0x39: // SQRT
+                vu.q = ps2_vu::squareRoot(vu, ps2_vu::lane(vu.vf[it], ftf));
+                break;
+            case 0x3A: // RSQRT
+                vu.q = ps2_vu::reciprocalRoot(vu, ps2_vu::lane(fs, fsf), ps2_vu::lane(vu.vf[it], ftf));
+                break;
+            case 0x3C: // MTIR
+                writeVi(vu, it, ps2_vu::floatBits(ps2_vu::lane(fs, fsf)));
+                break;
+            case 0x3D: // MFIR
+                writeVf(vu, it, _mm_castsi128_ps(_mm_set1_epi32(static_cast<int16_t>(vu.vi[is]))), dest);
+                break;
+            case 0x3E: // ILWR
+                writeVi(vu, it, ps2_vu::loadInteger(vu, vu.vi[is], dest));
+                break;
+            case 0x3F: // ISWR
+                ps2_vu::storeInteger(vu, vu.vi[is], vu.vi[it], dest);
+                break;
+            case 0x40: // RNEXT
+                ps2_vu::randomNext(vu);
+                writeVf(vu, it, _mm_set1_ps(ps2_vu::randomValue(vu)), dest);
+                break;
+            case 0x41: // RGET
+                writeVf(vu, it, _mm_set1_ps(ps2_vu::randomValue(vu)), dest);
+                break;
+            case 0x42: // RINIT
+                vu.r = ps2_vu::floatBits(ps2_vu::lane(fs, fsf)) & 0x7FFFFFu;
+                break;
+            case 0x43: // RXOR
+                vu.r = (vu.r ^ ps2_vu::floatBits(ps2_vu::lane(fs, fsf))) & 0x7FFFFFu;
+                break;
+            case 0x64: // MFP
+                writeVf(vu, it, _mm_set1_ps(vu.p), dest);
+                break;
+            case 0x68: // XTOP
+                writeVi(vu, it, ps2_vu::xtop(vu));
+                break;
+            case 0x69: // XITOP
+                writeVi(vu, it, ps2_vu::xitop(vu));
+                break;
+            case 0x6C: // XGKICK
+                ps2_vu::xgkick(vu, vu.vi[is]);
+                break;
+            case 0x70: // ESADD
+            case 0x71: // ERSADD
+            case 0x72: // ELENG
+            case 0x73: // ERLENG
+            {
+                const __m128 squares = _mm_mul_ps(fs, fs);
+                const float sum = ps2_vu::lane(squares, 0) + ps2_vu::lane(squares, 1) + ps2_vu::lane(squares, 2);
+                const uint32_t form = ((id << 2) | (op & 3u)) - 0x70u;
+                vu.p = form == 0 ? sum : form == 1 ? 1.0f / sum : form == 2 ? std::sqrt(sum) : 1.0f / std::sqrt(sum);
+                break;
+            }
+            case 0x74: // EATANxy
+                vu.p = std::atan2(ps2_vu::lane(fs, 1), ps2_vu::lane(fs, 0));
+                break;
+            case 0x75: // EATANxz
+                vu.p = std::atan2(ps2_vu::lane(fs, 2), ps2_vu::lane(fs, 0));
+                break;
+            case 0x76: // ESUM
+                vu.p = ps2_vu::lane(fs, 0) + ps2_vu::lane(fs, 1) + ps2_vu::lane(fs, 2) + ps2_vu::lane(fs, 3);
+                break;
+            case 0x78: // ESQRT
+                vu.p = std::sqrt(std::fabs(ps2_vu::lane(fs, fsf)));
+                break;
+            case 0x79: // ERSQRT
+                vu.p = 1.0f / std::sqrt(std::fabs(ps2_vu::lane(fs, fsf)));
+                break;
+            case 0x7A: // ERCPR
+                vu.p = 1.0f / ps2_vu::lane(fs, fsf);
+                break;
+            case 0x7C: // ESIN
+                vu.p = std::sin(ps2_vu::lane(fs, fsf));
+                break;
+            case 0x7D: // EATAN
+                vu.p = std::atan(ps2_vu::lane(fs, fsf));
+                break;
+            case 0x7E: // EEXP
+                vu.p = std::exp(-ps2_vu::lane(fs, fsf));
+                break;
+            default: // WAITQ, WAITP and NOP: results are never in flight here
+                break;
+            }
+            return kEnd;
+        }
+
+        const uint32_t imm24 = lower & 0xFFFFFFu;
+        const uint32_t imm12 = ((lower >> 10) & 0x800u) | (lower & 0x7FFu);
+        const uint32_t imm15 = ((lower >> 10) & 0x7800u) | (lower & 0x7FFu);
+        switch (lower >> 25)
+        {
+        case 0x00: // LQ
+            writeVf(vu, it, ps2_vu::loadQword(vu, static_cast<uint32_t>(vu.vi[is] + imm11)), dest);
+            break;
+        case 0x01: // SQ
+            ps2_vu::storeQword(vu, static_cast<uint32_t>(vu.vi[it] + imm11), vu.vf[is], dest);
+            break;
+        case 0x04: // ILW
+            writeVi(vu, it, ps2_vu::loadInteger(vu, static_cast<uint32_t>(vu.vi[is] + imm11), dest));
+            break;
+        case 0x05: // ISW
+            ps2_vu::storeInteger(vu, static_cast<uint32_t>(vu.vi[is] + imm11), vu.vi[it], dest);
+            break;
+        case 0x08: // IADDIU
+            writeVi(vu, it, vu.vi[is] + imm15);
+            break;
+        case 0x09: // ISUBIU
+            writeVi(vu, it, vu.vi[is] - imm15);
+            break;
+        case 0x10: // FCEQ
+            writeVi(vu, 1, (vu.clip & 0xFFFFFFu) == imm24 ? 1u : 0u);
+            break;
+        case 0x11: // FCSET
+            vu.clip = imm24;
+            break;
+        case 0x12: // FCAND
+            writeVi(vu, 1, (vu.clip & imm24) ? 1u : 0u);
+            break;
+        case 0x13: // FCOR
+            writeVi(vu, 1, ((vu.clip | imm24) & 0xFFFFFFu) == 0xFFFFFFu ? 1u : 0u);
+            break;
+        case 0x14: // FSEQ
+            writeVi(vu, it, (vu.status & 0xFFFu) == imm12 ? 1u : 0u);
+            break;
+        case 0x15: // FSSET
+            vu.status = (vu.status & 0x3Fu) | (imm12 & 0xFC0u);
+            break;
+        case 0x16: // FSAND
+            writeVi(vu, it, vu.status & imm12);
+            break;
+        case 0x17: // FSOR
+            writeVi(vu, it, (vu.status & 0xFFFu) | imm12);
+            break;
+        case 0x18: // FMEQ
+            writeVi(vu, it, (vu.mac & 0xFFFFu) == vu.vi[is] ? 1u : 0u);
+            break;
+        case 0x1A: // FMAND
+            writeVi(vu, it, vu.mac & vu.vi[is]);
+            break;
+        case 0x1B: // FMOR
+            writeVi(vu, it, vu.mac | vu.vi[is]);
+            break;
+        case 0x1C: // FCGET
+            writeVi(vu, it, vu.clip & 0xFFFu);
+            break;
+        case 0x20: // B
+            return target;
+        case 0x21: // BAL
+            writeVi(vu, it, pc + 2u);
+            return target;
+        case 0x24: // JR
+            return vu.vi[is];
+        case 0x25: // JALR
+        {
+            const uint32_t jump = vu.vi[is];
+            writeVi(vu, it, pc + 2u);
+            return jump;
+        }
+        case 0x28: // IBEQ
+            return vu.vi[it] == vu.vi[is] ? target : kEnd;
+        case 0x29: // IBNE
+            return vu.vi[it] != vu.vi[is] ? target : kEnd;
+        case 0x2C: // IBLTZ
+            return viSigned(is) < 0 ? target : kEnd;
+        case 0x2D: // IBGTZ
+            return viSigned(is) > 0 ? target : kEnd;
+        case 0x2E: // IBLEZ
+            return viSigned(is) <= 0 ? target : kEnd;
+        case 0x2F: // IBGEZ
+            return viSigned(is) >= 0 ? target : kEnd;
+        default:
+            break;
+        }
+        return kEnd;
+    }
+
+    // GIF packet length in qwords, from the tag at qword addr to its EOP.
+    uint32_t gifPacketQwords(const State &vu, uint32_t addr)
+    {
+        uint32_t qwords = 0;
+        for (uint32_t tags = 0; tags <= vu.dataMask; ++tags)
+        {
+            uint64_t tag[2];
+            std::memcpy(tag, vu.data + ((addr + qwords) & vu.dataMask) * 16u, sizeof(tag));
+            const uint32_t nloop = static_cast<uint32_t>(tag[0] & 0x7FFFu);
+            const bool eop = (tag[0] >> 15) & 1u;
+            const uint32_t flg = static_cast<uint32_t>(tag[0] >> 58) & 3u;
+            uint32_t nreg = static_cast<uint32_t>(tag[0] >> 60);
+            if (nreg == 0)
+                nreg = 16;
+            qwords += 1u;
+            if (flg == 0)
+                qwords += nloop * nreg;
+            else if (flg == 1)
+                qwords += (nloop * nreg + 1u) / 2u;
+            else
+                qwords += nloop;
+            if (eop || qwords > vu.dataMask)
+                break;
+        }
+        return std::min(qwords, vu.dataMask + 1u);
+    }
+}
+
+namespace ps2_vu
+{
+    uint64_t contentHash(const uint8_t *bytes, size_t size, uint64_t seed)
+    {
+        uint64_t hash = seed;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    void xgkick(State &vu, uint16_t addr)
+    {
+        if (vu.unit)
+            vu.unit->kick(addr);
+    }
+
+    uint16_t xtop(const State &vu)
+    {
+        return vu.unit && vu.unit->vif() ? static_cast<uint16_t>(vu.unit->vif()->top & 0x3FFu) : 0;
+    }
+
+    uint16_t xitop(const State &vu)
+    {
+        return vu.unit && vu.unit->vif() ? static_cast<uint16_t>(vu.unit->vif()->itop & 0x3FFu) : 0;
+    }
+
+    VectorUnit::VectorUnit()
+    {
+        reset();
+    }
+
+    void VectorUnit::attach(uint32_t unit, uint8_t *code, uint32_t codeSize, uint8_t *data, uint32_t dataSize,
+                            const VIFRegisters *vif)
+    {
+        m_unit = unit;
+        m_code = code;
+        m_codeSize = codeSize;
+        m_vif = vif;
+        m_state.data = data;
+        m_state.dataMask = dataSize / 16u - 1u;
+        m_state.unit = this;
+        m_resident.clear();
+        m_mismatched.clear();
+        m_uploading = false;
+    }
+
+    void VectorUnit::reset()
+    {
+        for (__m128 &vf : m_state.vf)
+            vf = _mm_setzero_ps();
+        m_state.vf[0] = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+        m_state.acc = _mm_setzero_ps();
+        std::fill(std::begin(m_state.vi), std::end(m_state.vi), static_cast<uint16_t>(0));
+        m_state.q = 0.0f;
+        m_state.p = 0.0f;
+        m_state.i = 0.0f;
+        m_state.r = 0;
+        m_state.status = 0;
+        m_state.mac = 0;
+        m_state.clip = 0;
+        m_state.tpc = 0;
+    }
+
+    void VectorUnit::registerProgram(const ProgramInfo &info)
+    {
+        if (!info.entry)
+            return;
+        m_programs[{info.start, info.size, info.hash}] = info.entry;
+        m_mismatched.clear();
+    }
+
+    void VectorUnit::upload(uint32_t offset, uint32_t bytes)
+    {
+        if (!m_code || bytes == 0)
+            return;
+        offset &= m_codeSize - 1u;
+        const uint32_t end = offset + bytes;
+        dropResident(offset, end);
+
+        if (m_uploading && offset == m_uploadEnd && end <= m_codeSize)
+        {
+            m_uploadHash = contentHash(m_code + offset, bytes, m_uploadHash);
+            m_uploadEnd = end;
+        }
+        else
+        {
+            m_uploading = end <= m_codeSize;
+            m_uploadStart = offset;
+            m_uploadEnd = end;
+            m_uploadHash = m_uploading ? contentHash(m_code + offset, bytes) : kHashSeed;
+        }
+        if (!m_uploading)
+            return;
+
+        const auto it = m_programs.find({m_uploadStart, m_uploadEnd - m_uploadStart, m_uploadHash});
+        if (it == m_programs.end())
+            return;
+        dropResident(m_uploadStart, m_uploadEnd);
+        m_resident.push_back({m_uploadStart, m_uploadEnd, it->second});
+    }
+
+    void VectorUnit::invalidate(uint32_t offset, uint32_t bytes)
+    {
+        if (!m_code || bytes == 0)
+            return;
+        offset &= m_codeSize - 1u;
+        dropResident(offset, offset + bytes);
+        m_uploading = false;
+    }
+
+    void VectorUnit::dropResident(uint32_t start, uint32_t end)
+    {
+        m_resident.erase(std::remove_if(m_resident.begin(), m_resident.end(), [&](const Resident &r)
+        {
+            return r.start < end && start < r.end;
+        }), m_resident.end());
+        m_mismatched.clear();
+    }
+
+    Program VectorUnit::residentAt(uint32_t pc) const
+    {
+        const uint32_t offset = pc * 8u;
+        for (const Resident &r : m_resident)
+        {
+            if (offset >= r.start && offset < r.end)
+                return r.entry;
+        }
+        return nullptr;
+    }
+
+    Program VectorUnit::resolve(uint32_t pc)
+    {
+        if (Program program = residentAt(pc))
+            return program;
+        const uint32_t offset = pc * 8u;
+        for (const auto &[key, entry] : m_programs)
+        {
+            const auto &[start, size, hash] = key;
+            if (offset < start || offset >= start + size || start + size > m_codeSize ||
+                m_mismatched.count({start, size}))
+                continue;
+            if (contentHash(m_code + start, size) != hash)
+            {
+                m_mismatched.insert({start, size});
+                continue;
+            }
+            dropResident(start, start + size);
+            m_resident.push_back({start, start + size, entry});
+            return entry;
+        }
+        return nullptr;
+    }
+
+    void VectorUnit::start(uint32_t pc)
+    {
+        if (!m_code)
+            return;
+        m_uploading = false;
+        const uint32_t pcMask = m_codeSize / 8u - 1u;
+        if (pc == ps2_vif::Processor::kContinue)
+            pc = m_state.tpc;
+        m_state.budget = kBranchBudget;
+
+        while (pc != kEnd)
+        {
+            pc &= pcMask;
+            if (Program program = resolve(pc))
+            {
+                ++m_compiledRuns;
+                pc = program(m_state, pc);
+            }
+            else
+            {
+                ++m_interpretedRuns;
+                pc = interpret(pc);
+            }
+            if (pc != kEnd && m_state.budget == 0)
+            {
+                std::cerr << "[VU" << m_unit << "] microprogram still running at 0x" << std::hex << pc * 8u
+                          << std::dec << ", stopping it" << std::endl;
+                m_state.tpc = pc & pcMask;
+                break;
+            }
+        }
+    }
+
+    uint32_t VectorUnit::interpret(uint32_t pc)
+    {
+        State &vu = m_state;
+        const uint32_t pcMask = m_codeSize / 8u - 1u;
+        uint32_t pendingBranch = kEnd;
+        bool ending = false;
+        for (;;)
+        {
+            pc &= pcMask;
+            uint32_t pair[2];
+            std::memcpy(pair, m_code + pc * 8u, sizeof(pair));
+            const uint32_t lower = pair[0];
+            const uint32_t upper = pair[1];
+
+            const UpperResult result = evaluateUpper(vu, upper);
+            uint32_t branch = kEnd;
+            if (!(upper & kIBit))
+                branch = executeLower(vu, lower, pc);
+            commitUpper(vu, result);
+            if (upper & kIBit)
+                vu.i = ps2_vu::floatFromBits(lower);
+
+            uint32_t next = pc + 1u;
+            bool jumped = false;
+            if (pendingBranch != kEnd)
+            {
+                next = pendingBranch;
+                pendingBranch = kEnd;
+                jumped = true;
+            }
+            else if (branch != kEnd)
+            {
+                pendingBranch = branch;
+            }
+
+            if (ending)
+            {
+                vu.tpc = next & pcMask;
+                return kEnd;
+            }
+            if (upper & kEBit)
+                ending = true;
+            if (jumped)
+            {
+                if (--vu.budget == 0 || (!ending && residentAt(next & pcMask)))
+                    return next & pcMask;
+            }
+            pc = next;
+        }
+    }
+
+    void VectorUnit::kick(uint16_t addr)
+    {
+        if (!m_kick || !m_state.data)
+            return;
+        const uint32_t qwords = gifPacketQwords(m_state, addr);
+        m_packet.resize(qwords * 16u);
+        for (uint32_t q = 0; q < qwords; ++q)
+            std::memcpy(m_packet.data() + q * 16u, m_state.data + ((addr + q) & m_state.dataMask) * 16u, 16u);
+        m_kick(m_packet.data(), static_cast<uint32_t>(m_packet.size()));
+    }
+}
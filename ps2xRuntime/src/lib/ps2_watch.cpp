@@ -0,0 +1,269 @@
+#include "ps2_watch.h"
+#include "ps2_log.h"
+#include "ps2_runtime.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mutex>
+
+namespace
+{
+    using namespace ps2_watch;
+
+    std::mutex g_mutex;
+    std::vector<Watchpoint> g_watchpoints;
+
+    // Hits skip the per-call-site log limit: kMaxLoggedHits already bounds each
+    // watchpoint, and a copy loop over a watched buffer must log every store.
+    constexpr uint32_t kHitLogRate = std::numeric_limits<uint32_t>::max();
+
+    void markPages(const Watchpoint &watchpoint)
+    {
+        const uint32_t first = watchpoint.address >> kPageShift;
+        const uint32_t last = (watchpoint.address + watchpoint.size - 1u) >> kPageShift;
+        for (uint32_t page = first; page <= last && page < kPageCount; ++page)
+            g_pages[page >> 6].fetch_or(uint64_t{1} << (page & 63u), std::memory_order_relaxed);
+    }
+
+    bool parseNumber(std::string_view text, uint32_t &value)
+    {
+        const std::string owned(text);
+        if (owned.empty())
+            return false;
+        char *end = nullptr;
+        const unsigned long long parsed = std::strtoull(owned.c_str(), &end, 0);
+        if (end != owned.c_str() + owned.size() || parsed > 0xFFFFFFFFull)
+            return false;
+        value = static_cast<uint32_t>(parsed);
+        return true;
+    }
+
+    std::string_view trim(std::string_view text)
+    {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+            text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+            text.remove_suffix(1);
+        return text;
+    }
+
+    bool parseEntry(std::string_view item, uint32_t &address, uint32_t &size, std::string &label)
+    {
+        const size_t equals = item.find('=');
+        if (equals != std::string_view::npos)
+        {
+            label = std::string(trim(item.substr(equals + 1)));
+            item = trim(item.substr(0, equals));
+        }
+
+        const size_t colon = item.find(':');
+        const size_t dash = item.find('-');
+        if (colon != std::string_view::npos)
+        {
+            return parseNumber(trim(item.substr(0, colon)), address) &&
+                   parseNumber(trim(item.substr(colon + 1)), size);
+        }
+        if (dash != std::string_view::npos)
+        {
+            uint32_t end = 0;
+            if (!parseNumber(trim(item.substr(0, dash)), address) ||
+                !parseNumber(trim(item.substr(dash + 1)), end) || end <= address)
+                return false;
+            size = end - address;
+            return true;
+        }
+        size = 4;
+        return parseNumber(item, address);
+    }
+
+    struct Registers
+    {
+        uint32_t pc = 0;
+        uint32_t ra = 0;
+        uint32_t sp = 0;
+    };
+
+    Registers registersOf(const R5900Context *ctx)
+    {
+        if (!ctx)
+            return {};
+        return {ctx->pc, getRegU32(ctx, 31), getRegU32(ctx, 29)};
+    }
+
+    // Counts a hit on every watchpoint the write overlaps and collects the ones
+    // still under kMaxLoggedHits; returns how many were collected.
+    size_t countHits(uint32_t writeStart, uint64_t writeEnd, std::vector<Watchpoint> &hit)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        for (auto &watchpoint : g_watchpoints)
+        {
+            const uint64_t watchEnd = static_cast<uint64_t>(watchpoint.address) + watchpoint.size;
+            if (writeEnd > watchpoint.address && writeStart < watchEnd)
+            {
+                ++watchpoint.hits;
+                if (watchpoint.hits <= kMaxLoggedHits)
+                    hit.push_back(watchpoint);
+            }
+        }
+        return hit.size();
+    }
+
+    const char *labelOf(const Watchpoint &watchpoint)
+    {
+        return watchpoint.label.empty() ? "-" : watchpoint.label.c_str();
+    }
+
+    // A few bytes of the watched range starting at from; enough to follow a
+    // string or small struct without flooding the log.
+    struct BytesAt
+    {
+        const uint8_t *rdram;
+        uint32_t from;
+        uint32_t count;
+    };
+
+    std::ostream &operator<<(std::ostream &out, const BytesAt &bytes)
+    {
+        for (uint32_t i = 0; i < bytes.count; ++i)
+        {
+            out << (i ? "." : "") << std::setw(2) << std::setfill('0')
+                << static_cast<uint32_t>(bytes.rdram[(bytes.from + i) & PS2_RAM_MASK]);
+        }
+        return out;
+    }
+
+    // PS2_WATCH arms watchpoints before the first guest store.
+    const bool g_environmentApplied = []()
+    {
+        if (const char *spec = std::getenv("PS2_WATCH"))
+            configure(spec);
+        return true;
+    }();
+}
+
+namespace ps2_watch
+{
+    bool add(uint32_t address, uint32_t size, std::string label)
+    {
+        address &= PS2_RAM_MASK;
+        if (size == 0)
+            return false;
+        size = std::min<uint32_t>(size, PS2_RAM_SIZE - address);
+
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_watchpoints.push_back({address, size, std::move(label), 0});
+        markPages(g_watchpoints.back());
+        g_armed.store(static_cast<uint32_t>(g_watchpoints.size()), std::memory_order_release);
+        return true;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_armed.store(0, std::memory_order_release);
+        g_watchpoints.clear();
+        for (auto &word : g_pages)
+            word.store(0, std::memory_order_relaxed);
+    }
+
+    bool configure(std::string_view spec)
+    {
+        bool ok = true;
+        while (!spec.empty())
+        {
+            const size_t comma = spec.find(',');
+            const std::string_view item = trim(spec.substr(0, comma));
+            spec = (comma == std::string_view::npos) ? std::string_view{} : spec.substr(comma + 1);
+            if (item.empty())
+                continue;
+
+            uint32_t address = 0;
+            uint32_t size = 0;
+            std::string label;
+            if (parseEntry(item, address, size, label) && add(address, size, std::move(label)))
+                continue;
+
+            std::cerr << "[watch] ignoring watchpoint '" << item << "'" << std::endl;
+            ok = false;
+        }
+        return ok;
+    }
+
+    bool overlaps(uint32_t address, uint32_t size)
+    {
+        if (!mayHit(address, size))
+            return false;
+        const uint64_t start = address & PS2_RAM_MASK;
+        const uint64_t end = start + size;
+        std::lock_guard<std::mutex> lock(g_mutex);
+        return std::any_of(g_watchpoints.begin(), g_watchpoints.end(), [&](const Watchpoint &watchpoint)
+                           { return end > watchpoint.address && start < static_cast<uint64_t>(watchpoint.address) + watchpoint.size; });
+    }
+
+    std::vector<Watchpoint> list()
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        return g_watchpoints;
+    }
+
+    void recordWrite(const uint8_t *rdram, uint32_t address, uint32_t size,
+                     uint64_t valueLo, uint64_t valueHi, const char *op, const R5900Context *ctx)
+    {
+        const uint32_t writeStart = address & PS2_RAM_MASK;
+        std::vector<Watchpoint> hit;
+        if (!rdram || countHits(writeStart, static_cast<uint64_t>(writeStart) + size, hit) == 0)
+            return;
+
+        const Registers regs = registersOf(ctx);
+        for (const auto &watchpoint : hit)
+        {
+            // Old -> new for the watched bytes this store overlaps; the store
+            // has not happened yet, so rdram still holds the old values.
+            const uint32_t from = std::max(writeStart, watchpoint.address);
+            const uint32_t to = std::min<uint32_t>(writeStart + size, watchpoint.address + watchpoint.size);
+            uint64_t before = 0;
+            uint64_t after = 0;
+            const uint32_t shown = std::min<uint32_t>(to - from, 8u);
+            for (uint32_t i = 0; i < shown; ++i)
+            {
+                const uint32_t byteIndex = from + i - writeStart;
+                const uint64_t newByte = byteIndex < 8u ? (valueLo >> (byteIndex * 8u)) & 0xFFu
+                                                        : (valueHi >> ((byteIndex - 8u) * 8u)) & 0xFFu;
+                before |= static_cast<uint64_t>(rdram[from + i]) << (i * 8u);
+                after |= newByte << (i * 8u);
+            }
+
+            PS2_LOG_RATE(::ps2_log::Level::Info, ::ps2_log::Category::Memory, kHitLogRate,
+                         "[watch] " << labelOf(watchpoint) << " #" << watchpoint.hits
+                                    << " op=" << op << std::hex
+                                    << " addr=0x" << writeStart << " size=0x" << size
+                                    << " pc=0x" << regs.pc << " ra=0x" << regs.ra << " sp=0x" << regs.sp
+                                    << " @0x" << from << ": 0x" << before << "->0x" << after
+                                    << ((before != 0 && after == 0) ? " (ZEROED)" : ""));
+        }
+    }
+
+    void recordRangeWrite(const uint8_t *rdram, uint32_t address, uint32_t size,
+                          const char *op, const R5900Context *ctx)
+    {
+        const uint32_t writeStart = address & PS2_RAM_MASK;
+        std::vector<Watchpoint> hit;
+        if (!rdram || countHits(writeStart, static_cast<uint64_t>(writeStart) + size, hit) == 0)
+            return;
+
+        const Registers regs = registersOf(ctx);
+        for (const auto &watchpoint : hit)
+        {
+            PS2_LOG_RATE(::ps2_log::Level::Info, ::ps2_log::Category::Memory, kHitLogRate,
+                         "[watch] " << labelOf(watchpoint) << " #" << watchpoint.hits
+                                    << " op=" << op << std::hex
+                                    << " addr=0x" << writeStart << " size=0x" << size
+                                    << " pc=0x" << regs.pc << " ra=0x" << regs.ra << " sp=0x" << regs.sp
+                                    << " buf="
+                                    << (BytesAt{rdram, watchpoint.address, std::min<uint32_t>(watchpoint.size, 16u)}));
+        }
+    }
+}
@@ -10,12 +10,16 @@ namespace
     struct CdFileEntry
     {
         std::filesystem::path hostPath;
+        uint64_t hostOffset = 0; // non-zero when the file lives inside a disc image
         uint32_t sizeBytes = 0;
         uint32_t baseLbn = 0;
         uint32_t sectors = 0;
     };
 
     std::unordered_map<std::string, CdFileEntry> g_cdFilesByKey;
+    // Pseudo-LBN ranges keyed by baseLbn. Ranges never overlap, so the entry
+    // owning an LBN is the last one starting at or before it.
+    std::map<uint32_t, CdFileEntry> g_cdFilesByLbn;
     std::unordered_map<std::string, std::filesystem::path> g_cdLeafIndex;
     std::filesystem::path g_cdLeafIndexRoot;
     bool g_cdLeafIndexBuilt = false;
@@ -26,9 +30,9 @@ namespace
     std::filesystem::path g_cdImageSizePath;
     uint64_t g_cdImageSizeBytes = 0;
     bool g_cdImageSizeValid = false;
-    int32_t g_lastCdError = 0;
+    std::atomic<int32_t> g_lastCdError{0};
     uint32_t g_cdMode = 0;
-    uint32_t g_cdStreamingLbn = 0;
+    std::atomic<uint32_t> g_cdStreamingLbn{0};
     bool g_cdInitialized = false;
 
     constexpr uint32_t kIopHeapBase = 0x01A00000;
@@ -149,7 +153,8 @@ namespace
     bool hasCdImageExtension(const std::filesystem::path &path)
     {
         const std::string ext = toLowerAscii(path.extension().string());
-        return ext == ".iso" || ext == ".bin" || ext == ".img" || ext == ".mdf" || ext == ".nrg";
+        return ext == ".iso" || ext == ".bin" || ext == ".img" || ext == ".mdf" || ext == ".nrg" ||
+               ext == ".cso" || ext == ".zso";
     }
 
     bool trySelectBestDiscImageFromDirectory(const std::filesystem::path &dir,
@@ -302,10 +307,11 @@ namespace
 
         if (!g_cdImageSizeValid || g_cdImageSizePath != imagePath)
         {
-            std::error_code ec;
-            g_cdImageSizeBytes = static_cast<uint64_t>(std::filesystem::file_size(imagePath, ec));
+            // Logical size: compressed images report their uncompressed length.
+            uint64_t sizeBytes = 0;
+            g_cdImageSizeValid = tryGetCdMediaSize(imagePath, sizeBytes);
+            g_cdImageSizeBytes = sizeBytes;
             g_cdImageSizePath = imagePath;
-            g_cdImageSizeValid = !ec;
         }
         if (!g_cdImageSizeValid)
         {
@@ -338,55 +344,6 @@ namespace
         return resolved.lexically_normal();
     }
 
-    bool resolveCaseInsensitivePath(const std::filesystem::path &root,
-                                    const std::filesystem::path &relative,
-                                    std::filesystem::path &resolvedOut)
-    {
-        std::filesystem::path current = root;
-        for (const auto &component : relative)
-        {
-            const std::filesystem::path direct = current / component;
-            std::error_code ec;
-            if (std::filesystem::exists(direct, ec) && !ec)
-            {
-                current = direct;
-                continue;
-            }
-
-            bool matched = false;
-            const std::string needle = toLowerAscii(component.string());
-            std::error_code iterEc;
-            for (const auto &entry : std::filesystem::directory_iterator(current, iterEc))
-            {
-                if (iterEc)
-                {
-                    break;
-                }
-
-                const std::string candidate = toLowerAscii(entry.path().filename().string());
-                if (candidate == needle)
-                {
-                    current = entry.path();
-                    matched = true;
-                    break;
-                }
-            }
-
-            if (!matched)
-            {
-                return false;
-            }
-        }
-
-        std::error_code fileEc;
-        if (std::filesystem::is_regular_file(current, fileEc) && !fileEc)
-        {
-            resolvedOut = current;
-            return true;
-        }
-        return false;
-    }
-
     void ensureCdLeafIndex(const std::filesystem::path &root)
     {
         if (g_cdLeafIndexBuilt && g_cdLeafIndexRoot == root)
@@ -430,6 +387,26 @@ namespace
             return false;
         }
 
+        // A disc image answers with its real LBNs; those are read straight from
+        // the image, so they never enter the pseudo-LBN tables.
+        const std::filesystem::path imagePath = getCdImagePath();
+        if (!imagePath.empty())
+        {
+            if (const IsoDirectoryIndex *iso = acquireIsoDirectoryIndex(imagePath))
+            {
+                if (const IsoDirectoryEntry *isoEntry = iso->find(key))
+                {
+                    entryOut.hostPath = imagePath;
+                    entryOut.hostOffset = static_cast<uint64_t>(isoEntry->lbn) * kCdSectorSize;
+                    entryOut.sizeBytes = isoEntry->sizeBytes;
+                    entryOut.baseLbn = isoEntry->lbn;
+                    entryOut.sectors = sectorsForBytes(isoEntry->sizeBytes);
+                    g_lastCdError = 0;
+                    return true;
+                }
+            }
+        }
+
         auto existing = g_cdFilesByKey.find(key);
         if (existing != g_cdFilesByKey.end())
         {
@@ -439,43 +416,28 @@ namespace
         }
 
         const std::filesystem::path root = getCdRootPath();
-        std::filesystem::path path = cdHostPath(ps2Path);
+        const std::filesystem::path relative(normalizeCdPathNoPrefix(ps2Path));
+        std::filesystem::path path;
         std::error_code ec;
-        const bool existsNow = std::filesystem::exists(path, ec) && !ec;
-        const bool isFile = existsNow && std::filesystem::is_regular_file(path, ec) && !ec;
-        const bool isDir  = existsNow && !isFile && std::filesystem::is_directory(path, ec) && !ec;
-        if (!isFile && !isDir)
+        if (ps2_path_cache::resolve(root, relative, path) != ps2_path_cache::EntryKind::Missing)
         {
-            const std::filesystem::path relative(normalizeCdPathNoPrefix(ps2Path));
-            std::filesystem::path resolvedCasePath;
-            if (resolveCaseInsensitivePath(root, relative, resolvedCasePath))
-            {
-                path = resolvedCasePath;
-                ec.clear();
-                std::cerr << "[registerCdFile] case-insensitive: '" << ps2Path << "' -> " << path.string() << std::endl;
-            }
-            else
-            {
-                ensureCdLeafIndex(root);
-                const std::string leaf = toLowerAscii(relative.filename().string());
-                auto it = g_cdLeafIndex.find(leaf);
-                if (it != g_cdLeafIndex.end())
-                {
-                    path = it->second;
-                    ec.clear();
-                    std::cerr << "[registerCdFile] leaf-fallback: '" << ps2Path << "' -> " << path.string() << std::endl;
-                }
-                else
-                {
-                    std::cerr << "[registerCdFile] FAILED: '" << ps2Path << "' root=" << root.string() << " tried=" << path.string() << std::endl;
-                    g_lastCdError = -1;
-                    return false;
-                }
-            }
+            const bool exactCase = path == cdHostPath(ps2Path);
+            std::cerr << "[registerCdFile] " << (exactCase ? "direct" : "case-insensitive") << ": '"
+                      << ps2Path << "' -> " << path.string() << std::endl;
         }
         else
         {
-            std::cerr << "[registerCdFile] direct: '" << ps2Path << "' -> " << path.string() << std::endl;
+            ensureCdLeafIndex(root);
+            const std::string leaf = toLowerAscii(relative.filename().string());
+            auto it = g_cdLeafIndex.find(leaf);
+            if (it == g_cdLeafIndex.end())
+            {
+                std::cerr << "[registerCdFile] FAILED: '" << ps2Path << "' root=" << root.string() << " tried=" << path.string() << std::endl;
+                g_lastCdError = -1;
+                return false;
+            }
+            path = it->second;
+            std::cerr << "[registerCdFile] leaf-fallback: '" << ps2Path << "' -> " << path.string() << std::endl;
         }
 
         // For directories, use a synthetic size (ISO9660 directory record size).
@@ -511,11 +473,29 @@ namespace
 
         g_nextPseudoLbn += entry.sectors + 1;
         g_cdFilesByKey.emplace(key, entry);
+        g_cdFilesByLbn.emplace(entry.baseLbn, entry);
         entryOut = entry;
         g_lastCdError = 0;
         return true;
     }
 
+    const CdFileEntry *findCdFileByLbn(uint32_t lbn)
+    {
+        auto it = g_cdFilesByLbn.upper_bound(lbn);
+        if (it == g_cdFilesByLbn.begin())
+        {
+            return nullptr;
+        }
+
+        --it;
+        const CdFileEntry &entry = it->second;
+        if (lbn >= entry.baseLbn + entry.sectors)
+        {
+            return nullptr;
+        }
+        return &entry;
+    }
+
     bool readHostRange(const std::filesystem::path &path, uint64_t offsetBytes, uint8_t *dst, size_t byteCount)
     {
         if (!dst)
@@ -529,6 +509,14 @@ namespace
             return true;
         }
 
+        if (const MappedHostFile *mapped = acquireMappedHostFile(path))
+        {
+            const bool ok = readMappedCdMedia(path, *mapped, offsetBytes, dst, byteCount);
+            g_lastCdError = ok ? 0 : -1;
+            return ok;
+        }
+
+        // Mapping can fail for special files; fall back to a plain stream read.
         std::memset(dst, 0, byteCount);
         std::ifstream file(path, std::ios::binary);
         if (!file.is_open())
@@ -551,17 +539,11 @@ namespace
 
     bool readCdSectors(uint32_t lbn, uint32_t sectors, uint8_t *dst, size_t byteCount)
     {
-        for (const auto &[key, entry] : g_cdFilesByKey)
+        if (const CdFileEntry *entry = findCdFileByLbn(lbn))
         {
-            const uint32_t endLbn = entry.baseLbn + entry.sectors;
-            if (lbn < entry.baseLbn || lbn >= endLbn)
-            {
-                continue;
-            }
-
-            const uint64_t relativeLbn = static_cast<uint64_t>(lbn - entry.baseLbn);
+            const uint64_t relativeLbn = static_cast<uint64_t>(lbn - entry->baseLbn);
             const uint64_t offset = relativeLbn * kCdSectorSize;
-            return readHostRange(entry.hostPath, offset, dst, byteCount);
+            return readHostRange(entry->hostPath, offset, dst, byteCount);
         }
 
         const std::filesystem::path cdImage = getCdImagePath();
@@ -592,13 +574,9 @@ namespace
 
     bool isResolvableCdLbn(uint32_t lbn)
     {
-        for (const auto &[key, entry] : g_cdFilesByKey)
+        if (findCdFileByLbn(lbn))
         {
-            const uint32_t endLbn = entry.baseLbn + entry.sectors;
-            if (lbn >= entry.baseLbn && lbn < endLbn)
-            {
-                return true;
-            }
+            return true;
         }
 
         uint64_t totalSectors = 0;
@@ -632,17 +610,18 @@ namespace
         return true;
     }
 
-    bool hostFileHasAfsMagic(const std::filesystem::path &path)
+    // Reads the logical media contents, so files inside CSO/ZSO images are
+    // checked after decompression. Caller holds g_cdStateMutex.
+    bool cdFileHasAfsMagic(const CdFileEntry &entry)
     {
-        std::ifstream file(path, std::ios::binary);
-        if (!file.is_open())
+        const MappedHostFile *mapped = acquireMappedHostFile(entry.hostPath);
+        if (!mapped)
         {
             return false;
         }
 
-        char magic[4] = {};
-        file.read(magic, sizeof(magic));
-        if (file.gcount() < 3)
+        uint8_t magic[4] = {};
+        if (!readMappedCdMedia(entry.hostPath, *mapped, entry.hostOffset, magic, sizeof(magic)))
         {
             return false;
         }
@@ -686,7 +665,7 @@ namespace
             {
                 return false;
             }
-            if (!hostFileHasAfsMagic(afsEntry.hostPath))
+            if (!cdFileHasAfsMagic(afsEntry))
             {
                 return false;
             }
@@ -1325,8 +1304,13 @@ namespace
         return std::find(kDmaChannelBases.begin(), kDmaChannelBases.end(), value) != kDmaChannelBases.end();
     }
 
+    // DMAC address: scratchpad pointers carry bit 31 (SPR), everything else is RAM.
     uint32_t toDmaPhys(uint32_t addr)
     {
+        if ((addr & 0xF0000000u) == PS2_SCRATCHPAD_BASE)
+        {
+            return 0x80000000u | (addr & (PS2_SCRATCHPAD_SIZE - 1u));
+        }
         return addr & 0x1FFFFFFFu;
     }
 
@@ -1343,37 +1327,6 @@ namespace
         return value & 0xFFFFu;
     }
 
-    struct ParsedDmaTag
-    {
-        bool valid = false;
-        uint32_t qwc = 0;
-        uint32_t id = 0;
-        uint32_t addr = 0;
-    };
-
-    ParsedDmaTag tryParseDmaTag(uint8_t *rdram, uint32_t guestAddr)
-    {
-        ParsedDmaTag out;
-        if (guestAddr == 0)
-        {
-            return out;
-        }
-
-        const uint8_t *ptr = getConstMemPtr(rdram, guestAddr);
-        if (!ptr)
-        {
-            return out;
-        }
-
-        uint64_t tag = 0;
-        std::memcpy(&tag, ptr, sizeof(tag));
-        out.valid = true;
-        out.qwc = static_cast<uint32_t>(tag & 0xFFFFu);
-        out.id = static_cast<uint32_t>((tag >> 28) & 0x7u);
-        out.addr = static_cast<uint32_t>((tag >> 32) & 0x7FFFFFFFu);
-        return out;
-    }
-
     uint32_t resolveDmaChannelBase(uint8_t *rdram, uint32_t chanArg)
     {
         if (isKnownDmaChannelBase(chanArg))
@@ -1433,50 +1386,22 @@ namespace
         const uint32_t payloadPhys = toDmaPhys(payloadArg);
         uint32_t madr = 0;
         uint32_t qwc = 0;
-        uint32_t tadr = payloadPhys;
-        uint32_t chcr = 0x00000181u; // DIR=1, TIE=1, STR=1 (normal mode).
+        uint32_t tadr = 0;
+        uint32_t chcr = 0;
 
         if (preferNormalCount)
         {
             qwc = normalizeQwcFromArg(countArg);
             madr = payloadPhys;
+            chcr = 0x00000181u; // DIR=1, TIE=1, STR=1 (normal mode).
         }
         else
         {
-            const ParsedDmaTag tag = tryParseDmaTag(rdram, payloadPhys);
-            if (tag.valid && tag.qwc != 0)
-            {
-                qwc = tag.qwc;
-                switch (tag.id)
-                {
-                case 0: // REFE
-                case 3: // REF
-                case 4: // REFS
-                    madr = toDmaPhys(tag.addr);
-                    break;
-                default:
-                    // CNT/NEXT/CALL/RET-style tags carry payload inline after the tag.
-                    madr = toDmaPhys(payloadPhys + 0x10u);
-                    break;
-                }
-            }
-            else
-            {
-                // Fall back to chain mode so the runtime DMA path can walk TADR.
-                chcr = 0x00000185u; // MODE=1 chain, DIR=1, TIE=1, STR=1.
-            }
+            // The DMAC walks the whole tag list from TADR.
+            tadr = payloadPhys;
+            chcr = 0x00000185u; // MODE=1 chain, DIR=1, TIE=1, STR=1.
         }
 
-        PS2Memory &mem = runtime->memory();
-        mem.writeIORegister(channelBase + 0x20u, qwc & 0xFFFFu);
-        mem.writeIORegister(channelBase + 0x10u, madr);
-        mem.writeIORegister(channelBase + 0x30u, tadr);
-        mem.writeIORegister(channelBase + 0x00u, chcr);
-
-        // DMA completes instantly — clear STR bit so recompiled code polling
-        // CHCR doesn't spin forever.  On real PS2, hardware clears STR on completion.
-        mem.writeIORegister(channelBase + 0x00u, chcr & ~0x100u);
-
         {
             std::lock_guard<std::mutex> lock(g_dmaStubMutex);
             g_dmaPendingPolls[channelBase] = 1;
@@ -1491,11 +1416,13 @@ namespace
             }
         }
 
-        // DMA completes instantly in this runtime — dispatch registered DMAC
-        // interrupt handlers so the engine's completion semaphore gets signaled.
-        {
-            ps2_syscalls::dispatchDmacForChannel(rdram, runtime, channelBase);
-        }
+        // Writing CHCR with STR set runs the transfer; the DMAC clears STR and
+        // raises the channel interrupt once it finishes.
+        PS2Memory &mem = runtime->memory();
+        mem.writeIORegister(channelBase + 0x20u, qwc & 0xFFFFu);
+        mem.writeIORegister(channelBase + 0x10u, madr);
+        mem.writeIORegister(channelBase + 0x30u, tadr);
+        mem.writeIORegister(channelBase + 0x00u, chcr);
 
         return 0;
     }
@@ -1644,40 +1571,6 @@ namespace
         return value;
     }
 
-    static uint32_t bytesForPixels(uint8_t psm, uint32_t pixelCount)
-    {
-        const uint64_t pixels = static_cast<uint64_t>(pixelCount);
-        uint64_t bytes = 0;
-        switch (psm)
-        {
-        case 0:  // PSMCT32
-        case 1:  // PSMCT24 (treat as 32)
-        case 27: // PSMT8H (packed in 32-bit lanes)
-        case 36: // PSMT4HL (packed in 32-bit lanes)
-        case 44: // PSMT4HH (packed in 32-bit lanes)
-            bytes = pixels * 4ull;
-            break;
-        case 2:  // PSMCT16
-        case 10: // PSMCT16S
-            bytes = pixels * 2ull;
-            break;
-        case 19: // PSMT8
-            bytes = pixels;
-            break;
-        case 20: // PSMT4
-            bytes = (pixels + 1ull) / 2ull;
-            break;
-        default:
-            bytes = pixels * 4ull;
-            break;
-        }
-        if (bytes > 0xFFFFFFFFull)
-        {
-            return 0xFFFFFFFFu;
-        }
-        return static_cast<uint32_t>(bytes);
-    }
-
     struct GsSetDefImageArgs
     {
         uint32_t x = 0;
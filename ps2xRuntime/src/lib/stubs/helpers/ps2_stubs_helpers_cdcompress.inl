@@ -0,0 +1,847 @@
+namespace
+{
+    // Raw DEFLATE (RFC 1951) decoder for CSO blocks, structured after zlib's puff.c.
+    // Codes up to kFastBits long resolve through a lookup table; longer ones fall
+    // back to puff's canonical bit-serial walk.
+    class DeflateDecoder
+    {
+    public:
+        DeflateDecoder(const uint8_t *src, size_t srcLen, uint8_t *dst, size_t dstLen)
+            : m_src(src), m_srcLen(srcLen), m_dst(dst), m_dstLen(dstLen)
+        {
+        }
+
+        bool run()
+        {
+            uint32_t last = 0;
+            do
+            {
+                last = bits(1);
+                const uint32_t type = bits(2);
+                bool ok = false;
+                switch (type)
+                {
+                case 0:
+                    ok = stored();
+                    break;
+                case 1:
+                    ok = fixed();
+                    break;
+                case 2:
+                    ok = dynamic();
+                    break;
+                default:
+                    ok = false;
+                    break;
+                }
+                if (!ok || m_error)
+                {
+                    return false;
+                }
+            } while (!last);
+            return true;
+        }
+
+        size_t written() const { return m_out; }
+
+    private:
+        static constexpr int kMaxBits = 15;
+        static constexpr int kMaxLengthCodes = 288;
+        static constexpr int kMaxDistanceCodes = 30;
+        static constexpr int kFastBits = 9;
+
+        struct Huffman
+        {
+            uint16_t count[kMaxBits + 1] = {};
+            uint16_t symbol[kMaxLengthCodes] = {};
+            // (symbol << 4) | length, indexed by the next kFastBits stream bits; 0 = slow path.
+            uint16_t fast[1u << kFastBits] = {};
+        };
+
+        uint32_t bits(int need)
+        {
+            while (m_bitCount < need)
+            {
+                if (m_in >= m_srcLen)
+                {
+                    m_error = true;
+                    return 0;
+                }
+                m_bitBuf |= static_cast<uint32_t>(m_src[m_in++]) << m_bitCount;
+                m_bitCount += 8;
+            }
+            const uint32_t value = m_bitBuf & ((1u << need) - 1u);
+            m_bitBuf >>= need;
+            m_bitCount -= need;
+            return value;
+        }
+
+        int decode(const Huffman &h)
+        {
+            while (m_bitCount < kFastBits && m_in < m_srcLen)
+            {
+                m_bitBuf |= static_cast<uint32_t>(m_src[m_in++]) << m_bitCount;
+                m_bitCount += 8;
+            }
+            const uint16_t entry = h.fast[m_bitBuf & ((1u << kFastBits) - 1u)];
+            const int length = entry & 0x0F;
+            if (entry != 0 && length <= m_bitCount)
+            {
+                m_bitBuf >>= length;
+                m_bitCount -= length;
+                return entry >> 4;
+            }
+
+            int code = 0;
+            int first = 0;
+            int index = 0;
+            for (int len = 1; len <= kMaxBits; ++len)
+            {
+                code |= static_cast<int>(bits(1));
+                if (m_error)
+                {
+                    return -1;
+                }
+                const int count = h.count[len];
+                if (code - count < first)
+                {
+                    return h.symbol[index + (code - first)];
+                }
+                index += count;
+                first += count;
+                first <<= 1;
+                code <<= 1;
+            }
+            return -1;
+        }
+
+        // Returns 0 for a complete code, >0 for an incomplete one, <0 if over-subscribed.
+        static int build(Huffman &h, const uint8_t *lengths, int n)
+        {
+            std::fill(std::begin(h.count), std::end(h.count), uint16_t{0});
+            std::fill(std::begin(h.fast), std::end(h.fast), uint16_t{0});
+            for (int symbol = 0; symbol < n; ++symbol)
+            {
+                ++h.count[lengths[symbol]];
+            }
+            if (h.count[0] == n)
+            {
+                return 0;
+            }
+
+            int left = 1;
+            for (int len = 1; len <= kMaxBits; ++len)
+            {
+                left <<= 1;
+                left -= h.count[len];
+                if (left < 0)
+                {
+                    return left;
+                }
+            }
+
+            uint16_t offsets[kMaxBits + 1] = {};
+            for (int len = 1; len < kMaxBits; ++len)
+            {
+                offsets[len + 1] = static_cast<uint16_t>(offsets[len] + h.count[len]);
+            }
+            for (int symbol = 0; symbol < n; ++symbol)
+            {
+                if (lengths[symbol] != 0)
+                {
+                    h.symbol[offsets[lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+                }
+            }
+
+            // Canonical codes are assigned in h.symbol order; the stream carries them
+            // MSB-first, so table slots use the bit-reversed code.
+            uint32_t code = 0;
+            int index = 0;
+            for (int len = 1; len <= kFastBits; ++len)
+            {
+                for (int i = 0; i < h.count[len]; ++i, ++index, ++code)
+                {
+                    uint32_t reversed = 0;
+                    for (int bit = 0; bit < len; ++bit)
+                    {
+                        reversed |= ((code >> bit) & 1u) << (len - 1 - bit);
+                    }
+                    const uint16_t entry = static_cast<uint16_t>((h.symbol[index] << 4) | len);
+                    for (uint32_t slot = reversed; slot < (1u << kFastBits); slot += (1u << len))
+                    {
+                        h.fast[slot] = entry;
+                    }
+                }
+                code <<= 1;
+            }
+            return left;
+        }
+
+        bool stored()
+        {
+            // decode() refills ahead, so whole bytes may still sit in the bit
+            // buffer; give them back before dropping the partial one.
+            m_in -= static_cast<size_t>(m_bitCount / 8);
+            m_bitBuf = 0;
+            m_bitCount = 0;
+            if (m_in + 4 > m_srcLen)
+            {
+                return false;
+            }
+            const uint32_t len = m_src[m_in] | (static_cast<uint32_t>(m_src[m_in + 1]) << 8);
+            const uint32_t nlen = m_src[m_in + 2] | (static_cast<uint32_t>(m_src[m_in + 3]) << 8);
+            m_in += 4;
+            if (len != (~nlen & 0xFFFFu) || m_in + len > m_srcLen || m_out + len > m_dstLen)
+            {
+                return false;
+            }
+            std::memcpy(m_dst + m_out, m_src + m_in, len);
+            m_in += len;
+            m_out += len;
+            return true;
+        }
+
+        bool codes(const Huffman &lengthCode, const Huffman &distanceCode)
+        {
+            static constexpr uint16_t kLengthBase[29] = {
+                3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+            static constexpr uint8_t kLengthExtra[29] = {
+                0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+            static constexpr uint16_t kDistanceBase[30] = {
+                1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+            static constexpr uint8_t kDistanceExtra[30] = {
+                0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+            while (true)
+            {
+                int symbol = decode(lengthCode);
+                if (symbol < 0)
+                {
+                    return false;
+                }
+                if (symbol < 256)
+                {
+                    if (m_out >= m_dstLen)
+                    {
+                        return false;
+                    }
+                    m_dst[m_out++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+                if (symbol == 256)
+                {
+                    return true;
+                }
+
+                symbol -= 257;
+                if (symbol >= 29)
+                {
+                    return false;
+                }
+                const size_t length = kLengthBase[symbol] + bits(kLengthExtra[symbol]);
+
+                const int distanceSymbol = decode(distanceCode);
+                if (distanceSymbol < 0 || distanceSymbol >= 30)
+                {
+                    return false;
+                }
+                const size_t distance = kDistanceBase[distanceSymbol] + bits(kDistanceExtra[distanceSymbol]);
+                if (m_error || distance > m_out || m_out + length > m_dstLen)
+                {
+                    return false;
+                }
+
+                // Byte-wise on purpose: matches may overlap their own output.
+                for (size_t i = 0; i < length; ++i, ++m_out)
+                {
+                    m_dst[m_out] = m_dst[m_out - distance];
+                }
+            }
+        }
+
+        bool fixed()
+        {
+            static const std::pair<Huffman, Huffman> kFixed = []()
+            {
+                std::pair<Huffman, Huffman> tables;
+                uint8_t lengths[kMaxLengthCodes];
+                int symbol = 0;
+                for (; symbol < 144; ++symbol)
+                    lengths[symbol] = 8;
+                for (; symbol < 256; ++symbol)
+                    lengths[symbol] = 9;
+                for (; symbol < 280; ++symbol)
+                    lengths[symbol] = 7;
+                for (; symbol < kMaxLengthCodes; ++symbol)
+                    lengths[symbol] = 8;
+                build(tables.first, lengths, kMaxLengthCodes);
+
+                std::fill(std::begin(lengths), std::begin(lengths) + kMaxDistanceCodes, uint8_t{5});
+                build(tables.second, lengths, kMaxDistanceCodes);
+                return tables;
+            }();
+            return codes(kFixed.first, kFixed.second);
+        }
+
+        bool dynamic()
+        {
+            static constexpr uint8_t kOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+            const int lengthCount = static_cast<int>(bits(5)) + 257;
+            const int distanceCount = static_cast<int>(bits(5)) + 1;
+            const int codeCount = static_cast<int>(bits(4)) + 4;
+            if (m_error || lengthCount > 286 || distanceCount > kMaxDistanceCodes)
+            {
+                return false;
+            }
+
+            uint8_t lengths[kMaxLengthCodes + kMaxDistanceCodes] = {};
+            for (int i = 0; i < codeCount; ++i)
+            {
+                lengths[kOrder[i]] = static_cast<uint8_t>(bits(3));
+            }
+
+            Huffman lengthCode;
+            Huffman distanceCode;
+            if (build(lengthCode, lengths, 19) != 0)
+            {
+                return false;
+            }
+
+            int index = 0;
+            while (index < lengthCount + distanceCount)
+            {
+                int symbol = decode(lengthCode);
+                if (symbol < 0)
+                {
+                    return false;
+                }
+                if (symbol < 16)
+                {
+                    lengths[index++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+
+                uint8_t repeatLength = 0;
+                if (symbol == 16)
+                {
+                    if (index == 0)
+                    {
+                        return false;
+                    }
+                    repeatLength = lengths[index - 1];
+                    symbol = 3 + static_cast<int>(bits(2));
+                }
+                else if (symbol == 17)
+                {
+                    symbol = 3 + static_cast<int>(bits(3));
+                }
+                else
+                {
+                    symbol = 11 + static_cast<int>(bits(7));
+                }
+                if (m_error || index + symbol > lengthCount + distanceCount)
+                {
+                    return false;
+                }
+                while (symbol--)
+                {
+                    lengths[index++] = repeatLength;
+                }
+            }
+
+            if (lengths[256] == 0)
+            {
+                return false;
+            }
+
+            // Incomplete codes are only legal when they hold a single symbol.
+            int err = build(lengthCode, lengths, lengthCount);
+            if (err < 0 || (err > 0 && lengthCount - lengthCode.count[0] != 1))
+            {
+                return false;
+            }
+            err = build(distanceCode, lengths + lengthCount, distanceCount);
+            if (err < 0 || (err > 0 && distanceCount - distanceCode.count[0] != 1))
+            {
+                return false;
+            }
+
+            return codes(lengthCode, distanceCode);
+        }
+
+        const uint8_t *m_src;
+        size_t m_srcLen;
+        size_t m_in = 0;
+        uint8_t *m_dst;
+        size_t m_dstLen;
+        size_t m_out = 0;
+        uint32_t m_bitBuf = 0;
+        int m_bitCount = 0;
+        bool m_error = false;
+    };
+
+    // LZ4 block format decoder (no frame header), as used by ZSO and CSOv2.
+    bool decodeLz4Block(const uint8_t *src, size_t srcLen, uint8_t *dst, size_t dstLen, size_t &writtenOut)
+    {
+        size_t in = 0;
+        size_t out = 0;
+        auto readLength = [&](size_t length) -> size_t
+        {
+            if (length != 15)
+            {
+                return length;
+            }
+            uint8_t extra = 0;
+            do
+            {
+                if (in >= srcLen)
+                {
+                    return SIZE_MAX;
+                }
+                extra = src[in++];
+                length += extra;
+            } while (extra == 255);
+            return length;
+        };
+
+        while (in < srcLen)
+        {
+            const uint8_t token = src[in++];
+            const size_t literals = readLength(token >> 4);
+            if (literals == SIZE_MAX || in + literals > srcLen || out + literals > dstLen)
+            {
+                return false;
+            }
+            std::memcpy(dst + out, src + in, literals);
+            in += literals;
+            out += literals;
+
+            // The last sequence carries literals only.
+            if (in == srcLen)
+            {
+                break;
+            }
+
+            if (in + 2 > srcLen)
+            {
+                return false;
+            }
+            const size_t distance = src[in] | (static_cast<size_t>(src[in + 1]) << 8);
+            in += 2;
+            size_t matchLength = readLength(token & 0x0Fu);
+            if (matchLength == SIZE_MAX || distance == 0 || distance > out)
+            {
+                return false;
+            }
+            matchLength += 4;
+            if (out + matchLength > dstLen)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < matchLength; ++i, ++out)
+            {
+                dst[out] = dst[out - distance];
+            }
+        }
+
+        writtenOut = out;
+        return true;
+    }
+
+    // CSO (CISO, deflate or v2 deflate/LZ4) and ZSO (ZISO, LZ4) block-compressed images.
+    // Layout: 24-byte header, then (blocks + 1) little-endian index words whose low
+    // 31 bits are the block's file offset >> align and whose top bit marks the block
+    // as stored (v1/ZSO) or LZ4-coded (CSOv2).
+    // Decompressed blocks live in a byte-bounded LRU; reads that span several
+    // missing blocks and the blocks just past each read decompress on a worker pool.
+    class CompressedDiscImage
+    {
+    public:
+        static constexpr size_t kCacheBytes = 16u * 1024u * 1024u;
+        static constexpr uint32_t kPrefetchBlocks = 8;
+        static constexpr uint64_t kReportInterval = 16384;
+
+        ~CompressedDiscImage()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_workAvailable.notify_all();
+            for (std::thread &worker : m_workers)
+            {
+                worker.join();
+            }
+        }
+
+        static std::unique_ptr<CompressedDiscImage> open(const MappedHostFile &file)
+        {
+            const uint8_t *data = file.data();
+            const uint64_t fileSize = file.size();
+            if (!data || fileSize < 24)
+            {
+                return nullptr;
+            }
+
+            const bool isCso = std::memcmp(data, "CISO", 4) == 0;
+            const bool isZso = std::memcmp(data, "ZISO", 4) == 0;
+            if (!isCso && !isZso)
+            {
+                return nullptr;
+            }
+
+            uint64_t totalBytes = 0;
+            uint32_t blockSize = 0;
+            std::memcpy(&totalBytes, data + 8, sizeof(totalBytes));
+            std::memcpy(&blockSize, data + 16, sizeof(blockSize));
+            const uint8_t version = data[20];
+            const uint8_t align = data[21];
+            if (blockSize < 2048 || (blockSize & (blockSize - 1)) != 0 || totalBytes == 0 || align > 31)
+            {
+                return nullptr;
+            }
+
+            const uint64_t blockCount = (totalBytes + blockSize - 1) / blockSize;
+            if (blockCount >= 0xFFFFFFFFull || 24 + (blockCount + 1) * 4 > fileSize)
+            {
+                return nullptr;
+            }
+
+            auto image = std::unique_ptr<CompressedDiscImage>(new CompressedDiscImage());
+            image->m_file = &file;
+            image->m_totalBytes = totalBytes;
+            image->m_blockSize = blockSize;
+            image->m_blockCount = static_cast<uint32_t>(blockCount);
+            image->m_align = align;
+            image->m_topBitIsLz4 = isCso && version >= 2;
+            image->m_lz4Only = isZso;
+            image->m_index = data + 24;
+            image->m_cacheCapacity = std::max<size_t>(kCacheBytes / blockSize, kPrefetchBlocks * 2);
+
+            const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+            const uint32_t workerCount = std::clamp(hardwareThreads / 2u, 1u, 4u);
+            for (uint32_t i = 0; i < workerCount; ++i)
+            {
+                image->m_workers.emplace_back([raw = image.get()]()
+                                              { raw->workerMain(); });
+            }
+            return image;
+        }
+
+        uint64_t size() const { return m_totalBytes; }
+
+        // Bytes past the logical end read as zero, like MappedHostFile::copyRange.
+        bool read(uint64_t offset, uint8_t *dst, size_t byteCount)
+        {
+            if (byteCount == 0)
+            {
+                return true;
+            }
+
+            const uint64_t end = offset + byteCount;
+            const uint32_t firstBlock = static_cast<uint32_t>(std::min<uint64_t>(offset / m_blockSize, m_blockCount));
+            const uint32_t lastBlock = static_cast<uint32_t>(std::min<uint64_t>((end - 1) / m_blockSize, m_blockCount - 1u));
+
+            // Hand every block after the first to the pool so they decompress
+            // alongside the one this thread is about to do.
+            if (lastBlock > firstBlock)
+            {
+                queuePrefetch(firstBlock + 1, lastBlock - firstBlock);
+            }
+
+            uint64_t cursor = offset;
+            for (uint32_t block = firstBlock; block <= lastBlock && cursor < std::min(end, m_totalBytes); ++block)
+            {
+                std::shared_ptr<const std::vector<uint8_t>> data = acquireBlock(block);
+                if (!data)
+                {
+                    return false;
+                }
+                const uint64_t blockStart = static_cast<uint64_t>(block) * m_blockSize;
+                const size_t inBlock = static_cast<size_t>(cursor - blockStart);
+                const size_t count = static_cast<size_t>(std::min<uint64_t>(end, blockStart + m_blockSize) - cursor);
+                std::memcpy(dst + (cursor - offset), data->data() + inBlock, count);
+                cursor += count;
+            }
+            if (cursor < end)
+            {
+                std::memset(dst + (cursor - offset), 0, static_cast<size_t>(end - cursor));
+            }
+
+            if (lastBlock + 1 < m_blockCount)
+            {
+                queuePrefetch(lastBlock + 1, kPrefetchBlocks);
+            }
+            return true;
+        }
+
+    private:
+        using BlockData = std::shared_ptr<const std::vector<uint8_t>>;
+
+        struct CachedBlock
+        {
+            BlockData data;
+            std::list<uint32_t>::iterator lruPosition;
+        };
+
+        CompressedDiscImage() = default;
+
+        uint32_t indexWord(uint32_t block) const
+        {
+            uint32_t word = 0;
+            std::memcpy(&word, m_index + static_cast<size_t>(block) * 4, sizeof(word));
+            return word;
+        }
+
+        BlockData decompressBlock(uint32_t block) const
+        {
+            const uint32_t word = indexWord(block);
+            const uint32_t nextWord = indexWord(block + 1);
+            const bool topBit = (word & 0x80000000u) != 0;
+            const uint64_t start = static_cast<uint64_t>(word & 0x7FFFFFFFu) << m_align;
+            const uint64_t next = static_cast<uint64_t>(nextWord & 0x7FFFFFFFu) << m_align;
+            if (next < start || start > m_file->size())
+            {
+                return nullptr;
+            }
+            const size_t compressedSize = static_cast<size_t>(std::min<uint64_t>(next, m_file->size()) - start);
+            const uint8_t *src = m_file->data() + start;
+
+            auto out = std::make_shared<std::vector<uint8_t>>(m_blockSize, 0);
+            const bool stored = m_topBitIsLz4 ? compressedSize >= m_blockSize : topBit;
+            if (stored)
+            {
+                std::memcpy(out->data(), src, std::min<size_t>(compressedSize, m_blockSize));
+                return out;
+            }
+
+            if (m_lz4Only || (m_topBitIsLz4 && topBit))
+            {
+                size_t written = 0;
+                if (!decodeLz4Block(src, compressedSize, out->data(), m_blockSize, written))
+                {
+                    return nullptr;
+                }
+                return out;
+            }
+
+            DeflateDecoder decoder(src, compressedSize, out->data(), m_blockSize);
+            return decoder.run() ? out : nullptr;
+        }
+
+        // Caller holds m_mutex.
+        void insertLocked(uint32_t block, BlockData data)
+        {
+            m_lru.push_front(block);
+            m_cache[block] = CachedBlock{std::move(data), m_lru.begin()};
+            while (m_cache.size() > m_cacheCapacity)
+            {
+                m_cache.erase(m_lru.back());
+                m_lru.pop_back();
+            }
+        }
+
+        BlockData acquireBlock(uint32_t block)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
+            {
+                auto it = m_cache.find(block);
+                if (it != m_cache.end())
+                {
+                    m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+                    BlockData data = it->second.data;
+                    lock.unlock();
+                    recordLookup(true, 0);
+                    return data;
+                }
+                if (m_inFlight.count(block) == 0)
+                {
+                    break;
+                }
+                m_blockReady.wait(lock);
+            }
+
+            m_inFlight.insert(block);
+            lock.unlock();
+
+            const auto started = std::chrono::steady_clock::now();
+            BlockData data = decompressBlock(block);
+            const auto elapsed = std::chrono::steady_clock::now() - started;
+
+            lock.lock();
+            m_inFlight.erase(block);
+            if (data)
+            {
+                insertLocked(block, data);
+            }
+            lock.unlock();
+            m_blockReady.notify_all();
+
+            if (!data)
+            {
+                PS2_LOG_ERROR(Io, "[cdImage] failed to decompress block " << block);
+                return nullptr;
+            }
+            recordLookup(false, static_cast<uint64_t>(
+                                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            return data;
+        }
+
+        void queuePrefetch(uint32_t firstBlock, uint32_t count)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                const uint32_t last = std::min(firstBlock + count, m_blockCount);
+                for (uint32_t block = firstBlock; block < last; ++block)
+                {
+                    if (m_cache.count(block) == 0 && m_inFlight.count(block) == 0)
+                    {
+                        m_inFlight.insert(block);
+                        m_prefetchQueue.push_back(block);
+                    }
+                }
+            }
+            m_workAvailable.notify_all();
+        }
+
+        void workerMain()
+        {
+            ThreadNaming::SetCurrentThreadName("CdInflateThread");
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
+            {
+                m_workAvailable.wait(lock, [this]()
+                                     { return m_stop || !m_prefetchQueue.empty(); });
+                if (m_stop)
+                {
+                    return;
+                }
+
+                const uint32_t block = m_prefetchQueue.front();
+                m_prefetchQueue.pop_front();
+                lock.unlock();
+
+                BlockData data = decompressBlock(block);
+
+                lock.lock();
+                m_inFlight.erase(block);
+                if (data)
+                {
+                    insertLocked(block, std::move(data));
+                    ++m_prefetched;
+                }
+                m_blockReady.notify_all();
+            }
+        }
+
+        void recordLookup(bool hit, uint64_t missNanos)
+        {
+            const uint64_t lookups = m_lookups.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (hit)
+            {
+                m_hits.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                m_missNanos.fetch_add(missNanos, std::memory_order_relaxed);
+            }
+
+            if ((lookups % kReportInterval) == 0 && ps2_log::enabled(ps2_log::Level::Debug, ps2_log::Category::Io))
+            {
+                const uint64_t hits = m_hits.load(std::memory_order_relaxed);
+                const uint64_t misses = lookups - hits;
+                const double hitRate = 100.0 * static_cast<double>(hits) / static_cast<double>(lookups);
+                const double avgMissUs = misses ? static_cast<double>(m_missNanos.load(std::memory_order_relaxed)) /
+                                                      static_cast<double>(misses) / 1000.0
+                                                : 0.0;
+                uint64_t prefetched = 0;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    prefetched = m_prefetched;
+                }
+                PS2_LOG_DEBUG(Io, "[cdImage] block cache: " << lookups << " lookups, hit rate "
+                                                              << std::fixed << std::setprecision(1) << hitRate
+                                                              << "%, avg miss latency " << avgMissUs << "us, "
+                                                              << prefetched << " blocks prefetched");
+            }
+        }
+
+        const MappedHostFile *m_file = nullptr;
+        const uint8_t *m_index = nullptr;
+        uint64_t m_totalBytes = 0;
+        uint32_t m_blockSize = 0;
+        uint32_t m_blockCount = 0;
+        uint8_t m_align = 0;
+        bool m_topBitIsLz4 = false;
+        bool m_lz4Only = false;
+
+        std::mutex m_mutex;
+        std::condition_variable m_blockReady;
+        std::condition_variable m_workAvailable;
+        std::unordered_map<uint32_t, CachedBlock> m_cache;
+        std::list<uint32_t> m_lru;
+        size_t m_cacheCapacity = 0;
+        std::unordered_set<uint32_t> m_inFlight;
+        std::deque<uint32_t> m_prefetchQueue;
+        uint64_t m_prefetched = 0;
+        bool m_stop = false;
+        std::vector<std::thread> m_workers;
+
+        std::atomic<uint64_t> m_lookups{0};
+        std::atomic<uint64_t> m_hits{0};
+        std::atomic<uint64_t> m_missNanos{0};
+    };
+
+    // Compressed views are keyed like the mappings they sit on; nullptr entries
+    // remember files that turned out to be plain images.
+    std::unordered_map<std::string, std::unique_ptr<CompressedDiscImage>> g_cdCompressedImages;
+
+    CompressedDiscImage *acquireCompressedDiscImage(const std::filesystem::path &path, const MappedHostFile &mapped)
+    {
+        const std::string key = path.string();
+        auto it = g_cdCompressedImages.find(key);
+        if (it == g_cdCompressedImages.end())
+        {
+            it = g_cdCompressedImages.emplace(key, CompressedDiscImage::open(mapped)).first;
+            if (it->second)
+            {
+                PS2_LOG_INFO(Io, "[cdImage] block-compressed image " << path.string() << " ("
+                                                                     << it->second->size() << " bytes uncompressed)");
+            }
+        }
+        return it->second.get();
+    }
+
+    // Logical contents of CD media: plain files are copied from their mapping,
+    // CSO/ZSO images are decompressed block by block through the cache.
+    bool readMappedCdMedia(const std::filesystem::path &path, const MappedHostFile &mapped,
+                           uint64_t offset, uint8_t *dst, size_t byteCount)
+    {
+        if (CompressedDiscImage *compressed = acquireCompressedDiscImage(path, mapped))
+        {
+            return compressed->read(offset, dst, byteCount);
+        }
+
+        mapped.copyRange(offset, dst, byteCount);
+        return true;
+    }
+
+    bool tryGetCdMediaSize(const std::filesystem::path &path, uint64_t &sizeOut)
+    {
+        const MappedHostFile *mapped = acquireMappedHostFile(path);
+        if (!mapped)
+        {
+            return false;
+        }
+
+        const CompressedDiscImage *compressed = acquireCompressedDiscImage(path, *mapped);
+        sizeOut = compressed ? compressed->size() : mapped->size();
+        return true;
+    }
+}
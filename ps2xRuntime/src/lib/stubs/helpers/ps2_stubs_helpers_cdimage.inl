@@ -0,0 +1,196 @@
+#if defined(_WIN32)
+#ifndef WINAPI
+#define WINAPI __stdcall
+#endif
+
+// Declared by hand (as in ThreadNaming.h) to keep <windows.h> macros out of the stub namespace.
+extern "C"
+{
+    typedef void *HANDLE;
+    struct _SECURITY_ATTRIBUTES;
+
+    __declspec(dllimport) HANDLE WINAPI CreateFileW(const wchar_t *lpFileName, unsigned long dwDesiredAccess,
+                                                    unsigned long dwShareMode, _SECURITY_ATTRIBUTES *lpSecurityAttributes,
+                                                    unsigned long dwCreationDisposition, unsigned long dwFlagsAndAttributes,
+                                                    HANDLE hTemplateFile);
+    __declspec(dllimport) unsigned long WINAPI GetFileSize(HANDLE hFile, unsigned long *lpFileSizeHigh);
+    __declspec(dllimport) HANDLE WINAPI CreateFileMappingW(HANDLE hFile, _SECURITY_ATTRIBUTES *lpAttributes,
+                                                           unsigned long flProtect, unsigned long dwMaximumSizeHigh,
+                                                           unsigned long dwMaximumSizeLow, const wchar_t *lpName);
+    __declspec(dllimport) void *WINAPI MapViewOfFile(HANDLE hFileMappingObject, unsigned long dwDesiredAccess,
+                                                     unsigned long dwFileOffsetHigh, unsigned long dwFileOffsetLow,
+                                                     size_t dwNumberOfBytesToMap);
+    __declspec(dllimport) int WINAPI UnmapViewOfFile(const void *lpBaseAddress);
+    __declspec(dllimport) int WINAPI CloseHandle(HANDLE hObject);
+}
+#endif
+
+namespace
+{
+    // Read-only host file mapped once into the process address space.
+    // CD reads become a bounds check plus memcpy straight into guest RDRAM.
+    class MappedHostFile
+    {
+    public:
+        MappedHostFile() = default;
+        ~MappedHostFile()
+        {
+            close();
+        }
+
+        MappedHostFile(const MappedHostFile &) = delete;
+        MappedHostFile &operator=(const MappedHostFile &) = delete;
+
+        bool open(const std::filesystem::path &path)
+        {
+            close();
+
+#ifdef _WIN32
+            constexpr unsigned long kGenericRead = 0x80000000ul;
+            constexpr unsigned long kFileShareRead = 0x00000001ul;
+            constexpr unsigned long kOpenExisting = 3ul;
+            constexpr unsigned long kFileFlagRandomAccess = 0x10000000ul;
+            constexpr unsigned long kPageReadOnly = 0x02ul;
+            constexpr unsigned long kFileMapRead = 0x04ul;
+            constexpr unsigned long kInvalidFileSize = 0xFFFFFFFFul;
+            HANDLE const kInvalidHandle = reinterpret_cast<HANDLE>(static_cast<intptr_t>(-1));
+
+            HANDLE file = ::CreateFileW(path.wstring().c_str(), kGenericRead, kFileShareRead, nullptr,
+                                        kOpenExisting, kFileFlagRandomAccess, nullptr);
+            if (file == kInvalidHandle)
+            {
+                return false;
+            }
+
+            unsigned long sizeHigh = 0;
+            const unsigned long sizeLow = ::GetFileSize(file, &sizeHigh);
+            if (sizeLow == kInvalidFileSize && sizeHigh == 0)
+            {
+                ::CloseHandle(file);
+                return false;
+            }
+
+            const uint64_t size = (static_cast<uint64_t>(sizeHigh) << 32) | sizeLow;
+            if (size != 0)
+            {
+                HANDLE mapping = ::CreateFileMappingW(file, nullptr, kPageReadOnly, 0, 0, nullptr);
+                if (!mapping)
+                {
+                    ::CloseHandle(file);
+                    return false;
+                }
+
+                // The view keeps the section alive; both handles can go.
+                void *view = ::MapViewOfFile(mapping, kFileMapRead, 0, 0, 0);
+                ::CloseHandle(mapping);
+                if (!view)
+                {
+                    ::CloseHandle(file);
+                    return false;
+                }
+                m_data = static_cast<const uint8_t *>(view);
+            }
+            ::CloseHandle(file);
+            m_size = size;
+#else
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            struct stat st{};
+            if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+            {
+                ::close(fd);
+                return false;
+            }
+
+            const uint64_t size = static_cast<uint64_t>(st.st_size);
+            if (size != 0)
+            {
+                void *view = ::mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fd, 0);
+                if (view == MAP_FAILED)
+                {
+                    ::close(fd);
+                    return false;
+                }
+                m_data = static_cast<const uint8_t *>(view);
+            }
+            // The mapping holds its own reference to the file.
+            ::close(fd);
+            m_size = size;
+#endif
+            m_path = path;
+            m_open = true;
+            return true;
+        }
+
+        void close()
+        {
+            if (m_data)
+            {
+#ifdef _WIN32
+                ::UnmapViewOfFile(m_data);
+#else
+                ::munmap(const_cast<uint8_t *>(m_data), static_cast<size_t>(m_size));
+#endif
+            }
+            m_data = nullptr;
+            m_size = 0;
+            m_open = false;
+            m_path.clear();
+        }
+
+        bool isOpen() const { return m_open; }
+        const uint8_t *data() const { return m_data; }
+        uint64_t size() const { return m_size; }
+        const std::filesystem::path &path() const { return m_path; }
+
+        // Copies [offset, offset + byteCount) into dst. Bytes past EOF read as zero,
+        // matching what a short ifstream read into a cleared buffer produced.
+        void copyRange(uint64_t offset, uint8_t *dst, size_t byteCount) const
+        {
+            size_t available = 0;
+            if (offset < m_size)
+            {
+                available = static_cast<size_t>(std::min<uint64_t>(byteCount, m_size - offset));
+                std::memcpy(dst, m_data + offset, available);
+            }
+            if (available < byteCount)
+            {
+                std::memset(dst + available, 0, byteCount - available);
+            }
+        }
+
+    private:
+        const uint8_t *m_data = nullptr;
+        uint64_t m_size = 0;
+        bool m_open = false;
+        std::filesystem::path m_path;
+    };
+
+    // Mapped views stay alive for the whole run: CD media is read-only and the
+    // same handful of files (or the one disc image) get hit over and over.
+    std::unordered_map<std::string, std::unique_ptr<MappedHostFile>> g_cdMappedFiles;
+
+    const MappedHostFile *acquireMappedHostFile(const std::filesystem::path &path)
+    {
+        const std::string key = path.string();
+        auto it = g_cdMappedFiles.find(key);
+        if (it != g_cdMappedFiles.end())
+        {
+            return it->second.get();
+        }
+
+        auto mapped = std::make_unique<MappedHostFile>();
+        if (!mapped->open(path))
+        {
+            return nullptr;
+        }
+
+        const MappedHostFile *result = mapped.get();
+        g_cdMappedFiles.emplace(key, std::move(mapped));
+        return result;
+    }
+}
@@ -0,0 +1,361 @@
+// Asynchronous CD command pipeline.
+// sceCdRead/sceCdReadChain only validate and enqueue; a worker thread copies the
+// sectors while the guest keeps running, and completion is observed through
+// sceCdSync, sceCdGetReadPos and the sceCdCallback handler.
+// Build with PS2_CD_ASYNC_READ=0 to execute commands inline on the caller.
+#ifndef PS2_CD_ASYNC_READ
+#define PS2_CD_ASYNC_READ 1
+#endif
+
+namespace
+{
+    constexpr int32_t kCdFuncRead = 1;            // SCECdFuncRead
+    constexpr uint32_t kCdReadChunkSectors = 16;  // sceCdGetReadPos granularity
+    constexpr uint32_t kCdReadAheadSectors = 128; // 256 KiB ahead of sequential readers
+
+    // Guards the CD file tables, mapped media and the read-ahead window.
+    // Taken by guest-side stubs that resolve LBNs and by the worker per chunk.
+    std::mutex g_cdStateMutex;
+
+    struct CdReadSegment
+    {
+        uint32_t lbn = 0;
+        uint32_t sectors = 0;
+        uint8_t *dst = nullptr;
+        size_t byteCount = 0;
+    };
+
+    struct CdReadCommand
+    {
+        std::vector<CdReadSegment> segments;
+        int32_t func = kCdFuncRead;
+        uint32_t prefetchLbn = 0; // read-ahead hint when segments is empty
+    };
+
+    // Contiguous sectors fetched past the end of the last sequential read.
+    struct CdReadAheadWindow
+    {
+        std::filesystem::path media;
+        uint32_t lbn = 0;
+        uint32_t sectors = 0;
+        std::vector<uint8_t> data;
+    };
+
+    CdReadAheadWindow g_cdReadAhead;
+    std::atomic<uint32_t> g_cdCallbackFunc{0};
+    std::atomic<uint32_t> g_cdCallbackGp{0};
+
+    // Callers below hold g_cdStateMutex.
+
+    std::filesystem::path cdMediaPathForLbn(uint32_t lbn)
+    {
+        if (const CdFileEntry *entry = findCdFileByLbn(lbn))
+        {
+            return entry->hostPath;
+        }
+        return getCdImagePath();
+    }
+
+    uint32_t cdSectorsAvailableFrom(uint32_t lbn)
+    {
+        if (const CdFileEntry *entry = findCdFileByLbn(lbn))
+        {
+            return entry->baseLbn + entry->sectors - lbn;
+        }
+
+        uint64_t totalSectors = 0;
+        if (tryGetCdImageTotalSectors(totalSectors) && lbn < totalSectors)
+        {
+            return static_cast<uint32_t>(std::min<uint64_t>(totalSectors - lbn, 0xFFFFFFFFull));
+        }
+        return 0;
+    }
+
+    // Same acceptance rules the synchronous path had: pseudo-LBN files zero-fill
+    // past EOF, disc images reject reads that run off the end of the image.
+    bool isReadableCdRange(uint32_t lbn, uint32_t sectors)
+    {
+        if (findCdFileByLbn(lbn))
+        {
+            return true;
+        }
+
+        uint64_t totalSectors = 0;
+        if (!tryGetCdImageTotalSectors(totalSectors))
+        {
+            return false;
+        }
+        const uint64_t end = static_cast<uint64_t>(lbn) + sectors;
+        return lbn < totalSectors && end <= totalSectors;
+    }
+
+    bool readCdSectorsCached(uint32_t lbn, uint32_t sectors, uint8_t *dst, size_t byteCount)
+    {
+        const CdReadAheadWindow &window = g_cdReadAhead;
+        if (window.sectors != 0 && lbn >= window.lbn && lbn < window.lbn + window.sectors &&
+            window.media == cdMediaPathForLbn(lbn))
+        {
+            const size_t windowOffset = static_cast<size_t>(lbn - window.lbn) * kCdSectorSize;
+            const size_t windowBytes = static_cast<size_t>(window.sectors) * kCdSectorSize;
+            const size_t fromWindow = std::min(byteCount, windowBytes - windowOffset);
+            std::memcpy(dst, window.data.data() + windowOffset, fromWindow);
+            if (fromWindow == byteCount)
+            {
+                g_lastCdError = 0;
+                return true;
+            }
+
+            // The window ends on a sector boundary; fetch the tail directly.
+            const uint32_t consumed = static_cast<uint32_t>(fromWindow / kCdSectorSize);
+            return readCdSectors(lbn + consumed, sectors - consumed, dst + fromWindow, byteCount - fromWindow);
+        }
+
+        return readCdSectors(lbn, sectors, dst, byteCount);
+    }
+
+    void fillCdReadAhead(uint32_t lbn)
+    {
+        CdReadAheadWindow &window = g_cdReadAhead;
+        const std::filesystem::path media = cdMediaPathForLbn(lbn);
+        if (window.sectors != 0 && window.media == media && lbn >= window.lbn &&
+            lbn + (kCdReadAheadSectors / 2) <= window.lbn + window.sectors)
+        {
+            return;
+        }
+
+        const uint32_t sectors = std::min(cdSectorsAvailableFrom(lbn), kCdReadAheadSectors);
+        if (sectors == 0)
+        {
+            return;
+        }
+
+        window.data.resize(static_cast<size_t>(kCdReadAheadSectors) * kCdSectorSize);
+        // Speculative reads must not surface as the guest's sceCdGetError.
+        const int32_t savedError = g_lastCdError;
+        const bool ok = readCdSectors(lbn, sectors, window.data.data(), static_cast<size_t>(sectors) * kCdSectorSize);
+        g_lastCdError = savedError;
+
+        window.media = ok ? media : std::filesystem::path{};
+        window.lbn = lbn;
+        window.sectors = ok ? sectors : 0;
+    }
+
+    class CdIoWorker
+    {
+    public:
+        ~CdIoWorker()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            if (m_thread.joinable())
+            {
+                m_thread.join();
+            }
+        }
+
+        void submit(CdReadCommand command)
+        {
+            const bool countsAsPending = !command.segments.empty();
+#if PS2_CD_ASYNC_READ
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_thread.joinable())
+                {
+                    m_thread = std::thread([this]()
+                                           { run(); });
+                }
+                if (countsAsPending)
+                {
+                    m_pending.fetch_add(1, std::memory_order_acq_rel);
+                }
+                m_queue.push_back(std::move(command));
+            }
+            m_wake.notify_one();
+#else
+            execute(command);
+            if (countsAsPending)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_completed.push_back(command.func);
+            }
+#endif
+        }
+
+        bool busy() const
+        {
+            return m_pending.load(std::memory_order_acquire) != 0;
+        }
+
+        void waitIdle()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_idle.wait(lock, [this]()
+                        { return m_pending.load(std::memory_order_acquire) == 0; });
+        }
+
+        // Drops queued commands; a command already being copied runs to completion.
+        bool cancelQueued()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            bool dropped = false;
+            for (auto it = m_queue.begin(); it != m_queue.end();)
+            {
+                if (it->segments.empty())
+                {
+                    ++it;
+                    continue;
+                }
+                it = m_queue.erase(it);
+                m_pending.fetch_sub(1, std::memory_order_acq_rel);
+                dropped = true;
+            }
+            if (m_pending.load(std::memory_order_acquire) == 0)
+            {
+                m_idle.notify_all();
+            }
+            return dropped;
+        }
+
+        std::vector<int32_t> takeCompletions()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::vector<int32_t> completed;
+            completed.swap(m_completed);
+            return completed;
+        }
+
+    private:
+        void run()
+        {
+            ThreadNaming::SetCurrentThreadName("CdIoThread");
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
+            {
+                m_wake.wait(lock, [this]()
+                            { return m_stop || !m_queue.empty(); });
+                if (m_stop)
+                {
+                    return;
+                }
+
+                CdReadCommand command = std::move(m_queue.front());
+                m_queue.pop_front();
+                lock.unlock();
+
+                execute(command);
+
+                lock.lock();
+                if (!command.segments.empty())
+                {
+                    m_completed.push_back(command.func);
+                    if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    {
+                        m_idle.notify_all();
+                    }
+                }
+            }
+        }
+
+        void execute(const CdReadCommand &command)
+        {
+            if (command.segments.empty())
+            {
+                PS2_TRACE_SCOPE_ARG("cd", "CD read-ahead", "lbn", command.prefetchLbn);
+                std::lock_guard<std::mutex> stateLock(g_cdStateMutex);
+                fillCdReadAhead(command.prefetchLbn);
+                return;
+            }
+
+            PS2_TRACE_SCOPE_ARG("cd", "CD read", "lbn", command.segments.front().lbn);
+            const bool sequential = command.segments.front().lbn == m_sequentialEnd;
+            for (const CdReadSegment &segment : command.segments)
+            {
+                size_t doneBytes = 0;
+                uint32_t doneSectors = 0;
+                while (doneBytes < segment.byteCount)
+                {
+                    const uint32_t chunkSectors = std::min(kCdReadChunkSectors, segment.sectors - doneSectors);
+                    const size_t chunkBytes = std::min(segment.byteCount - doneBytes,
+                                                       static_cast<size_t>(chunkSectors) * kCdSectorSize);
+                    bool ok = false;
+                    {
+                        std::lock_guard<std::mutex> stateLock(g_cdStateMutex);
+                        ok = readCdSectorsCached(segment.lbn + doneSectors, chunkSectors,
+                                                 segment.dst + doneBytes, chunkBytes);
+                    }
+                    if (!ok)
+                    {
+                        std::memset(segment.dst + doneBytes, 0, segment.byteCount - doneBytes);
+                        m_sequentialEnd = 0xFFFFFFFFu;
+                        return;
+                    }
+
+                    doneBytes += chunkBytes;
+                    doneSectors += chunkSectors;
+                    g_cdStreamingLbn = segment.lbn + doneSectors;
+                }
+                g_cdStreamingLbn = segment.lbn + segment.sectors;
+                m_sequentialEnd = segment.lbn + segment.sectors;
+            }
+
+            if (sequential)
+            {
+                std::lock_guard<std::mutex> stateLock(g_cdStateMutex);
+                fillCdReadAhead(m_sequentialEnd);
+            }
+        }
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        std::deque<CdReadCommand> m_queue;
+        std::vector<int32_t> m_completed;
+        std::atomic<uint32_t> m_pending{0};
+        uint32_t m_sequentialEnd = 0xFFFFFFFFu;
+        bool m_stop = false;
+        std::thread m_thread;
+    };
+
+    CdIoWorker g_cdIoWorker;
+
+    // Runs pending sceCdCallback handlers on the calling guest thread.
+    void dispatchCdCallbacks(uint8_t *rdram, PS2Runtime *runtime)
+    {
+        static thread_local bool inCallback = false;
+        if (!rdram || !runtime || inCallback)
+        {
+            return;
+        }
+
+        const std::vector<int32_t> completed = g_cdIoWorker.takeCompletions();
+        const uint32_t handler = g_cdCallbackFunc.load(std::memory_order_acquire);
+        if (completed.empty() || handler == 0u || !runtime->hasFunction(handler))
+        {
+            return;
+        }
+
+        inCallback = true;
+        for (const int32_t func : completed)
+        {
+            try
+            {
+                R5900Context cbCtx{};
+                SET_GPR_U32(&cbCtx, 28, g_cdCallbackGp.load(std::memory_order_acquire));
+                SET_GPR_U32(&cbCtx, 29, PS2_IRQ_STACK_TOP);
+                SET_GPR_U32(&cbCtx, 31, 0u);
+                SET_GPR_U32(&cbCtx, 4, static_cast<uint32_t>(func));
+                cbCtx.pc = handler;
+                runtime->lookupFunction(handler)(rdram, &cbCtx, runtime);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "[sceCdCallback] handler 0x" << std::hex << handler << std::dec
+                          << " threw: " << e.what() << std::endl;
+            }
+        }
+        inCallback = false;
+    }
+}
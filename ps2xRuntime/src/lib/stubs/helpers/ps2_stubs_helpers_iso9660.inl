@@ -0,0 +1,249 @@
+namespace
+{
+    // File and directory lookup straight from an ISO9660 disc image.
+    // The primary volume descriptor and L path table are parsed once per image;
+    // every directory extent they list is walked into a flat path -> extent map.
+    struct IsoDirectoryEntry
+    {
+        uint32_t lbn = 0;
+        uint32_t sizeBytes = 0;
+        bool isDirectory = false;
+    };
+
+    class IsoDirectoryIndex
+    {
+    public:
+        static constexpr uint32_t kSectorSize = 2048;
+
+        bool build(const std::filesystem::path &imagePath, const MappedHostFile &image)
+        {
+            m_entries.clear();
+            m_imagePath = &imagePath;
+            m_image = &image;
+            if (!tryGetCdMediaSize(imagePath, m_imageSize))
+            {
+                return false;
+            }
+
+            std::vector<uint8_t> pvd;
+            if (!findPrimaryVolumeDescriptor(pvd))
+            {
+                return false;
+            }
+
+            const uint32_t pathTableSize = readLe32(pvd.data() + 132);
+            const uint32_t pathTableLbn = readLe32(pvd.data() + 140);
+            std::vector<uint8_t> pathTableBytes;
+            if (pathTableSize == 0 || !readSpan(pathTableLbn, pathTableSize, pathTableBytes))
+            {
+                return false;
+            }
+            const uint8_t *pathTable = pathTableBytes.data();
+
+            // Path table records are ordered so a parent always precedes its children;
+            // directory numbers are 1-based indices into this list.
+            struct DirectoryInfo
+            {
+                std::string path;
+                uint32_t lbn = 0;
+            };
+            std::vector<DirectoryInfo> directories;
+            size_t pos = 0;
+            while (pos + 8 <= pathTableSize)
+            {
+                const uint8_t nameLength = pathTable[pos];
+                if (nameLength == 0 || pos + 8 + nameLength > pathTableSize)
+                {
+                    break;
+                }
+
+                const uint32_t extentLbn = readLe32(pathTable + pos + 2);
+                const uint16_t parent = static_cast<uint16_t>(pathTable[pos + 6] | (pathTable[pos + 7] << 8));
+                const std::string name = foldName(reinterpret_cast<const char *>(pathTable + pos + 8), nameLength);
+
+                DirectoryInfo info;
+                info.lbn = extentLbn;
+                if (!directories.empty() && parent >= 1 && parent <= directories.size())
+                {
+                    const std::string &parentPath = directories[parent - 1].path;
+                    info.path = parentPath.empty() ? name : parentPath + "/" + name;
+                }
+                directories.push_back(std::move(info));
+
+                pos += 8 + nameLength + (nameLength & 1u);
+            }
+
+            for (const DirectoryInfo &directory : directories)
+            {
+                indexDirectory(directory.path, directory.lbn);
+            }
+
+            m_imagePath = nullptr;
+            m_image = nullptr;
+            return !m_entries.empty();
+        }
+
+        // Keys are lowercase, '/'-separated, without a leading slash or ";1" suffix.
+        const IsoDirectoryEntry *find(const std::string &key) const
+        {
+            auto it = m_entries.find(key);
+            return it != m_entries.end() ? &it->second : nullptr;
+        }
+
+        size_t size() const { return m_entries.size(); }
+
+    private:
+        static uint32_t readLe32(const uint8_t *p)
+        {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        static std::string foldName(const char *name, size_t length)
+        {
+            std::string folded(name, length);
+            const size_t semicolon = folded.find(';');
+            if (semicolon != std::string::npos)
+            {
+                folded.erase(semicolon);
+            }
+            // "README.;1" is how level-1 names without an extension are recorded.
+            if (!folded.empty() && folded.back() == '.')
+            {
+                folded.pop_back();
+            }
+            for (char &c : folded)
+            {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            return folded;
+        }
+
+        // Reads through readMappedCdMedia so CSO/ZSO images index the same way.
+        bool readSpan(uint32_t lbn, uint64_t byteCount, std::vector<uint8_t> &out) const
+        {
+            const uint64_t offset = static_cast<uint64_t>(lbn) * kSectorSize;
+            if (offset > m_imageSize || byteCount > m_imageSize - offset)
+            {
+                return false;
+            }
+            out.resize(static_cast<size_t>(byteCount));
+            return readMappedCdMedia(*m_imagePath, *m_image, offset, out.data(), out.size());
+        }
+
+        bool findPrimaryVolumeDescriptor(std::vector<uint8_t> &descriptor) const
+        {
+            // Volume descriptors start at sector 16 and end with a type 255 terminator.
+            for (uint32_t lbn = 16; lbn < 16 + 64; ++lbn)
+            {
+                if (!readSpan(lbn, kSectorSize, descriptor) || std::memcmp(descriptor.data() + 1, "CD001", 5) != 0)
+                {
+                    return false;
+                }
+                if (descriptor[0] == 1)
+                {
+                    return true;
+                }
+                if (descriptor[0] == 255)
+                {
+                    return false;
+                }
+            }
+            return false;
+        }
+
+        void indexDirectory(const std::string &path, uint32_t lbn)
+        {
+            std::vector<uint8_t> bytes;
+            if (!readSpan(lbn, kSectorSize, bytes) || bytes[0] < 34)
+            {
+                return;
+            }
+
+            // The "." record carries the directory's own extent size.
+            const uint32_t extentSize = readLe32(bytes.data() + 10);
+            if (extentSize > kSectorSize && !readSpan(lbn, extentSize, bytes))
+            {
+                return;
+            }
+            const uint8_t *extent = bytes.data();
+
+            if (!path.empty())
+            {
+                m_entries.emplace(path, IsoDirectoryEntry{lbn, extentSize, true});
+            }
+
+            size_t pos = 0;
+            while (pos < extentSize)
+            {
+                const uint8_t recordLength = extent[pos];
+                if (recordLength == 0)
+                {
+                    // Records never straddle sectors; zero padding runs to the next one.
+                    pos = (pos / kSectorSize + 1) * kSectorSize;
+                    continue;
+                }
+                if (recordLength < 34 || pos + recordLength > extentSize)
+                {
+                    break;
+                }
+
+                const uint8_t *record = extent + pos;
+                const uint8_t flags = record[25];
+                const uint8_t nameLength = record[32];
+                pos += recordLength;
+
+                // Subdirectories come from the path table; "." and ".." are single 0/1 bytes.
+                if ((flags & 0x02u) != 0 || nameLength == 0 || 33u + nameLength > recordLength)
+                {
+                    continue;
+                }
+
+                const std::string name = foldName(reinterpret_cast<const char *>(record + 33), nameLength);
+                const std::string key = path.empty() ? name : path + "/" + name;
+                // Multi-extent files list their first extent first; keep that one.
+                m_entries.emplace(key, IsoDirectoryEntry{readLe32(record + 2), readLe32(record + 10), false});
+            }
+        }
+
+        std::unordered_map<std::string, IsoDirectoryEntry> m_entries;
+        const std::filesystem::path *m_imagePath = nullptr;
+        const MappedHostFile *m_image = nullptr;
+        uint64_t m_imageSize = 0;
+    };
+
+    std::unordered_map<std::string, std::unique_ptr<IsoDirectoryIndex>> g_cdIsoIndexes;
+
+    // Returns nullptr when the image is not a readable ISO9660 volume; callers then
+    // fall back to resolving names against the extracted host tree.
+    const IsoDirectoryIndex *acquireIsoDirectoryIndex(const std::filesystem::path &imagePath)
+    {
+        const std::string key = imagePath.string();
+        auto it = g_cdIsoIndexes.find(key);
+        if (it != g_cdIsoIndexes.end())
+        {
+            return it->second.get();
+        }
+
+        std::unique_ptr<IsoDirectoryIndex> index;
+        if (const MappedHostFile *image = acquireMappedHostFile(imagePath))
+        {
+            index = std::make_unique<IsoDirectoryIndex>();
+            if (index->build(imagePath, *image))
+            {
+                PS2_LOG_INFO(Io, "[cdImage] indexed " << index->size() << " ISO9660 entries from "
+                                                      << imagePath.string());
+            }
+            else
+            {
+                PS2_LOG_WARN(Io, "[cdImage] no ISO9660 volume in " << imagePath.string()
+                                                                   << "; resolving names against the host tree");
+                index.reset();
+            }
+        }
+
+        const IsoDirectoryIndex *result = index.get();
+        g_cdIsoIndexes.emplace(key, std::move(index));
+        return result;
+    }
+}
@@ -10,22 +10,22 @@ void sceGsExecLoadImage(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         return;
     }
 
-    const uint32_t rowBytes = bytesForPixels(img.psm, static_cast<uint32_t>(img.width));
-    if (rowBytes == 0)
+    if (!ps2_gs_swizzle::isSupported(img.psm))
     {
+        static uint32_t warnCount = 0;
+        if (warnCount < 8)
+        {
+            std::cerr << "ps2_stub sceGsExecLoadImage: unsupported psm=" << static_cast<int>(img.psm) << std::endl;
+            ++warnCount;
+        }
         setReturnS32(ctx, -1);
         return;
     }
 
-    uint32_t fbw = img.vram_width ? img.vram_width : std::max<uint32_t>(1, (img.width + 63) / 64);
-    uint32_t base = static_cast<uint32_t>(img.vram_addr) * 2048u;
-    uint32_t stride = bytesForPixels(img.psm, fbw * 64u);
-    if (stride == 0)
-    {
-        setReturnS32(ctx, -1);
-        return;
-    }
+    const uint32_t fbw = img.vram_width ? img.vram_width : std::max<uint32_t>(1, (img.width + 63) / 64);
 
+    // Keep ordering with GIF transfers still queued for the GS.
+    runtime->memory().flushGs();
     uint8_t *gsvram = runtime->memory().getGSVRAM();
     uint8_t *src = getMemPtr(rdram, srcAddr);
     if (!gsvram || !src)
@@ -48,22 +48,14 @@ void sceGsExecLoadImage(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         ++logCount;
     }
 
-    for (uint32_t row = 0; row < img.height; ++row)
-    {
-        uint32_t dstOff = base + (static_cast<uint32_t>(img.y) + row) * stride + bytesForPixels(img.psm, static_cast<uint32_t>(img.x));
-        uint32_t srcOff = row * rowBytes;
-        if (dstOff >= PS2_GS_VRAM_SIZE)
-            break;
-        uint32_t copyBytes = rowBytes;
-        if (dstOff + copyBytes > PS2_GS_VRAM_SIZE)
-            copyBytes = PS2_GS_VRAM_SIZE - dstOff;
-        std::memcpy(gsvram + dstOff, src + srcOff, copyBytes);
-    }
+    ps2_gs_swizzle::writeImage(gsvram, img.psm, img.vram_addr, fbw, img.x, img.y, img.width, img.height,
+                               src, ps2_gs_swizzle::rowBytes(img.psm, img.width));
 
     if (img.width >= 320 && img.height >= 200)
     {
         auto &gs = runtime->memory().gs();
-        gs.dispfb1 = makeDispFb(img.vram_addr, fbw, img.psm, 0, 0);
+        // DISPFB takes the frame base in 2048-word pages, the image base is in blocks.
+        gs.dispfb1 = makeDispFb(img.vram_addr / 32u, fbw, img.psm, 0, 0);
         gs.display1 = makeDisplay(0, 0, 0, 0, img.width - 1, img.height - 1);
     }
 
@@ -82,22 +74,22 @@ void sceGsExecStoreImage(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         return;
     }
 
-    const uint32_t rowBytes = bytesForPixels(img.psm, static_cast<uint32_t>(img.width));
-    if (rowBytes == 0)
+    if (!ps2_gs_swizzle::isSupported(img.psm))
     {
+        static uint32_t warnCount = 0;
+        if (warnCount < 8)
+        {
+            std::cerr << "ps2_stub sceGsExecStoreImage: unsupported psm=" << static_cast<int>(img.psm) << std::endl;
+            ++warnCount;
+        }
         setReturnS32(ctx, -1);
         return;
     }
 
-    uint32_t fbw = img.vram_width ? img.vram_width : std::max<uint32_t>(1, (img.width + 63) / 64);
-    uint32_t base = static_cast<uint32_t>(img.vram_addr) * 2048u;
-    uint32_t stride = bytesForPixels(img.psm, fbw * 64u);
-    if (stride == 0)
-    {
-        setReturnS32(ctx, -1);
-        return;
-    }
+    const uint32_t fbw = img.vram_width ? img.vram_width : std::max<uint32_t>(1, (img.width + 63) / 64);
 
+    // Keep ordering with GIF transfers still queued for the GS.
+    runtime->memory().flushGs();
     uint8_t *gsvram = runtime->memory().getGSVRAM();
     uint8_t *dst = getMemPtr(rdram, dstAddr);
     if (!gsvram || !dst)
@@ -120,17 +112,8 @@ void sceGsExecStoreImage(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         ++logCount;
     }
 
-    for (uint32_t row = 0; row < img.height; ++row)
-    {
-        uint32_t srcOff = base + (static_cast<uint32_t>(img.y) + row) * stride + bytesForPixels(img.psm, static_cast<uint32_t>(img.x));
-        uint32_t dstOff = row * rowBytes;
-        if (srcOff >= PS2_GS_VRAM_SIZE)
-            break;
-        uint32_t copyBytes = rowBytes;
-        if (srcOff + copyBytes > PS2_GS_VRAM_SIZE)
-            copyBytes = PS2_GS_VRAM_SIZE - srcOff;
-        std::memcpy(dst + dstOff, gsvram + srcOff, copyBytes);
-    }
+    ps2_gs_swizzle::readImage(gsvram, img.psm, img.vram_addr, fbw, img.x, img.y, img.width, img.height,
+                              dst, ps2_gs_swizzle::rowBytes(img.psm, img.width));
 
     setReturnS32(ctx, 0);
 }
@@ -150,6 +133,7 @@ void sceGsPutDispEnv(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         auto &gs = runtime->memory().gs();
         gs.display1 = env.display;
         gs.dispfb1 = env.dispfb;
+        runtime->memory().publishFrame();
     }
     setReturnS32(ctx, 0);
 }
@@ -293,6 +277,7 @@ void sceGsSwapDBuffDc(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     // can we get away with that ? kkkk
     static int cur = 0;
     cur ^= 1;
+    runtime->memory().publishFrame();
     setReturnS32(ctx, cur);
 }
 
@@ -306,6 +291,12 @@ void sceGsSyncPath(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
 void sceGsSyncV(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 {
+    // The guest is waiting for the next frame; the Unlimited clock delivers
+    // it right away instead of letting the game outrun VBlank.
+    if (runtime->clockMode() == PS2Runtime::ClockMode::Unlimited)
+    {
+        ps2_syscalls::pollVBlank(rdram, runtime);
+    }
     setReturnS32(ctx, 0);
 }
 
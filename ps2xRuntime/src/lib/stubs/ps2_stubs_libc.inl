@@ -42,7 +42,7 @@ void memcpy(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     if (hostDest && hostSrc)
     {
         ::memcpy(hostDest, hostSrc, size);
-        ps2TraceGuestRangeWrite(rdram, destAddr, static_cast<uint32_t>(size), "memcpy", ctx);
+        ps2_watch::noteRangeWrite(rdram, destAddr, static_cast<uint32_t>(size), "memcpy", ctx);
     }
     else
     {
@@ -67,7 +67,7 @@ void memset(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     if (hostDest)
     {
         ::memset(hostDest, value, size);
-        ps2TraceGuestRangeWrite(rdram, destAddr, size, "memset", ctx);
+        ps2_watch::noteRangeWrite(rdram, destAddr, size, "memset", ctx);
     }
     else
     {
@@ -90,7 +90,7 @@ void memmove(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     if (hostDest && hostSrc)
     {
         ::memmove(hostDest, hostSrc, size);
-        ps2TraceGuestRangeWrite(rdram, destAddr, static_cast<uint32_t>(size), "memmove", ctx);
+        ps2_watch::noteRangeWrite(rdram, destAddr, static_cast<uint32_t>(size), "memmove", ctx);
     }
     else
     {
@@ -143,7 +143,7 @@ void strcpy(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     if (hostDest && hostSrc)
     {
         ::strcpy(hostDest, hostSrc);
-        ps2TraceGuestRangeWrite(rdram, destAddr, static_cast<uint32_t>(::strlen(hostSrc) + 1u), "strcpy", ctx);
+        ps2_watch::noteRangeWrite(rdram, destAddr, static_cast<uint32_t>(::strlen(hostSrc) + 1u), "strcpy", ctx);
     }
     else
     {
@@ -169,7 +169,7 @@ void strncpy(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     if (hostDest && hostSrc)
     {
         ::strncpy(hostDest, hostSrc, size);
-        ps2TraceGuestRangeWrite(rdram, destAddr, size, "strncpy", ctx);
+        ps2_watch::noteRangeWrite(rdram, destAddr, size, "strncpy", ctx);
     }
     else
     {
@@ -433,24 +433,17 @@ void sprintf(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
     if (format_addr != 0)
     {
-        const uint32_t watchBase = ps2PathWatchPhysAddr();
-        const uint32_t watchEnd = watchBase + PS2_PATH_WATCH_BYTES;
-        const uint32_t dest = str_addr & PS2_RAM_MASK;
-        const bool touchesWatch = dest < watchEnd && dest >= watchBase;
-        static uint32_t watchSprintfLogCount = 0;
-        if (touchesWatch && watchSprintfLogCount < 64u)
+        if (ps2_watch::overlaps(str_addr, 1u))
         {
             const uint32_t arg0 = getRegU32(ctx, 6);
             const uint32_t arg1 = getRegU32(ctx, 7);
-            std::cout << "[watch:sprintf] dest=0x" << std::hex << str_addr
-                      << " fmt@0x" << format_addr
-                      << " arg0=0x" << arg0
-                      << " arg1=0x" << arg1
-                      << " fmt=\"" << sanitizeForLog(readPs2CStringBounded(rdram, runtime, format_addr, 64)) << "\""
-                      << " s0=\"" << sanitizeForLog(readPs2CStringBounded(rdram, runtime, arg0, 64)) << "\""
-                      << " s1=\"" << sanitizeForLog(readPs2CStringBounded(rdram, runtime, arg1, 64)) << "\""
-                      << std::dec << std::endl;
-            ++watchSprintfLogCount;
+            PS2_LOG_INFO(Memory, "[watch:sprintf] dest=0x" << std::hex << str_addr
+                                                           << " fmt@0x" << format_addr
+                                                           << " arg0=0x" << arg0
+                                                           << " arg1=0x" << arg1
+                                                           << " fmt=\"" << sanitizeForLog(readPs2CStringBounded(rdram, runtime, format_addr, 64)) << "\""
+                                                           << " s0=\"" << sanitizeForLog(readPs2CStringBounded(rdram, runtime, arg0, 64)) << "\""
+                                                           << " s1=\"" << sanitizeForLog(readPs2CStringBounded(rdram, runtime, arg1, 64)) << "\"");
         }
 
         std::string rendered = formatPs2StringWithArgs(rdram, ctx, runtime, formatOwned.c_str(), 2);
@@ -461,7 +454,7 @@ void sprintf(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         const size_t writeLen = rendered.size() + 1u;
         if (writeGuestBytes(rdram, runtime, str_addr, reinterpret_cast<const uint8_t *>(rendered.c_str()), writeLen))
         {
-            ps2TraceGuestRangeWrite(rdram, str_addr, static_cast<uint32_t>(writeLen), "sprintf", ctx);
+            ps2_watch::noteRangeWrite(rdram, str_addr, static_cast<uint32_t>(writeLen), "sprintf", ctx);
             ret = static_cast<int>(rendered.size());
         }
         else
@@ -538,7 +531,7 @@ void snprintf(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
             }
             if (writeGuestBytes(rdram, runtime, str_addr, output.data(), output.size()))
             {
-                ps2TraceGuestRangeWrite(rdram, str_addr, static_cast<uint32_t>(output.size()), "snprintf", ctx);
+                ps2_watch::noteRangeWrite(rdram, str_addr, static_cast<uint32_t>(output.size()), "snprintf", ctx);
             }
             else
             {
@@ -262,12 +262,17 @@ void sceCdApplyNCmd(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
 void sceCdBreak(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 {
+    g_cdIoWorker.cancelQueued();
     setReturnS32(ctx, 1);
 }
 
 void sceCdCallback(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 {
-    setReturnS32(ctx, 0);
+    // Returns the previously installed handler, like libcdvd.
+    const uint32_t handler = getRegU32(ctx, 4);
+    g_cdCallbackGp.store(getRegU32(ctx, 28), std::memory_order_release);
+    const uint32_t previous = g_cdCallbackFunc.exchange(handler, std::memory_order_acq_rel);
+    setReturnU32(ctx, previous);
 }
 
 void sceCdChangeThreadPriority(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
@@ -293,6 +298,8 @@ void sceCdGetDiskType(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
 void sceCdGetReadPos(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 {
+    // Advances chunk by chunk while an asynchronous read is in flight.
+    dispatchCdCallbacks(rdram, runtime);
     setReturnU32(ctx, g_cdStreamingLbn);
 }
 
@@ -308,6 +315,15 @@ void sceCdGetToc(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
 void sceCdInit(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 {
+    {
+        // Index the disc up front so sceCdSearchFile is a single lookup.
+        std::lock_guard<std::mutex> stateLock(g_cdStateMutex);
+        const std::filesystem::path imagePath = getCdImagePath();
+        if (!imagePath.empty())
+        {
+            acquireIsoDirectoryIndex(imagePath);
+        }
+    }
     g_cdInitialized = true;
     g_lastCdError = 0;
     setReturnS32(ctx, 1);
@@ -380,7 +396,9 @@ void sceCdReadChain(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 {
     uint32_t chainAddr = getRegU32(ctx, 4);
     bool ok = true;
+    CdReadCommand command;
 
+    std::unique_lock<std::mutex> stateLock(g_cdStateMutex);
     for (int i = 0; i < 64; ++i)
     {
         uint32_t *entry = reinterpret_cast<uint32_t *>(getMemPtr(rdram, chainAddr + (i * 16)));
@@ -406,16 +424,29 @@ void sceCdReadChain(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
             bytes = maxBytes;
         }
 
-        if (!readCdSectors(lbn, sectors, rdram + offset, bytes))
+        if (!isReadableCdRange(lbn, sectors))
         {
             ok = false;
             break;
         }
 
-        g_cdStreamingLbn = lbn + sectors;
+        command.segments.push_back(CdReadSegment{lbn, sectors, rdram + offset, bytes});
     }
+    stateLock.unlock();
 
-    setReturnS32(ctx, ok ? 1 : 0);
+    if (!ok)
+    {
+        g_lastCdError = -1;
+        setReturnS32(ctx, 0);
+        return;
+    }
+
+    g_lastCdError = 0;
+    if (!command.segments.empty())
+    {
+        g_cdIoWorker.submit(std::move(command));
+    }
+    setReturnS32(ctx, 1);
 }
 
 void sceCdReadClock(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
@@ -473,6 +504,7 @@ void sceCdSearchFile(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     }
     ++traceCount;
 
+    std::lock_guard<std::mutex> stateLock(g_cdStateMutex);
     if (path.empty())
     {
         static uint32_t emptyPathCount = 0;
@@ -622,15 +654,24 @@ void sceCdStRead(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         bytes = maxBytes;
     }
 
-    const bool ok = readCdSectors(g_cdStreamingLbn, sectors, rdram + offset, bytes);
+    // Streams are consumed in order, so serve from the read-ahead window and
+    // ask the I/O thread to refill it past the new position.
+    bool ok = false;
+    {
+        std::lock_guard<std::mutex> stateLock(g_cdStateMutex);
+        ok = readCdSectorsCached(g_cdStreamingLbn, sectors, rdram + offset, bytes);
+    }
     if (ok)
     {
         g_cdStreamingLbn += sectors;
+        CdReadCommand prefetch;
+        prefetch.prefetchLbn = g_cdStreamingLbn;
+        g_cdIoWorker.submit(std::move(prefetch));
     }
 
     if (int32_t *err = reinterpret_cast<int32_t *>(getMemPtr(rdram, errAddr)); err)
     {
-        *err = ok ? 0 : g_lastCdError;
+        *err = ok ? 0 : g_lastCdError.load();
     }
 
     setReturnS32(ctx, ok ? static_cast<int32_t>(sectors) : 0);
@@ -676,7 +717,7 @@ void sceCdStStop(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
 void sceCdSyncS(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 {
-    setReturnS32(ctx, 0);
+    setReturnS32(ctx, g_cdIoWorker.busy() ? 1 : 0);
 }
 
 void sceCdTrayReq(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
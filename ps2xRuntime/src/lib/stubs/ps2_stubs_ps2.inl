@@ -3,6 +3,7 @@ void sceCdRead(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     const uint32_t a0 = getRegU32(ctx, 4); // usually lbn
     const uint32_t a1 = getRegU32(ctx, 5); // usually sector count
     const uint32_t a2 = getRegU32(ctx, 6); // usually destination buffer
+    PS2_TRACE_SCOPE_ARG("cd", "sceCdRead", "lbn", a0);
 
     struct CdReadArgs
     {
@@ -25,20 +26,20 @@ void sceCdRead(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         return static_cast<size_t>(clamped);
     };
 
-    auto tryRead = [&](const CdReadArgs &args) -> bool
+    auto canRead = [&](const CdReadArgs &args) -> bool
     {
         const uint32_t offset = args.buf & PS2_RAM_MASK;
-        const size_t bytes = clampReadBytes(args.sectors, offset);
-        if (bytes == 0)
+        if (clampReadBytes(args.sectors, offset) == 0)
         {
             return true;
         }
 
-        return readCdSectors(args.lbn, args.sectors, rdram + offset, bytes);
+        return isReadableCdRange(args.lbn, args.sectors);
     };
 
+    std::unique_lock<std::mutex> stateLock(g_cdStateMutex);
     CdReadArgs selected{a0, a1, a2, "a0/a1/a2"};
-    bool ok = tryRead(selected);
+    bool ok = canRead(selected);
 
     if (!ok)
     {
@@ -65,7 +66,7 @@ void sceCdRead(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
                     continue;
                 }
 
-                if (tryRead(candidate))
+                if (canRead(candidate))
                 {
                     static uint32_t recoverLogCount = 0;
                     if (recoverLogCount < 16)
@@ -84,42 +85,56 @@ void sceCdRead(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
                 }
             }
         }
+    }
+    stateLock.unlock();
 
-        if (!ok)
+    if (!ok)
+    {
+        const uint32_t offset = a2 & PS2_RAM_MASK;
+        const size_t bytes = clampReadBytes(a1, offset);
+        if (bytes > 0)
         {
-            const uint32_t offset = a2 & PS2_RAM_MASK;
-            const size_t bytes = clampReadBytes(a1, offset);
-            if (bytes > 0)
-            {
-                std::memset(rdram + offset, 0, bytes);
-            }
-
-            static uint32_t unresolvedLogCount = 0;
-            if (unresolvedLogCount < 32)
-            {
-                std::cerr << "[sceCdRead] unresolved request pc=0x" << std::hex << ctx->pc
-                          << " ra=0x" << getRegU32(ctx, 31)
-                          << " a0=0x" << a0
-                          << " a1=0x" << a1
-                          << " a2=0x" << a2 << std::dec << std::endl;
-                ++unresolvedLogCount;
-            }
+            std::memset(rdram + offset, 0, bytes);
         }
-    }
 
-    if (ok)
-    {
-        g_cdStreamingLbn = selected.lbn + selected.sectors;
-        setReturnS32(ctx, 1); // command accepted/success
+        static uint32_t unresolvedLogCount = 0;
+        if (unresolvedLogCount < 32)
+        {
+            std::cerr << "[sceCdRead] unresolved request pc=0x" << std::hex << ctx->pc
+                      << " ra=0x" << getRegU32(ctx, 31)
+                      << " a0=0x" << a0
+                      << " a1=0x" << a1
+                      << " a2=0x" << a2 << std::dec << std::endl;
+            ++unresolvedLogCount;
+        }
+        g_lastCdError = -1;
+        setReturnS32(ctx, 0);
         return;
     }
 
-    setReturnS32(ctx, 0);
+    // Accepted: the copy happens on the CD I/O thread; the guest observes it
+    // through sceCdSync/sceCdGetReadPos or its sceCdCallback handler.
+    const uint32_t offset = selected.buf & PS2_RAM_MASK;
+    CdReadCommand command;
+    command.segments.push_back(CdReadSegment{selected.lbn, selected.sectors, rdram + offset,
+                                             clampReadBytes(selected.sectors, offset)});
+    g_lastCdError = 0;
+    g_cdIoWorker.submit(std::move(command));
+    setReturnS32(ctx, 1); // command accepted
 }
 
 void sceCdSync(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 {
-    setReturnS32(ctx, 0); // 0 = completed/not busy
+    // mode 0 blocks until the drive is idle; any other mode only polls.
+    const uint32_t mode = getRegU32(ctx, 4);
+    if (mode == 0)
+    {
+        g_cdIoWorker.waitIdle();
+    }
+
+    const bool busy = g_cdIoWorker.busy();
+    dispatchCdCallbacks(rdram, runtime);
+    setReturnS32(ctx, busy ? 1 : 0); // 0 = completed/not busy
 }
 
 void sceCdGetError(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
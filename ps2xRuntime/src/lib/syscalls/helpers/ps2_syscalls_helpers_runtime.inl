@@ -345,11 +345,14 @@ std::string translatePs2Path(const char *ps2Path)
     auto resolveWithBase = [&](const std::filesystem::path &base, const std::string &suffix) -> std::string
     {
         const std::string normalizedSuffix = normalizePs2PathSuffix(suffix);
-        std::filesystem::path resolved = base;
-        if (!normalizedSuffix.empty())
+        if (normalizedSuffix.empty())
         {
-            resolved /= std::filesystem::path(normalizedSuffix);
+            return base.lexically_normal().string();
         }
+        // Guest paths are case-insensitive; the cache maps them onto the host
+        // tree and keeps components that do not exist yet as written.
+        std::filesystem::path resolved;
+        ps2_path_cache::resolve(base, std::filesystem::path(normalizedSuffix), resolved);
         return resolved.lexically_normal().string();
     };
 
@@ -4,10 +4,62 @@
 // rdram must hold this mutex while executing guest code. Release before
 // blocking (WaitSema, SleepThread) and reacquire after waking.
 // ---------------------------------------------------------------------------
-static std::mutex g_guest_exec_mutex;
+struct GuestExecMutex
+{
+    std::mutex mutex;
+
+    // A contended lock is a guest thread handoff; show the wait on the trace.
+    void lock()
+    {
+        if (ps2_trace::enabled()) [[unlikely]]
+        {
+            if (mutex.try_lock())
+            {
+                return;
+            }
+            PS2_TRACE_SCOPE("sched", "guest mutex wait");
+            mutex.lock();
+            return;
+        }
+        mutex.lock();
+    }
+
+    void unlock()
+    {
+        mutex.unlock();
+    }
+};
+static GuestExecMutex g_guest_exec_mutex;
+
+// Guest fio descriptors map to fixed slots holding a raw host descriptor and
+// the guest-visible file offset. Reads and writes go through pread/pwrite at
+// that offset, so lookups never take a lock and never touch stdio buffers.
+constexpr int kPs2FdBase = 3; // Start after stdin, stdout, stderr
+constexpr int kPs2MaxOpenFds = 256;
+constexpr int kPs2FdSlotFree = -1;
+constexpr int kPs2FdSlotReserved = -2;
+constexpr int kPs2FdSlotOpening = -3; // PS2_FIO_O_NOWAIT open still in flight
+
+struct Ps2FdSlot
+{
+    std::atomic<int> hostFd{kPs2FdSlotFree};
+    uint64_t offset = 0;
+    bool append = false;
+    // PS2_FIO_O_NOWAIT descriptors keep at most one host operation in flight;
+    // any later call on the descriptor settles it first.
+    bool nowait = false;
+    ps2_async_io::Ticket pendingTicket = 0;
+    ps2_async_io::Op pendingOp = ps2_async_io::Op::Read;
+    std::string pendingPath; // host path of an in-flight open
+    bool pendingCreate = false;
+};
+
+static Ps2FdSlot g_fdSlots[kPs2MaxOpenFds];
 
-std::unordered_map<int, FILE *> g_fileDescriptors;
-int g_nextFd = 3; // Start after stdin, stdout, stderr
+// The operation fioSync reports on, as with the single fileio RPC client.
+static ps2_async_io::Ticket g_fioLastAsyncTicket = 0;
+static Ps2FdSlot *g_fioLastAsyncSlot = nullptr;
+static int64_t g_fioLastAsyncResult = 0;
 
 struct ThreadInfo
 {
@@ -222,7 +274,6 @@ static std::mutex g_alarm_mutex;
 static std::condition_variable g_alarm_cv;
 static std::once_flag g_alarm_worker_once;
 std::atomic<int> g_activeThreads{0};
-static std::mutex g_fd_mutex;
 
 struct RpcServerState
 {
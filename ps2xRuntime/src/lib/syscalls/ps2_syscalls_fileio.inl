@@ -1,62 +1,209 @@
-static int allocatePs2Fd(FILE *file)
+#ifdef _WIN32
+static int64_t hostPread(int fd, void *buf, size_t size, uint64_t offset)
 {
-    if (!file)
+    if (::_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0)
         return -1;
+    return ::_read(fd, buf, static_cast<unsigned int>(size));
+}
+
+static int64_t hostPwrite(int fd, const void *buf, size_t size, uint64_t offset)
+{
+    if (::_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0)
+        return -1;
+    return ::_write(fd, buf, static_cast<unsigned int>(size));
+}
+
+static bool hostFileSize(int fd, uint64_t &sizeOut)
+{
+    struct _stat64 st{};
+    if (::_fstat64(fd, &st) != 0)
+        return false;
+    sizeOut = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+static int hostClose(int fd) { return ::_close(fd); }
+#else
+static int64_t hostPread(int fd, void *buf, size_t size, uint64_t offset)
+{
+    ssize_t n;
+    do
+    {
+        n = ::pread(fd, buf, size, static_cast<off_t>(offset));
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+static int64_t hostPwrite(int fd, const void *buf, size_t size, uint64_t offset)
+{
+    ssize_t n;
+    do
+    {
+        n = ::pwrite(fd, buf, size, static_cast<off_t>(offset));
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
 
-    std::lock_guard<std::mutex> lock(g_fd_mutex);
-    int fd = g_nextFd++;
-    g_fileDescriptors[fd] = file;
-    return fd;
+static bool hostFileSize(int fd, uint64_t &sizeOut)
+{
+    struct stat st{};
+    if (::fstat(fd, &st) != 0)
+        return false;
+    sizeOut = static_cast<uint64_t>(st.st_size);
+    return true;
 }
 
-static FILE *getHostFile(int ps2Fd)
+static int hostClose(int fd) { return ::close(fd); }
+#endif
+
+// Lowest free slot wins, matching the IOP's descriptor reuse.
+static int allocatePs2Fd(int hostFd, bool append)
 {
-    std::lock_guard<std::mutex> lock(g_fd_mutex);
-    auto it = g_fileDescriptors.find(ps2Fd);
-    if (it != g_fileDescriptors.end())
+    if (hostFd < 0 && hostFd != kPs2FdSlotOpening)
+        return -1;
+
+    for (int i = 0; i < kPs2MaxOpenFds; ++i)
     {
-        return it->second;
+        Ps2FdSlot &slot = g_fdSlots[i];
+        int expected = kPs2FdSlotFree;
+        if (!slot.hostFd.compare_exchange_strong(expected, kPs2FdSlotReserved, std::memory_order_acquire))
+            continue;
+
+        slot.offset = 0;
+        slot.append = append;
+        slot.nowait = false;
+        slot.pendingTicket = 0;
+        slot.pendingPath.clear();
+        slot.hostFd.store(hostFd, std::memory_order_release);
+        return kPs2FdBase + i;
     }
-    return nullptr;
+    return -1;
+}
+
+static Ps2FdSlot *getFdSlot(int ps2Fd)
+{
+    const int index = ps2Fd - kPs2FdBase;
+    if (index < 0 || index >= kPs2MaxOpenFds)
+        return nullptr;
+
+    Ps2FdSlot &slot = g_fdSlots[index];
+    const int hostFd = slot.hostFd.load(std::memory_order_acquire);
+    return (hostFd >= 0 || hostFd == kPs2FdSlotOpening) ? &slot : nullptr;
 }
 
-static void releasePs2Fd(int ps2Fd)
+// Returns the host descriptor the slot held, or -1 if it was not open.
+static int releasePs2Fd(int ps2Fd)
 {
-    std::lock_guard<std::mutex> lock(g_fd_mutex);
-    g_fileDescriptors.erase(ps2Fd);
+    const int index = ps2Fd - kPs2FdBase;
+    if (index < 0 || index >= kPs2MaxOpenFds)
+        return -1;
+
+    Ps2FdSlot &slot = g_fdSlots[index];
+    int hostFd = slot.hostFd.load(std::memory_order_acquire);
+    while (hostFd >= 0 &&
+           !slot.hostFd.compare_exchange_weak(hostFd, kPs2FdSlotFree, std::memory_order_acq_rel))
+    {
+    }
+    return hostFd >= 0 ? hostFd : -1;
 }
 
-static const char *translateFioMode(int ps2Flags)
+static void finishPendingFio(Ps2FdSlot &slot, int64_t result)
 {
-    bool read = (ps2Flags & PS2_FIO_O_RDONLY) || (ps2Flags & PS2_FIO_O_RDWR);
-    bool write = (ps2Flags & PS2_FIO_O_WRONLY) || (ps2Flags & PS2_FIO_O_RDWR);
-    bool append = (ps2Flags & PS2_FIO_O_APPEND);
-    bool create = (ps2Flags & PS2_FIO_O_CREAT);
-    bool truncate = (ps2Flags & PS2_FIO_O_TRUNC);
+    if (slot.pendingTicket == g_fioLastAsyncTicket)
+    {
+        // A completed open reports the guest descriptor, not the host one.
+        const bool openedFd = slot.pendingOp == ps2_async_io::Op::Open && result >= 0;
+        g_fioLastAsyncResult = openedFd ? kPs2FdBase + (&slot - g_fdSlots) : result;
+    }
+    slot.pendingTicket = 0;
 
-    if (read && write)
+    switch (slot.pendingOp)
     {
-        if (create && truncate)
-            return "w+b";
-        if (create)
-            return "a+b";
-        return "r+b";
+    case ps2_async_io::Op::Open:
+        if (result >= 0)
+        {
+            if (slot.pendingCreate)
+            {
+                ps2_path_cache::invalidate(slot.pendingPath);
+            }
+            slot.hostFd.store(static_cast<int>(result), std::memory_order_release);
+        }
+        else
+        {
+            PS2_LOG_WARN(Io, "fioOpen error: open failed for '" << slot.pendingPath << "': " << strerror(static_cast<int>(-result)));
+            slot.hostFd.store(kPs2FdSlotFree, std::memory_order_release);
+        }
+        slot.pendingPath.clear();
+        break;
+    case ps2_async_io::Op::Read:
+    case ps2_async_io::Op::Write:
+        if (result > 0)
+        {
+            slot.offset += static_cast<uint64_t>(result);
+        }
+        break;
     }
-    else if (write)
+}
+
+static void settlePendingFio(Ps2FdSlot &slot)
+{
+    if (slot.pendingTicket != 0)
     {
-        if (append)
-            return "ab";
-        if (create && truncate)
-            return "wb";
-        if (create)
-            return "wx";
-        return "r+b";
+        finishPendingFio(slot, ps2_async_io::wait(slot.pendingTicket));
     }
-    else if (read)
+}
+
+// getFdSlot plus completion of any NOWAIT operation still running on it;
+// nullptr if the descriptor is closed or its NOWAIT open failed.
+static Ps2FdSlot *acquireFdSlot(int ps2Fd)
+{
+    Ps2FdSlot *slot = getFdSlot(ps2Fd);
+    if (!slot)
+        return nullptr;
+
+    settlePendingFio(*slot);
+    return slot->hostFd.load(std::memory_order_acquire) >= 0 ? slot : nullptr;
+}
+
+static void submitNowaitFio(Ps2FdSlot &slot, ps2_async_io::Request request)
+{
+    slot.pendingOp = request.op;
+    slot.pendingTicket = ps2_async_io::submit(std::move(request));
+    g_fioLastAsyncTicket = slot.pendingTicket;
+    g_fioLastAsyncSlot = &slot;
+    g_fioLastAsyncResult = 0;
+}
+
+static int translateFioFlags(int ps2Flags)
+{
+    int hostFlags = 0;
+    switch (ps2Flags & PS2_FIO_O_RDWR)
     {
-        return "rb";
+    case PS2_FIO_O_RDWR:
+        hostFlags = O_RDWR;
+        break;
+    case PS2_FIO_O_WRONLY:
+        hostFlags = O_WRONLY;
+        break;
+    default:
+        hostFlags = O_RDONLY;
+        break;
     }
-    return "rb";
+
+    if (ps2Flags & PS2_FIO_O_CREAT)
+        hostFlags |= O_CREAT;
+    if (ps2Flags & PS2_FIO_O_TRUNC)
+        hostFlags |= O_TRUNC;
+    if (ps2Flags & PS2_FIO_O_EXCL)
+        hostFlags |= O_EXCL;
+    // PS2_FIO_O_APPEND is applied per write: O_APPEND would make pwrite ignore
+    // the offset on Linux.
+#ifdef _WIN32
+    hostFlags |= O_BINARY;
+#else
+    hostFlags |= O_CLOEXEC;
+#endif
+    return hostFlags;
 }
 
 void fioOpen(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
@@ -67,7 +214,7 @@ void fioOpen(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     const char *ps2Path = reinterpret_cast<const char *>(getConstMemPtr(rdram, pathAddr));
     if (!ps2Path)
     {
-        std::cerr << "fioOpen error: Invalid path address" << std::endl;
+        PS2_LOG_WARN(Io, "fioOpen error: Invalid path address");
         setReturnS32(ctx, -1);
         return;
     }
@@ -75,27 +222,67 @@ void fioOpen(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     std::string hostPath = translatePs2Path(ps2Path);
     if (hostPath.empty())
     {
-        std::cerr << "fioOpen error: Failed to translate path '" << ps2Path << "'" << std::endl;
+        PS2_LOG_WARN(Io, "fioOpen error: Failed to translate path '" << ps2Path << "'");
         setReturnS32(ctx, -1);
         return;
     }
 
-    const char *mode = translateFioMode(flags);
-    std::cout << "fioOpen: '" << hostPath << "' flags=0x" << std::hex << flags << std::dec << " mode='" << mode << "'" << std::endl;
+#ifdef _WIN32
+    constexpr int kCreateMode = _S_IREAD | _S_IWRITE;
+#else
+    constexpr int kCreateMode = 0644;
+#endif
 
-    FILE *fp = ::fopen(hostPath.c_str(), mode);
-    if (!fp)
+    if ((flags & PS2_FIO_O_NOWAIT) != 0)
     {
-        std::cerr << "fioOpen error: fopen failed for '" << hostPath << "': " << strerror(errno) << std::endl;
+        // The descriptor is handed out now; the host open completes in the
+        // background and is reported through fioSync.
+        const int ps2Fd = allocatePs2Fd(kPs2FdSlotOpening, (flags & PS2_FIO_O_APPEND) != 0);
+        if (ps2Fd < 0)
+        {
+            PS2_LOG_WARN(Io, "fioOpen error: Failed to allocate PS2 file descriptor");
+            setReturnS32(ctx, -1);
+            return;
+        }
+
+        Ps2FdSlot &slot = g_fdSlots[ps2Fd - kPs2FdBase];
+        slot.nowait = true;
+        slot.pendingPath = hostPath;
+        slot.pendingCreate = (flags & PS2_FIO_O_CREAT) != 0;
+
+        ps2_async_io::Request request;
+        request.op = ps2_async_io::Op::Open;
+        request.path = hostPath;
+        request.flags = translateFioFlags(flags);
+        request.mode = kCreateMode;
+        submitNowaitFio(slot, std::move(request));
+        setReturnS32(ctx, ps2Fd);
+        return;
+    }
+
+#ifdef _WIN32
+    const int hostFd = ::_open(hostPath.c_str(), translateFioFlags(flags), kCreateMode);
+#else
+    const int hostFd = ::open(hostPath.c_str(), translateFioFlags(flags), kCreateMode);
+#endif
+    if (hostFd < 0)
+    {
+        PS2_LOG_WARN(Io, "fioOpen error: open failed for '" << hostPath << "' flags=0x" << std::hex << flags << std::dec
+                         << ": " << strerror(errno));
         setReturnS32(ctx, -1); // e.g., -ENOENT, -EACCES
         return;
     }
 
-    int ps2Fd = allocatePs2Fd(fp);
+    if ((flags & PS2_FIO_O_CREAT) != 0)
+    {
+        ps2_path_cache::invalidate(hostPath);
+    }
+
+    int ps2Fd = allocatePs2Fd(hostFd, (flags & PS2_FIO_O_APPEND) != 0);
     if (ps2Fd < 0)
     {
-        std::cerr << "fioOpen error: Failed to allocate PS2 file descriptor" << std::endl;
-        ::fclose(fp);
+        PS2_LOG_WARN(Io, "fioOpen error: Failed to allocate PS2 file descriptor");
+        hostClose(hostFd);
         setReturnS32(ctx, -1); // e.g., -EMFILE
         return;
     }
@@ -107,18 +294,20 @@ void fioOpen(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 void fioClose(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 {
     int ps2Fd = (int)getRegU32(ctx, 4); // $a0
-    std::cout << "fioClose: fd=" << ps2Fd << std::endl;
 
-    FILE *fp = getHostFile(ps2Fd);
-    if (!fp)
+    if (Ps2FdSlot *slot = getFdSlot(ps2Fd))
+    {
+        settlePendingFio(*slot);
+    }
+    const int hostFd = releasePs2Fd(ps2Fd);
+    if (hostFd < 0)
     {
-        std::cerr << "fioClose warning: Invalid PS2 file descriptor " << ps2Fd << std::endl;
+        PS2_LOG_WARN(Io, "fioClose warning: Invalid PS2 file descriptor " << ps2Fd);
         setReturnS32(ctx, -1); // e.g., -EBADF
         return;
     }
 
-    int ret = ::fclose(fp);
-    releasePs2Fd(ps2Fd);
+    int ret = hostClose(hostFd);
 
     // returns 0 on success, -1 on error
     setReturnS32(ctx, ret == 0 ? 0 : -1);
@@ -131,17 +320,17 @@ void fioRead(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     size_t size = getRegU32(ctx, 6);      // $a2
 
     uint8_t *hostBuf = getMemPtr(rdram, bufAddr);
-    FILE *fp = getHostFile(ps2Fd);
+    Ps2FdSlot *slot = acquireFdSlot(ps2Fd);
 
     if (!hostBuf)
     {
-        std::cerr << "fioRead error: Invalid buffer address for fd " << ps2Fd << std::endl;
+        PS2_LOG_WARN(Io, "fioRead error: Invalid buffer address for fd " << ps2Fd);
         setReturnS32(ctx, -1); // -EFAULT
         return;
     }
-    if (!fp)
+    if (!slot)
     {
-        std::cerr << "fioRead error: Invalid file descriptor " << ps2Fd << std::endl;
+        PS2_LOG_WARN(Io, "fioRead error: Invalid file descriptor " << ps2Fd);
         setReturnS32(ctx, -1); // -EBADF
         return;
     }
@@ -151,19 +340,35 @@ void fioRead(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         return;
     }
 
-    size_t bytesRead = 0;
+    const int hostFd = slot->hostFd.load(std::memory_order_acquire);
+    if (slot->nowait)
     {
-        std::lock_guard<std::mutex> lock(g_sys_fd_mutex);
-        bytesRead = fread(hostBuf, 1, size, fp);
+        ps2_async_io::Request request;
+        request.op = ps2_async_io::Op::Read;
+        request.fd = hostFd;
+        request.buffer = hostBuf;
+        request.size = size;
+        request.offset = slot->offset;
+        submitNowaitFio(*slot, std::move(request));
+        setReturnS32(ctx, 0); // byte count comes from fioSync
+        return;
     }
 
-    if (bytesRead < size && ferror(fp))
+    size_t bytesRead = 0;
+    while (bytesRead < size)
     {
-        std::cerr << "fioRead error: fread failed for fd " << ps2Fd << ": " << strerror(errno) << std::endl;
-        clearerr(fp);
-        setReturnS32(ctx, -1); // -EIO or other appropriate error
-        return;
+        const int64_t n = hostPread(hostFd, hostBuf + bytesRead, size - bytesRead, slot->offset + bytesRead);
+        if (n < 0)
+        {
+            PS2_LOG_WARN(Io, "fioRead error: pread failed for fd " << ps2Fd << ": " << strerror(errno));
+            setReturnS32(ctx, -1); // -EIO or other appropriate error
+            return;
+        }
+        if (n == 0)
+            break;
+        bytesRead += static_cast<size_t>(n);
     }
+    slot->offset += bytesRead;
 
     // returns number of bytes read (can be 0 for EOF)
     setReturnS32(ctx, (int32_t)bytesRead);
@@ -182,10 +387,10 @@ void fioWrite(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         return;
     }
 
-    FILE *fp = getHostFile(ps2Fd);
-    if (!fp)
+    Ps2FdSlot *slot = acquireFdSlot(ps2Fd);
+    if (!slot)
     {
-        setReturnS32(ctx, -1); // -EFAULT
+        setReturnS32(ctx, -1); // -EBADF
         return;
     }
 
@@ -195,17 +400,42 @@ void fioWrite(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         return;
     }
 
+    const int hostFd = slot->hostFd.load(std::memory_order_acquire);
+    if (slot->append && !hostFileSize(hostFd, slot->offset))
+    {
+        setReturnS32(ctx, -1);
+        return;
+    }
+
+    if (slot->nowait)
+    {
+        ps2_async_io::Request request;
+        request.op = ps2_async_io::Op::Write;
+        request.fd = hostFd;
+        request.buffer = const_cast<uint8_t *>(hostBuf);
+        request.size = size;
+        request.offset = slot->offset;
+        submitNowaitFio(*slot, std::move(request));
+        setReturnS32(ctx, 0); // byte count comes from fioSync
+        return;
+    }
+
     size_t bytesWritten = 0;
+    while (bytesWritten < size)
     {
-        std::lock_guard<std::mutex> lock(g_sys_fd_mutex);
-        bytesWritten = ::fwrite(hostBuf, 1, size, fp);
-        if (bytesWritten < size && ferror(fp))
+        const int64_t n = hostPwrite(hostFd, hostBuf + bytesWritten, size - bytesWritten, slot->offset + bytesWritten);
+        if (n <= 0)
         {
-            clearerr(fp);
-            setReturnS32(ctx, -1); // -EIO, -ENOSPC etc.
-            return;
+            if (bytesWritten == 0)
+            {
+                setReturnS32(ctx, -1); // -EIO, -ENOSPC etc.
+                return;
+            }
+            break;
         }
+        bytesWritten += static_cast<size_t>(n);
     }
+    slot->offset += bytesWritten;
 
     // returns number of bytes written
     setReturnS32(ctx, (int32_t)bytesWritten);
@@ -217,57 +447,57 @@ void fioLseek(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     int32_t offset = getRegU32(ctx, 5);  // $a1 (PS2 seems to use 32-bit offset here commonly)
     int whence = (int)getRegU32(ctx, 6); // $a2 (PS2 FIO_SEEK constants)
 
-    FILE *fp = getHostFile(ps2Fd);
-    if (!fp)
+    Ps2FdSlot *slot = acquireFdSlot(ps2Fd);
+    if (!slot)
     {
-        std::cerr << "fioLseek error: Invalid file descriptor " << ps2Fd << std::endl;
+        PS2_LOG_WARN(Io, "fioLseek error: Invalid file descriptor " << ps2Fd);
         setReturnS32(ctx, -1); // -EBADF
         return;
     }
 
-    int hostWhence;
+    int64_t base = 0;
     switch (whence)
     {
     case PS2_FIO_SEEK_SET:
-        hostWhence = SEEK_SET;
+        base = 0;
         break;
     case PS2_FIO_SEEK_CUR:
-        hostWhence = SEEK_CUR;
+        base = static_cast<int64_t>(slot->offset);
         break;
     case PS2_FIO_SEEK_END:
-        hostWhence = SEEK_END;
+    {
+        uint64_t fileSize = 0;
+        if (!hostFileSize(slot->hostFd.load(std::memory_order_acquire), fileSize))
+        {
+            PS2_LOG_WARN(Io, "fioLseek error: fstat failed for fd " << ps2Fd << ": " << strerror(errno));
+            setReturnS32(ctx, -1);
+            return;
+        }
+        base = static_cast<int64_t>(fileSize);
         break;
+    }
     default:
-        std::cerr << "fioLseek error: Invalid whence value " << whence << " for fd " << ps2Fd << std::endl;
+        PS2_LOG_WARN(Io, "fioLseek error: Invalid whence value " << whence << " for fd " << ps2Fd);
         setReturnS32(ctx, -1); // -EINVAL
         return;
     }
 
-    if (::fseek(fp, static_cast<long>(offset), hostWhence) != 0)
-    {
-        std::cerr << "fioLseek error: fseek failed for fd " << ps2Fd << ": " << strerror(errno) << std::endl;
-        setReturnS32(ctx, -1); // Return error code
-        return;
-    }
-
-    long newPos = ::ftell(fp);
+    const int64_t newPos = base + offset;
     if (newPos < 0)
     {
-        std::cerr << "fioLseek error: ftell failed after fseek for fd " << ps2Fd << ": " << strerror(errno) << std::endl;
+        PS2_LOG_WARN(Io, "fioLseek error: negative position for fd " << ps2Fd);
         setReturnS32(ctx, -1);
+        return;
     }
-    else
+    if (newPos > 0xFFFFFFFFLL)
     {
-        if (newPos > 0xFFFFFFFFL)
-        {
-            std::cerr << "fioLseek warning: New position exceeds 32-bit for fd " << ps2Fd << std::endl;
-            setReturnS32(ctx, -1);
-        }
-        else
-        {
-            setReturnS32(ctx, (int32_t)newPos);
-        }
+        PS2_LOG_WARN(Io, "fioLseek warning: New position exceeds 32-bit for fd " << ps2Fd);
+        setReturnS32(ctx, -1);
+        return;
     }
+
+    slot->offset = static_cast<uint64_t>(newPos);
+    setReturnS32(ctx, (int32_t)newPos);
 }
 
 void fioMkdir(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
@@ -278,14 +508,14 @@ void fioMkdir(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     const char *ps2Path = reinterpret_cast<const char *>(getConstMemPtr(rdram, pathAddr));
     if (!ps2Path)
     {
-        std::cerr << "fioMkdir error: Invalid path address" << std::endl;
+        PS2_LOG_WARN(Io, "fioMkdir error: Invalid path address");
         setReturnS32(ctx, -1); // -EFAULT
         return;
     }
     std::string hostPath = translatePs2Path(ps2Path);
     if (hostPath.empty())
     {
-        std::cerr << "fioMkdir error: Failed to translate path '" << ps2Path << "'" << std::endl;
+        PS2_LOG_WARN(Io, "fioMkdir error: Failed to translate path '" << ps2Path << "'");
         setReturnS32(ctx, -1);
         return;
     }
@@ -294,13 +524,14 @@ void fioMkdir(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
     if (!success && ec)
     {
-        std::cerr << "fioMkdir error: create_directory failed for '" << hostPath
-                  << "': " << ec.message() << std::endl;
+        PS2_LOG_WARN(Io, "fioMkdir error: create_directory failed for '" << hostPath
+                         << "': " << ec.message());
         setReturnS32(ctx, -1);
     }
     else
     {
-        std::cout << "fioMkdir: Created directory '" << hostPath << "'" << std::endl;
+        ps2_path_cache::invalidate(hostPath);
+        PS2_LOG_INFO(Io, "fioMkdir: Created directory '" << hostPath << "'");
         setReturnS32(ctx, 0); // Success
     }
 }
@@ -311,7 +542,7 @@ void fioChdir(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     const char *ps2Path = reinterpret_cast<const char *>(getConstMemPtr(rdram, pathAddr));
     if (!ps2Path)
     {
-        std::cerr << "fioChdir error: Invalid path address" << std::endl;
+        PS2_LOG_WARN(Io, "fioChdir error: Invalid path address");
         setReturnS32(ctx, -1);
         return;
     }
@@ -319,7 +550,7 @@ void fioChdir(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     std::string hostPath = translatePs2Path(ps2Path);
     if (hostPath.empty())
     {
-        std::cerr << "fioChdir error: Failed to translate path '" << ps2Path << "'" << std::endl;
+        PS2_LOG_WARN(Io, "fioChdir error: Failed to translate path '" << ps2Path << "'");
         setReturnS32(ctx, -1);
         return;
     }
@@ -329,13 +560,13 @@ void fioChdir(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
     if (ec)
     {
-        std::cerr << "fioChdir error: current_path failed for '" << hostPath
-                  << "': " << ec.message() << std::endl;
+        PS2_LOG_WARN(Io, "fioChdir error: current_path failed for '" << hostPath
+                         << "': " << ec.message());
         setReturnS32(ctx, -1);
     }
     else
     {
-        std::cout << "fioChdir: Changed directory to '" << hostPath << "'" << std::endl;
+        PS2_LOG_INFO(Io, "fioChdir: Changed directory to '" << hostPath << "'");
         setReturnS32(ctx, 0); // Success
     }
 }
@@ -346,14 +577,14 @@ void fioRmdir(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     const char *ps2Path = reinterpret_cast<const char *>(getConstMemPtr(rdram, pathAddr));
     if (!ps2Path)
     {
-        std::cerr << "fioRmdir error: Invalid path address" << std::endl;
+        PS2_LOG_WARN(Io, "fioRmdir error: Invalid path address");
         setReturnS32(ctx, -1);
         return;
     }
     std::string hostPath = translatePs2Path(ps2Path);
     if (hostPath.empty())
     {
-        std::cerr << "fioRmdir error: Failed to translate path '" << ps2Path << "'" << std::endl;
+        PS2_LOG_WARN(Io, "fioRmdir error: Failed to translate path '" << ps2Path << "'");
         setReturnS32(ctx, -1);
         return;
     }
@@ -363,13 +594,14 @@ void fioRmdir(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
     if (!success || ec)
     {
-        std::cerr << "fioRmdir error: remove failed for '" << hostPath
-                  << "': " << ec.message() << std::endl;
+        PS2_LOG_WARN(Io, "fioRmdir error: remove failed for '" << hostPath
+                         << "': " << ec.message());
         setReturnS32(ctx, -1);
     }
     else
     {
-        std::cout << "fioRmdir: Removed directory '" << hostPath << "'" << std::endl;
+        ps2_path_cache::invalidate(hostPath);
+        PS2_LOG_INFO(Io, "fioRmdir: Removed directory '" << hostPath << "'");
         setReturnS32(ctx, 0); // Success
     }
 }
@@ -384,13 +616,13 @@ void fioGetstat(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
     if (!ps2Path)
     {
-        std::cerr << "fioGetstat error: Invalid path addr" << std::endl;
+        PS2_LOG_WARN(Io, "fioGetstat error: Invalid path addr");
         setReturnS32(ctx, -1);
         return;
     }
     if (!ps2StatBuf)
     {
-        std::cerr << "fioGetstat error: Invalid buffer addr" << std::endl;
+        PS2_LOG_WARN(Io, "fioGetstat error: Invalid buffer addr");
         setReturnS32(ctx, -1);
         return;
     }
@@ -398,7 +630,7 @@ void fioGetstat(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     std::string hostPath = translatePs2Path(ps2Path);
     if (hostPath.empty())
     {
-        std::cerr << "fioGetstat: path not found '" << ps2Path << "'" << std::endl;
+        PS2_LOG_WARN(Io, "fioGetstat: path not found '" << ps2Path << "'");
         setReturnS32(ctx, -1);
         return;
     }
@@ -407,7 +639,7 @@ void fioGetstat(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     std::filesystem::file_status fstatus = std::filesystem::status(hostPath, ec);
     if (ec || !std::filesystem::exists(fstatus))
     {
-        std::cerr << "fioGetstat: not found '" << hostPath << "'" << std::endl;
+        PS2_LOG_WARN(Io, "fioGetstat: not found '" << hostPath << "'");
         setReturnS32(ctx, -1);
         return;
     }
@@ -443,7 +675,7 @@ void fioRemove(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     const char *ps2Path = reinterpret_cast<const char *>(getConstMemPtr(rdram, pathAddr));
     if (!ps2Path)
     {
-        std::cerr << "fioRemove error: Invalid path" << std::endl;
+        PS2_LOG_WARN(Io, "fioRemove error: Invalid path");
         setReturnS32(ctx, -1);
         return;
     }
@@ -451,7 +683,7 @@ void fioRemove(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
     std::string hostPath = translatePs2Path(ps2Path);
     if (hostPath.empty())
     {
-        std::cerr << "fioRemove error: Path translate fail" << std::endl;
+        PS2_LOG_WARN(Io, "fioRemove error: Path translate fail");
         setReturnS32(ctx, -1);
         return;
     }
@@ -461,13 +693,49 @@ void fioRemove(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
     if (!success || ec)
     {
-        std::cerr << "fioRemove error: remove failed for '" << hostPath
-                  << "': " << ec.message() << std::endl;
+        PS2_LOG_WARN(Io, "fioRemove error: remove failed for '" << hostPath
+                         << "': " << ec.message());
         setReturnS32(ctx, -1);
     }
     else
     {
-        std::cout << "fioRemove: Removed file '" << hostPath << "'" << std::endl;
+        ps2_path_cache::invalidate(hostPath);
+        PS2_LOG_INFO(Io, "fioRemove: Removed file '" << hostPath << "'");
         setReturnS32(ctx, 0); // Success
     }
-}
\ No newline at end of file
+}
+
+// Completion of the last PS2_FIO_O_NOWAIT operation, mirroring how the fileio
+// RPC client reports it: PS2_FIO_NOWAIT polls like SifCheckStatRpc, while
+// PS2_FIO_WAIT blocks. The operation's return value goes to *retVal.
+void fioSync(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
+{
+    const uint32_t mode = getRegU32(ctx, 4);    // $a0
+    const uint32_t retAddr = getRegU32(ctx, 5); // $a1
+
+    Ps2FdSlot *slot = g_fioLastAsyncSlot;
+    if (slot && g_fioLastAsyncTicket != 0 && slot->pendingTicket == g_fioLastAsyncTicket)
+    {
+        if (mode == PS2_FIO_NOWAIT)
+        {
+            int64_t result = 0;
+            if (!ps2_async_io::poll(slot->pendingTicket, result))
+            {
+                setReturnS32(ctx, PS2_FIO_INCOMPLETE);
+                return;
+            }
+            finishPendingFio(*slot, result);
+        }
+        else
+        {
+            settlePendingFio(*slot);
+        }
+    }
+
+    if (uint8_t *retPtr = retAddr ? getMemPtr(rdram, retAddr) : nullptr)
+    {
+        const int32_t result = static_cast<int32_t>(g_fioLastAsyncResult);
+        std::memcpy(retPtr, &result, sizeof(result));
+    }
+    setReturnS32(ctx, PS2_FIO_COMPLETE);
+}
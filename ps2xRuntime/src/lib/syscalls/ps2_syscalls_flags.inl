@@ -279,13 +279,7 @@ void WaitSema(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 
     if (sema->count == 0)
     {
-        static int wsLog = 0;
-        if (wsLog < 200)
-        {
-            std::cerr << "[WaitSema] BLOCK sema=" << sid
-                      << " pc=0x" << std::hex << ctx->pc << std::dec << std::endl;
-            ++wsLog;
-        }
+        PS2_LOG_TRACE(Syscall, "[WaitSema] BLOCK sema=" << sid << " pc=0x" << std::hex << ctx->pc << std::dec);
 
         if (info)
         {
@@ -327,6 +321,7 @@ void WaitSema(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
             uint32_t loopIter = 0;
             while (true)
             {
+                raiseVBlankAtWaitPoint(runtime);
                 pollVBlankInline(rdram, runtime);
 
                 lock.lock();
@@ -339,31 +334,22 @@ void WaitSema(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
                 lock.unlock();
 
                 ++loopIter;
-                if (loopIter <= 5 || loopIter == 100 || (loopIter % 10000) == 0)
-                {
-                    std::cerr << "[WaitSema:main] sema=" << sid
-                              << " iter=" << loopIter
-                              << " count=" << sema->count
-                              << " pending=" << g_vblank_pending.load() << std::endl;
-                }
+                PS2_LOG_TRACE(Syscall, "[WaitSema:main] sema=" << sid << " iter=" << loopIter
+                                      << " count=" << sema->count << " pending=" << g_vblank_pending.load());
 
                 // Brief sleep — no mutex contention since workers are
-                // blocked on CVs, not competing for the mutex.
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                // blocked on CVs, not competing for the mutex. Faster clocks
+                // only yield so a 1ms sleep does not cap the frame rate.
+                if (runtime->clockMode() != PS2Runtime::ClockMode::RealTime)
+                    std::this_thread::yield();
+                else
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
             }
         }
 
         sema->waiters--;
 
-        {
-            static int wakeLog = 0;
-            if (wakeLog < 200)
-            {
-                std::cerr << "[WaitSema] WAKE sema=" << sid
-                          << " pc=0x" << std::hex << ctx->pc << std::dec << std::endl;
-                ++wakeLog;
-            }
-        }
+        PS2_LOG_TRACE(Syscall, "[WaitSema] WAKE sema=" << sid << " pc=0x" << std::hex << ctx->pc << std::dec);
 
         if (sema->deleted)
         {
@@ -4,6 +4,7 @@ namespace
     constexpr uint32_t kIntcVblankEnd = 3u;
     constexpr auto kVblankPeriod = std::chrono::microseconds(16667);
     constexpr int kMaxCatchupTicks = 4;
+    constexpr auto kUnlimitedFallbackPeriod = std::chrono::milliseconds(1);
 
     struct VSyncFlagRegistration
     {
@@ -25,6 +26,9 @@ namespace
     // drains it via pollVBlank().  Models PS2 where interrupts fire on the
     // same core at instruction boundaries.
     static std::atomic<int> g_vblank_pending{0};
+    // Unlimited clock: bumped by every frame-wait point, so the timer thread
+    // can tell when the guest waits for VBlank somewhere else.
+    static std::atomic<uint64_t> g_vblank_wait_points{0};
 }
 
 static void writeGuestU32NoThrow(uint8_t *rdram, uint32_t addr, uint32_t value)
@@ -112,6 +116,7 @@ static void dispatchIntcHandlersForCause(uint8_t *rdram, PS2Runtime *runtime, ui
             SET_GPR_U32(&irqCtx, 7, 0u);
             irqCtx.pc = info.handler;
 
+            PS2_TRACE_SCOPE_ARG("irq", "INTC handler", "handler", info.handler);
             PS2Runtime::RecompiledFunction func = runtime->lookupFunction(info.handler);
             func(rdram, &irqCtx, runtime);
         }
@@ -120,13 +125,8 @@ static void dispatchIntcHandlersForCause(uint8_t *rdram, PS2Runtime *runtime, ui
         }
         catch (const std::exception &e)
         {
-            static uint32_t warnCount = 0;
-            if (warnCount < 8u)
-            {
-                std::cerr << "[INTC] handler 0x" << std::hex << info.handler
-                          << " threw exception: " << e.what() << std::dec << std::endl;
-                ++warnCount;
-            }
+            PS2_LOG_RATE(ps2_log::Level::Warn, ps2_log::Category::Interrupt, 8,
+                         "[INTC] handler 0x" << std::hex << info.handler << " threw exception: " << e.what() << std::dec);
         }
     }
 }
@@ -168,23 +168,22 @@ static void dispatchDmacHandlersForCause(uint8_t *rdram, PS2Runtime *runtime, ui
 
     if (handlers.empty())
     {
-        std::cerr << "[DMAC] no handlers for cause=" << cause << std::endl;
+        PS2_LOG_DEBUG(Interrupt, "[DMAC] no handlers for cause=" << cause);
     }
 
     for (const IrqHandlerInfo &info : handlers)
     {
         if (!runtime->hasFunction(info.handler))
         {
-            std::cerr << "[DMAC] handler 0x" << std::hex << info.handler
-                      << " NOT FOUND in runtime (cause=" << std::dec << cause << ")" << std::endl;
+            PS2_LOG_WARN(Interrupt, "[DMAC] handler 0x" << std::hex << info.handler
+                                        << " NOT FOUND in runtime (cause=" << std::dec << cause << ")");
             continue;
         }
 
         try
         {
-            std::cerr << "[DMAC] dispatching handler 0x" << std::hex << info.handler
-                      << " cause=" << std::dec << cause
-                      << " arg=0x" << std::hex << info.arg << std::dec << std::endl;
+            PS2_LOG_DEBUG(Interrupt, "[DMAC] dispatching handler 0x" << std::hex << info.handler
+                                         << " cause=" << std::dec << cause << " arg=0x" << std::hex << info.arg << std::dec);
             R5900Context irqCtx{};
             const uint32_t sp = (info.sp != 0u) ? info.sp : PS2_IRQ_STACK_TOP;
             SET_GPR_U32(&irqCtx, 28, info.gp);
@@ -196,6 +195,7 @@ static void dispatchDmacHandlersForCause(uint8_t *rdram, PS2Runtime *runtime, ui
             SET_GPR_U32(&irqCtx, 7, 0u);
             irqCtx.pc = info.handler;
 
+            PS2_TRACE_SCOPE_ARG("irq", "DMAC handler", "handler", info.handler);
             PS2Runtime::RecompiledFunction func = runtime->lookupFunction(info.handler);
             func(rdram, &irqCtx, runtime);
         }
@@ -204,13 +204,8 @@ static void dispatchDmacHandlersForCause(uint8_t *rdram, PS2Runtime *runtime, ui
         }
         catch (const std::exception &e)
         {
-            static uint32_t warnCount = 0;
-            if (warnCount < 8u)
-            {
-                std::cerr << "[DMAC] handler 0x" << std::hex << info.handler
-                          << " threw exception: " << e.what() << std::dec << std::endl;
-                ++warnCount;
-            }
+            PS2_LOG_RATE(ps2_log::Level::Warn, ps2_log::Category::Interrupt, 8,
+                         "[DMAC] handler 0x" << std::hex << info.handler << " threw exception: " << e.what() << std::dec);
         }
     }
 }
@@ -235,15 +230,63 @@ static void signalVSyncFlag(uint8_t *rdram, uint64_t tickValue)
     }
 }
 
+static std::chrono::steady_clock::duration vblankPeriodFor(const PS2Runtime *runtime)
+{
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(kVblankPeriod);
+    if (runtime->clockMode() != PS2Runtime::ClockMode::FastForward)
+    {
+        return period;
+    }
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(period / runtime->clockMultiplier());
+}
+
+static void pollVBlankInline(uint8_t *rdram, PS2Runtime *runtime);
+
+// Unlimited clock with no frame-wait point in sight: the guest may be waiting
+// on another thread (an event flag set by the VBlank handler, a polled VSync
+// counter), so the timer thread delivers the VBlank itself. The guest exec
+// mutex keeps the handlers off any running PS2 thread.
+static void deliverFallbackVBlank(uint8_t *rdram, PS2Runtime *runtime)
+{
+    int idle = 0;
+    g_vblank_pending.compare_exchange_strong(idle, 1, std::memory_order_acq_rel);
+    PS2_TRACE_INSTANT("vblank", "VBlank timer", "ticks", 1);
+
+    g_guest_exec_mutex.lock();
+    if (!g_irq_worker_stop.load(std::memory_order_acquire) && !runtime->isStopRequested())
+    {
+        pollVBlankInline(rdram, runtime);
+    }
+    g_guest_exec_mutex.unlock();
+}
+
 static void interruptWorkerMain(uint8_t *rdram, PS2Runtime *runtime)
 {
     using clock = std::chrono::steady_clock;
-    auto nextTick = clock::now() + kVblankPeriod;
+    auto nextTick = clock::now() + vblankPeriodFor(runtime);
 
     while (!g_irq_worker_stop.load(std::memory_order_acquire) &&
            runtime != nullptr &&
            !runtime->isStopRequested())
     {
+        if (runtime->clockMode() == PS2Runtime::ClockMode::Unlimited)
+        {
+            // Frame-wait points raise VBlank themselves; fall back to a tick
+            // when none fired for a whole period. Resume the timer one period
+            // out if the mode changes back.
+            const uint64_t waitPoints = g_vblank_wait_points.load(std::memory_order_acquire);
+            std::this_thread::sleep_for(kUnlimitedFallbackPeriod);
+            nextTick = clock::now() + vblankPeriodFor(runtime);
+            if (waitPoints == g_vblank_wait_points.load(std::memory_order_acquire) &&
+                runtime->clockMode() == PS2Runtime::ClockMode::Unlimited &&
+                !g_irq_worker_stop.load(std::memory_order_acquire) &&
+                !runtime->isStopRequested())
+            {
+                deliverFallbackVBlank(rdram, runtime);
+            }
+            continue;
+        }
+
         std::this_thread::sleep_until(nextTick);
 
         const auto now = clock::now();
@@ -251,7 +294,7 @@ static void interruptWorkerMain(uint8_t *rdram, PS2Runtime *runtime)
         while (now >= nextTick && ticksToProcess < kMaxCatchupTicks)
         {
             ++ticksToProcess;
-            nextTick += kVblankPeriod;
+            nextTick += vblankPeriodFor(runtime);
         }
         if (ticksToProcess == 0)
         {
@@ -262,21 +305,13 @@ static void interruptWorkerMain(uint8_t *rdram, PS2Runtime *runtime)
         // thread via pollVBlank(), matching how real PS2 fires interrupts
         // on the same core at instruction boundaries.
         g_vblank_pending.fetch_add(ticksToProcess, std::memory_order_release);
+        PS2_TRACE_INSTANT("vblank", "VBlank timer", "ticks", ticksToProcess);
 
-        static uint32_t timerLog = 0;
-        ++timerLog;
-        if (timerLog <= 20 || (timerLog % 120) == 0)
-        {
-            std::cerr << "[VBlankTimer] tick#" << timerLog
-                      << " added=" << ticksToProcess
-                      << " pending=" << g_vblank_pending.load() << std::endl;
-        }
+        PS2_LOG_TRACE(VBlank, "[VBlankTimer] added=" << ticksToProcess << " pending=" << g_vblank_pending.load(std::memory_order_relaxed));
     }
 
-    std::cerr << "[VBlankTimer] EXITING! stop="
-              << g_irq_worker_stop.load()
-              << " stopReq=" << (runtime ? runtime->isStopRequested() : -1)
-              << std::endl;
+    PS2_LOG_DEBUG(VBlank, "[VBlankTimer] EXITING! stop=" << g_irq_worker_stop.load()
+                                << " stopReq=" << (runtime ? runtime->isStopRequested() : -1));
     g_irq_worker_running.store(false, std::memory_order_release);
 }
 
@@ -297,9 +332,7 @@ static void pollVBlankInline(uint8_t *rdram, PS2Runtime *runtime)
     {
         pending = kMaxCatchupTicks;
     }
-
-    static uint32_t pollLog = 0;
-    ++pollLog;
+    PS2_TRACE_SCOPE_ARG("vblank", "VBlank", "ticks", pending);
 
     for (int i = 0; i < pending; ++i)
     {
@@ -309,14 +342,28 @@ static void pollVBlankInline(uint8_t *rdram, PS2Runtime *runtime)
             tickValue = ++g_vsync_tick_counter;
         }
         signalVSyncFlag(rdram, tickValue);
-        if (pollLog <= 30 || (pollLog % 60) == 0)
-        {
-            std::cerr << "[pollVBlank] tick=" << tickValue
-                      << " pending=" << pending << std::endl;
-        }
+        PS2_LOG_TRACE(VBlank, "[pollVBlank] tick=" << tickValue << " pending=" << pending);
         dispatchIntcHandlersForCause(rdram, runtime, kIntcVblankStart);
         dispatchIntcHandlersForCause(rdram, runtime, kIntcVblankEnd);
+        // Transfers held back by the per-frame DMA budget continue here.
+        runtime->memory().advanceDma();
+    }
+    runtime->memory().publishFrame();
+
+    ps2_stubs::pollCdCallbacks(rdram, runtime);
+}
+
+// Frame-wait point: under the Unlimited clock the guest is done with its
+// frame, so the next VBlank is due now.
+static void raiseVBlankAtWaitPoint(PS2Runtime *runtime)
+{
+    if (runtime->clockMode() != PS2Runtime::ClockMode::Unlimited)
+    {
+        return;
     }
+    g_vblank_wait_points.fetch_add(1, std::memory_order_release);
+    int idle = 0;
+    g_vblank_pending.compare_exchange_strong(idle, 1, std::memory_order_acq_rel);
 }
 
 static void ensureInterruptWorkerRunning(uint8_t *rdram, PS2Runtime *runtime)
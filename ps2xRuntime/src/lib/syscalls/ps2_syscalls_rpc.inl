@@ -162,6 +162,7 @@ void SifCallRpc(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
 {
     uint32_t clientPtr = getRegU32(ctx, 4);
     uint32_t rpcNum = getRegU32(ctx, 5);
+    PS2_TRACE_SCOPE_ARG("rpc", "SifCallRpc", "rpc", rpcNum);
     uint32_t mode = getRegU32(ctx, 6);
     uint32_t sendBuf = getRegU32(ctx, 7);
     uint32_t sendSize = 0;
@@ -197,6 +197,7 @@ void DeleteThread(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         setReturnS32(ctx, KE_UNKNOWN_THID);
         return;
     }
+    PS2_TRACE_INSTANT("thread", "DeleteThread", "tid", tid);
 
     uint32_t autoStackToFree = 0;
     {
@@ -251,6 +252,7 @@ void StartThread(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
         setReturnS32(ctx, KE_UNKNOWN_THID);
         return;
     }
+    PS2_TRACE_INSTANT("thread", "StartThread", "tid", tid);
 
     if (!runtime || !runtime->hasFunction(info->entry))
     {
@@ -343,6 +345,8 @@ void StartThread(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
                       << " gp=0x" << GPR_U32(threadCtx, 28)
                       << " arg=0x" << info->arg << std::dec << std::endl;
 
+            ps2_profiler::ThreadScope profile(threadCtx, "PS2Thread_" + std::to_string(tid));
+            PS2_TRACE_INSTANT("thread", "thread entry", "entry", info->entry);
             bool exited = false;
             try
             {
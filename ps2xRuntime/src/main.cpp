@@ -1,19 +1,111 @@
 #include "ps2_runtime.h"
+#include "ps2_callstats.h"
+#include "ps2_profiler.h"
+#include "ps2_trace.h"
 #include "register_functions.h"
+#include <cstdlib>
 #include <iostream>
 #include <string>
 
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " <elf_file> [--headless <frames>] [--report <file.json>]"
+              << " [--fast-forward <multiplier> | --unlimited] [--watch <addr:size,...>]"
+              << " [--profile <file.folded>] [--profile-hz <rate>]"
+              << " [--trace <file.json>] [--call-stats <file.json>]" << std::endl;
+}
+
 int main(int argc, char *argv[])
 {
     if (argc < 2)
     {
-        std::cout << "Usage: " << argv[0] << " <elf_file>" << std::endl;
+        printUsage(argv[0]);
         return 1;
     }
 
-    std::string elfPath = argv[1];
+    std::string elfPath;
+    bool headless = false;
+    PS2Runtime::HeadlessOptions headlessOptions;
+    bool clockSelected = false;
+    PS2Runtime::ClockMode clockMode = PS2Runtime::ClockMode::RealTime;
+    double clockMultiplier = 1.0;
+    ps2_profiler::Options profileOptions;
+    ps2_trace::Options traceOptions;
+    bool callStats = false;
+    ps2_callstats::Options callStatsOptions;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--headless" && i + 1 < argc)
+        {
+            headless = true;
+            headlessOptions.frames = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--report" && i + 1 < argc)
+        {
+            headlessOptions.reportPath = argv[++i];
+        }
+        else if (arg == "--fast-forward" && i + 1 < argc)
+        {
+            clockSelected = true;
+            clockMode = PS2Runtime::ClockMode::FastForward;
+            clockMultiplier = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--unlimited")
+        {
+            clockSelected = true;
+            clockMode = PS2Runtime::ClockMode::Unlimited;
+        }
+        else if (arg == "--watch" && i + 1 < argc)
+        {
+            if (!ps2_watch::configure(argv[++i]))
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg == "--profile" && i + 1 < argc)
+        {
+            profileOptions.outputPath = argv[++i];
+        }
+        else if (arg == "--profile-hz" && i + 1 < argc)
+        {
+            profileOptions.hz = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--trace" && i + 1 < argc)
+        {
+            traceOptions.outputPath = argv[++i];
+        }
+        else if (arg == "--call-stats" && i + 1 < argc)
+        {
+            callStats = true;
+            callStatsOptions.outputPath = argv[++i];
+        }
+        else if (elfPath.empty() && arg.rfind("--", 0) != 0)
+        {
+            elfPath = arg;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (elfPath.empty())
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
 
     PS2Runtime runtime;
+    if (headless)
+    {
+        runtime.setHeadless(headlessOptions);
+    }
+    if (clockSelected)
+    {
+        runtime.setClockMode(clockMode, clockMultiplier);
+    }
     if (!runtime.initialize("ps2xRuntime (Raylib host)"))
     {
         std::cerr << "Failed to initialize PS2 runtime" << std::endl;
@@ -28,7 +120,28 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (!profileOptions.outputPath.empty() && !ps2_profiler::start(profileOptions))
+    {
+        std::cerr << "Failed to start the profiler (rate " << profileOptions.hz << ")" << std::endl;
+        return 1;
+    }
+
+    if (!traceOptions.outputPath.empty())
+    {
+        ps2_trace::start(traceOptions);
+    }
+
+    if (callStats)
+    {
+        ps2_callstats::start(callStatsOptions);
+        ps2_callstats::installDumpSignal();
+    }
+
     runtime.run();
 
+    ps2_callstats::stop();
+    ps2_trace::stop();
+    ps2_profiler::stop();
+
     return 0;
-}
\ No newline at end of file
+}
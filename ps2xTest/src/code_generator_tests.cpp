@@ -563,6 +563,55 @@ void register_code_generator_tests()
             t.IsTrue(generated.find("if (ctx->pc == __entryPc) { ctx->pc = 0xA008u; }") != std::string::npos,
                      "JAL should recover fallthrough when callee leaves ctx->pc unchanged");
             t.IsTrue(generated.find("if (ctx->pc != 0xA008u) { return; }") != std::string::npos, "JAL should check return PC");
+            t.IsTrue(generated.find("PS2_PROFILE_CALL(0xB000u);") != std::string::npos,
+                     "JAL should push the callee on the profiler shadow stack");
+        });
+
+        tc.Run("guest line info points each instruction at the listing", [](TestCase &t) {
+            Function func;
+            func.name = "line_test";
+            func.start = 0xA000;
+            func.end = 0xA010;
+            func.isRecompiled = true;
+
+            CodeGenerator gen({});
+            gen.setGuestListingPath("/out/guest_lines.lst");
+            const std::string generated =
+                gen.generateFunction(func, {makeNop(0xA000), makeJal(0xA004, 0xB000), makeNop(0xA008)}, false);
+            const std::string listing = gen.generateGuestListing();
+
+            t.IsTrue(generated.find("    // 0xa000: 0x0\n#line 1 \"/out/guest_lines.lst\"\n    ctx->pc = 0xa000u;\n") !=
+                         std::string::npos,
+                     "first instruction's code maps to listing line 1");
+            t.IsTrue(generated.find("#line 3") == std::string::npos, "delay slot shares the branch line");
+
+            // #line only covers the next source line, so each line of the
+            // multi-line branch code has to carry its own directive.
+            std::istringstream lines(generated.substr(generated.find("    // 0xa004:")));
+            std::string line;
+            std::getline(lines, line);
+            std::string previous;
+            int branchLines = 0;
+            bool allMapped = true;
+            while (std::getline(lines, line) && line != "}")
+            {
+                if (line.rfind("#line", 0) != 0)
+                {
+                    allMapped = allMapped && previous == "#line 2 \"/out/guest_lines.lst\"";
+                    ++branchLines;
+                }
+                previous = line;
+            }
+            t.IsTrue(branchLines > 1, "branch code spans several lines");
+            t.IsTrue(allMapped, "every branch code line maps to listing line 2");
+            t.IsTrue(listing.find("0x0000A004  0x0C002C00  line_test+0x4\n") != std::string::npos,
+                     "listing names address, word and offset");
+            t.IsTrue(listing.find("0x0000A008  0x00000000  line_test+0x8  (delay slot)\n") != std::string::npos,
+                     "delay slot is listed after its branch");
+
+            CodeGenerator plain({});
+            t.IsTrue(plain.generateFunction(func, {makeNop(0xA000)}, false).find("#line") == std::string::npos,
+                     "no #line without a listing path");
         });
 
         tc.Run("JAL to internal target becomes goto", [](TestCase &t) {
@@ -775,6 +824,38 @@ void register_code_generator_tests()
             t.Equals(PS2Recompiler::resolveStubTarget("_DefinitelyNotARealCall"), StubTarget::Unknown,
                      "unknown names must still stay unknown");
         });
+
+        tc.Run("registration arms configured watchpoints", [](TestCase &t) {
+            CodeGenerator gen({});
+            gen.setWatchpoints({"0x00369F2F:32=path", "0x100000-0x100100"});
+            const std::string generated = gen.generateFunctionRegistration({}, {});
+            t.IsTrue(generated.find("ps2_watch::configure(\"0x00369F2F:32=path\");") != std::string::npos,
+                     "each spec should be armed by registerAllFunctions");
+            t.IsTrue(generated.find("ps2_watch::configure(\"0x100000-0x100100\");") != std::string::npos,
+                     "range specs are passed through unchanged");
+        });
+
+        tc.Run("registration emits the guest function symbol table", [](TestCase &t) {
+            Function recompiled;
+            recompiled.name = "UpdateFrame";
+            recompiled.start = 0x100000;
+            recompiled.end = 0x100040;
+            recompiled.isRecompiled = true;
+
+            Function stub;
+            stub.name = "printf";
+            stub.start = 0x200000;
+            stub.end = 0x200010;
+            stub.isStub = true;
+
+            CodeGenerator gen({});
+            const std::string generated = gen.generateFunctionRegistration({recompiled, stub}, {});
+            t.IsTrue(generated.find("{0x100000u, 0x100040u, \"UpdateFrame\"},") != std::string::npos,
+                     "recompiled functions are listed with their guest extent");
+            t.IsTrue(generated.find("\"printf\"") == std::string::npos, "stubs have no guest code to symbolize");
+            t.IsTrue(generated.find("ps2_symbols::registerFunctions(kFunctionSymbols") != std::string::npos,
+                     "registerAllFunctions installs the table");
+        });
     
     });
 }
@@ -4,6 +4,16 @@ void register_code_generator_tests();
 void register_r5900_decoder_tests();
 void register_elf_analyzer_tests();
 void register_ps2_runtime_io_tests();
+void register_ps2_gs_tests();
+void register_ps2_dmac_tests();
+void register_ps2_vif_tests();
+void register_ps2_vu_tests();
+void register_ps2_benchmark_tests();
+void register_ps2_log_tests();
+void register_ps2_watch_tests();
+void register_ps2_profiler_tests();
+void register_ps2_trace_tests();
+void register_ps2_callstats_tests();
 void register_ps2_recompiler_tests();
 
 int main()
@@ -12,6 +22,16 @@ int main()
     register_r5900_decoder_tests();
     register_elf_analyzer_tests();
     register_ps2_runtime_io_tests();
+    register_ps2_gs_tests();
+    register_ps2_dmac_tests();
+    register_ps2_vif_tests();
+    register_ps2_vu_tests();
+    register_ps2_benchmark_tests();
+    register_ps2_log_tests();
+    register_ps2_watch_tests();
+    register_ps2_profiler_tests();
+    register_ps2_trace_tests();
+    register_ps2_callstats_tests();
     register_ps2_recompiler_tests();
     return MiniTest::Run();
 }
@@ -0,0 +1,269 @@
+#include "MiniTest.h"
+#include "ps2_benchmark.h"
+#include "ps2_runtime.h"
+#include "ps2_runtime_macros.h"
+#include "ps2_syscalls.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+    constexpr uint32_t kEntry = 0x00100000u;
+    constexpr uint32_t kVSyncFlagAddr = 0x00080000u;
+    constexpr double kVBlankSeconds = 0.016667;
+
+    // Wait points that delivered anything but exactly one VBlank.
+    std::atomic<uint64_t> g_unevenWaits{0};
+
+    // Registers a VSync flag (which starts the VBlank timer) and then waits
+    // on VBlanks until the runtime stops it.
+    void vblankWaiter(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
+    {
+        SET_GPR_U32(ctx, 4, kVSyncFlagAddr);
+        SET_GPR_U32(ctx, 5, 0u);
+        runtime->handleSyscall(rdram, ctx, 0x73); // SetVSyncFlag
+        while (!runtime->isStopRequested())
+        {
+            const uint64_t before = ps2_syscalls::vblankCount();
+            ps2_syscalls::pollVBlank(rdram, runtime);
+            if (ps2_syscalls::vblankCount() - before != 1)
+                g_unevenWaits.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    constexpr uint32_t kWaiterThreadEntry = 0x00100100u;
+    constexpr uint32_t kVBlankHandler = 0x00100200u;
+    constexpr uint32_t kEventFlagParamAddr = 0x00081000u;
+    constexpr uint32_t kThreadParamAddr = 0x00081100u;
+    constexpr uint32_t kIntcVBlankStart = 2u;
+
+    std::atomic<uint64_t> g_threadWakes{0};
+
+    // INTC VBlank handler: sets the event flag passed as its argument.
+    void vblankFlagHandler(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
+    {
+        SET_GPR_U32(ctx, 4, GPR_U32(ctx, 5));
+        SET_GPR_U32(ctx, 5, 1u);
+        ps2_syscalls::iSetEventFlag(rdram, ctx, runtime);
+    }
+
+    // PS2 thread that waits for VBlank on the event flag in $a0.
+    void flagWaiterThread(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
+    {
+        const uint32_t eventFlag = GPR_U32(ctx, 4);
+        while (!runtime->isStopRequested())
+        {
+            SET_GPR_U32(ctx, 4, eventFlag);
+            SET_GPR_U32(ctx, 5, 1u);
+            SET_GPR_U32(ctx, 6, 0x11u); // WEF_OR | WEF_CLEAR
+            SET_GPR_U32(ctx, 7, 0u);
+            ps2_syscalls::WaitEventFlag(rdram, ctx, runtime);
+            g_threadWakes.fetch_add(1, std::memory_order_relaxed);
+        }
+        ctx->pc = 0u;
+    }
+
+    // Hands VBlank waiting to flagWaiterThread and never reaches a
+    // frame-wait point itself.
+    void flagWaiterMain(uint8_t *rdram, R5900Context *ctx, PS2Runtime *runtime)
+    {
+        const uint32_t flagParam[3] = {0u, 0u, 0u};
+        std::memcpy(rdram + kEventFlagParamAddr, flagParam, sizeof(flagParam));
+        SET_GPR_U32(ctx, 4, kEventFlagParamAddr);
+        ps2_syscalls::CreateEventFlag(rdram, ctx, runtime);
+        const uint32_t eventFlag = GPR_U32(ctx, 2);
+
+        SET_GPR_U32(ctx, 4, kIntcVBlankStart);
+        SET_GPR_U32(ctx, 5, kVBlankHandler);
+        SET_GPR_U32(ctx, 6, 0u);
+        SET_GPR_U32(ctx, 7, eventFlag);
+        runtime->handleSyscall(rdram, ctx, 0x10); // AddIntcHandler
+
+        const uint32_t threadParam[7] = {0u, kWaiterThreadEntry, 0x00200000u, 0x1000u, 0x00300000u, 10u, 0u};
+        std::memcpy(rdram + kThreadParamAddr, threadParam, sizeof(threadParam));
+        SET_GPR_U32(ctx, 4, kThreadParamAddr);
+        ps2_syscalls::CreateThread(rdram, ctx, runtime);
+        SET_GPR_U32(ctx, 4, GPR_U32(ctx, 2));
+        SET_GPR_U32(ctx, 5, eventFlag);
+        ps2_syscalls::StartThread(rdram, ctx, runtime);
+
+        while (!runtime->isStopRequested())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    uint64_t jsonNumber(const std::string &json, const std::string &key)
+    {
+        std::smatch match;
+        const std::regex re("\"" + key + "\": ([0-9]+)");
+        return std::regex_search(json, match, re) ? std::stoull(match[1].str()) : ~0ull;
+    }
+
+    double jsonReal(const std::string &json, const std::string &key)
+    {
+        std::smatch match;
+        const std::regex re("\"" + key + "\": ([0-9.e+-]+)");
+        return std::regex_search(json, match, re) ? std::stod(match[1].str()) : -1.0;
+    }
+
+    std::filesystem::path reportPathFor(const std::string &name)
+    {
+        return std::filesystem::temp_directory_path() /
+               ("ps2x-" + name + "-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".json");
+    }
+
+    // Runs vblankWaiter headless under the given clock and returns the report.
+    std::string runWaiter(PS2Runtime::ClockMode mode, double multiplier, uint64_t frames)
+    {
+        const std::filesystem::path reportPath = reportPathFor("clock");
+        {
+            PS2Runtime runtime;
+            PS2Runtime::HeadlessOptions options;
+            options.frames = frames;
+            options.reportPath = reportPath.string();
+            runtime.setHeadless(options);
+            runtime.setClockMode(mode, multiplier);
+            if (!runtime.initialize())
+                return {};
+            runtime.registerFunction(kEntry, vblankWaiter);
+            runtime.cpu().pc = kEntry;
+            runtime.run();
+        }
+
+        std::ifstream file(reportPath);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        file.close();
+        std::error_code ec;
+        std::filesystem::remove(reportPath, ec);
+        return ss.str();
+    }
+}
+
+void register_ps2_benchmark_tests()
+{
+    MiniTest::Case("PS2Benchmark", [](TestCase &tc)
+    {
+        tc.Run("report serializes counters and rates", [](TestCase &t)
+        {
+            ps2_benchmark::Report report;
+            report.frames = 120;
+            report.seconds = 2.0;
+            report.dispatches = 1000;
+            report.syscalls = 7;
+            report.gsWrites = 3;
+            report.peakRssBytes = 4096;
+            const std::string json = ps2_benchmark::toJson(report);
+            t.IsTrue(json.find("\"fps\": 60,") != std::string::npos, "frames per second derived from the duration");
+            t.IsTrue(json.find("\"dispatches_per_second\": 500,") != std::string::npos, "dispatch rate reported");
+            t.Equals(jsonNumber(json, "syscalls"), uint64_t{7}, "syscall count reported");
+            t.Equals(jsonNumber(json, "gs_writes"), uint64_t{3}, "GS write count reported");
+            t.IsTrue(json.find("\"guest_exited\": false") != std::string::npos, "exit flag reported");
+            t.IsTrue(ps2_benchmark::peakResidentBytes() > 0, "peak RSS is available on this host");
+        });
+
+        tc.Run("headless run stops after the requested frames", [](TestCase &t)
+        {
+            const std::filesystem::path reportPath = reportPathFor("benchmark");
+            g_unevenWaits.store(0, std::memory_order_relaxed);
+            {
+                PS2Runtime runtime;
+                PS2Runtime::HeadlessOptions options;
+                options.frames = 30;
+                options.reportPath = reportPath.string();
+                runtime.setHeadless(options);
+                t.IsTrue(runtime.initialize(), "headless runtime initializes without a window");
+                runtime.registerFunction(kEntry, vblankWaiter);
+                runtime.cpu().pc = kEntry;
+                runtime.run();
+            }
+            // The waiter keeps reaching wait points, so the unlimited clock
+            // never falls back to the timer and each wait point delivers
+            // exactly one VBlank.
+            t.Equals(g_unevenWaits.load(std::memory_order_relaxed), uint64_t{0}, "one VBlank per wait point");
+
+            std::ifstream file(reportPath);
+            std::stringstream ss;
+            ss << file.rdbuf();
+            const std::string json = ss.str();
+            t.IsTrue(jsonNumber(json, "frames") >= 30 && jsonNumber(json, "frames") != ~0ull, "report counts the frames");
+            t.Equals(jsonNumber(json, "syscalls"), uint64_t{1}, "report counts syscalls");
+            t.IsTrue(jsonNumber(json, "dispatches") >= 1 && jsonNumber(json, "dispatches") != ~0ull, "report counts dispatches");
+            t.IsTrue(json.find("\"guest_exited\": false") != std::string::npos, "stopped by the frame limit");
+            std::error_code ec;
+            std::filesystem::remove(reportPath, ec);
+        });
+
+        tc.Run("unlimited clock wakes a VBlank waiter on another thread", [](TestCase &t)
+        {
+            const std::filesystem::path reportPath = reportPathFor("thread-waiter");
+            g_threadWakes.store(0, std::memory_order_relaxed);
+            {
+                PS2Runtime runtime;
+                PS2Runtime::HeadlessOptions options;
+                options.frames = 10;
+                options.reportPath = reportPath.string();
+                runtime.setHeadless(options);
+                if (!runtime.initialize())
+                {
+                    t.IsTrue(false, "headless runtime initializes");
+                    return;
+                }
+                runtime.registerFunction(kEntry, flagWaiterMain);
+                runtime.registerFunction(kWaiterThreadEntry, flagWaiterThread);
+                runtime.registerFunction(kVBlankHandler, vblankFlagHandler);
+                runtime.cpu().pc = kEntry;
+                runtime.run();
+            }
+
+            std::ifstream file(reportPath);
+            std::stringstream ss;
+            ss << file.rdbuf();
+            file.close();
+            const uint64_t frames = jsonNumber(ss.str(), "frames");
+            t.IsTrue(frames >= 10 && frames != ~0ull, "the fallback tick delivers the frames");
+            t.IsTrue(g_threadWakes.load(std::memory_order_relaxed) > 0, "the VBlank handler woke the waiter thread");
+            std::error_code ec;
+            std::filesystem::remove(reportPath, ec);
+        });
+
+        tc.Run("fast-forward clock scales the VBlank period", [](TestCase &t)
+        {
+            {
+                PS2Runtime runtime;
+                runtime.setHeadless({});
+                t.IsTrue(runtime.clockMode() == PS2Runtime::ClockMode::Unlimited, "headless runs default to the unlimited clock");
+                runtime.setClockMode(PS2Runtime::ClockMode::FastForward, 8.0);
+                t.IsTrue(runtime.clockMode() == PS2Runtime::ClockMode::FastForward, "fast-forward selected");
+                t.IsTrue(runtime.clockMultiplier() == 8.0, "multiplier kept");
+                runtime.setClockMode(PS2Runtime::ClockMode::FastForward, 0.0);
+                t.IsTrue(runtime.clockMode() == PS2Runtime::ClockMode::RealTime, "invalid multiplier falls back to real time");
+            }
+
+            const std::string fast = runWaiter(PS2Runtime::ClockMode::FastForward, 8.0, 24);
+            const std::string real = runWaiter(PS2Runtime::ClockMode::RealTime, 1.0, 6);
+            const double fastSeconds = jsonReal(fast, "seconds");
+            const double realSeconds = jsonReal(real, "seconds");
+            const uint64_t fastFrames = jsonNumber(fast, "frames");
+            const uint64_t realFrames = jsonNumber(real, "frames");
+            t.IsTrue(fastFrames >= 24 && fastFrames != ~0ull && realFrames >= 6 && realFrames != ~0ull, "both runs reach their frames");
+
+            // The timer cannot tick faster than its period, however loaded the host is.
+            t.IsTrue(static_cast<double>(fastFrames) <= fastSeconds * 8.0 / kVBlankSeconds + 1.0,
+                     "fast-forward still follows a clock (" + std::to_string(fastFrames) + " frames in " +
+                         std::to_string(fastSeconds) + "s)");
+            t.IsTrue(static_cast<double>(realFrames) <= realSeconds / kVBlankSeconds + 1.0, "real time follows the 60Hz clock");
+
+            // 8x nominally; only require a clear speedup per frame.
+            const double ratio = (fastSeconds / static_cast<double>(fastFrames)) / (realSeconds / static_cast<double>(realFrames));
+            t.IsTrue(ratio < 0.5, "fast-forward outruns real time (per-frame ratio " + std::to_string(ratio) + ")");
+        });
+    });
+}
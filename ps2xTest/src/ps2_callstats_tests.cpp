@@ -0,0 +1,137 @@
+#include "MiniTest.h"
+#include "ps2_benchmark.h"
+#include "ps2_callstats.h"
+#include "ps2_syscalls.h"
+
+#include <string>
+#include <thread>
+
+namespace
+{
+    using ps2_callstats::Id;
+
+    int g_handlerCalls = 0;
+
+    void countingHandler(uint8_t *, R5900Context *, PS2Runtime *)
+    {
+        ++g_handlerCalls;
+    }
+
+    // Leaves counting stopped and every counter zero.
+    class CallStatsScope
+    {
+    public:
+        CallStatsScope()
+        {
+            ps2_callstats::stop();
+            ps2_callstats::reset();
+        }
+
+        ~CallStatsScope()
+        {
+            ps2_callstats::stop();
+            ps2_callstats::reset();
+        }
+    };
+
+    bool contains(const std::string &text, const char *needle)
+    {
+        return text.find(needle) != std::string::npos;
+    }
+}
+
+void register_ps2_callstats_tests()
+{
+    MiniTest::Case("PS2CallStats", [](TestCase &tc)
+    {
+        tc.Run("nothing is counted while stopped", [](TestCase &t)
+        {
+            CallStatsScope scope;
+            {
+                PS2_CALL_STATS_SYSCALL(FlushCache);
+            }
+            ps2_callstats::counted<Id::Stub_ret0, &countingHandler>(nullptr, nullptr, nullptr);
+            t.IsTrue(ps2_callstats::snapshot().empty(), "no handlers");
+        });
+
+        tc.Run("per-thread counters merge into one histogram per handler", [](TestCase &t)
+        {
+            CallStatsScope scope;
+            t.IsTrue(ps2_callstats::start({}), "started");
+            t.IsFalse(ps2_callstats::start({}), "already counting");
+
+            std::thread fast([]()
+                             { ps2_callstats::record(Id::Stub_ret0, 100); });
+            std::thread slow([]()
+                             { ps2_callstats::record(Id::Stub_ret0, 3000); });
+            fast.join();
+            slow.join();
+            ps2_callstats::record(Id::Syscall_FlushCache, 1);
+
+            const auto stats = ps2_callstats::snapshot();
+            t.Equals(stats.size(), static_cast<size_t>(2), "two handlers called");
+            const auto &ret0 = stats[0];
+            t.Equals(ret0.name, std::string("ret0"), "most total time first");
+            t.IsTrue(ret0.kind == ps2_callstats::Kind::Stub, "stub list entry");
+            t.Equals(ret0.calls, static_cast<uint64_t>(2), "calls from both threads");
+            t.Equals(ret0.totalNs, static_cast<uint64_t>(3100), "total time");
+            t.Equals(ret0.maxNs, static_cast<uint64_t>(3000), "max time");
+            t.Equals(ret0.buckets[6], static_cast<uint64_t>(1), "100 ns in [64, 128)");
+            t.Equals(ret0.buckets[11], static_cast<uint64_t>(1), "3000 ns in [2048, 4096)");
+            t.Equals(ret0.percentileNs(0.5), static_cast<uint64_t>(128), "median bucket bound");
+            t.Equals(ret0.percentileNs(0.99), static_cast<uint64_t>(3000), "tail clamped to max");
+            t.Equals(stats[1].buckets[0], static_cast<uint64_t>(1), "under 2 ns");
+            t.IsTrue(stats[1].kind == ps2_callstats::Kind::Syscall, "syscall list entry");
+        });
+
+        tc.Run("counted wrapper calls the handler and counts it", [](TestCase &t)
+        {
+            CallStatsScope scope;
+            ps2_callstats::start({});
+            g_handlerCalls = 0;
+            auto *handler = &ps2_callstats::counted<Id::Syscall_FlushCache, &countingHandler>;
+            handler(nullptr, nullptr, nullptr);
+            handler(nullptr, nullptr, nullptr);
+
+            const auto stats = ps2_callstats::snapshot();
+            t.Equals(g_handlerCalls, 2, "handler ran");
+            t.Equals(stats.size(), static_cast<size_t>(1), "one handler");
+            t.Equals(stats[0].name, std::string("FlushCache"), "named from the syscall list");
+            t.Equals(stats[0].calls, static_cast<uint64_t>(2), "both calls counted");
+        });
+
+        tc.Run("numeric syscalls are counted by number", [](TestCase &t)
+        {
+            CallStatsScope scope;
+            t.IsTrue(ps2_callstats::numericSyscallId(0x3Cu) == ps2_callstats::numericSyscallId(static_cast<uint32_t>(-0x3C)),
+                     "interrupt form shares the slot");
+            t.Equals(ps2_callstats::name(ps2_callstats::numericSyscallId(0x3Cu)), std::string("syscall 0x3C"), "name");
+            t.Equals(ps2_callstats::name(ps2_callstats::numericSyscallId(0x1000u)), std::string("syscall 0xFF+"),
+                     "large numbers share the last slot");
+            t.IsTrue(ps2_callstats::kind(ps2_callstats::numericSyscallId(0u)) == ps2_callstats::Kind::NumericSyscall,
+                     "numeric kind");
+
+            ps2_callstats::start({});
+            R5900Context ctx;
+            t.IsFalse(ps2_syscalls::dispatchNumericSyscall(0x1000u, nullptr, &ctx, nullptr), "unknown syscall");
+            t.IsTrue(ps2_callstats::snapshot().empty(), "unhandled numbers are discarded");
+        });
+
+        tc.Run("headless report lists handler stats", [](TestCase &t)
+        {
+            CallStatsScope scope;
+            ps2_callstats::start({});
+            ps2_callstats::record(Id::Stub_ret0, 100);
+
+            ps2_benchmark::Report report;
+            report.calls = ps2_callstats::snapshot();
+            const std::string json = ps2_benchmark::toJson(report);
+            t.IsTrue(contains(json, "\"guest_exited\": false,\n  \"calls\": [\n"), "calls follow the totals");
+            t.IsTrue(contains(json, "{\"name\": \"ret0\", \"kind\": \"stub\", \"calls\": 1, \"total_ns\": 100"),
+                     "handler entry");
+            t.IsTrue(contains(json, "\"histogram\": [0, 0, 0, 0, 0, 0, 1]}"), "histogram up to the last used bucket");
+            t.IsFalse(contains(ps2_benchmark::toJson(ps2_benchmark::Report{}), "\"calls\""), "omitted when not counting");
+            t.IsTrue(contains(ps2_callstats::text(report.calls), "ret0"), "text table");
+        });
+    });
+}
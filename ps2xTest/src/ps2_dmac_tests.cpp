@@ -0,0 +1,147 @@
+#include "MiniTest.h"
+#include "ps2_memory.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t GIF_BASE = 0x1000A000;
+    constexpr uint32_t FROM_SPR_BASE = 0x1000D000;
+    constexpr uint32_t TO_SPR_BASE = 0x1000D400;
+    constexpr uint32_t D_STAT = 0x1000E010;
+    constexpr uint32_t D_SQWC = 0x1000E030;
+
+    void writeTag(uint8_t *rdram, uint32_t addr, uint32_t id, uint32_t qwc, uint32_t target)
+    {
+        const uint64_t tag = qwc | (static_cast<uint64_t>(id) << 28) | (static_cast<uint64_t>(target) << 32);
+        std::memcpy(rdram + addr, &tag, sizeof(tag));
+        std::memset(rdram + addr + 8, 0, 8);
+    }
+
+    // One qword whose first word identifies it in the received stream.
+    void writeMarker(uint8_t *mem, uint32_t addr, uint32_t marker)
+    {
+        std::memset(mem + addr, 0, 16);
+        std::memcpy(mem + addr, &marker, sizeof(marker));
+    }
+
+    std::vector<uint32_t> markersOf(const std::vector<uint8_t> &stream)
+    {
+        std::vector<uint32_t> markers;
+        for (size_t offset = 0; offset + 16 <= stream.size(); offset += 16)
+        {
+            uint32_t marker;
+            std::memcpy(&marker, stream.data() + offset, sizeof(marker));
+            markers.push_back(marker);
+        }
+        return markers;
+    }
+
+    std::unique_ptr<PS2Memory> makeMemory(std::vector<uint8_t> &stream, std::vector<uint32_t> &completed)
+    {
+        auto mem = std::make_unique<PS2Memory>();
+        mem->initialize();
+        mem->setDmaSink(GIF_BASE, [&stream](const uint8_t *data, uint32_t bytes)
+        {
+            stream.insert(stream.end(), data, data + bytes);
+        });
+        mem->setDmaCompletionHandler([&completed](uint32_t channelBase)
+        {
+            completed.push_back(channelBase);
+        });
+        return mem;
+    }
+}
+
+void register_ps2_dmac_tests()
+{
+    MiniTest::Case("PS2Dmac", [](TestCase &tc)
+    {
+        tc.Run("source chain follows cnt, next, call, ret and end", [](TestCase &t)
+        {
+            std::vector<uint8_t> stream;
+            std::vector<uint32_t> completed;
+            auto mem = makeMemory(stream, completed);
+            uint8_t *rdram = mem->getRDRAM();
+
+            writeTag(rdram, 0x1000, 1, 1, 0); // cnt
+            writeMarker(rdram, 0x1010, 0xA);
+            writeTag(rdram, 0x1020, 2, 1, 0x2000); // next
+            writeMarker(rdram, 0x1030, 0xB);
+            writeTag(rdram, 0x2000, 5, 1, 0x3000); // call
+            writeMarker(rdram, 0x2010, 0xC);
+            writeTag(rdram, 0x3000, 3, 1, 0x4000); // ref
+            writeMarker(rdram, 0x4000, 0xD);
+            writeTag(rdram, 0x3010, 6, 0, 0); // ret
+            writeTag(rdram, 0x2020, 7, 1, 0); // end
+            writeMarker(rdram, 0x2030, 0xE);
+
+            mem->writeIORegister(GIF_BASE + 0x20, 0);
+            mem->writeIORegister(GIF_BASE + 0x30, 0x1000);
+            mem->writeIORegister(GIF_BASE + 0x00, 0x185);
+
+            const std::vector<uint32_t> expected = {0xA, 0xB, 0xC, 0xD, 0xE};
+            t.IsTrue(markersOf(stream) == expected, "payloads arrive in chain order");
+            t.Equals(completed.size(), static_cast<size_t>(1), "one completion");
+            t.Equals(completed.empty() ? 0u : completed[0], GIF_BASE, "completion names the GIF channel");
+            t.Equals(mem->readIORegister(GIF_BASE) & 0x130u, 0u, "STR cleared and call stack empty");
+            t.Equals(mem->readIORegister(D_STAT) & 0x4u, 0x4u, "CIS2 set");
+
+            mem->writeIORegister(D_STAT, 0x4);
+            t.Equals(mem->readIORegister(D_STAT) & 0x4u, 0u, "writing 1 clears CIS2");
+        });
+
+        tc.Run("scratchpad channels copy normal and interleaved transfers", [](TestCase &t)
+        {
+            std::vector<uint8_t> stream;
+            std::vector<uint32_t> completed;
+            auto mem = makeMemory(stream, completed);
+            uint8_t *rdram = mem->getRDRAM();
+            uint8_t *spr = mem->getScratchpad();
+
+            writeMarker(rdram, 0x5000, 0x11);
+            writeMarker(rdram, 0x5010, 0x22);
+            mem->writeIORegister(TO_SPR_BASE + 0x10, 0x5000);
+            mem->writeIORegister(TO_SPR_BASE + 0x20, 2);
+            mem->writeIORegister(TO_SPR_BASE + 0x80, 0x100);
+            mem->writeIORegister(TO_SPR_BASE + 0x00, 0x100);
+            t.IsTrue(std::memcmp(spr + 0x100, rdram + 0x5000, 32) == 0, "toSPR copies into the scratchpad");
+
+            // Two qwords from SPR, one at a time, skipping one qword in RAM between them.
+            mem->writeIORegister(D_SQWC, (1u << 16) | 1u);
+            mem->writeIORegister(FROM_SPR_BASE + 0x10, 0x6000);
+            mem->writeIORegister(FROM_SPR_BASE + 0x20, 2);
+            mem->writeIORegister(FROM_SPR_BASE + 0x80, 0x100);
+            mem->writeIORegister(FROM_SPR_BASE + 0x00, 0x108);
+            t.IsTrue(std::memcmp(rdram + 0x6000, spr + 0x100, 16) == 0, "first slice lands at MADR");
+            t.IsTrue(std::memcmp(rdram + 0x6020, spr + 0x110, 16) == 0, "second slice lands after the skip");
+            t.Equals(completed.size(), static_cast<size_t>(2), "both channels complete");
+        });
+
+        tc.Run("frame budget defers completion to advanceDma", [](TestCase &t)
+        {
+            std::vector<uint8_t> stream;
+            std::vector<uint32_t> completed;
+            auto mem = makeMemory(stream, completed);
+            uint8_t *rdram = mem->getRDRAM();
+            for (uint32_t i = 0; i < 3; ++i)
+                writeMarker(rdram, 0x7000 + i * 16, i + 1);
+
+            mem->setDmaBudget(1);
+            mem->writeIORegister(GIF_BASE + 0x10, 0x7000);
+            mem->writeIORegister(GIF_BASE + 0x20, 3);
+            mem->writeIORegister(GIF_BASE + 0x00, 0x101);
+            t.IsTrue(completed.empty(), "not finished within the first frame");
+            t.Equals(mem->readIORegister(GIF_BASE) & 0x100u, 0x100u, "STR stays set while deferred");
+
+            mem->advanceDma();
+            mem->advanceDma();
+            const std::vector<uint32_t> expected = {1, 2, 3};
+            t.IsTrue(markersOf(stream) == expected, "all qwords delivered in order");
+            t.Equals(completed.size(), static_cast<size_t>(1), "completion after the last frame");
+            t.Equals(mem->readIORegister(GIF_BASE + 0x20), 0u, "QWC drained");
+        });
+    });
+}
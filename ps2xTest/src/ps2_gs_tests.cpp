@@ -0,0 +1,522 @@
+#include "MiniTest.h"
+#include "ps2_gif.h"
+#include "ps2_gs_display.h"
+#include "ps2_gs_raster.h"
+#include "ps2_gs_swizzle.h"
+#include "ps2_memory.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace ps2_gs_swizzle;
+
+namespace
+{
+    std::vector<uint8_t> makePattern(size_t bytes, uint32_t seed)
+    {
+        std::vector<uint8_t> data(bytes);
+        uint32_t state = seed;
+        for (uint8_t &value : data)
+        {
+            state = state * 1664525u + 1013904223u;
+            value = static_cast<uint8_t>(state >> 24);
+        }
+        return data;
+    }
+
+    void putQword(std::vector<uint8_t> &out, uint64_t lo, uint64_t hi)
+    {
+        const size_t at = out.size();
+        out.resize(at + 16);
+        std::memcpy(out.data() + at, &lo, 8);
+        std::memcpy(out.data() + at + 8, &hi, 8);
+    }
+
+    uint64_t gifTag(uint32_t nloop, bool eop, uint32_t flg, uint32_t nreg)
+    {
+        return nloop | (eop ? 0x8000ull : 0ull) | (static_cast<uint64_t>(flg) << 58) |
+               (static_cast<uint64_t>(nreg) << 60);
+    }
+
+    // 640x448 PSMCT32 frame at block 0 with a PSMZ32 buffer right after it.
+    ps2_gs_raster::DrawState frameState()
+    {
+        ps2_gs_raster::DrawState s{};
+        s.fbw = 10;
+        s.fpsm = PSMCT32;
+        s.zbp = 140 * 32;
+        s.zpsm = PSMZ32;
+        s.zmsk = 1;
+        s.scax1 = 639;
+        s.scay1 = 447;
+        return s;
+    }
+
+    ps2_gs_raster::Vertex vertex(float x, float y, uint32_t z, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    {
+        ps2_gs_raster::Vertex v;
+        v.x = static_cast<int32_t>(x * 16.0f);
+        v.y = static_cast<int32_t>(y * 16.0f);
+        v.z = z;
+        v.r = r;
+        v.g = g;
+        v.b = b;
+        v.a = a;
+        return v;
+    }
+}
+
+void register_ps2_gs_tests()
+{
+    MiniTest::Case("PS2Gs", [](TestCase &tc)
+    {
+        tc.Run("PSMCT32 pixels land on GS column and block addresses", [](TestCase &t)
+        {
+            std::vector<uint8_t> vram(PS2_GS_VRAM_SIZE, 0);
+            auto wordOf = [&](uint32_t x, uint32_t y) -> int
+            {
+                writePixel(vram.data(), PSMCT32, 0, 10, x, y, 0xA5A5A5A5u);
+                for (uint32_t word = 0; word < PS2_GS_VRAM_SIZE / 4u; ++word)
+                {
+                    uint32_t value;
+                    std::memcpy(&value, vram.data() + word * 4u, sizeof(value));
+                    if (value != 0)
+                    {
+                        std::memset(vram.data() + word * 4u, 0, sizeof(value));
+                        return static_cast<int>(word);
+                    }
+                }
+                return -1;
+            };
+
+            t.Equals(wordOf(1, 0), 1, "(1,0) is the second word of the first column");
+            t.Equals(wordOf(2, 0), 4, "(2,0) skips the pair stored for row 1");
+            t.Equals(wordOf(0, 1), 2, "(0,1) shares the first column with row 0");
+            t.Equals(wordOf(0, 2), 16, "row 2 starts the second column");
+            t.Equals(wordOf(8, 0), 64, "(8,0) is in block 1");
+            t.Equals(wordOf(0, 8), 128, "(0,8) is in block 2");
+            t.Equals(wordOf(64, 0), 32 * 64, "(64,0) starts the second page");
+            t.Equals(wordOf(0, 32), 10 * 32 * 64, "(0,32) starts the next page row for bw=10");
+        });
+
+        tc.Run("block kernels match per-pixel addressing for every format", [](TestCase &t)
+        {
+            const uint32_t formats[] = {PSMCT32, PSMCT24, PSMCT16, PSMCT16S, PSMT8, PSMT4};
+            for (uint32_t psm : formats)
+            {
+                // Unaligned origin and size exercise both the block interior and the edges.
+                const uint32_t x = 6, y = 3, w = 150, h = 71, bw = 4, bp = 96;
+                const size_t pitch = rowBytes(psm, w);
+                const std::vector<uint8_t> image = makePattern(pitch * h, psm + 1u);
+
+                std::vector<uint8_t> fast(PS2_GS_VRAM_SIZE, 0);
+                writeImage(fast.data(), psm, bp, bw, x, y, w, h, image.data(), pitch);
+
+                std::vector<uint8_t> reference(PS2_GS_VRAM_SIZE, 0);
+                for (uint32_t row = 0; row < h; ++row)
+                {
+                    for (uint32_t col = 0; col < w; ++col)
+                    {
+                        const uint8_t *line = image.data() + row * pitch;
+                        uint32_t value = 0;
+                        switch (psm)
+                        {
+                        case PSMCT32: std::memcpy(&value, line + col * 4u, 4); break;
+                        case PSMCT24: std::memcpy(&value, line + col * 3u, 3); break;
+                        case PSMCT16:
+                        case PSMCT16S: std::memcpy(&value, line + col * 2u, 2); break;
+                        case PSMT8: value = line[col]; break;
+                        default: value = (line[col >> 1] >> ((col & 1u) * 4u)) & 0xFu; break;
+                        }
+                        writePixel(reference.data(), psm, bp, bw, x + col, y + row, value);
+                    }
+                }
+                t.IsTrue(fast == reference, "psm " + std::to_string(psm) + " block writes match pixel writes");
+
+                std::vector<uint8_t> readBack(image.size(), 0);
+                readImage(fast.data(), psm, bp, bw, x, y, w, h, readBack.data(), pitch);
+                t.IsTrue(readBack == image, "psm " + std::to_string(psm) + " round-trips through VRAM");
+            }
+        });
+
+        tc.Run("PSMCT24 uploads keep the VRAM alpha byte", [](TestCase &t)
+        {
+            std::vector<uint8_t> vram(PS2_GS_VRAM_SIZE, 0);
+            const std::vector<uint8_t> opaque(64u * 16u * 4u, 0xFF);
+            writeImage(vram.data(), PSMCT32, 0, 1, 0, 0, 64, 16, opaque.data(), 64u * 4u);
+
+            const std::vector<uint8_t> rgb = makePattern(64u * 16u * 3u, 7);
+            writeImage(vram.data(), PSMCT24, 0, 1, 0, 0, 64, 16, rgb.data(), 64u * 3u);
+
+            bool alphaKept = true;
+            bool colorWritten = true;
+            for (uint32_t y = 0; y < 16; ++y)
+            {
+                for (uint32_t x = 0; x < 64; ++x)
+                {
+                    const uint32_t value = readPixel(vram.data(), PSMCT32, 0, 1, x, y);
+                    const uint8_t *src = rgb.data() + (y * 64u + x) * 3u;
+                    alphaKept &= (value >> 24) == 0xFFu;
+                    colorWritten &= (value & 0xFFFFFFu) ==
+                                    (static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+                                     (static_cast<uint32_t>(src[2]) << 16));
+                }
+            }
+            t.IsTrue(alphaKept, "upper byte should survive a 24-bit upload");
+            t.IsTrue(colorWritten, "RGB should come from the 24-bit stream");
+        });
+
+        tc.Run("display converts 16-bit pixels with the GS bit layout", [](TestCase &t)
+        {
+            std::vector<uint16_t> src(19);
+            for (size_t i = 0; i < src.size(); ++i)
+                src[i] = static_cast<uint16_t>(i * 0x0DB7u + 0x8421u * (i & 1u));
+            std::vector<uint32_t> out(src.size());
+            ps2_gs_display::convertCT16(src.data(), out.data(), src.size());
+
+            bool matches = true;
+            for (size_t i = 0; i < src.size(); ++i)
+            {
+                const uint32_t p = src[i];
+                const uint32_t r = (p & 0x1Fu) << 3, g = ((p >> 5) & 0x1Fu) << 3, b = ((p >> 10) & 0x1Fu) << 3;
+                const uint32_t a = (p & 0x8000u) ? 0x80u : 0u;
+                matches &= out[i] == (r | (g << 8) | (b << 16) | (a << 24));
+            }
+            t.IsTrue(matches, "vector and tail pixels expand 5 bits per channel and map STP to 0x80");
+        });
+
+        tc.Run("display blends circuits by pixel alpha or ALP", [](TestCase &t)
+        {
+            const std::vector<uint32_t> rc1(6, 0x80FF0000u); // alpha 1.0, blue
+            const std::vector<uint32_t> rc2(6, 0x000000FFu); // red
+            std::vector<uint32_t> out(6);
+
+            ps2_gs_display::blendRow(rc1.data(), rc2.data(), out.data(), out.size(), false, 0);
+            t.IsTrue(std::all_of(out.begin(), out.end(), [](uint32_t v) { return (v & 0xFFFFFFu) == 0xFF0000u; }),
+                     "rc1 alpha 0x80 selects circuit 1 only");
+
+            ps2_gs_display::blendRow(rc1.data(), rc2.data(), out.data(), out.size(), true, 0x80);
+            t.IsTrue(std::all_of(out.begin(), out.end(), [](uint32_t v) { return (v & 0xFFFFFFu) == 0x80007Fu; }),
+                     "ALP 0x80 mixes both circuits about evenly");
+        });
+
+        tc.Run("display composes a 16-bit circuit 1 framebuffer", [](TestCase &t)
+        {
+            std::vector<uint8_t> vram(PS2_GS_VRAM_SIZE, 0);
+            constexpr uint32_t width = 64, height = 32;
+            std::vector<uint16_t> image(width * height);
+            for (uint32_t i = 0; i < image.size(); ++i)
+                image[i] = static_cast<uint16_t>(i * 37u);
+            const uint32_t fbp = 3;
+            writeImage(vram.data(), PSMCT16, fbp * 32u, 1, 0, 0, width, height,
+                       reinterpret_cast<const uint8_t *>(image.data()), width * 2u);
+
+            GSRegisters gs{};
+            gs.pmode = 0x1; // EN1
+            gs.dispfb1 = fbp | (1ull << 9) | (static_cast<uint64_t>(PSMCT16) << 15);
+            gs.display1 = (static_cast<uint64_t>(width - 1) << 32) | (static_cast<uint64_t>(height - 1) << 44);
+
+            ps2_gs_display::Scratch scratch;
+            std::vector<uint32_t> frame(80 * 40);
+            t.IsTrue(ps2_gs_display::compose(vram.data(), gs, frame.data(), 80, 40, scratch), "PSMCT16 is displayable");
+
+            std::vector<uint32_t> expected(image.size());
+            ps2_gs_display::convertCT16(image.data(), expected.data(), image.size());
+            bool inside = true;
+            for (uint32_t y = 0; y < height; ++y)
+                for (uint32_t x = 0; x < width; ++x)
+                    inside &= frame[y * 80 + x] == (expected[y * width + x] | 0xFF000000u);
+            t.IsTrue(inside, "display area shows the converted framebuffer");
+            t.Equals(frame[79], 0xFF000000u, "outside the display area is opaque black");
+
+            gs.dispfb1 = fbp | (1ull << 9) | (0x30ull << 15); // PSMZ32
+            t.IsFalse(ps2_gs_display::compose(vram.data(), gs, frame.data(), 80, 40, scratch), "Z formats are reported");
+        });
+
+        tc.Run("GIF PACKED and REGLIST tags decode to register writes", [](TestCase &t)
+        {
+            std::vector<uint8_t> packet;
+            // PACKED, PRE with PRIM=6 (sprite), regs ST, RGBAQ, XYZ2, A+D.
+            putQword(packet, gifTag(1, false, 0, 4) | (1ull << 46) | (6ull << 47), 0xE512u);
+            putQword(packet, 0x3F0000003E800000ull, 0x40000000u);                    // S, T, Q=2.0
+            putQword(packet, 0x0000002000000010ull, 0x0000008000000030ull);          // R,G,B,A
+            putQword(packet, 0x0000020000000100ull, (1ull << 47) | 0x1234u);         // X,Y,Z with ADC
+            putQword(packet, 0x0000000000000007ull, ps2_gif::FRAME_1);               // A+D
+            // REGLIST, regs PRIM, UV, XYZ2: three values plus padding.
+            putQword(packet, gifTag(1, true, 1, 3), 0x530u);
+            putQword(packet, 0x3u, 0x00200010u);
+            putQword(packet, 0x0000020000000100ull, 0);
+
+            ps2_gif::Parser parser;
+            ps2_gif::CommandStream stream;
+            // Split mid-packet to exercise the streaming state.
+            parser.feed(packet.data(), 48, stream);
+            parser.feed(packet.data() + 48, packet.size() - 48, stream);
+
+            const std::vector<uint8_t> regs = {ps2_gif::PRIM, ps2_gif::ST, ps2_gif::RGBAQ, ps2_gif::XYZ3,
+                                               ps2_gif::FRAME_1, ps2_gif::PRIM, ps2_gif::UV, ps2_gif::XYZ2};
+            t.IsTrue(stream.reg == regs, "register sequence");
+            if (stream.reg == regs)
+            {
+                t.Equals(stream.value[0], 6ull, "PRE emits PRIM");
+                t.Equals(stream.value[2], 0x4000000080302010ull, "RGBAQ packs channels and the ST Q");
+                t.Equals(stream.value[3], 0x0000123402000100ull, "XYZ packs X, Y and Z");
+                t.Equals(stream.value[4], 7ull, "A+D passes data through");
+                t.Equals(stream.value[6], 0x00200010ull, "REGLIST values are raw");
+            }
+            t.IsTrue(parser.idle(), "EOP packet fully consumed");
+        });
+
+        tc.Run("GIF DMA image transfers land in VRAM through the GS pipeline", [](TestCase &t)
+        {
+            PS2Memory mem;
+            t.IsTrue(mem.initialize(), "memory initializes");
+            constexpr uint32_t w = 24, h = 5; // 120 pixels, 30 qwords
+            const std::vector<uint8_t> image = makePattern(w * h * 4u, 11);
+
+            std::vector<uint8_t> packet;
+            putQword(packet, gifTag(4, false, 0, 1), 0xEu);
+            putQword(packet, (64ull << 32) | (2ull << 48), ps2_gif::BITBLTBUF); // DBP 64, DBW 2, PSMCT32
+            putQword(packet, (3ull << 32) | (7ull << 48), ps2_gif::TRXPOS);
+            putQword(packet, w | (static_cast<uint64_t>(h) << 32), ps2_gif::TRXREG);
+            putQword(packet, 0, ps2_gif::TRXDIR);
+            putQword(packet, gifTag(static_cast<uint32_t>(image.size() / 16), true, 2, 0), 0);
+            packet.insert(packet.end(), image.begin(), image.end());
+
+            // Deliver it the way a two-packet DMA chain would, split inside the image.
+            const size_t split = 6 * 16 + 13 * 16;
+            mem.submitGifPacket(3, packet.data(), static_cast<uint32_t>(split));
+            mem.submitGifPacket(3, packet.data() + split, static_cast<uint32_t>(packet.size() - split));
+            mem.flushGs();
+
+            std::vector<uint8_t> readBack(image.size());
+            readImage(mem.getGSVRAM(), PSMCT32, 64, 2, 3, 7, w, h, readBack.data(), w * 4u);
+            t.IsTrue(readBack == image, "image matches after swizzled upload");
+        });
+
+        tc.Run("SIGNAL, FINISH and LABEL raise CSR events the EE acknowledges", [](TestCase &t)
+        {
+            PS2Memory mem;
+            t.IsTrue(mem.initialize(), "memory initializes");
+            constexpr uint32_t kCsr = PS2_GS_PRIV_REG_BASE + 0x1000;
+            constexpr uint32_t kSiglblid = PS2_GS_PRIV_REG_BASE + 0x1080;
+            mem.write64(kSiglblid, 0xAAAA0000BBBB0000ull);
+
+            std::vector<uint8_t> packet;
+            putQword(packet, gifTag(3, true, 0, 1), 0xEu);
+            putQword(packet, 0x0000FFFF00001234ull, ps2_gif::SIGNAL); // ID 0x1234 under mask 0xFFFF
+            putQword(packet, 0x0000FFFF00005678ull, ps2_gif::LABEL);
+            putQword(packet, 0, ps2_gif::FINISH);
+            mem.submitGifPacket(3, packet.data(), static_cast<uint32_t>(packet.size()));
+            mem.flushGs();
+
+            t.Equals(mem.read64(kCsr) & kGsCsrEventBits, uint64_t{0x3}, "SIGNAL and FINISH raised");
+            t.Equals(mem.read64(kSiglblid), 0xAAAA5678BBBB1234ull, "IDs merged under their masks");
+
+            mem.write32(kCsr, 0x2u);
+            t.Equals(mem.read64(kCsr) & kGsCsrEventBits, uint64_t{0x1}, "acknowledging FINISH keeps SIGNAL");
+            mem.write32(kCsr, 0x1u);
+            t.Equals(mem.read64(kCsr) & kGsCsrEventBits, uint64_t{0}, "SIGNAL acknowledged");
+        });
+
+        tc.Run("GIF sprites rasterize into the frame buffer within the scissor", [](TestCase &t)
+        {
+            PS2Memory mem;
+            t.IsTrue(mem.initialize(), "memory initializes");
+
+            std::vector<uint8_t> packet;
+            putQword(packet, gifTag(9, true, 0, 1), 0xEu);
+            putQword(packet, 10ull << 16, ps2_gif::FRAME_1);                     // FBP 0, FBW 10, PSMCT32
+            putQword(packet, 99ull << 16 | 99ull << 48, ps2_gif::SCISSOR_1);     // 0..99 x 0..99
+            putQword(packet, 0, ps2_gif::TEST_1);
+            putQword(packet, 0, ps2_gif::XYOFFSET_1);
+            putQword(packet, 1, ps2_gif::PRMODECONT);
+            putQword(packet, 6, ps2_gif::PRIM);                                  // sprite
+            putQword(packet, 0x80204080u, ps2_gif::RGBAQ);
+            putQword(packet, (10u * 16u) | ((20u * 16u) << 16), ps2_gif::XYZ2);
+            putQword(packet, (150u * 16u) | ((30u * 16u) << 16), ps2_gif::XYZ2); // right edge past the scissor
+            mem.submitGifPacket(3, packet.data(), static_cast<uint32_t>(packet.size()));
+            mem.flushGs();
+
+            const uint8_t *vram = mem.getGSVRAM();
+            t.Equals(readPixel(vram, PSMCT32, 0, 10, 10, 20), 0x80204080u, "top-left pixel drawn");
+            t.Equals(readPixel(vram, PSMCT32, 0, 10, 99, 29), 0x80204080u, "last pixel inside the scissor drawn");
+            t.Equals(readPixel(vram, PSMCT32, 0, 10, 100, 25), 0u, "scissor clips the right edge");
+            t.Equals(readPixel(vram, PSMCT32, 0, 10, 9, 25), 0u, "nothing left of X0");
+            t.Equals(readPixel(vram, PSMCT32, 0, 10, 50, 30), 0u, "Y1 is exclusive");
+        });
+
+        tc.Run("triangles sharing an edge cover each pixel once", [](TestCase &t)
+        {
+            std::vector<uint8_t> vram(PS2_GS_VRAM_SIZE, 0);
+            ps2_gs_raster::Rasterizer raster(1);
+            raster.setVram(vram.data());
+
+            // Additive blend: Cs * FIX(1.0) + Cd, so overlap would show as 20.
+            ps2_gs_raster::DrawState s = frameState();
+            s.abe = 1;
+            s.blendA = 0;
+            s.blendB = 2;
+            s.blendC = 2;
+            s.blendD = 1;
+            s.fix = 0x80;
+            const ps2_gs_raster::Vertex quad[4] = {
+                vertex(3.5f, 2.25f, 0, 10, 0, 0, 0x80), vertex(60.75f, 5.5f, 0, 10, 0, 0, 0x80),
+                vertex(55.125f, 40.875f, 0, 10, 0, 0, 0x80), vertex(7.3125f, 37.625f, 0, 10, 0, 0, 0x80)};
+            const ps2_gs_raster::Vertex first[3] = {quad[0], quad[1], quad[2]};
+            const ps2_gs_raster::Vertex second[3] = {quad[0], quad[3], quad[2]}; // clockwise on purpose
+            raster.draw(ps2_gs_raster::PrimKind::Triangle, first, s);
+            raster.draw(ps2_gs_raster::PrimKind::Triangle, second, s);
+            raster.flush();
+
+            uint32_t covered = 0;
+            bool onlyOnce = true;
+            for (uint32_t y = 0; y < 48; ++y)
+            {
+                for (uint32_t x = 0; x < 70; ++x)
+                {
+                    const uint32_t red = readPixel(vram.data(), PSMCT32, 0, 10, x, y) & 0xFFu;
+                    covered += red == 10;
+                    onlyOnce = onlyOnce && (red == 0 || red == 10);
+                }
+            }
+            t.IsTrue(onlyOnce, "no pixel blended twice along the diagonal");
+            t.IsTrue(covered > 1700 && covered < 2000, "quad interior covered");
+            t.Equals(readPixel(vram.data(), PSMCT32, 0, 10, 30, 20) & 0xFFu, 10u, "centre pixel drawn");
+        });
+
+        tc.Run("depth test keeps the nearer sprite", [](TestCase &t)
+        {
+            std::vector<uint8_t> vram(PS2_GS_VRAM_SIZE, 0);
+            ps2_gs_raster::Rasterizer raster(1);
+            raster.setVram(vram.data());
+
+            ps2_gs_raster::DrawState s = frameState();
+            s.zmsk = 0;
+            s.zte = 1;
+            s.ztst = 2; // GEQUAL
+            const ps2_gs_raster::Vertex red[2] = {vertex(0, 0, 100, 255, 0, 0, 0x80), vertex(32, 32, 100, 255, 0, 0, 0x80)};
+            const ps2_gs_raster::Vertex green[2] = {vertex(8, 8, 50, 0, 255, 0, 0x80), vertex(24, 24, 50, 0, 255, 0, 0x80)};
+            const ps2_gs_raster::Vertex blue[2] = {vertex(16, 16, 200, 0, 0, 255, 0x80), vertex(40, 40, 200, 0, 0, 255, 0x80)};
+            raster.draw(ps2_gs_raster::PrimKind::Sprite, red, s);
+            raster.draw(ps2_gs_raster::PrimKind::Sprite, green, s);
+            raster.draw(ps2_gs_raster::PrimKind::Sprite, blue, s);
+            raster.flush();
+
+            t.Equals(readPixel(vram.data(), PSMCT32, 0, 10, 10, 10), 0x800000FFu, "farther sprite rejected");
+            t.Equals(readPixel(vram.data(), PSMCT32, 0, 10, 20, 20), 0x80FF0000u, "nearer sprite drawn");
+            t.Equals(readPixel(vram.data(), PSMZ32, s.zbp, 10, 20, 20), 200u, "depth written");
+            t.Equals(readPixel(vram.data(), PSMZ32, s.zbp, 10, 10, 10), 100u, "rejected pixel keeps depth");
+        });
+
+        tc.Run("threaded tiles match a single-threaded draw", [](TestCase &t)
+        {
+            // Gouraud, textured, depth-tested and blended triangles spread over
+            // many tiles, drawn once inline and once on a worker pool.
+            std::vector<uint8_t> reference(PS2_GS_VRAM_SIZE, 0);
+            const std::vector<uint8_t> texture = makePattern(64 * 64 * 4, 5);
+            writeImage(reference.data(), PSMCT32, 9000, 1, 0, 0, 64, 64, texture.data(), 64 * 4);
+            std::vector<uint8_t> threaded = reference;
+
+            ps2_gs_raster::DrawState s = frameState();
+            s.zmsk = 0;
+            s.zte = 1;
+            s.ztst = 3; // GREATER
+            s.abe = 1;
+            s.blendA = 0;
+            s.blendB = 1;
+            s.blendC = 0;
+            s.blendD = 1;
+            s.iip = 1;
+            ps2_gs_raster::DrawState textured = s;
+            textured.tme = 1;
+            textured.fst = 1;
+            textured.tbp = 9000;
+            textured.tbw = 1;
+            textured.tpsm = PSMCT32;
+            textured.tw = 6;
+            textured.th = 6;
+            textured.tcc = 1;
+
+            const std::vector<uint8_t> random = makePattern(400 * 16, 77);
+            auto drawAll = [&](std::vector<uint8_t> &vram, unsigned threads)
+            {
+                ps2_gs_raster::Rasterizer raster(threads);
+                raster.setVram(vram.data());
+                for (size_t i = 0; i < 400; ++i)
+                {
+                    const uint8_t *r = random.data() + i * 16;
+                    ps2_gs_raster::Vertex v[3];
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        v[k] = vertex(r[k * 2] * 2.5f + (r[15] & 15) / 16.0f, r[k * 2 + 1] * 1.75f,
+                                      r[6 + k] * 1000u, r[9 + k], r[12 + k], r[k * 3], r[7 + k] >> 1);
+                        v[k].u = r[k * 4] / 2.0f;
+                        v[k].v = r[k * 4 + 1] / 2.0f;
+                    }
+                    raster.draw(ps2_gs_raster::PrimKind::Triangle, v, (i & 1) ? textured : s);
+                }
+                raster.flush();
+            };
+            drawAll(reference, 1);
+            drawAll(threaded, 4);
+
+            t.IsTrue(std::any_of(reference.begin(), reference.begin() + 640 * 448 * 4, [](uint8_t b) { return b != 0; }),
+                     "scene draws something");
+            t.IsTrue(reference == threaded, "VRAM identical with 1 and 4 threads");
+        });
+
+        tc.Run("triple buffer hands the consumer the newest frame", [](TestCase &t)
+        {
+            ps2_gs_display::TripleBuffer frames;
+            frames.resize(2, 1);
+            t.IsFalse(frames.acquire(), "nothing published yet");
+
+            frames.back()[0] = 1;
+            frames.publish();
+            frames.back()[0] = 2;
+            frames.publish();
+            t.IsTrue(frames.acquire(), "a published frame is waiting");
+            t.Equals(frames.front()[0], 2u, "the older frame was dropped");
+            t.IsFalse(frames.acquire(), "each frame is handed over once");
+
+            frames.back()[0] = 3;
+            frames.publish();
+            t.Equals(frames.front()[0], 2u, "publishing leaves the consumer's frame alone");
+            t.IsTrue(frames.acquire(), "next frame waiting");
+            t.Equals(frames.front()[0], 3u, "newest frame acquired");
+            t.Equals(frames.published(), uint64_t{3}, "publish count");
+        });
+
+        tc.Run("DISPFB writes publish the frame after queued GS work", [](TestCase &t)
+        {
+            PS2Memory mem;
+            t.IsTrue(mem.initialize(), "memory initializes");
+            mem.enableFrameOutput(64, 32);
+
+            std::vector<uint8_t> packet;
+            putQword(packet, gifTag(7, true, 0, 1), 0xEu);
+            putQword(packet, 1ull << 16, ps2_gif::FRAME_1);                      // FBP 0, FBW 1, PSMCT32
+            putQword(packet, 63ull << 16 | 31ull << 48, ps2_gif::SCISSOR_1);
+            putQword(packet, 0, ps2_gif::TEST_1);
+            putQword(packet, 6, ps2_gif::PRIM);                                  // sprite
+            putQword(packet, 0x80204080u, ps2_gif::RGBAQ);
+            putQword(packet, 0, ps2_gif::XYZ2);
+            putQword(packet, (64u * 16u) | ((32u * 16u) << 16), ps2_gif::XYZ2);
+            mem.submitGifPacket(3, packet.data(), static_cast<uint32_t>(packet.size()));
+
+            mem.write64(PS2_GS_PRIV_REG_BASE + 0x00, 1);                         // PMODE: EN1
+            mem.write64(PS2_GS_PRIV_REG_BASE + 0x80, (63ull << 32) | (31ull << 44)); // DISPLAY1 64x32
+            t.Equals(mem.frames().published(), uint64_t{0}, "only a flip publishes");
+            mem.write64(PS2_GS_PRIV_REG_BASE + 0x70, 1ull << 9);                 // DISPFB1: FBP 0, FBW 1
+            mem.flushGs();
+
+            t.Equals(mem.frames().published(), uint64_t{1}, "DISPFB write published a frame");
+            t.IsTrue(mem.frames().acquire(), "frame handed to the consumer");
+            t.Equals(mem.frames().front()[5 * 64 + 5], 0xFF204080u, "frame shows the sprite drawn before the flip");
+            t.Equals(mem.frames().front()[31 * 64 + 63], 0xFF204080u, "whole display area composed");
+        });
+    });
+}
@@ -0,0 +1,136 @@
+#include "MiniTest.h"
+#include "ps2_log.h"
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Captured
+    {
+        ps2_log::Level level;
+        ps2_log::Category category;
+        std::string text;
+    };
+
+    // Routes log output into a vector for the lifetime of the object.
+    class CaptureSink
+    {
+    public:
+        CaptureSink()
+        {
+            ps2_log::flush();
+            ps2_log::setSink([this](ps2_log::Level level, ps2_log::Category category, std::string_view text)
+                             {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_lines.push_back({level, category, std::string(text)}); });
+        }
+
+        ~CaptureSink()
+        {
+            ps2_log::flush();
+            ps2_log::setSink({});
+            ps2_log::setLevel(ps2_log::Level::Info);
+        }
+
+        std::vector<Captured> lines()
+        {
+            ps2_log::flush();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_lines;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<Captured> m_lines;
+    };
+
+    void logFromOneSite(int i)
+    {
+        PS2_LOG_RATE(ps2_log::Level::Warn, ps2_log::Category::Io, 3, "burst " << i);
+    }
+}
+
+void register_ps2_log_tests()
+{
+    MiniTest::Case("PS2Log", [](TestCase &tc)
+    {
+        tc.Run("levels filter per category", [](TestCase &t)
+        {
+            ps2_log::setLevel(ps2_log::Level::Warn);
+            ps2_log::setLevel(ps2_log::Category::Io, ps2_log::Level::Debug);
+            t.IsFalse(ps2_log::enabled(ps2_log::Level::Info, ps2_log::Category::VBlank), "info hidden at warn");
+            t.IsTrue(ps2_log::enabled(ps2_log::Level::Error, ps2_log::Category::VBlank), "errors shown");
+            t.IsTrue(ps2_log::enabled(ps2_log::Level::Debug, ps2_log::Category::Io), "category override");
+
+            t.IsTrue(ps2_log::configure("info, vblank=trace"), "spec accepted");
+            t.IsTrue(ps2_log::enabled(ps2_log::Level::Trace, ps2_log::Category::VBlank), "vblank traced");
+            t.IsFalse(ps2_log::enabled(ps2_log::Level::Debug, ps2_log::Category::Io), "global level reset io");
+            t.IsFalse(ps2_log::configure("loud,gpu=debug"), "unknown level and category reported");
+            ps2_log::setLevel(ps2_log::Level::Info);
+        });
+
+        tc.Run("each call site is rate limited on its own", [](TestCase &t)
+        {
+            CaptureSink sink;
+            for (int i = 0; i < 10; ++i)
+                logFromOneSite(i);
+            PS2_LOG_WARN(Io, "other site");
+            PS2_LOG_DEBUG(Io, "below the threshold");
+
+            const std::vector<Captured> lines = sink.lines();
+            t.Equals(lines.size(), size_t{4}, "three from the limited site plus one from another");
+            if (lines.size() == 4)
+            {
+                t.Equals(lines[0].text, std::string("burst 0"), "first message kept");
+                t.Equals(lines[2].text, std::string("burst 2"), "burst allowance");
+                t.Equals(lines[3].text, std::string("other site"), "other call site unaffected");
+                t.IsTrue(lines[3].level == ps2_log::Level::Warn && lines[3].category == ps2_log::Category::Io, "level and category kept");
+            }
+        });
+
+        tc.Run("messages from many threads all arrive in per-thread order", [](TestCase &t)
+        {
+            CaptureSink sink;
+            constexpr int kThreads = 4;
+            constexpr int kPerThread = 500;
+            std::vector<std::thread> threads;
+            for (int id = 0; id < kThreads; ++id)
+            {
+                threads.emplace_back([id]()
+                                     {
+                    for (int i = 0; i < kPerThread; ++i)
+                        ps2_log::write(ps2_log::Level::Info, ps2_log::Category::Runtime,
+                                       std::to_string(id) + ":" + std::to_string(i)); });
+            }
+            for (auto &thread : threads)
+                thread.join();
+
+            const std::vector<Captured> lines = sink.lines();
+            t.Equals(lines.size() + ps2_log::droppedCount(), size_t{kThreads * kPerThread}, "every message written or counted as dropped");
+            std::vector<int> next(kThreads, -1);
+            bool ordered = true;
+            for (const Captured &line : lines)
+            {
+                const size_t colon = line.text.find(':');
+                const int id = std::stoi(line.text.substr(0, colon));
+                const int seq = std::stoi(line.text.substr(colon + 1));
+                ordered &= seq > next[id];
+                next[id] = seq;
+            }
+            t.IsTrue(ordered, "each producer's messages stay in order");
+        });
+
+        tc.Run("long messages are truncated", [](TestCase &t)
+        {
+            CaptureSink sink;
+            PS2_LOG_WARN(Runtime, std::string(ps2_log::kMaxMessage * 2, 'x'));
+            const std::vector<Captured> lines = sink.lines();
+            t.Equals(lines.size(), size_t{1}, "message written");
+            if (!lines.empty())
+                t.Equals(lines[0].text.size(), ps2_log::kMaxMessage, "cut at the message limit");
+        });
+    });
+}
@@ -0,0 +1,88 @@
+#include "MiniTest.h"
+#include "ps2_profiler.h"
+#include "ps2_runtime.h"
+#include "ps2_symbols.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace
+{
+    const ps2_symbols::FunctionSymbol kSymbols[] = {
+        {0x00100000u, 0x00100100u, "main"},
+        {0x00100200u, 0x00100280u, "UpdateFrame"},
+        {0x00100300u, 0x00100340u, "Draw Model"},
+    };
+
+    // Installs kSymbols and leaves no symbols or samples behind.
+    class ProfilerScope
+    {
+    public:
+        ProfilerScope()
+        {
+            ps2_symbols::clear();
+            ps2_symbols::registerFunctions(kSymbols, sizeof(kSymbols) / sizeof(kSymbols[0]));
+            ps2_profiler::reset();
+        }
+
+        ~ProfilerScope()
+        {
+            ps2_profiler::stop();
+            ps2_profiler::reset();
+            ps2_symbols::clear();
+        }
+    };
+}
+
+void register_ps2_profiler_tests()
+{
+    MiniTest::Case("PS2Profiler", [](TestCase &tc)
+    {
+        tc.Run("symbols resolve pcs inside function extents", [](TestCase &t)
+        {
+            ProfilerScope scope;
+            ps2_symbols::FunctionSymbol symbol{};
+            t.IsTrue(ps2_symbols::find(0x00100210u, symbol), "pc inside UpdateFrame");
+            t.Equals(symbol.start, 0x00100200u, "containing function start");
+            t.Equals(ps2_symbols::describe(0x00100000u), std::string("main"), "first instruction");
+            t.Equals(ps2_symbols::describe(0x00100100u), std::string("0x00100100"), "end is exclusive");
+            t.Equals(ps2_symbols::describe(0x00080000u), std::string("0x00080000"), "below every function");
+        });
+
+        tc.Run("samples are collapsed per thread and call stack", [](TestCase &t)
+        {
+            ProfilerScope scope;
+            R5900Context ctx;
+            ctx.pc = 0x00100310u;
+
+            ps2_profiler::ThreadScope thread(&ctx, "Guest Thread");
+            ps2_profiler::CallScope outer(0x00100000u);
+            ps2_profiler::CallScope inner(0x00100200u);
+
+            ps2_profiler::Options options;
+            options.hz = 2000;
+            t.IsTrue(ps2_profiler::start(options), "sampler started");
+            t.IsFalse(ps2_profiler::start(options), "only one sampler at a time");
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+            while (ps2_profiler::sampleCount() < 5 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            t.IsTrue(ps2_profiler::stop(), "stopped");
+
+            const std::string folded = ps2_profiler::collapsed();
+            t.IsTrue(ps2_profiler::sampleCount() >= 5, "samples taken");
+            t.IsTrue(folded.rfind("Guest_Thread;main;UpdateFrame;Draw_Model ", 0) == 0,
+                     "thread, shadow stack and current function, separators escaped");
+        });
+
+        tc.Run("zero rate is rejected", [](TestCase &t)
+        {
+            ProfilerScope scope;
+            ps2_profiler::Options options;
+            options.hz = 0;
+            t.IsFalse(ps2_profiler::start(options), "hz must be positive");
+            t.IsFalse(ps2_profiler::running(), "nothing started");
+        });
+    });
+}
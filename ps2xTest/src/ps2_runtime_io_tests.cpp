@@ -1,12 +1,16 @@
 #include "MiniTest.h"
 #include "ps2_runtime.h"
 #include "ps2_syscalls.h"
+#include "ps2_stubs.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <map>
 #include <vector>
 #include <cstring>
 #include <chrono>
+#include <thread>
 
 using namespace ps2_syscalls;
 
@@ -61,6 +65,297 @@ namespace
         return paths;
     }
 
+    void writeHostFile(const std::filesystem::path &path, const std::vector<uint8_t> &bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    std::vector<uint8_t> makeSectorPattern(uint32_t sectors)
+    {
+        constexpr uint32_t kSectorSize = 2048;
+        std::vector<uint8_t> bytes(static_cast<size_t>(sectors) * kSectorSize);
+        for (size_t i = 0; i < bytes.size(); ++i)
+        {
+            // An odd multiplier keeps the first 256 sectors distinguishable.
+            bytes[i] = static_cast<uint8_t>(((i / kSectorSize) * 37u) ^ (i & 0xFF));
+        }
+        return bytes;
+    }
+
+    void putLe32(std::vector<uint8_t> &bytes, size_t offset, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            bytes[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    size_t putIsoDirectoryRecord(std::vector<uint8_t> &bytes, size_t offset, uint32_t lbn, uint32_t size,
+                                 bool isDirectory, const std::string &name)
+    {
+        const size_t length = 33 + name.size() + ((name.size() & 1u) == 0 ? 1 : 0);
+        bytes[offset] = static_cast<uint8_t>(length);
+        putLe32(bytes, offset + 2, lbn);
+        putLe32(bytes, offset + 10, size);
+        bytes[offset + 25] = isDirectory ? 0x02 : 0x00;
+        bytes[offset + 32] = static_cast<uint8_t>(name.size());
+        std::memcpy(bytes.data() + offset + 33, name.data(), name.size());
+        return offset + length;
+    }
+
+    // Minimal ISO9660 volume: PVD at 16, L path table at 18, root at 19,
+    // DATA/ at 20, DATA/MOVIE.PSS at 21 (the payload) and SYSTEM.CNF at 24.
+    std::vector<uint8_t> makeIsoImage(const std::vector<uint8_t> &payload,
+                                      const std::string &payloadName = "MOVIE.PSS;1")
+    {
+        constexpr size_t kSector = 2048;
+        std::vector<uint8_t> image(26 * kSector, 0);
+
+        uint8_t *pvd = image.data() + 16 * kSector;
+        pvd[0] = 1;
+        std::memcpy(pvd + 1, "CD001", 5);
+        uint8_t *terminator = image.data() + 17 * kSector;
+        terminator[0] = 255;
+        std::memcpy(terminator + 1, "CD001", 5);
+
+        const std::vector<uint8_t> pathTable = {1, 0, 19, 0, 0, 0, 1, 0, 0, 0,
+                                                4, 0, 20, 0, 0, 0, 1, 0, 'D', 'A', 'T', 'A'};
+        std::memcpy(image.data() + 18 * kSector, pathTable.data(), pathTable.size());
+        putLe32(image, 16 * kSector + 132, static_cast<uint32_t>(pathTable.size()));
+        putLe32(image, 16 * kSector + 140, 18);
+
+        size_t pos = 19 * kSector;
+        pos = putIsoDirectoryRecord(image, pos, 19, kSector, true, std::string(1, '\0'));
+        pos = putIsoDirectoryRecord(image, pos, 19, kSector, true, std::string(1, '\1'));
+        pos = putIsoDirectoryRecord(image, pos, 20, kSector, true, "DATA");
+        putIsoDirectoryRecord(image, pos, 24, 20, false, "SYSTEM.CNF;1");
+
+        pos = 20 * kSector;
+        pos = putIsoDirectoryRecord(image, pos, 20, kSector, true, std::string(1, '\0'));
+        pos = putIsoDirectoryRecord(image, pos, 19, kSector, true, std::string(1, '\1'));
+        putIsoDirectoryRecord(image, pos, 21, static_cast<uint32_t>(payload.size()), false, payloadName);
+
+        std::memcpy(image.data() + 21 * kSector, payload.data(), payload.size());
+        return image;
+    }
+
+    // CSO v1 with 2 KiB blocks. All-zero sectors use a fixed-Huffman deflate stream,
+    // storedDeflateSector a stored deflate block and the sectors in `deflated` the
+    // given streams; everything else is stored raw.
+    std::vector<uint8_t> makeCsoImage(const std::vector<uint8_t> &iso, uint32_t storedDeflateSector,
+                                      const std::map<uint32_t, std::vector<uint8_t>> &deflated = {})
+    {
+        constexpr size_t kSector = 2048;
+        static const uint8_t kDeflatedZeroSector[] = {0x63, 0x60, 0x18, 0x05, 0xa3, 0x60, 0x14, 0x8c, 0x82,
+                                                      0x51, 0x30, 0x0a, 0x46, 0xc1, 0x48, 0x03, 0x00};
+        const uint32_t blocks = static_cast<uint32_t>(iso.size() / kSector);
+
+        std::vector<uint8_t> header(24, 0);
+        std::memcpy(header.data(), "CISO", 4);
+        putLe32(header, 4, 24);
+        putLe32(header, 8, static_cast<uint32_t>(iso.size()));
+        putLe32(header, 16, static_cast<uint32_t>(kSector));
+        header[20] = 1;
+
+        std::vector<uint8_t> index((blocks + 1) * 4, 0);
+        std::vector<uint8_t> data;
+        const size_t dataStart = header.size() + index.size();
+        for (uint32_t block = 0; block < blocks; ++block)
+        {
+            const uint8_t *sector = iso.data() + block * kSector;
+            uint32_t word = static_cast<uint32_t>(dataStart + data.size());
+            if (auto stream = deflated.find(block); stream != deflated.end())
+            {
+                data.insert(data.end(), stream->second.begin(), stream->second.end());
+            }
+            else if (std::all_of(sector, sector + kSector, [](uint8_t b) { return b == 0; }))
+            {
+                data.insert(data.end(), std::begin(kDeflatedZeroSector), std::end(kDeflatedZeroSector));
+            }
+            else if (block == storedDeflateSector)
+            {
+                const uint8_t storedHeader[] = {0x01, 0x00, 0x08, 0xFF, 0xF7};
+                data.insert(data.end(), std::begin(storedHeader), std::end(storedHeader));
+                data.insert(data.end(), sector, sector + kSector);
+            }
+            else
+            {
+                word |= 0x80000000u;
+                data.insert(data.end(), sector, sector + kSector);
+            }
+            putLe32(index, block * 4, word);
+        }
+        putLe32(index, blocks * 4, static_cast<uint32_t>(dataStart + data.size()));
+
+        std::vector<uint8_t> image = header;
+        image.insert(image.end(), index.begin(), index.end());
+        image.insert(image.end(), data.begin(), data.end());
+        return image;
+    }
+
+    // Text-like sector content; the streams below were produced from it by zlib
+    // (raw deflate, level 9).
+    uint8_t huffmanPatternByte(size_t i)
+    {
+        return static_cast<uint8_t>('a' + ((i * i) >> 5) % 23);
+    }
+
+    // The whole 2 KiB pattern as one dynamic Huffman block.
+    const std::vector<uint8_t> kDynamicPatternSector = {
+        0xed, 0xd0, 0x5b, 0x8e, 0x60, 0x21, 0x08, 0x00, 0xd1, 0xb5, 0x8a, 0x08, 0x8a, 0x8a, 0xf8, 0x64,
+        0xfb, 0x9d, 0x49, 0x26, 0xe9, 0x25, 0xf4, 0xcf, 0xad, 0xda, 0xc1, 0x09, 0xe1, 0x5f, 0x00, 0x31,
+        0x22, 0x26, 0xe2, 0x5c, 0xa4, 0xb6, 0xae, 0x36, 0xf7, 0x79, 0x0e, 0x48, 0x59, 0x9a, 0xda, 0x3a,
+        0x0e, 0x89, 0xa5, 0x8d, 0x75, 0x03, 0xb2, 0x74, 0xdb, 0x1e, 0x59, 0x74, 0x5e, 0x20, 0xd1, 0xf5,
+        0x22, 0x57, 0x3b, 0x40, 0x75, 0x1c, 0xe0, 0x36, 0x1f, 0x16, 0xdd, 0xc0, 0x7d, 0x05, 0x6a, 0x2b,
+        0x70, 0xdf, 0x90, 0xf5, 0xa0, 0x4c, 0xe7, 0x7e, 0xb0, 0x2e, 0x28, 0xe6, 0xac, 0x8f, 0xf4, 0x52,
+        0xbf, 0xa4, 0x8f, 0x87, 0x67, 0x0b, 0xb2, 0xb0, 0x5d, 0x1a, 0x41, 0x76, 0x52, 0x2f, 0x0b, 0xd5,
+        0x65, 0xd3, 0x80, 0xf6, 0xca, 0x26, 0x8b, 0xdd, 0xeb, 0x2d, 0x9b, 0x67, 0x32, 0x1c, 0x51, 0xa1,
+        0x87, 0xf6, 0xff, 0x0e, 0x1a, 0x07, 0x5a, 0x9a, 0xbc, 0xcb, 0xad, 0xde, 0xa3, 0xd1, 0x2e, 0xaf,
+        0xc1, 0xa0, 0x2d, 0xae, 0xb8, 0x8a, 0x6b, 0xda, 0x12, 0x06, 0xdd, 0x86, 0x4b, 0x82, 0x65, 0x1f,
+        0xfc, 0x94, 0x6e, 0xa7, 0xab, 0xf4, 0x94, 0xdd, 0x0a, 0xac, 0x8a, 0xa7, 0xb3, 0x4f, 0xc1, 0xa3,
+        0x19, 0x76, 0xe7, 0xb0, 0x1a, 0x85, 0xd5, 0x19, 0xb6, 0x16, 0x7c, 0xb3, 0x31, 0x9c, 0x51, 0x09,
+        0x8e, 0x55, 0x8e, 0x6f, 0xa9, 0x10, 0xdc, 0xa9, 0xc2, 0xd1, 0xb7, 0x75, 0x61, 0x0c, 0x77, 0x8d,
+        0x26, 0x9c, 0xc0, 0xcf, 0x32, 0x6d, 0x92, 0x09, 0xc1, 0xdf, 0xd9, 0xd3, 0xb4, 0xb7, 0x2a, 0x25,
+        0x33, 0x25, 0xc4, 0x18, 0x01, 0xc2, 0x6f, 0x9f, 0xf7, 0xe7, 0xfd, 0x79, 0x7f, 0xde, 0x9f, 0xf7,
+        0xe7, 0xfd, 0xb7, 0xde, 0x3f,
+    };
+
+    // The first 52 pattern bytes as a dynamic Huffman block, then Z_SYNC_FLUSH's
+    // empty stored block. Its short end-of-block code leaves a whole byte in the
+    // decoder's bit buffer when the stored block starts.
+    const std::vector<uint8_t> kDynamicPatternPrefix = {
+        0x14, 0xc1, 0x09, 0x12, 0x00, 0x10, 0x08, 0x00, 0xc0, 0xb7, 0x96, 0x88, 0x84, 0xdc, 0xdf, 0x37,
+        0x76, 0x01, 0x3e, 0x44, 0xe7, 0x88, 0x7c, 0xe0, 0x98, 0x24, 0x6b, 0xa9, 0xd6, 0xe7, 0x3a, 0x17,
+        0x29, 0x44, 0xd1, 0x6a, 0x63, 0x5d, 0xf4, 0x2c, 0xda, 0xc6, 0x06, 0x62, 0x29, 0x0f, 0x00, 0x00,
+        0xff, 0xff,
+    };
+
+    // The first 64 pattern bytes as a fixed Huffman block (Z_FIXED), then
+    // Z_SYNC_FLUSH's empty stored block.
+    const std::vector<uint8_t> kFixedPatternPrefix = {
+        0x4a, 0x4c, 0x04, 0x81, 0xa4, 0xa4, 0xe4, 0xe4, 0x94, 0x94, 0xd4, 0xb4, 0xf4, 0x8c, 0xcc, 0xac,
+        0xec, 0x9c, 0xdc, 0xbc, 0x82, 0xc2, 0xe2, 0x92, 0xb2, 0xf2, 0xa4, 0x94, 0xb4, 0x8c, 0xac, 0x9c,
+        0xbc, 0x82, 0xa2, 0x92, 0xf2, 0xa4, 0xd4, 0xf4, 0xac, 0x9c, 0xfc, 0xa2, 0xd2, 0xc4, 0x94, 0xf4,
+        0xac, 0xdc, 0x82, 0xe2, 0xf2, 0xe4, 0xf4, 0xac, 0xbc, 0xc2, 0xd2, 0xa4, 0xb4, 0x2c, 0x00, 0x00,
+        0x00, 0x00, 0xff, 0xff,
+    };
+
+    // Appends a final stored block holding bytes to a byte-aligned deflate stream.
+    std::vector<uint8_t> withFinalStoredBlock(std::vector<uint8_t> stream, const uint8_t *bytes, size_t size)
+    {
+        stream.push_back(0x01);
+        stream.push_back(static_cast<uint8_t>(size));
+        stream.push_back(static_cast<uint8_t>(size >> 8));
+        stream.push_back(static_cast<uint8_t>(~size));
+        stream.push_back(static_cast<uint8_t>(~size >> 8));
+        stream.insert(stream.end(), bytes, bytes + size);
+        return stream;
+    }
+
+    void putLz4Length(std::vector<uint8_t> &out, size_t extra)
+    {
+        for (; extra >= 255; extra -= 255)
+        {
+            out.push_back(255);
+        }
+        out.push_back(static_cast<uint8_t>(extra));
+    }
+
+    // LZ4 block for a sector that repeats every `period` bytes: the first period
+    // as literals, one overlapping match, and the five trailing literals LZ4 requires.
+    std::vector<uint8_t> lz4PeriodicSector(const uint8_t *sector, size_t size, size_t period)
+    {
+        const size_t match = size - period - 5;
+        std::vector<uint8_t> out;
+        out.push_back(static_cast<uint8_t>((std::min<size_t>(period, 15) << 4) | std::min<size_t>(match - 4, 15)));
+        if (period >= 15)
+        {
+            putLz4Length(out, period - 15);
+        }
+        out.insert(out.end(), sector, sector + period);
+        out.push_back(static_cast<uint8_t>(period));
+        out.push_back(static_cast<uint8_t>(period >> 8));
+        if (match - 4 >= 15)
+        {
+            putLz4Length(out, match - 4 - 15);
+        }
+        out.push_back(0x50);
+        out.insert(out.end(), sector + size - 5, sector + size);
+        return out;
+    }
+
+    // ZSO, or CSO v2 when csoV2 is set, with 2 KiB blocks. Sectors that repeat
+    // every 1 or 256 bytes are LZ4-coded, except that CSO v2 deflates all-zero
+    // sectors; anything else is stored.
+    std::vector<uint8_t> makeLz4Image(const std::vector<uint8_t> &iso, bool csoV2)
+    {
+        constexpr size_t kSector = 2048;
+        static const uint8_t kDeflatedZeroSector[] = {0x63, 0x60, 0x18, 0x05, 0xa3, 0x60, 0x14, 0x8c, 0x82,
+                                                      0x51, 0x30, 0x0a, 0x46, 0xc1, 0x48, 0x03, 0x00};
+        const uint32_t blocks = static_cast<uint32_t>(iso.size() / kSector);
+
+        std::vector<uint8_t> header(24, 0);
+        std::memcpy(header.data(), csoV2 ? "CISO" : "ZISO", 4);
+        putLe32(header, 4, 24);
+        putLe32(header, 8, static_cast<uint32_t>(iso.size()));
+        putLe32(header, 16, static_cast<uint32_t>(kSector));
+        header[20] = csoV2 ? 2 : 1;
+
+        std::vector<uint8_t> index((blocks + 1) * 4, 0);
+        std::vector<uint8_t> data;
+        const size_t dataStart = header.size() + index.size();
+        for (uint32_t block = 0; block < blocks; ++block)
+        {
+            const uint8_t *sector = iso.data() + block * kSector;
+            uint32_t word = static_cast<uint32_t>(dataStart + data.size());
+            size_t period = 0;
+            for (const size_t candidate : {size_t{1}, size_t{256}})
+            {
+                bool repeats = true;
+                for (size_t i = candidate; i < kSector && repeats; ++i)
+                {
+                    repeats = sector[i] == sector[i - candidate];
+                }
+                if (repeats)
+                {
+                    period = candidate;
+                    break;
+                }
+            }
+
+            if (csoV2 && period == 1 && sector[0] == 0)
+            {
+                data.insert(data.end(), std::begin(kDeflatedZeroSector), std::end(kDeflatedZeroSector));
+            }
+            else if (period != 0)
+            {
+                const std::vector<uint8_t> coded = lz4PeriodicSector(sector, kSector, period);
+                data.insert(data.end(), coded.begin(), coded.end());
+                if (csoV2)
+                {
+                    word |= 0x80000000u;
+                }
+            }
+            else
+            {
+                // ZSO flags stored blocks; CSO v2 recognises them by size.
+                if (!csoV2)
+                {
+                    word |= 0x80000000u;
+                }
+                data.insert(data.end(), sector, sector + kSector);
+            }
+            putLe32(index, block * 4, word);
+        }
+        putLe32(index, blocks * 4, static_cast<uint32_t>(dataStart + data.size()));
+
+        std::vector<uint8_t> image = header;
+        image.insert(image.end(), index.begin(), index.end());
+        image.insert(image.end(), data.begin(), data.end());
+        return image;
+    }
+
     struct TestContext
     {
         TempPaths paths;
@@ -77,6 +372,23 @@ namespace
             PS2Runtime::setIoPaths(ioPaths);
         }
     };
+
+    constexpr uint32_t kCdCallbackAddr = 0x00100000u;
+    int g_cdCallbackCalls = 0;
+    int32_t g_cdCallbackFunc = -1;
+
+    void recordCdCallback(uint8_t *, R5900Context *ctx, PS2Runtime *)
+    {
+        ++g_cdCallbackCalls;
+        g_cdCallbackFunc = getRegS32(ctx, 4);
+    }
+
+    // sceCdRead only queues the copy; block until the CD I/O thread drains.
+    void waitCdIdle(TestContext &test)
+    {
+        setRegU32(test.ctx, 4, 0u);
+        ps2_stubs::sceCdSync(test.rdram.data(), &test.ctx, nullptr);
+    }
 }
 
 void register_ps2_runtime_io_tests()
@@ -224,6 +536,531 @@ void register_ps2_runtime_io_tests()
             fioClose(test.rdram.data(), &test.ctx, nullptr);
         });
 
+        tc.Run("sceCdRead resolves pseudo-LBN files", [](TestCase &t)
+        {
+            TestContext test;
+
+            const std::vector<uint8_t> first = makeSectorPattern(3);
+            const std::vector<uint8_t> second = makeSectorPattern(5);
+            writeHostFile(test.paths.cdRoot / "LBNMAP_A.BIN", first);
+            writeHostFile(test.paths.cdRoot / "LBNMAP_B.BIN", second);
+
+            const uint32_t fileStructAddr = GUEST_BUFFER_AREA_START;
+            const uint32_t pathAddr = GUEST_STRING_AREA_START;
+            uint32_t lbnB = 0;
+            for (const char *name : {"cdrom0:\\LBNMAP_A.BIN;1", "cdrom0:\\LBNMAP_B.BIN;1"})
+            {
+                writeGuestString(test.rdram.data(), pathAddr, name);
+                setRegU32(test.ctx, 4, fileStructAddr);
+                setRegU32(test.ctx, 5, pathAddr);
+                ps2_stubs::sceCdSearchFile(test.rdram.data(), &test.ctx, nullptr);
+                t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdSearchFile should find the host file");
+                std::memcpy(&lbnB, test.rdram.data() + fileStructAddr, sizeof(lbnB));
+            }
+
+            // Read the tail of the second file, starting one sector in.
+            const uint32_t readAddr = GUEST_BUFFER_AREA_START + 0x1000;
+            setRegU32(test.ctx, 4, lbnB + 1u);
+            setRegU32(test.ctx, 5, 2u);
+            setRegU32(test.ctx, 6, readAddr);
+            ps2_stubs::sceCdRead(test.rdram.data(), &test.ctx, nullptr);
+            t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdRead should accept a mapped LBN");
+            waitCdIdle(test);
+            t.IsTrue(std::memcmp(test.rdram.data() + readAddr, second.data() + 2048, 2 * 2048) == 0,
+                     "sceCdRead should copy sectors from the owning file");
+        });
+
+        tc.Run("sceCdSearchFile resolves real LBNs from an ISO9660 image", [](TestCase &t)
+        {
+            TestContext test;
+
+            const std::vector<uint8_t> payload = makeSectorPattern(3);
+            const std::filesystem::path imagePath = test.paths.base / "volume.iso";
+            writeHostFile(imagePath, makeIsoImage(payload));
+
+            PS2Runtime::IoPaths ioPaths = PS2Runtime::getIoPaths();
+            ioPaths.cdImage = imagePath;
+            PS2Runtime::setIoPaths(ioPaths);
+
+            const uint32_t fileStructAddr = GUEST_BUFFER_AREA_START;
+            const uint32_t pathAddr = GUEST_STRING_AREA_START;
+            writeGuestString(test.rdram.data(), pathAddr, "cdrom0:\\data\\movie.pss;1");
+            setRegU32(test.ctx, 4, fileStructAddr);
+            setRegU32(test.ctx, 5, pathAddr);
+            ps2_stubs::sceCdSearchFile(test.rdram.data(), &test.ctx, nullptr);
+            t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdSearchFile should find the file inside the image");
+
+            uint32_t lsn = 0;
+            uint32_t size = 0;
+            std::memcpy(&lsn, test.rdram.data() + fileStructAddr, sizeof(lsn));
+            std::memcpy(&size, test.rdram.data() + fileStructAddr + 4, sizeof(size));
+            t.Equals(lsn, 21u, "sceCdSearchFile should report the extent LBN from the directory record");
+            t.Equals(size, static_cast<uint32_t>(payload.size()), "sceCdSearchFile should report the recorded size");
+
+            const uint32_t readAddr = GUEST_BUFFER_AREA_START + 0x1000;
+            setRegU32(test.ctx, 4, lsn);
+            setRegU32(test.ctx, 5, 3u);
+            setRegU32(test.ctx, 6, readAddr);
+            ps2_stubs::sceCdRead(test.rdram.data(), &test.ctx, nullptr);
+            t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdRead should accept the real LBN");
+            waitCdIdle(test);
+            t.IsTrue(std::memcmp(test.rdram.data() + readAddr, payload.data(), payload.size()) == 0,
+                     "sceCdRead should return the file contents from the image");
+
+            writeGuestString(test.rdram.data(), pathAddr, "cdrom0:\\SYSTEM.CNF;1");
+            setRegU32(test.ctx, 4, fileStructAddr);
+            setRegU32(test.ctx, 5, pathAddr);
+            ps2_stubs::sceCdSearchFile(test.rdram.data(), &test.ctx, nullptr);
+            t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdSearchFile should find root-level files");
+            std::memcpy(&lsn, test.rdram.data() + fileStructAddr, sizeof(lsn));
+            t.Equals(lsn, 24u, "root-level file should keep its recorded LBN");
+
+            ioPaths.cdImage.clear();
+            PS2Runtime::setIoPaths(ioPaths);
+        });
+
+        tc.Run("sceCdRead decompresses CSO images", [](TestCase &t)
+        {
+            TestContext test;
+
+            const std::vector<uint8_t> payload = makeSectorPattern(3);
+            const std::vector<uint8_t> iso = makeIsoImage(payload);
+            const std::filesystem::path imagePath = test.paths.base / "volume.cso";
+            writeHostFile(imagePath, makeCsoImage(iso, 21));
+
+            PS2Runtime::IoPaths ioPaths = PS2Runtime::getIoPaths();
+            ioPaths.cdImage = imagePath;
+            PS2Runtime::setIoPaths(ioPaths);
+
+            const uint32_t fileStructAddr = GUEST_BUFFER_AREA_START;
+            const uint32_t pathAddr = GUEST_STRING_AREA_START;
+            writeGuestString(test.rdram.data(), pathAddr, "cdrom0:\\DATA\\MOVIE.PSS;1");
+            setRegU32(test.ctx, 4, fileStructAddr);
+            setRegU32(test.ctx, 5, pathAddr);
+            ps2_stubs::sceCdSearchFile(test.rdram.data(), &test.ctx, nullptr);
+            t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdSearchFile should index the compressed volume");
+
+            // The whole disc, so zero, stored-deflate and raw blocks are all decoded.
+            const uint32_t readAddr = GUEST_BUFFER_AREA_START + 0x1000;
+            setRegU32(test.ctx, 4, 0u);
+            setRegU32(test.ctx, 5, static_cast<uint32_t>(iso.size() / 2048));
+            setRegU32(test.ctx, 6, readAddr);
+            ps2_stubs::sceCdRead(test.rdram.data(), &test.ctx, nullptr);
+            t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdRead should accept LBNs within the uncompressed size");
+            waitCdIdle(test);
+            t.IsTrue(std::memcmp(test.rdram.data() + readAddr, iso.data(), iso.size()) == 0,
+                     "decompressed sectors should match the original image");
+
+            ioPaths.cdImage.clear();
+            PS2Runtime::setIoPaths(ioPaths);
+        });
+
+        tc.Run("sceCdRead decodes dynamic Huffman and stored-after-Huffman CSO blocks", [](TestCase &t)
+        {
+            TestContext test;
+
+            // Sector 21: dynamic Huffman. 22 and 23: a dynamic or fixed Huffman
+            // prefix followed by stored blocks, as zlib's flush modes produce.
+            constexpr size_t kSector = 2048;
+            std::vector<uint8_t> payload(3 * kSector);
+            for (size_t i = 0; i < kSector; ++i)
+            {
+                payload[i] = huffmanPatternByte(i);
+                payload[kSector + i] = i < 52 ? huffmanPatternByte(i) : static_cast<uint8_t>(i * 37 + 11);
+                payload[2 * kSector + i] = i < 64 ? huffmanPatternByte(i) : static_cast<uint8_t>(i * 91 + 5);
+            }
+            const std::vector<uint8_t> iso = makeIsoImage(payload);
+            const std::map<uint32_t, std::vector<uint8_t>> deflated = {
+                {21, kDynamicPatternSector},
+                {22, withFinalStoredBlock(kDynamicPatternPrefix, payload.data() + kSector + 52, kSector - 52)},
+                {23, withFinalStoredBlock(kFixedPatternPrefix, payload.data() + 2 * kSector + 64, kSector - 64)},
+            };
+            const std::filesystem::path imagePath = test.paths.base / "huffman.cso";
+            writeHostFile(imagePath, makeCsoImage(iso, 0xFFFFFFFFu, deflated));
+
+            PS2Runtime::IoPaths ioPaths = PS2Runtime::getIoPaths();
+            ioPaths.cdImage = imagePath;
+            PS2Runtime::setIoPaths(ioPaths);
+
+            const uint32_t readAddr = GUEST_BUFFER_AREA_START;
+            setRegU32(test.ctx, 4, 21u);
+            setRegU32(test.ctx, 5, 3u);
+            setRegU32(test.ctx, 6, readAddr);
+            ps2_stubs::sceCdRead(test.rdram.data(), &test.ctx, nullptr);
+            t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdRead should accept the payload sectors");
+            waitCdIdle(test);
+            const uint8_t *read = test.rdram.data() + readAddr;
+            t.IsTrue(std::memcmp(read, payload.data(), kSector) == 0, "dynamic Huffman sector");
+            t.IsTrue(std::memcmp(read + kSector, payload.data() + kSector, kSector) == 0,
+                     "stored block after a dynamic Huffman block");
+            t.IsTrue(std::memcmp(read + 2 * kSector, payload.data() + 2 * kSector, kSector) == 0,
+                     "stored block after a fixed Huffman block");
+
+            ioPaths.cdImage.clear();
+            PS2Runtime::setIoPaths(ioPaths);
+        });
+
+        tc.Run("sceCdRead decompresses ZSO and CSO v2 images", [](TestCase &t)
+        {
+            const std::vector<uint8_t> payload = makeSectorPattern(3);
+            const std::vector<uint8_t> iso = makeIsoImage(payload);
+
+            for (const bool csoV2 : {false, true})
+            {
+                TestContext test;
+                const std::filesystem::path imagePath = test.paths.base / (csoV2 ? "volume.cso" : "volume.zso");
+                writeHostFile(imagePath, makeLz4Image(iso, csoV2));
+
+                PS2Runtime::IoPaths ioPaths = PS2Runtime::getIoPaths();
+                ioPaths.cdImage = imagePath;
+                PS2Runtime::setIoPaths(ioPaths);
+
+                const uint32_t fileStructAddr = GUEST_BUFFER_AREA_START;
+                const uint32_t pathAddr = GUEST_STRING_AREA_START;
+                writeGuestString(test.rdram.data(), pathAddr, "cdrom0:\\DATA\\MOVIE.PSS;1");
+                setRegU32(test.ctx, 4, fileStructAddr);
+                setRegU32(test.ctx, 5, pathAddr);
+                ps2_stubs::sceCdSearchFile(test.rdram.data(), &test.ctx, nullptr);
+                t.Equals(getRegS32(&test.ctx, 2), 1,
+                         csoV2 ? "CSO v2: sceCdSearchFile should index the volume" : "ZSO: sceCdSearchFile should index the volume");
+
+                // The whole disc, so LZ4, stored and (CSO v2) deflate blocks are all decoded.
+                const uint32_t readAddr = GUEST_BUFFER_AREA_START + 0x1000;
+                setRegU32(test.ctx, 4, 0u);
+                setRegU32(test.ctx, 5, static_cast<uint32_t>(iso.size() / 2048));
+                setRegU32(test.ctx, 6, readAddr);
+                ps2_stubs::sceCdRead(test.rdram.data(), &test.ctx, nullptr);
+                t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdRead should accept LBNs within the uncompressed size");
+                waitCdIdle(test);
+                t.IsTrue(std::memcmp(test.rdram.data() + readAddr, iso.data(), iso.size()) == 0,
+                         csoV2 ? "CSO v2: decompressed sectors should match the original image"
+                               : "ZSO: decompressed sectors should match the original image");
+
+                ioPaths.cdImage.clear();
+                PS2Runtime::setIoPaths(ioPaths);
+            }
+        });
+
+        tc.Run("gd-init IDX search falls back to the AFS inside plain and CSO images", [](TestCase &t)
+        {
+            std::vector<uint8_t> payload = makeSectorPattern(3);
+            std::memcpy(payload.data(), "AFS", 4);
+            const std::vector<uint8_t> iso = makeIsoImage(payload, "MOVIE.AFS;1");
+
+            for (const bool compressed : {false, true})
+            {
+                TestContext test;
+                const std::filesystem::path imagePath = test.paths.base / (compressed ? "volume.cso" : "volume.iso");
+                writeHostFile(imagePath, compressed ? makeCsoImage(iso, 21) : iso);
+
+                PS2Runtime::IoPaths ioPaths = PS2Runtime::getIoPaths();
+                ioPaths.cdImage = imagePath;
+                PS2Runtime::setIoPaths(ioPaths);
+
+                const uint32_t fileStructAddr = GUEST_BUFFER_AREA_START;
+                const uint32_t pathAddr = GUEST_STRING_AREA_START;
+                writeGuestString(test.rdram.data(), pathAddr, "cdrom0:\\DATA\\MOVIE.IDX;1");
+                setRegU32(test.ctx, 4, fileStructAddr);
+                setRegU32(test.ctx, 5, pathAddr);
+                setRegU32(test.ctx, 31, 0x2d9444u);
+                ps2_stubs::sceCdSearchFile(test.rdram.data(), &test.ctx, nullptr);
+                t.Equals(getRegS32(&test.ctx, 2), 1,
+                         compressed ? "CSO: missing IDX should resolve to the AFS" : "ISO: missing IDX should resolve to the AFS");
+
+                uint32_t lsn = 0;
+                std::memcpy(&lsn, test.rdram.data() + fileStructAddr, sizeof(lsn));
+                t.Equals(lsn, 21u, compressed ? "CSO: AFS extent" : "ISO: AFS extent");
+
+                ioPaths.cdImage.clear();
+                PS2Runtime::setIoPaths(ioPaths);
+            }
+        });
+
+        tc.Run("sceCdRead reads from configured CD image", [](TestCase &t)
+        {
+            TestContext test;
+
+            const std::vector<uint8_t> image = makeSectorPattern(8);
+            const std::filesystem::path imagePath = test.paths.base / "disc.iso";
+            writeHostFile(imagePath, image);
+
+            PS2Runtime::IoPaths ioPaths = PS2Runtime::getIoPaths();
+            ioPaths.cdImage = imagePath;
+            PS2Runtime::setIoPaths(ioPaths);
+
+            const uint32_t readAddr = GUEST_BUFFER_AREA_START;
+            setRegU32(test.ctx, 4, 5u);
+            setRegU32(test.ctx, 5, 3u);
+            setRegU32(test.ctx, 6, readAddr);
+            ps2_stubs::sceCdRead(test.rdram.data(), &test.ctx, nullptr);
+            t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdRead should accept an in-range image LBN");
+            waitCdIdle(test);
+            t.IsTrue(std::memcmp(test.rdram.data() + readAddr, image.data() + 5 * 2048, 3 * 2048) == 0,
+                     "sceCdRead should copy image sectors verbatim");
+
+            setRegU32(test.ctx, 4, 7u);
+            setRegU32(test.ctx, 5, 2u);
+            ps2_stubs::sceCdRead(test.rdram.data(), &test.ctx, nullptr);
+            t.Equals(getRegS32(&test.ctx, 2), 0, "sceCdRead should reject reads past the image end");
+
+            ioPaths.cdImage.clear();
+            PS2Runtime::setIoPaths(ioPaths);
+        });
+
+        tc.Run("sceCdRead completes asynchronously across sequential reads", [](TestCase &t)
+        {
+            TestContext test;
+
+            const std::vector<uint8_t> image = makeSectorPattern(64);
+            const std::filesystem::path imagePath = test.paths.base / "stream.iso";
+            writeHostFile(imagePath, image);
+
+            PS2Runtime::IoPaths ioPaths = PS2Runtime::getIoPaths();
+            ioPaths.cdImage = imagePath;
+            PS2Runtime::setIoPaths(ioPaths);
+
+            // Back-to-back reads turn on read-ahead; later reads are served from it.
+            const uint32_t readAddr = GUEST_BUFFER_AREA_START;
+            for (uint32_t lbn = 0; lbn < 60u; lbn += 20u)
+            {
+                setRegU32(test.ctx, 4, lbn);
+                setRegU32(test.ctx, 5, 20u);
+                setRegU32(test.ctx, 6, readAddr + lbn * 2048u);
+                ps2_stubs::sceCdRead(test.rdram.data(), &test.ctx, nullptr);
+                t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdRead should queue the request");
+            }
+
+            int32_t busy = 1;
+            for (int i = 0; i < 5000 && busy != 0; ++i)
+            {
+                setRegU32(test.ctx, 4, 1u);
+                ps2_stubs::sceCdSync(test.rdram.data(), &test.ctx, nullptr);
+                busy = getRegS32(&test.ctx, 2);
+                if (busy != 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            t.Equals(busy, 0, "non-blocking sceCdSync should report completion");
+
+            ps2_stubs::sceCdGetReadPos(test.rdram.data(), &test.ctx, nullptr);
+            t.Equals(getRegU32(&test.ctx, 2), 60u, "sceCdGetReadPos should report the end of the last read");
+            t.IsTrue(std::memcmp(test.rdram.data() + readAddr, image.data(), 60 * 2048) == 0,
+                     "queued reads should land in guest memory in order");
+
+            ioPaths.cdImage.clear();
+            PS2Runtime::setIoPaths(ioPaths);
+        });
+
+        tc.Run("sceCdCallback runs once per finished read", [](TestCase &t)
+        {
+            TestContext test;
+            PS2Runtime runtime;
+            runtime.registerFunction(kCdCallbackAddr, recordCdCallback);
+
+            const std::vector<uint8_t> image = makeSectorPattern(8);
+            const std::filesystem::path imagePath = test.paths.base / "callback.iso";
+            writeHostFile(imagePath, image);
+
+            PS2Runtime::IoPaths ioPaths = PS2Runtime::getIoPaths();
+            ioPaths.cdImage = imagePath;
+            PS2Runtime::setIoPaths(ioPaths);
+
+            // Drop completions left by earlier reads that had no handler.
+            setRegU32(test.ctx, 4, 0u);
+            ps2_stubs::sceCdCallback(test.rdram.data(), &test.ctx, &runtime);
+            setRegU32(test.ctx, 4, 0u);
+            ps2_stubs::sceCdSync(test.rdram.data(), &test.ctx, &runtime);
+
+            setRegU32(test.ctx, 4, kCdCallbackAddr);
+            ps2_stubs::sceCdCallback(test.rdram.data(), &test.ctx, &runtime);
+            t.Equals(getRegU32(&test.ctx, 2), 0u, "first install returns no previous handler");
+            setRegU32(test.ctx, 4, kCdCallbackAddr);
+            ps2_stubs::sceCdCallback(test.rdram.data(), &test.ctx, &runtime);
+            t.Equals(getRegU32(&test.ctx, 2), kCdCallbackAddr, "reinstall returns the previous handler");
+
+            g_cdCallbackCalls = 0;
+            g_cdCallbackFunc = -1;
+            setRegU32(test.ctx, 4, 2u);
+            setRegU32(test.ctx, 5, 1u);
+            setRegU32(test.ctx, 6, GUEST_BUFFER_AREA_START);
+            ps2_stubs::sceCdRead(test.rdram.data(), &test.ctx, &runtime);
+            t.Equals(getRegS32(&test.ctx, 2), 1, "sceCdRead should queue the request");
+
+            setRegU32(test.ctx, 4, 0u);
+            ps2_stubs::sceCdSync(test.rdram.data(), &test.ctx, &runtime);
+            t.Equals(g_cdCallbackCalls, 1, "handler runs when sceCdSync sees the read finish");
+            t.Equals(g_cdCallbackFunc, 1, "handler is told SCECdFuncRead");
+
+            setRegU32(test.ctx, 4, 0u);
+            ps2_stubs::sceCdSync(test.rdram.data(), &test.ctx, &runtime);
+            setRegU32(test.ctx, 4, 1u);
+            ps2_stubs::sceCdSync(test.rdram.data(), &test.ctx, &runtime);
+            t.Equals(g_cdCallbackCalls, 1, "one read never runs the handler twice");
+
+            setRegU32(test.ctx, 4, 0u);
+            ps2_stubs::sceCdCallback(test.rdram.data(), &test.ctx, &runtime);
+            ioPaths.cdImage.clear();
+            PS2Runtime::setIoPaths(ioPaths);
+        });
+
+        tc.Run("fio descriptors keep independent offsets", [](TestCase &t)
+        {
+            TestContext test;
+            writeGuestString(test.rdram.data(), GUEST_STRING_AREA_START, "host0:offsets.bin");
+
+            auto call = [&](void (*fn)(uint8_t *, R5900Context *, PS2Runtime *),
+                            uint32_t a0, uint32_t a1, uint32_t a2)
+            {
+                setRegU32(test.ctx, 4, a0);
+                setRegU32(test.ctx, 5, a1);
+                setRegU32(test.ctx, 6, a2);
+                fn(test.rdram.data(), &test.ctx, nullptr);
+                return getRegS32(&test.ctx, 2);
+            };
+
+            const int32_t fd = call(fioOpen, GUEST_STRING_AREA_START,
+                                    PS2_FIO_O_RDWR | PS2_FIO_O_CREAT | PS2_FIO_O_TRUNC, 0);
+            t.IsTrue(fd >= 0, "fioOpen should create the file");
+
+            std::memcpy(test.rdram.data() + GUEST_BUFFER_AREA_START, "abcdef", 6);
+            t.Equals(call(fioWrite, fd, GUEST_BUFFER_AREA_START, 6), 6, "fioWrite should write all bytes");
+            t.Equals(call(fioLseek, fd, 2, PS2_FIO_SEEK_SET), 2, "SEEK_SET should move to the offset");
+
+            const uint32_t readAddr = GUEST_BUFFER_AREA_START + 0x100;
+            t.Equals(call(fioRead, fd, readAddr, 3), 3, "fioRead should read from the seek position");
+            t.IsTrue(std::memcmp(test.rdram.data() + readAddr, "cde", 3) == 0, "read data should match");
+            t.Equals(call(fioLseek, fd, 0, PS2_FIO_SEEK_CUR), 5, "reads should advance the offset");
+            t.Equals(call(fioLseek, fd, static_cast<uint32_t>(-1), PS2_FIO_SEEK_END), 5,
+                     "SEEK_END should be relative to the file size");
+
+            const int32_t appendFd = call(fioOpen, GUEST_STRING_AREA_START, PS2_FIO_O_WRONLY | PS2_FIO_O_APPEND, 0);
+            t.IsTrue(appendFd >= 0 && appendFd != fd, "second open should get its own descriptor");
+            std::memcpy(test.rdram.data() + GUEST_BUFFER_AREA_START, "XY", 2);
+            t.Equals(call(fioWrite, appendFd, GUEST_BUFFER_AREA_START, 2), 2, "append write should succeed");
+
+            t.Equals(call(fioRead, fd, readAddr, 8), 3, "first descriptor should see the appended bytes");
+            t.IsTrue(std::memcmp(test.rdram.data() + readAddr, "fXY", 3) == 0, "appended data should follow");
+
+            t.Equals(call(fioClose, appendFd, 0, 0), 0, "fioClose should succeed");
+            t.Equals(call(fioClose, appendFd, 0, 0), -1, "double close should fail");
+            t.Equals(call(fioRead, appendFd, readAddr, 1), -1, "closed descriptor should be rejected");
+            t.Equals(call(fioClose, fd, 0, 0), 0, "fioClose should succeed");
+        });
+
+        tc.Run("fio NOWAIT operations complete through fioSync", [](TestCase &t)
+        {
+            TestContext test;
+            std::vector<uint8_t> payload(64 * 1024);
+            for (size_t i = 0; i < payload.size(); ++i)
+            {
+                payload[i] = static_cast<uint8_t>((i * 7) ^ (i >> 8));
+            }
+            writeHostFile(test.paths.cdRoot / "ASYNC.BIN", payload);
+            writeGuestString(test.rdram.data(), GUEST_STRING_AREA_START, "host0:ASYNC.BIN");
+
+            auto call = [&](void (*fn)(uint8_t *, R5900Context *, PS2Runtime *),
+                            uint32_t a0, uint32_t a1, uint32_t a2)
+            {
+                setRegU32(test.ctx, 4, a0);
+                setRegU32(test.ctx, 5, a1);
+                setRegU32(test.ctx, 6, a2);
+                fn(test.rdram.data(), &test.ctx, nullptr);
+                return getRegS32(&test.ctx, 2);
+            };
+            const uint32_t retAddr = GUEST_BUFFER_AREA_START;
+            auto syncResult = [&]()
+            {
+                int32_t value = 0;
+                std::memcpy(&value, test.rdram.data() + retAddr, sizeof(value));
+                return value;
+            };
+
+            const int32_t fd = call(fioOpen, GUEST_STRING_AREA_START, PS2_FIO_O_RDONLY | PS2_FIO_O_NOWAIT, 0);
+            t.IsTrue(fd >= 0, "NOWAIT open should hand out a descriptor immediately");
+            t.Equals(call(fioSync, PS2_FIO_WAIT, retAddr, 0), PS2_FIO_COMPLETE, "fioSync should complete the open");
+            t.Equals(syncResult(), fd, "open result should be the guest descriptor");
+
+            const uint32_t readAddr = 0x100000;
+            t.Equals(call(fioRead, fd, readAddr, static_cast<uint32_t>(payload.size())), 0,
+                     "NOWAIT read should return before the data arrives");
+            int32_t status = PS2_FIO_INCOMPLETE;
+            for (int i = 0; i < 2000 && status != PS2_FIO_COMPLETE; ++i)
+            {
+                status = call(fioSync, PS2_FIO_NOWAIT, retAddr, 0);
+                if (status != PS2_FIO_COMPLETE)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            t.Equals(status, PS2_FIO_COMPLETE, "polling fioSync should observe completion");
+            t.Equals(syncResult(), static_cast<int32_t>(payload.size()), "read result should be the byte count");
+            t.IsTrue(std::memcmp(test.rdram.data() + readAddr, payload.data(), payload.size()) == 0,
+                     "NOWAIT read should land in guest memory");
+
+            t.Equals(call(fioRead, fd, readAddr, 16), 0, "second NOWAIT read should queue");
+            t.Equals(call(fioLseek, fd, 0, PS2_FIO_SEEK_CUR), static_cast<int32_t>(payload.size()),
+                     "a blocking call should settle the pending read first");
+            t.Equals(call(fioClose, fd, 0, 0), 0, "fioClose should succeed");
+
+            writeGuestString(test.rdram.data(), GUEST_STRING_AREA_START, "host0:MISSING.BIN");
+            const int32_t missingFd = call(fioOpen, GUEST_STRING_AREA_START, PS2_FIO_O_RDONLY | PS2_FIO_O_NOWAIT, 0);
+            t.IsTrue(missingFd >= 0, "NOWAIT open defers errors to fioSync");
+            t.Equals(call(fioSync, PS2_FIO_WAIT, retAddr, 0), PS2_FIO_COMPLETE, "fioSync should complete the open");
+            t.IsTrue(syncResult() < 0, "failed open should report a negative result");
+            t.Equals(call(fioRead, missingFd, readAddr, 16), -1, "failed NOWAIT open leaves no descriptor");
+        });
+
+        tc.Run("fio path lookups fold case and see created files", [](TestCase &t)
+        {
+            TestContext test;
+            std::filesystem::create_directories(test.paths.cdRoot / "Data");
+            writeHostFile(test.paths.cdRoot / "Data" / "Level1.BIN", {1, 2, 3, 4});
+
+            auto openPath = [&](const std::string &path, uint32_t flags)
+            {
+                writeGuestString(test.rdram.data(), GUEST_STRING_AREA_START, path);
+                setRegU32(test.ctx, 4, GUEST_STRING_AREA_START);
+                setRegU32(test.ctx, 5, flags);
+                fioOpen(test.rdram.data(), &test.ctx, nullptr);
+                const int32_t fd = getRegS32(&test.ctx, 2);
+                if (fd >= 0)
+                {
+                    setRegU32(test.ctx, 4, static_cast<uint32_t>(fd));
+                    fioClose(test.rdram.data(), &test.ctx, nullptr);
+                }
+                return fd >= 0;
+            };
+
+            t.IsTrue(openPath("cdrom0:\\DATA\\LEVEL1.BIN;1", PS2_FIO_O_RDONLY),
+                     "upper-case guest path should open a mixed-case host file");
+            t.IsTrue(openPath("cdrom0:\\DATA\\LEVEL1.BIN;1", PS2_FIO_O_RDONLY),
+                     "repeated lookup should be served from the cache");
+            t.IsFalse(openPath("host0:data/new.bin", PS2_FIO_O_RDONLY),
+                      "missing file should fail to open");
+
+            t.IsTrue(openPath("host0:data/new.bin", PS2_FIO_WRITE_CREATE_TRUNC),
+                     "O_CREAT should create the file");
+            t.IsTrue(std::filesystem::exists(test.paths.cdRoot / "Data" / "new.bin"),
+                     "new file should land in the existing mixed-case directory");
+            t.IsTrue(openPath("host0:DATA/NEW.BIN", PS2_FIO_O_RDONLY),
+                     "created file should replace the cached negative lookup");
+
+            writeGuestString(test.rdram.data(), GUEST_STRING_AREA_START, "host0:data/new.bin");
+            setRegU32(test.ctx, 4, GUEST_STRING_AREA_START);
+            fioRemove(test.rdram.data(), &test.ctx, nullptr);
+            t.Equals(getRegS32(&test.ctx, 2), 0, "fioRemove should succeed");
+            t.IsFalse(openPath("host0:data/new.bin", PS2_FIO_O_RDONLY),
+                      "removed file should no longer resolve");
+
+#ifdef __linux__
+            t.IsFalse(openPath("host0:data/outside.bin", PS2_FIO_O_RDONLY), "not created yet");
+            writeHostFile(test.paths.cdRoot / "Data" / "Outside.BIN", {5});
+            t.IsTrue(openPath("host0:data/outside.bin", PS2_FIO_O_RDONLY),
+                     "a file created outside the runtime should resolve by case right after a miss");
+#endif
+        });
+
         tc.Run("mc0 paths isolated from cdRoot", [](TestCase &t)
         {
             TestContext test;
@@ -0,0 +1,153 @@
+#include "MiniTest.h"
+#include "ps2_runtime.h"
+#include "ps2_runtime_macros.h"
+#include "ps2_syscalls.h"
+#include "ps2_trace.h"
+#include <ThreadNaming.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Leaves tracing stopped and the buffers empty.
+    class TraceScope
+    {
+    public:
+        TraceScope()
+        {
+            ps2_trace::stop();
+            ps2_trace::reset();
+        }
+
+        ~TraceScope()
+        {
+            ps2_trace::stop();
+            ps2_trace::reset();
+        }
+    };
+
+    bool contains(const std::string &text, const char *needle)
+    {
+        return text.find(needle) != std::string::npos;
+    }
+
+    size_t occurrences(const std::string &text, const char *needle)
+    {
+        size_t count = 0;
+        for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1))
+            ++count;
+        return count;
+    }
+}
+
+void register_ps2_trace_tests()
+{
+    MiniTest::Case("PS2Trace", [](TestCase &tc)
+    {
+        tc.Run("nothing is recorded while stopped", [](TestCase &t)
+        {
+            TraceScope scope;
+            {
+                PS2_TRACE_SCOPE("test", "ignored");
+                PS2_TRACE_INSTANT("test", "ignored instant", "n", 1);
+            }
+            t.Equals(ps2_trace::eventCount(), static_cast<uint64_t>(0), "no events");
+        });
+
+        tc.Run("scopes and instants become chrome trace events per thread", [](TestCase &t)
+        {
+            TraceScope scope;
+            ps2_trace::Options options;
+            t.IsTrue(ps2_trace::start(options), "started");
+            t.IsFalse(ps2_trace::start(options), "already tracing");
+
+            std::thread worker([]()
+                               {
+                ThreadNaming::SetCurrentThreadName("TraceTestWorker");
+                PS2_TRACE_SCOPE_ARG("rpc", "SifCallRpc", "rpc", 7);
+                PS2_TRACE_INSTANT("thread", "StartThread", "tid", 3); });
+            worker.join();
+            t.IsTrue(ps2_trace::stop(), "stopped");
+
+            const std::string json = ps2_trace::json();
+            t.Equals(ps2_trace::eventCount(), static_cast<uint64_t>(3), "begin, instant and end");
+            t.IsTrue(contains(json, "\"args\":{\"name\":\"TraceTestWorker\"}"), "thread named from ThreadNaming");
+            t.IsTrue(contains(json, "{\"name\":\"SifCallRpc\",\"cat\":\"rpc\",\"ph\":\"B\""), "begin event");
+            t.IsTrue(contains(json, "\"args\":{\"rpc\":7}"), "begin argument");
+            t.IsTrue(contains(json, "{\"name\":\"SifCallRpc\",\"cat\":\"rpc\",\"ph\":\"E\""), "end event");
+            t.IsTrue(contains(json, "\"ph\":\"i\"") && contains(json, "\"s\":\"t\""), "thread-scoped instant");
+            t.IsTrue(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0 && contains(json, "]}\n"),
+                     "trace object");
+        });
+
+        tc.Run("thread syscalls are named after themselves", [](TestCase &t)
+        {
+            TraceScope scope;
+            std::vector<uint8_t> rdram(PS2_RAM_SIZE, 0);
+            constexpr uint32_t kParamAddr = 0x00010000u;
+            const uint32_t param[7] = {0u, 0x00100000u, 0x00200000u, 0x1000u, 0x00300000u, 10u, 0u};
+            std::memcpy(rdram.data() + kParamAddr, param, sizeof(param));
+
+            R5900Context ctx;
+            SET_GPR_U32(&ctx, 4, kParamAddr);
+            ps2_syscalls::CreateThread(rdram.data(), &ctx, nullptr);
+            const int32_t tid = GPR_S32((&ctx), 2);
+            t.IsTrue(tid > 0, "thread created");
+
+            ps2_trace::start(ps2_trace::Options{});
+            SET_GPR_U32(&ctx, 4, static_cast<uint32_t>(tid));
+            ps2_syscalls::StartThread(rdram.data(), &ctx, nullptr); // entry not registered, fails after the lookup
+            SET_GPR_U32(&ctx, 4, static_cast<uint32_t>(tid));
+            ps2_syscalls::DeleteThread(rdram.data(), &ctx, nullptr);
+            ps2_trace::stop();
+
+            const std::string json = ps2_trace::json();
+            t.Equals(occurrences(json, "{\"name\":\"StartThread\",\"cat\":\"thread\",\"ph\":\"i\""), static_cast<size_t>(1),
+                     "one StartThread instant");
+            t.Equals(occurrences(json, "{\"name\":\"DeleteThread\",\"cat\":\"thread\",\"ph\":\"i\""), static_cast<size_t>(1),
+                     "one DeleteThread instant");
+        });
+
+        tc.Run("buffers grow across chunks up to the cap", [](TestCase &t)
+        {
+            TraceScope scope;
+            ps2_trace::Options options;
+            options.eventsPerThread = 3000;
+            ps2_trace::start(options);
+
+            std::thread worker([]()
+                               {
+                for (int i = 0; i < 2500; ++i)
+                    PS2_TRACE_INSTANT("test", "tick", "i", i); });
+            worker.join();
+            ps2_trace::stop();
+
+            t.Equals(ps2_trace::eventCount(), static_cast<uint64_t>(2500), "every event kept");
+            t.Equals(ps2_trace::droppedCount(), static_cast<uint64_t>(0), "nothing dropped");
+            const std::string json = ps2_trace::json();
+            t.IsTrue(contains(json, "\"args\":{\"i\":1024}") && contains(json, "\"args\":{\"i\":2499}"),
+                     "events past the first chunk");
+        });
+
+        tc.Run("full buffers drop and count events", [](TestCase &t)
+        {
+            TraceScope scope;
+            ps2_trace::Options options;
+            options.eventsPerThread = 2;
+            ps2_trace::start(options);
+
+            std::thread worker([]()
+                               {
+                for (int i = 0; i < 5; ++i)
+                    PS2_TRACE_INSTANT("test", "tick", "i", i); });
+            worker.join();
+            ps2_trace::stop();
+
+            t.Equals(ps2_trace::eventCount(), static_cast<uint64_t>(2), "capacity kept");
+            t.Equals(ps2_trace::droppedCount(), static_cast<uint64_t>(3), "rest dropped");
+        });
+    });
+}
@@ -0,0 +1,276 @@
+#include "MiniTest.h"
+#include "ps2_memory.h"
+#include "ps2_gs_swizzle.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::vector<uint8_t> makeBytes(size_t bytes, uint32_t seed)
+    {
+        std::vector<uint8_t> data(bytes);
+        uint32_t state = seed;
+        for (uint8_t &value : data)
+        {
+            state = state * 1664525u + 1013904223u;
+            value = static_cast<uint8_t>(state >> 24);
+        }
+        return data;
+    }
+
+    // Component `comp` of element `index`, decoded one field at a time.
+    uint32_t referenceComponent(const ps2_vif::Unpack &u, const uint8_t *src, uint32_t index, uint32_t comp)
+    {
+        if (u.vl == 3)
+        {
+            uint16_t v;
+            std::memcpy(&v, src + index * 2u, sizeof(v));
+            const uint32_t shifts[4] = {0, 5, 10, 15};
+            return comp == 3 ? ((v >> 15) & 1u) << 7 : ((v >> shifts[comp]) & 0x1Fu) << 3;
+        }
+        const uint32_t count = u.vn + 1u;
+        uint32_t field = comp;
+        if (u.vn == 0)
+            field = 0;
+        else if (u.vn == 1)
+            field = comp & 1u;
+        else if (u.vn == 2 && comp == 3)
+            return 0;
+
+        const uint32_t bytes = 4u >> u.vl;
+        const uint8_t *p = src + (index * count + field) * bytes;
+        if (bytes == 4)
+        {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        if (bytes == 2)
+        {
+            uint16_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return u.zeroExtend ? v : static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(v)));
+        }
+        return u.zeroExtend ? *p : static_cast<uint32_t>(static_cast<int32_t>(static_cast<int8_t>(*p)));
+    }
+
+    void referenceUnpack(const ps2_vif::Unpack &u, const uint8_t *src, uint8_t *mem, uint32_t qwords, uint32_t row[4],
+                         const uint32_t col[4])
+    {
+        const uint32_t cl = u.cl ? u.cl : 256u;
+        const uint32_t wl = u.wl ? u.wl : 256u;
+        uint32_t qw = u.addr;
+        uint32_t element = 0;
+        for (uint32_t i = 0, pos = 0; i < u.num; ++i)
+        {
+            const bool fromData = cl >= wl || pos < cl;
+            const uint32_t cyclePos = pos < 3u ? pos : 3u;
+            uint32_t *out = reinterpret_cast<uint32_t *>(mem + (qw & (qwords - 1u)) * 16u);
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                uint32_t value = row[c];
+                if (fromData)
+                {
+                    value = referenceComponent(u, src, element, c);
+                    if (u.mode != 0)
+                        value += row[c];
+                }
+                const uint32_t sel = u.masked ? (u.mask >> (cyclePos * 8u + c * 2u)) & 3u : 0u;
+                if (sel == 0 && fromData && u.mode == 2)
+                    row[c] = value;
+                if (sel == 1)
+                    value = row[c];
+                else if (sel == 2)
+                    value = col[cyclePos];
+                if (sel != 3)
+                    out[c] = value;
+            }
+            if (fromData)
+                ++element;
+            ++qw;
+            if (++pos == wl)
+            {
+                pos = 0;
+                if (cl >= wl)
+                    qw += cl - wl;
+            }
+        }
+    }
+
+    void putWord(std::vector<uint8_t> &out, uint32_t word)
+    {
+        const size_t at = out.size();
+        out.resize(at + 4);
+        std::memcpy(out.data() + at, &word, sizeof(word));
+    }
+
+    uint32_t vifCode(uint32_t cmd, uint32_t num, uint32_t imm)
+    {
+        return (cmd << 24) | (num << 16) | imm;
+    }
+}
+
+void register_ps2_vif_tests()
+{
+    MiniTest::Case("PS2Vif", [](TestCase &tc)
+    {
+        tc.Run("UNPACK kernels match a per-component reference", [](TestCase &t)
+        {
+            const std::vector<uint8_t> source = makeBytes(4096, 3);
+            const std::vector<uint8_t> initial = makeBytes(1024 * 16, 9);
+            struct Cycle
+            {
+                uint32_t cl, wl;
+            };
+            const Cycle cycles[] = {{4, 4}, {4, 2}, {2, 4}, {1, 3}};
+            const uint32_t formats[][2] = {{0, 0}, {1, 0}, {2, 0}, {3, 0}, {0, 1}, {1, 1}, {2, 1},
+                                           {3, 1}, {0, 2}, {1, 2}, {2, 2}, {3, 2}, {3, 3}};
+
+            bool allMatch = true;
+            std::string firstMismatch;
+            for (const auto &format : formats)
+            {
+                for (const Cycle &cycle : cycles)
+                {
+                    for (uint32_t variant = 0; variant < 12; ++variant)
+                    {
+                        ps2_vif::Unpack u;
+                        u.vn = format[0];
+                        u.vl = format[1];
+                        u.zeroExtend = (variant & 1u) != 0;
+                        u.masked = (variant & 2u) != 0;
+                        u.mode = variant >> 2; // normal, offset, difference
+                        u.mask = 0xE4A51B6Cu;
+                        u.addr = 1020; // wraps at the end of VU1 data memory
+                        u.num = 37;
+                        u.cl = cycle.cl;
+                        u.wl = cycle.wl;
+
+                        std::vector<uint8_t> simd = initial;
+                        std::vector<uint8_t> reference = initial;
+                        uint32_t rowSimd[4] = {1, 0x100, 0xFFFFFFF0u, 7};
+                        uint32_t rowRef[4] = {1, 0x100, 0xFFFFFFF0u, 7};
+                        const uint32_t col[4] = {0xC0, 0xC1, 0xC2, 0xC3};
+                        ps2_vif::unpack(u, source.data(), simd.data(), 1024, rowSimd, col);
+                        referenceUnpack(u, source.data(), reference.data(), 1024, rowRef, col);
+                        if (allMatch && (simd != reference || std::memcmp(rowSimd, rowRef, sizeof(rowRef)) != 0))
+                        {
+                            allMatch = false;
+                            firstMismatch = "vn=" + std::to_string(u.vn) + " vl=" + std::to_string(u.vl) +
+                                            " cl=" + std::to_string(u.cl) + " wl=" + std::to_string(u.wl) +
+                                            " variant=" + std::to_string(variant);
+                        }
+                    }
+                }
+            }
+            t.IsTrue(allMatch, "every format, cycle, mask and mode agrees " + firstMismatch);
+
+            ps2_vif::Unpack v3;
+            v3.vn = 2;
+            v3.num = 10;
+            v3.cl = 1;
+            v3.wl = 1;
+            t.Equals(ps2_vif::unpackBytes(v3), 120u, "V3-32 consumes 12 bytes per vector");
+            ps2_vif::Unpack v2_8 = v3;
+            v2_8.vn = 1;
+            v2_8.vl = 2;
+            v2_8.num = 3;
+            t.Equals(ps2_vif::unpackBytes(v2_8), 8u, "V2-8 rounds up to whole words");
+            ps2_vif::Unpack fill = v3;
+            fill.vn = 3;
+            fill.num = 8;
+            fill.cl = 1;
+            fill.wl = 4;
+            t.Equals(ps2_vif::unpackBytes(fill), 32u, "filling write reads CL of every WL vectors");
+        });
+
+        tc.Run("VIF1 DMA stream drives registers, microcode, MSCAL and UNPACK", [](TestCase &t)
+        {
+            PS2Memory mem;
+            t.IsTrue(mem.initialize(), "memory initializes");
+            std::vector<uint32_t> calls;
+            std::vector<uint32_t> tops;
+            mem.setVuMicroHandler(1, [&](uint32_t pc)
+            {
+                calls.push_back(pc);
+                tops.push_back(mem.vif(1).top);
+            });
+
+            std::vector<uint8_t> stream;
+            putWord(stream, vifCode(ps2_vif::BASE, 0, 0x10));
+            putWord(stream, vifCode(ps2_vif::OFFSET, 0, 0x80));
+            putWord(stream, vifCode(ps2_vif::STCYCL, 0, 0x0104)); // CL 4, WL 1
+            putWord(stream, vifCode(ps2_vif::MPG, 2, 8));          // 2 doublewords at 64 bytes
+            for (uint32_t w = 0; w < 4; ++w)
+                putWord(stream, 0xA0000000u + w);
+            putWord(stream, vifCode(0x6D, 3, 0x8000 | 2)); // V4-16, FLG, addr 2
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                putWord(stream, (0x0002u << 16) | (0xFFFFu - i)); // x = -1 - i, y = 2
+                putWord(stream, 0x7FFF0000u | i);                  // z = i, w = 0x7FFF
+            }
+            putWord(stream, vifCode(ps2_vif::MSCAL, 0, 4));
+            putWord(stream, vifCode(ps2_vif::MSCAL, 0, 6));
+            putWord(stream, vifCode(ps2_vif::MARK, 0, 0x1234));
+
+            // Deliver a few words at a time, as FIFO writes would.
+            for (size_t offset = 0; offset < stream.size(); offset += 12)
+                mem.feedVif(1, stream.data() + offset, static_cast<uint32_t>(std::min<size_t>(12, stream.size() - offset)));
+
+            uint32_t code[4];
+            std::memcpy(code, mem.getVUCode(1) + 64, sizeof(code));
+            t.IsTrue(code[0] == 0xA0000000u && code[3] == 0xA0000003u, "MPG uploads microcode");
+
+            const uint8_t *data = mem.getVUData(1);
+            int32_t vec[4];
+            std::memcpy(vec, data + (0x10 + 2 + 4) * 16, sizeof(vec)); // second vector, skipped by CL-WL
+            t.IsTrue(vec[0] == -2 && vec[1] == 2 && vec[2] == 1 && vec[3] == 0x7FFF, "UNPACK sign-extends at TOPS+ADDR");
+
+            t.Equals(static_cast<uint32_t>(calls.size()), 2u, "two microprograms started");
+            t.IsTrue(calls.size() == 2 && calls[0] == 4 && calls[1] == 6, "MSCAL passes the start address");
+            t.IsTrue(tops.size() == 2 && tops[0] == 0x10 && tops[1] == 0x90, "TOP alternates between double buffers");
+            t.Equals(mem.read32(0x10003C30), 0x1234u, "MARK readable through VIF1 registers");
+            t.Equals(mem.read32(0x10003C40), 0x0104u, "CYCLE readable through VIF1 registers");
+        });
+
+        tc.Run("VIF1 DIRECT feeds GIF PATH2", [](TestCase &t)
+        {
+            PS2Memory mem;
+            t.IsTrue(mem.initialize(), "memory initializes");
+            const std::vector<uint8_t> image = makeBytes(8 * 2 * 4, 21);
+
+            std::vector<uint8_t> gif;
+            auto qword = [&gif](uint64_t lo, uint64_t hi)
+            {
+                const size_t at = gif.size();
+                gif.resize(at + 16);
+                std::memcpy(gif.data() + at, &lo, 8);
+                std::memcpy(gif.data() + at + 8, &hi, 8);
+            };
+            qword(4ull | (1ull << 60), 0xEu); // PACKED A+D x4
+            qword((32ull << 32) | (1ull << 48), 0x50);
+            qword(0, 0x51);
+            qword(8ull | (2ull << 32), 0x52);
+            qword(0, 0x53);
+            qword((image.size() / 16) | 0x8000ull | (2ull << 58), 0); // IMAGE, EOP
+            gif.insert(gif.end(), image.begin(), image.end());
+
+            std::vector<uint8_t> stream;
+            for (int i = 0; i < 3; ++i)
+                putWord(stream, 0);
+            putWord(stream, vifCode(ps2_vif::DIRECT, 0, static_cast<uint32_t>(gif.size() / 16)));
+            stream.insert(stream.end(), gif.begin(), gif.end());
+
+            // Word-sized pieces exercise the qword regrouping in front of the GIF parser.
+            for (size_t offset = 0; offset < stream.size(); offset += 4)
+                mem.write32(0x10005000, *reinterpret_cast<const uint32_t *>(stream.data() + offset));
+            mem.flushGs();
+
+            std::vector<uint8_t> readBack(image.size());
+            ps2_gs_swizzle::readImage(mem.getGSVRAM(), ps2_gs_swizzle::PSMCT32, 32, 1, 0, 0, 8, 2, readBack.data(), 32);
+            t.IsTrue(readBack == image, "image sent through DIRECT lands in VRAM");
+        });
+    });
+}
@@ -0,0 +1,324 @@
+#include "MiniTest.h"
+#include "ps2_memory.h"
+#include "ps2_runtime.h"
+#include "ps2_vu.h"
+#include "ps2recomp/vu_code_generator.h"
+#include "ps2recomp/vu_decoder.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ps2recomp;
+
+namespace
+{
+    // Micro mode encoders; each pair is stored lower word first.
+    uint32_t upper(uint32_t op, uint32_t dest, uint32_t ft, uint32_t fs, uint32_t fd)
+    {
+        return dest << 21 | ft << 16 | fs << 11 | fd << 6 | op;
+    }
+
+    uint32_t upperSpecial(uint32_t index, uint32_t dest, uint32_t ft, uint32_t fs)
+    {
+        return dest << 21 | ft << 16 | fs << 11 | (index >> 2) << 6 | 0x3Cu | (index & 3u);
+    }
+
+    uint32_t lower(uint32_t op, uint32_t dest, uint32_t it, uint32_t is, int32_t imm11)
+    {
+        return op << 25 | dest << 21 | it << 16 | is << 11 | (static_cast<uint32_t>(imm11) & 0x7FFu);
+    }
+
+    uint32_t lowerImm15(uint32_t op, uint32_t it, uint32_t is, uint32_t imm15)
+    {
+        return op << 25 | it << 16 | is << 11 | (imm15 & 0x7800u) << 10 | (imm15 & 0x7FFu);
+    }
+
+    uint32_t lowerSpecial(uint32_t index, uint32_t dest, uint32_t it, uint32_t is)
+    {
+        return 0x80000000u | dest << 21 | it << 16 | is << 11 | (index >> 2) << 6 | 0x3Cu | (index & 3u);
+    }
+
+    uint32_t lowerIntegerImm(uint32_t it, uint32_t is, uint32_t imm5)
+    {
+        return 0x80000000u | it << 16 | is << 11 | (imm5 & 0x1Fu) << 6 | VU0_S1_VIADDI;
+    }
+
+    constexpr uint32_t kUpperNop = 0x2FFu;
+    constexpr uint32_t kLowerNop = 0x8000033Cu; // MOVE with an empty dest
+    constexpr uint32_t kEBit = 1u << 30;
+    constexpr uint32_t kLoopPc = 7;
+    constexpr uint32_t kEndPc = 19;
+
+    // Transforms vi1 vertices from qword 1 by the matrix at 0x30, divides by w,
+    // stores FTOI4 results from 0x40 and kicks the GIF packet at 0x80.
+    std::vector<uint32_t> transformProgram(int32_t loopStep)
+    {
+        std::vector<uint32_t> words;
+        auto pair = [&words](uint32_t lo, uint32_t up)
+        {
+            words.push_back(lo);
+            words.push_back(up);
+        };
+        pair(lower(VU_LOWER_ILW, 8, 1, 0, 0), kUpperNop);
+        pair(lowerImm15(VU_LOWER_IADDIU, 2, 0, 1), kUpperNop);
+        pair(lowerImm15(VU_LOWER_IADDIU, 3, 0, 0x40), kUpperNop);
+        for (uint32_t row = 0; row < 4; ++row)
+            pair(lower(VU_LOWER_LQ, 0xF, 4 + row, 0, 0x30 + static_cast<int32_t>(row)), kUpperNop);
+        pair(lowerSpecial(VU0_S2_VLQI, 0xF, 1, 2), kUpperNop);                                         // 7
+        pair(kLowerNop, upperSpecial(VU0_S2_VMULAx, 0xF, 1, 4));                                       // ACC = vf4 * x
+        pair(kLowerNop, upperSpecial(VU0_S2_VMADDAy, 0xF, 1, 5));                                      // + vf5 * y
+        pair(kLowerNop, upperSpecial(VU0_S2_VMADDAz, 0xF, 1, 6));                                      // + vf6 * z
+        pair(kLowerNop, upper(VU0_S1_VMADDw, 0xF, 1, 7, 2));                                           // vf2 = .. + vf7 * w
+        pair(0x80000000u | 3u << 23 | 3u << 21 | 2u << 16 | VU0_S2_VDIV >> 2 << 6 | 0x3Cu, kUpperNop); // Q = vf0w / vf2w
+        pair(lowerImm15(VU_LOWER_ISUBIU, 1, 1, 1), upper(VU0_S1_VMULq, 0xE, 0, 2, 2));
+        pair(kLowerNop, upperSpecial(VU0_S2_VFTOI4, 0xF, 3, 2));
+        pair(lowerSpecial(VU0_S2_VSQI, 0xF, 3, 3), kUpperNop);
+        pair(lower(VU_LOWER_IBNE, 0, 0, 1, static_cast<int32_t>(kLoopPc) - 17), kUpperNop); // 16
+        pair(lowerIntegerImm(6, 6, static_cast<uint32_t>(loopStep)), kUpperNop);            // delay slot
+        pair(lowerImm15(VU_LOWER_IADDIU, 7, 0, 0x80), kUpperNop);
+        pair(lowerSpecial(VU_LOWER_S2_XGKICK, 0, 0, 7), kUpperNop | kEBit);
+        pair(kLowerNop, kUpperNop);
+        return words;
+    }
+
+    void putWord(std::vector<uint8_t> &out, uint32_t word)
+    {
+        const size_t at = out.size();
+        out.resize(at + 4);
+        std::memcpy(out.data() + at, &word, sizeof(word));
+    }
+
+    uint32_t vifCode(uint32_t cmd, uint32_t num, uint32_t imm)
+    {
+        return (cmd << 24) | (num << 16) | imm;
+    }
+
+    std::vector<uint8_t> mpgStream(const std::vector<uint32_t> &words)
+    {
+        std::vector<uint8_t> stream;
+        putWord(stream, 0); // NOP so the MPG payload is doubleword aligned, as in a DMA packet
+        putWord(stream, vifCode(ps2_vif::MPG, static_cast<uint32_t>(words.size() / 2), 0));
+        for (uint32_t word : words)
+            putWord(stream, word);
+        return stream;
+    }
+
+    void writeScene(uint8_t *data, uint32_t vertices)
+    {
+        std::memcpy(data, &vertices, sizeof(vertices));
+        for (uint32_t v = 0; v < vertices; ++v)
+        {
+            const float vertex[4] = {1.0f + v, -2.0f * v, 0.5f, 1.0f};
+            std::memcpy(data + (1 + v) * 16, vertex, sizeof(vertex));
+        }
+        const float matrix[16] = {2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 1, 0.25f, 10, 20, 30, 2};
+        std::memcpy(data + 0x30 * 16, matrix, sizeof(matrix));
+        const uint64_t tag[2] = {1ull | (1ull << 15) | (1ull << 60), 0xEull}; // NLOOP 1, EOP, A+D
+        std::memcpy(data + 0x80 * 16, tag, sizeof(tag));
+    }
+
+    // vf3 = vf1 + vf2 and vi4 = 7, ending after one more pair.
+    std::vector<uint32_t> addProgram()
+    {
+        return {lowerImm15(VU_LOWER_IADDIU, 4, 0, 7), upper(VU0_S1_VADD, 0xF, 2, 1, 3),
+                kLowerNop, kUpperNop | kEBit,
+                kLowerNop, kUpperNop};
+    }
+
+    int g_compiledCalls = 0;
+
+    uint32_t compiledTransform(ps2_vu::State &vu, uint32_t pc)
+    {
+        ++g_compiledCalls;
+        vu.vi[6] = 42;
+        vu.tpc = pc + 1;
+        return ps2_vu::kEnd;
+    }
+}
+
+void register_ps2_vu_tests()
+{
+    MiniTest::Case("PS2Vu", [](TestCase &tc)
+    {
+        tc.Run("VU1 interprets microcode uploaded by MPG and started by MSCAL", [](TestCase &t)
+        {
+            PS2Memory mem;
+            t.IsTrue(mem.initialize(), "memory initializes");
+            std::vector<uint8_t> kicked;
+            mem.vu(1).setKickHandler([&](const uint8_t *packet, uint32_t bytes)
+            {
+                kicked.assign(packet, packet + bytes);
+            });
+            writeScene(mem.getVUData(1), 2);
+
+            std::vector<uint8_t> stream = mpgStream(transformProgram(1));
+            putWord(stream, vifCode(ps2_vif::MSCAL, 0, 0));
+            mem.feedVif(1, stream.data(), static_cast<uint32_t>(stream.size()));
+
+            int32_t first[4];
+            int32_t second[4];
+            std::memcpy(first, mem.getVUData(1) + 0x40 * 16, sizeof(first));
+            std::memcpy(second, mem.getVUData(1) + 0x41 * 16, sizeof(second));
+            t.IsTrue(first[0] == 90 && first[1] == 150 && first[2] == 229 && first[3] == 34,
+                     "first vertex transformed, divided by w and converted to 12.4");
+            t.IsTrue(second[0] == 105 && second[1] == 105 && second[2] == 229 && second[3] == 34,
+                     "loop transforms the second vertex");
+
+            const ps2_vu::State &vu = mem.vu(1).state();
+            t.Equals(static_cast<uint32_t>(vu.vi[6]), 2u, "branch delay slot runs on every iteration");
+            t.Equals(static_cast<uint32_t>(vu.vi[1]), 0u, "loop counter reaches zero");
+            t.Equals(vu.tpc, kEndPc + 2, "TPC points past the E-bit delay slot");
+            t.Equals(static_cast<uint32_t>(kicked.size()), 32u, "XGKICK hands over tag and one A+D qword");
+            t.Equals(mem.vu(1).interpretedRuns(), uint64_t{1}, "unknown microcode is interpreted");
+            t.Equals(mem.vu(1).compiledRuns(), uint64_t{0}, "nothing recompiled was registered");
+        });
+
+        tc.Run("Registered programs run only for matching uploads", [](TestCase &t)
+        {
+            PS2Memory mem;
+            t.IsTrue(mem.initialize(), "memory initializes");
+            mem.vu(1).setKickHandler([](const uint8_t *, uint32_t) {});
+            writeScene(mem.getVUData(1), 2);
+
+            const std::vector<uint32_t> words = transformProgram(1);
+            const uint32_t bytes = static_cast<uint32_t>(words.size() * 4);
+            ps2_vu::ProgramInfo info;
+            info.unit = 1;
+            info.start = 0;
+            info.size = bytes;
+            info.hash = ps2_vu::contentHash(reinterpret_cast<const uint8_t *>(words.data()), bytes);
+            info.entry = compiledTransform;
+            mem.registerVuProgram(info);
+
+            g_compiledCalls = 0;
+            std::vector<uint8_t> stream = mpgStream(words);
+            putWord(stream, vifCode(ps2_vif::MSCAL, 0, 0));
+            mem.feedVif(1, stream.data(), static_cast<uint32_t>(stream.size()));
+            t.Equals(g_compiledCalls, 1, "matching upload runs the registered program");
+            t.Equals(static_cast<uint32_t>(mem.vu(1).state().vi[6]), 42u, "registered program updates state");
+            t.Equals(mem.vu(1).compiledRuns(), uint64_t{1}, "compiled run counted");
+
+            stream = mpgStream(transformProgram(3));
+            putWord(stream, vifCode(ps2_vif::MSCAL, 0, 0));
+            mem.feedVif(1, stream.data(), static_cast<uint32_t>(stream.size()));
+            t.Equals(g_compiledCalls, 1, "different microcode at the same address is not dispatched");
+            t.Equals(static_cast<uint32_t>(mem.vu(1).state().vi[6]), 48u, "changed upload is interpreted");
+            t.Equals(mem.vu(1).interpretedRuns(), uint64_t{1}, "interpreted run counted");
+        });
+
+        tc.Run("VCALLMS runs VU0 micro memory on the macro mode registers", [](TestCase &t)
+        {
+            PS2Runtime runtime;
+            t.IsTrue(runtime.memory().initialize(), "memory initializes");
+            PS2Memory &mem = runtime.memory();
+            const std::vector<uint32_t> words = addProgram();
+            for (size_t w = 0; w < words.size(); ++w)
+                mem.write32(PS2_VU0_CODE_BASE + 0x100 + static_cast<uint32_t>(w * 4), words[w]);
+
+            R5900Context &ctx = runtime.cpu();
+            ctx.vu0_vf[1] = _mm_setr_ps(1.0f, 2.0f, 3.0f, 4.0f);
+            ctx.vu0_vf[2] = _mm_setr_ps(10.0f, 20.0f, 30.0f, 40.0f);
+            runtime.executeVU0Microprogram(mem.getRDRAM(), &ctx, 0x100);
+
+            t.IsTrue(ps2_vu::lane(ctx.vu0_vf[3], 0) == 11.0f && ps2_vu::lane(ctx.vu0_vf[3], 3) == 44.0f,
+                     "micro mode result lands in the macro mode VF registers");
+            t.Equals(static_cast<uint32_t>(ctx.vi[4]), 7u, "VI registers are shared too");
+            t.Equals(ctx.vu0_tpc, 0x118u, "TPC stops after the E-bit delay slot");
+            t.Equals(mem.vu(0).interpretedRuns(), uint64_t{1}, "unregistered code is interpreted");
+
+            const uint32_t bytes = static_cast<uint32_t>(words.size() * 4);
+            ps2_vu::ProgramInfo info;
+            info.unit = 0;
+            info.start = 0x100;
+            info.size = bytes;
+            info.hash = ps2_vu::contentHash(reinterpret_cast<const uint8_t *>(words.data()), bytes);
+            info.entry = compiledTransform;
+            mem.registerVuProgram(info);
+            g_compiledCalls = 0;
+            runtime.executeVU0Microprogram(mem.getRDRAM(), &ctx, 0x100);
+            t.Equals(g_compiledCalls, 1, "code stored by the EE is matched by hash and start address");
+            t.Equals(static_cast<uint32_t>(ctx.vi[6]), 42u, "compiled program writes back through the context");
+
+            mem.write32(PS2_VU0_CODE_BASE + 0x100, lowerImm15(VU_LOWER_IADDIU, 4, 0, 9));
+            runtime.executeVU0Microprogram(mem.getRDRAM(), &ctx, 0x100);
+            t.Equals(g_compiledCalls, 1, "a store into the program retires the compiled version");
+            t.Equals(static_cast<uint32_t>(ctx.vi[4]), 9u, "modified code is interpreted");
+        });
+
+        tc.Run("decoder splits pairs and finds chained MPG uploads", [](TestCase &t)
+        {
+            const std::vector<uint32_t> words = transformProgram(1);
+            VUDecoder decoder;
+            const VUInstruction branch = decoder.decodePair(16 * 8, words[32], words[33]);
+            t.IsTrue(branch.valid && branch.isBranch, "IBNE decodes as a branch");
+            t.Equals(branch.branchTarget, kLoopPc, "branch target is relative to the next pair");
+            t.Equals(static_cast<uint32_t>(branch.is), 1u, "IBNE compares vi1");
+
+            const VUInstruction divide = decoder.decodePair(12 * 8, words[24], words[25]);
+            t.IsTrue(divide.valid && divide.lowerSpecial && divide.lowerFunction == VU0_S2_VDIV, "DIV is a lower special");
+            t.IsTrue(divide.fsf == 3 && divide.ftf == 3 && divide.it == 2, "DIV field selectors decode");
+
+            const VUInstruction kick = decoder.decodePair(kEndPc * 8, words[kEndPc * 2], words[kEndPc * 2 + 1]);
+            t.IsTrue(kick.valid && kick.eBit && kick.lowerFunction == VU_LOWER_S2_XGKICK, "E bit and XGKICK decode");
+
+            const VUInstruction immediate = decoder.decodePair(0, 0x40000000u, kUpperNop | 0x80000000u);
+            t.IsTrue(immediate.valid && immediate.iBit, "lower word of an I-bit pair is a float, not an instruction");
+
+            // One upload split over two MPGs, as a DMA packet would carry it.
+            const uint32_t split = 10;
+            std::vector<uint8_t> image;
+            putWord(image, 0);
+            putWord(image, vifCode(ps2_vif::MPG, split, 0));
+            for (uint32_t w = 0; w < split * 2; ++w)
+                putWord(image, words[w]);
+            putWord(image, 0); // NOP so the next payload stays doubleword aligned
+            putWord(image, vifCode(ps2_vif::MPG, static_cast<uint32_t>(words.size() / 2) - split, split));
+            for (uint32_t w = split * 2; w < words.size(); ++w)
+                putWord(image, words[w]);
+            while (image.size() % 16)
+                putWord(image, 0);
+
+            Section section{".data", 0x200000, static_cast<uint32_t>(image.size()), 0, false, true, false, false, image.data()};
+            const std::vector<VUMicroprogram> programs = decoder.findMicroprograms({section});
+            t.Equals(static_cast<uint32_t>(programs.size()), 1u, "chained MPGs form one upload");
+            if (programs.empty())
+                return;
+            const VUMicroprogram &program = programs.front();
+            const uint32_t bytes = static_cast<uint32_t>(words.size() * 4);
+            t.Equals(static_cast<uint32_t>(program.code.size()), bytes, "both MPG payloads collected");
+            t.Equals(program.elfAddress, 0x200008u, "upload address points at the first payload");
+            t.IsTrue(program.hash == ps2_vu::contentHash(reinterpret_cast<const uint8_t *>(words.data()), bytes),
+                     "recompiler hash matches the runtime upload hash");
+        });
+
+        tc.Run("generator emits labels, delay slots and registration", [](TestCase &t)
+        {
+            const std::vector<uint32_t> words = transformProgram(1);
+            VUMicroprogram program;
+            program.loadAddress = 0;
+            program.code.resize(words.size() * 4);
+            std::memcpy(program.code.data(), words.data(), program.code.size());
+            VUDecoder decoder;
+            program.instructions = decoder.decodeProgram(program.code.data(), static_cast<uint32_t>(program.code.size()), 0);
+            program.hash = VUDecoder::contentHash(program.code.data(), program.code.size());
+
+            const std::string code = VUCodeGenerator().generateFile({program});
+#ifdef PRINT_GENERATED_CODE
+            std::cout << code << std::endl;
+#endif
+            const std::string name = VUCodeGenerator::getProgramName(program);
+            t.IsTrue(code.find("uint32_t " + name + "(ps2_vu::State &vu, uint32_t pc)") != std::string::npos,
+                     "program function emitted");
+            t.IsTrue(code.find("goto L_7;") != std::string::npos, "loop branch jumps to its label");
+            t.IsTrue(code.find("// delay slot") != std::string::npos, "delay slot inlined after the branch");
+            t.IsTrue(code.find("vu.tpc = 0x15u;") != std::string::npos, "E bit ends after its delay slot");
+            t.IsTrue(code.find("ps2_vu::xgkick(vu, vi7);") != std::string::npos, "XGKICK calls the runtime");
+            t.IsTrue(code.find("ps2_vu::setFlags") == std::string::npos, "flags skipped when nothing reads them");
+            t.IsTrue(code.find("registerVuProgram({1, 0x0, 0xa8,") != std::string::npos, "VU1 registration emitted");
+            t.IsTrue(code.find("registerVuProgram({0, 0x0, 0xa8,") != std::string::npos,
+                     "program small enough for VU0 is registered there too");
+        });
+    });
+}
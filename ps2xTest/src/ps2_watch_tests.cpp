@@ -0,0 +1,122 @@
+#include "MiniTest.h"
+#include "ps2_log.h"
+#include "ps2_runtime.h"
+#include "ps2_watch.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Collects log text while alive and leaves no watchpoints behind.
+    class WatchScope
+    {
+    public:
+        WatchScope()
+        {
+            ps2_watch::clear();
+            ps2_log::flush();
+            ps2_log::setSink([this](ps2_log::Level, ps2_log::Category, std::string_view text)
+                             {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_lines.emplace_back(text); });
+        }
+
+        ~WatchScope()
+        {
+            ps2_log::flush();
+            ps2_log::setSink({});
+            ps2_watch::clear();
+        }
+
+        std::vector<std::string> lines()
+        {
+            ps2_log::flush();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_lines;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<std::string> m_lines;
+    };
+
+    bool contains(const std::string &text, const char *needle)
+    {
+        return text.find(needle) != std::string::npos;
+    }
+}
+
+void register_ps2_watch_tests()
+{
+    MiniTest::Case("PS2Watch", [](TestCase &tc)
+    {
+        tc.Run("spec accepts sizes, ranges and labels", [](TestCase &t)
+        {
+            WatchScope scope;
+            t.IsTrue(ps2_watch::configure("0x20100100:16=path, 0x2000-0x2010,0x3000"), "spec accepted");
+            const auto armed = ps2_watch::list();
+            t.Equals(armed.size(), static_cast<size_t>(3), "three watchpoints");
+            t.Equals(armed[0].address, 0x00100100u, "kseg address masked to RDRAM");
+            t.Equals(armed[0].size, 16u, "addr:size");
+            t.Equals(armed[0].label, std::string("path"), "label kept");
+            t.Equals(armed[1].size, 0x10u, "start-end");
+            t.Equals(armed[2].size, 4u, "bare address watches a word");
+
+            t.IsFalse(ps2_watch::configure("nonsense,0x40-0x20"), "malformed entries reported");
+            t.Equals(ps2_watch::list().size(), static_cast<size_t>(3), "malformed entries skipped");
+        });
+
+        tc.Run("only armed pages pass the filter", [](TestCase &t)
+        {
+            WatchScope scope;
+            t.IsFalse(ps2_watch::mayHit(0x5000, 4), "nothing armed");
+            ps2_watch::add(0x5000, 8);
+            t.IsTrue(ps2_watch::mayHit(0x5FFC, 4), "same page");
+            t.IsTrue(ps2_watch::mayHit(0x4FFE, 4), "store straddling into the page");
+            t.IsFalse(ps2_watch::mayHit(0x7000, 16), "other page");
+            t.IsFalse(ps2_watch::overlaps(0x5008, 4), "same page but outside the range");
+            t.IsTrue(ps2_watch::overlaps(0x5006, 4), "overlaps the range tail");
+            ps2_watch::clear();
+            t.IsFalse(ps2_watch::mayHit(0x5000, 4), "cleared");
+        });
+
+        tc.Run("hits report old and new bytes and are counted", [](TestCase &t)
+        {
+            WatchScope scope;
+            std::vector<uint8_t> rdram(PS2_RAM_SIZE, 0);
+            R5900Context ctx;
+            ctx.pc = 0x00123450;
+            rdram[0x1000] = 0x2F;
+            ps2_watch::add(0x1000, 4, "flag");
+
+            ps2_watch::noteWrite(rdram.data(), 0x1000, 4, 0, 0, "WRITE32", &ctx);
+            ps2_watch::noteWrite(rdram.data(), 0x1004, 4, 1, 0, "WRITE32", &ctx); // same page, missed
+            ps2_watch::noteRangeWrite(rdram.data(), 0x0FF0, 0x20, "memcpy", &ctx);
+
+            const auto lines = scope.lines();
+            t.Equals(lines.size(), static_cast<size_t>(2), "one line per hit");
+            t.IsTrue(contains(lines[0], "flag #1") && contains(lines[0], "pc=0x123450"), "label, count and pc");
+            t.IsTrue(contains(lines[0], "0x2f->0x0 (ZEROED)"), "old and new bytes");
+            t.IsTrue(contains(lines[1], "op=memcpy") && contains(lines[1], "buf=2f.00.00.00"), "range write dump");
+            t.Equals(ps2_watch::list()[0].hits, static_cast<uint64_t>(2), "hits counted");
+        });
+
+        tc.Run("copy loops log every hit up to the per-watchpoint cap", [](TestCase &t)
+        {
+            WatchScope scope;
+            std::vector<uint8_t> rdram(PS2_RAM_SIZE, 0);
+            R5900Context ctx;
+            ps2_watch::add(0x2000, 0x1000, "buffer");
+
+            for (uint32_t i = 0; i < ps2_watch::kMaxLoggedHits + 10u; ++i)
+                ps2_watch::noteWrite(rdram.data(), 0x2000 + (i & 0xFFFu), 1, i & 0xFFu, 0, "WRITE8", &ctx);
+
+            const auto lines = scope.lines();
+            t.Equals(lines.size(), static_cast<size_t>(ps2_watch::kMaxLoggedHits), "not cut by the log rate limit");
+            t.IsFalse(contains(lines.back(), "suppressed"), "nothing suppressed");
+            t.Equals(ps2_watch::list()[0].hits, static_cast<uint64_t>(ps2_watch::kMaxLoggedHits + 10u), "later hits counted");
+        });
+    });
+}